@@ -32,14 +32,21 @@
 #include <Urho3D/Graphics/IndexBuffer.h>
 #include <Urho3D/Graphics/Light.h>
 #include <Urho3D/Graphics/Material.h>
+#include <Urho3D/Graphics/MeshOptimizer.h>
 #include <Urho3D/Graphics/Octree.h>
 #include <Urho3D/Graphics/VertexBuffer.h>
 #include <Urho3D/Graphics/Zone.h>
+#include <Urho3D/IO/ContentCache.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/IO/MemoryBuffer.h>
+#include <Urho3D/IO/VectorBuffer.h>
 #ifdef URHO3D_PHYSICS
+#include <Urho3D/Physics/CollisionModel.h>
 #include <Urho3D/Physics/PhysicsWorld.h>
 #endif
+#include <Urho3D/Resource/Image.h>
 #include <Urho3D/Resource/ResourceCache.h>
 #include <Urho3D/Resource/XMLFile.h>
 #include <Urho3D/Scene/Scene.h>
@@ -49,6 +56,7 @@
 #endif
 
 #include <assimp/config.h>
+#include <assimp/cfileio.h>
 #include <assimp/cimport.h>
 #include <assimp/scene.h>
 #include <assimp/postprocess.h>
@@ -135,6 +143,8 @@ const char *transformSuffix[TransformationComp_MAXIMUM] =
 };
 
 static const unsigned MAX_CHANNELS = 4;
+// Version of the cached import results. Increment when the output of any command changes
+static const unsigned CACHE_VERSION = 2;
 
 SharedPtr<Context> context_(new Context());
 const aiScene* scene_ = nullptr;
@@ -163,6 +173,12 @@ bool noOverwriteTexture_ = false;
 bool noOverwriteNewerTexture_ = false;
 bool checkUniqueModel_ = true;
 bool moveToBindPose_ = false;
+bool optimizeMeshes_ = true;
+bool quantizeVertices_ = false;
+unsigned lodLevels_ = 0;
+float lodRatio_ = 0.5f;
+float lodDistance_ = 0.0f;
+unsigned clusterTriangles_ = 0;
 unsigned maxBones_ = 64;
 Vector<String> nonSkinningBoneIncludes_;
 Vector<String> nonSkinningBoneExcludes_;
@@ -175,6 +191,11 @@ float defaultTicksPerSecond_ = 4800.0f;
 float importStartTime_ = 0.0f;
 float importEndTime_ = 0.0f;
 bool suppressFbxPivotNodes_ = true;
+// Content cache of import results, keyed by the input files and the command line
+SharedPtr<ContentCache> contentCache_;
+String cacheKey_;
+Vector<String> outputFiles_;
+Vector<String> dependencyFiles_;
 
 int main(int argc, char** argv);
 void Run(const Vector<String>& arguments);
@@ -202,6 +223,23 @@ void BuildAndSaveMaterial(aiMaterial* material, HashSet<String>& usedTextures);
 void CopyTextures(const HashSet<String>& usedTextures, const String& sourcePath);
 
 void CombineLods(const PODVector<float>& lodDistances, const Vector<String>& modelNames, const String& outName);
+void PackScene(const String& inName, const String& outName);
+String GetCacheKey(const Vector<String>& arguments);
+void GetInputFileArguments(const Vector<String>& arguments, PODVector<unsigned>& dest);
+bool RestoreCachedOutputs();
+void StoreCachedOutputs();
+void AddOutputFile(const String& fileName);
+void AddDependencyFile(const String& fileName);
+aiFile* OpenImportFile(aiFileIO* fileIO, const char* fileName, const char* mode);
+void CloseImportFile(aiFileIO* fileIO, aiFile* file);
+size_t ReadImportFile(aiFile* file, char* buffer, size_t size, size_t count);
+size_t WriteImportFile(aiFile* file, const char* buffer, size_t size, size_t count);
+size_t GetImportFilePosition(aiFile* file);
+size_t GetImportFileSize(aiFile* file);
+aiReturn SeekImportFile(aiFile* file, size_t offset, aiOrigin origin);
+void FlushImportFile(aiFile* file);
+void CompressTexture(const String& inName, const String& outName, CompressedFormat format, CompressionQuality quality, bool sRGB);
+void CookCollision(const String& inName, const String& outName, bool triangleMesh, bool convexHull);
 
 void GetMeshesUnderNode(Vector<Pair<aiNode*, aiMesh*> >& dest, aiNode* node);
 unsigned GetMeshIndex(aiMesh* mesh);
@@ -222,6 +260,7 @@ void WriteVertex(float*& dest, aiMesh* mesh, unsigned index, bool isSkinned, Bou
     const Matrix3x4& vertexTransform, const Matrix3& normalTransform, Vector<PODVector<unsigned char> >& blendIndices,
     Vector<PODVector<float> >& blendWeights);
 PODVector<VertexElement> GetVertexElements(aiMesh* mesh, bool isSkinned);
+void QuantizeVertices(Model* model);
 
 aiNode* GetNode(const String& name, aiNode* rootNode, bool caseSensitive = true);
 aiMatrix4x4 GetDerivedTransform(aiNode* node, aiNode* rootNode, bool rootInclusive = true);
@@ -270,6 +309,13 @@ void Run(const Vector<String>& arguments)
             "dump        Dump scene node structure. No output file is generated\n"
             "lod         Combine several Urho3D models as LOD levels of the output model\n"
             "            Syntax: lod <dist0> <mdl0> <dist1 <mdl1> ... <output file>\n"
+            "packscene   Convert an Urho3D XML, JSON or binary scene to the packed binary format\n"
+            "            Syntax: packscene <input scene> <output file>\n"
+            "texture     Compress an image to a DDS file with mipmaps\n"
+            "            Syntax: texture <input image> <output file> [dxt1|dxt3|dxt5|etc1] [fast|normal|high] [srgb]\n"
+            "collision   Precook triangle mesh BVHs and convex hulls of an Urho3D model for all\n"
+            "            LOD levels. CollisionShape uses them when saved next to the model as .col\n"
+            "            Syntax: collision <input model> <output file> [trimesh] [convex]\n"
             "\n"
             "Options:\n"
             "-b          Save scene in binary format, default format is XML\n"
@@ -285,8 +331,17 @@ void Run(const Vector<String>& arguments)
             "-ns         Do not create subdirectories for resources\n"
             "-nz         Do not create a zone and a directional light (scene mode only)\n"
             "-nf         Do not fix infacing normals\n"
+            "-no         Do not optimize triangle and vertex order for vertex cache, overdraw\n"
+            "            and vertex fetch\n"
             "-ne         Do not save empty nodes (scene mode only)\n"
             "-mb <x>     Maximum number of bones per submesh. Default 64\n"
+            "-lod <n> <ratio> <distance> Generate n LOD levels by mesh simplification. Each\n"
+            "            level keeps ratio of the triangles of the previous one, and the LOD\n"
+            "            distances are multiples of distance\n"
+            "-cl <n>     Split geometries of at least 1024 triangles into clusters of at most\n"
+            "            n triangles for culling parts of them. 128 is a good default\n"
+            "-q          Quantize positions, normals and tangents to 16-bit normalized and\n"
+            "            texture coordinates to half floats\n"
             "-p <path>   Set path for scene resources. Default is output file path\n"
             "-r <name>   Use the named scene node as root node\n"
             "-f <freq>   Animation tick frequency to use if unspecified. Default 4800\n"
@@ -306,9 +361,15 @@ void Run(const Vector<String>& arguments)
             "-split <start> <end> (animation model only)\n"
             "            Split animation, will only import from start frame to end frame\n"
             "-np         Do not suppress $fbx pivot nodes (FBX files only)\n"
+            "-cache <dir> Skip the import and restore the previous output files if the input\n"
+            "            files and the command line match an import stored in the cache dir\n"
         );
     }
 
+    // Library code logs for example when creating directories, which requires the log subsystem. Show only warnings and errors
+    auto* log = new Log(context_);
+    log->SetLevel(LOG_WARNING);
+    context_->RegisterSubsystem(log);
     context_->RegisterSubsystem(new FileSystem(context_));
     context_->RegisterSubsystem(new ResourceCache(context_));
     context_->RegisterSubsystem(new WorkQueue(context_));
@@ -320,6 +381,7 @@ void Run(const Vector<String>& arguments)
 
     String command = arguments[0].ToLower();
     String rootNodeName;
+    String cacheDir;
 
     unsigned flags =
         aiProcess_ConvertToLeftHanded |
@@ -399,6 +461,10 @@ void Run(const Vector<String>& arguments)
                     flags &= ~aiProcess_FixInfacingNormals;
                     break;
 
+                case 'o':
+                    optimizeMeshes_ = false;
+                    break;
+
                 case 'p':
                         suppressFbxPivotNodes_ = false;
                     break;
@@ -412,6 +478,18 @@ void Run(const Vector<String>& arguments)
                     maxBones_ = 1;
                 ++i;
             }
+            else if (argument == "lod" && i + 3 < arguments.Size())
+            {
+                lodLevels_ = ToUInt(value);
+                lodRatio_ = Clamp(ToFloat(arguments[i + 2]), 0.0f, 1.0f);
+                lodDistance_ = ToFloat(arguments[i + 3]);
+                i += 3;
+            }
+            else if (argument == "cl" && !value.Empty())
+            {
+                clusterTriangles_ = ToUInt(value);
+                ++i;
+            }
             else if (argument == "p" && !value.Empty())
             {
                 resourcePath_ = AddTrailingSlash(value);
@@ -442,6 +520,8 @@ void Run(const Vector<String>& arguments)
                     }
                 }
             }
+            else if (argument == "q")
+                quantizeVertices_ = true;
             else if (argument == "v")
                 verboseLog_ = true;
             else if (argument == "eao")
@@ -456,6 +536,11 @@ void Run(const Vector<String>& arguments)
                 checkUniqueModel_ = false;
             else if (argument == "bp")
                 moveToBindPose_ = true;
+            else if (argument == "cache" && !value.Empty())
+            {
+                cacheDir = value;
+                ++i;
+            }
             else if (argument == "split")
             {
                 String value2 = i + 2 < arguments.Size() ? arguments[i + 2] : String::EMPTY;
@@ -468,6 +553,16 @@ void Run(const Vector<String>& arguments)
         }
     }
 
+    if (!cacheDir.Empty() && command != "dump")
+    {
+        contentCache_ = new ContentCache(context_);
+        if (!contentCache_->SetCacheDir(cacheDir))
+            ErrorExit("Could not use cache directory " + cacheDir);
+        cacheKey_ = GetCacheKey(arguments);
+        if (RestoreCachedOutputs())
+            return;
+    }
+
     if (command == "model" || command == "scene" || command == "anim" || command == "node" || command == "dump")
     {
         String inFile = arguments[1];
@@ -504,6 +599,11 @@ void Run(const Vector<String>& arguments)
 
         PrintLine("Reading file " + inFile);
 
+        // When caching, read through callbacks that record the files Assimp opens, such as OBJ material libraries and glTF
+        // buffers, as dependencies of the import
+        aiFileIO fileIO{OpenImportFile, CloseImportFile, nullptr};
+        aiFileIO* fileSystem = contentCache_ ? &fileIO : nullptr;
+
         if (!inFile.EndsWith(".fbx", false))
             suppressFbxPivotNodes_ = false;
 
@@ -522,13 +622,13 @@ void Run(const Vector<String>& arguments)
             aiSetImportPropertyInteger(aiprops, AI_CONFIG_IMPORT_FBX_PRESERVE_PIVOTS, 0);                //**false, default = true;
             aiSetImportPropertyInteger(aiprops, AI_CONFIG_IMPORT_FBX_OPTIMIZE_EMPTY_ANIMATION_CURVES, 1);//default = true;
 
-            scene_ = aiImportFileExWithProperties(GetNativePath(inFile).CString(), flags, nullptr, aiprops);
+            scene_ = aiImportFileExWithProperties(GetNativePath(inFile).CString(), flags, fileSystem, aiprops);
 
             // prevent processing animation suppression, both cannot work simultaneously
             suppressFbxPivotNodes_ = false;
         }
         else
-            scene_ = aiImportFile(GetNativePath(inFile).CString(), flags);
+            scene_ = aiImportFileEx(GetNativePath(inFile).CString(), flags, fileSystem);
 
         if (!scene_)
             ErrorExit("Could not open or parse input file " + inFile + ": " + String(aiGetErrorString()));
@@ -614,8 +714,76 @@ void Run(const Vector<String>& arguments)
 
         CombineLods(lodDistances, modelNames, outFile);
     }
+    else if (command == "packscene")
+    {
+        if (arguments.Size() < 3 || arguments[2][0] == '-')
+            ErrorExit("No output file defined");
+
+        PackScene(GetInternalPath(arguments[1]), GetInternalPath(arguments[2]));
+    }
+    else if (command == "texture")
+    {
+        if (arguments.Size() < 3 || arguments[2][0] == '-')
+            ErrorExit("No output file defined");
+
+        CompressedFormat format = CF_DXT5;
+        CompressionQuality quality = COMPRESSION_NORMAL;
+        bool sRGB = false;
+        // Positional options end at the first option switch, such as -cache
+        for (unsigned i = 3; i < arguments.Size() && arguments[i][0] != '-'; ++i)
+        {
+            String argument = arguments[i].ToLower();
+            if (argument == "dxt1")
+                format = CF_DXT1;
+            else if (argument == "dxt3")
+                format = CF_DXT3;
+            else if (argument == "dxt5")
+                format = CF_DXT5;
+            else if (argument == "etc1")
+                format = CF_ETC1;
+            else if (argument == "fast")
+                quality = COMPRESSION_FAST;
+            else if (argument == "normal")
+                quality = COMPRESSION_NORMAL;
+            else if (argument == "high")
+                quality = COMPRESSION_HIGH;
+            else if (argument == "srgb")
+                sRGB = true;
+            else
+                ErrorExit("Unrecognized texture option " + arguments[i]);
+        }
+
+        CompressTexture(GetInternalPath(arguments[1]), GetInternalPath(arguments[2]), format, quality, sRGB);
+    }
+    else if (command == "collision")
+    {
+        if (arguments.Size() < 3 || arguments[2][0] == '-')
+            ErrorExit("No output file defined");
+
+        bool triangleMesh = false;
+        bool convexHull = false;
+        for (unsigned i = 3; i < arguments.Size() && arguments[i][0] != '-'; ++i)
+        {
+            String argument = arguments[i].ToLower();
+            if (argument == "trimesh")
+                triangleMesh = true;
+            else if (argument == "convex")
+                convexHull = true;
+            else
+                ErrorExit("Unrecognized collision option " + arguments[i]);
+        }
+
+        // Cook both shape types if neither is specified
+        if (!triangleMesh && !convexHull)
+            triangleMesh = convexHull = true;
+
+        CookCollision(GetInternalPath(arguments[1]), GetInternalPath(arguments[2]), triangleMesh, convexHull);
+    }
     else
         ErrorExit("Unrecognized command " + command);
+
+    if (contentCache_)
+        StoreCachedOutputs();
 }
 
 void DumpNodes(aiNode* rootNode, unsigned level)
@@ -1130,6 +1298,15 @@ void BuildAndSaveModel(OutModel& model)
         for (unsigned j = 0; j < mesh->mNumVertices; ++j)
             WriteVertex(dest, mesh, j, isSkinned, box, vertexTransform, normalTransform, blendIndices, blendWeights);
 
+        // Reorder triangles and vertices for the GPU. Position is always the first vertex element
+        if (optimizeMeshes_)
+        {
+            float acmrBefore, acmrAfter;
+            OptimizeMesh(vertexData, vb->GetVertexSize(), 0, indexData, ib->GetIndexSize(), startIndexOffset, validFaces * 3,
+                startVertexOffset, mesh->mNumVertices, 1.05f, &acmrBefore, &acmrAfter);
+            PrintLine("Optimized geometry " + String(i) + ", ACMR " + String(acmrBefore) + " -> " + String(acmrAfter));
+        }
+
         // Calculate the geometry center
         Vector3 center = Vector3::ZERO;
         if (validFaces)
@@ -1220,10 +1397,50 @@ void BuildAndSaveModel(OutModel& model)
             outModel->SetGeometryBoneMappings(allBoneMappings);
     }
 
+    // Generate LOD levels after the skeleton, as they share the vertices and bone mappings of the highest detail level
+    if (lodLevels_)
+    {
+        PODVector<float> ratios;
+        PODVector<float> distances;
+        float ratio = 1.0f;
+        for (unsigned i = 0; i < lodLevels_; ++i)
+        {
+            ratio *= lodRatio_;
+            ratios.Push(ratio);
+            distances.Push(lodDistance_ * (i + 1));
+        }
+
+        outModel->GenerateLodLevels(ratios, distances);
+        for (unsigned i = 0; i < outModel->GetNumGeometries(); ++i)
+        {
+            String triangleCounts;
+            for (unsigned j = 0; j < outModel->GetNumGeometryLodLevels(i); ++j)
+                triangleCounts += " " + String(outModel->GetGeometry(i, j)->GetIndexCount() / 3);
+            PrintLine("Geometry " + String(i) + " LOD level triangle counts:" + triangleCounts);
+        }
+    }
+
+    // Cluster after LOD generation, so that the lower detail levels get clusters too
+    if (clusterTriangles_)
+    {
+        outModel->GenerateClusters(clusterTriangles_);
+        for (unsigned i = 0; i < outModel->GetNumGeometries(); ++i)
+        {
+            unsigned numClusters = outModel->GetGeometry(i, 0)->GetClusters().Size();
+            if (numClusters)
+                PrintLine("Geometry " + String(i) + " split into " + String(numClusters) + " clusters");
+        }
+    }
+
+    // Quantize last, as LOD generation and the optimizations above work on float positions
+    if (quantizeVertices_)
+        QuantizeVertices(outModel);
+
     File outFile(context_);
     if (!outFile.Open(model.outName_, FILE_WRITE))
         ErrorExit("Could not open output file " + model.outName_);
     outModel->Save(outFile);
+    AddOutputFile(model.outName_);
 
     // If exporting materials, also save material list for use by the editor
     if (!noMaterials_ && saveMaterialList_)
@@ -1234,6 +1451,7 @@ void BuildAndSaveModel(OutModel& model)
         {
             for (unsigned i = 0; i < model.meshes_.Size(); ++i)
                 listFile.WriteLine(GetMeshMaterialName(model.meshes_[i]));
+            AddOutputFile(materialListName);
         }
         else
             PrintLine("Warning: could not write material list file " + materialListName);
@@ -1493,6 +1711,7 @@ void BuildAndSaveAnimations(OutModel* model)
         if (!outFile.Open(animOutName, FILE_WRITE))
             ErrorExit("Could not open output file " + animOutName);
         outAnim->Save(outFile);
+        AddOutputFile(animOutName);
     }
 }
 
@@ -1808,6 +2027,7 @@ void BuildAndSaveScene(OutScene& scene, bool asPrefab)
         else
             outRootNode->SaveXML(file);
     }
+    AddOutputFile(scene.outName_);
 }
 
 void ExportMaterials(HashSet<String>& usedTextures)
@@ -1975,6 +2195,7 @@ void BuildAndSaveMaterial(aiMaterial* material, HashSet<String>& usedTextures)
     if (!outFile.Open(outFileName, FILE_WRITE))
         ErrorExit("Could not open output file " + outFileName);
     outMaterial.Save(outFile);
+    AddOutputFile(outFileName);
 }
 
 void CopyTextures(const HashSet<String>& usedTextures, const String& sourcePath)
@@ -2008,6 +2229,7 @@ void CopyTextures(const HashSet<String>& usedTextures, const String& sourcePath)
                     PrintLine("Saving embedded texture " + GetFileNameAndExtension(fullDestName));
                     File dest(context_, fullDestName, FILE_WRITE);
                     dest.Write((const void*)tex->pcData, tex->mWidth);
+                    dest.Close();
                 }
                 // RGBA8 texture
                 else
@@ -2018,12 +2240,15 @@ void CopyTextures(const HashSet<String>& usedTextures, const String& sourcePath)
                     memcpy(image.GetData(), (const void*)tex->pcData, (size_t)tex->mWidth * tex->mHeight * 4);
                     image.SavePNG(fullDestName);
                 }
+                AddOutputFile(fullDestName);
             }
         }
         else
         {
             String fullSourceName = sourcePath + *i;
             String fullDestName = resourcePath_ + (useSubdirs_ ? "Textures/" : "") + *i;
+            // Also a dependency when skipped, so that the import is redone once the texture exists
+            AddDependencyFile(fullSourceName);
 
             if (!fileSystem->FileExists(fullSourceName))
             {
@@ -2054,6 +2279,7 @@ void CopyTextures(const HashSet<String>& usedTextures, const String& sourcePath)
 
             PrintLine("Copying material texture " + *i);
             fileSystem->Copy(fullSourceName, fullDestName);
+            AddOutputFile(fullDestName);
         }
     }
 }
@@ -2146,6 +2372,305 @@ void CombineLods(const PODVector<float>& lodDistances, const Vector<String>& mod
     if (!outFile.Open(outName, FILE_WRITE))
         ErrorExit("Could not open output file " + outName);
     outModel->Save(outFile);
+    outFile.Close();
+    AddOutputFile(outName);
+}
+
+void PackScene(const String& inName, const String& outName)
+{
+    // Keep references to resources that can not be loaded here, so that they are written out unchanged
+    auto* cache = context_->GetSubsystem<ResourceCache>();
+    cache->SetReturnFailedResources(true);
+    cache->AddResourceDir(GetPath(inName));
+
+    PrintLine("Reading scene " + inName);
+    File srcFile(context_);
+    if (!srcFile.Open(inName))
+        ErrorExit("Could not open input scene " + inName);
+
+    SharedPtr<Scene> scene(new Scene(context_));
+    String extension = GetExtension(inName);
+    bool success;
+    if (extension == ".xml")
+        success = scene->LoadXML(srcFile);
+    else if (extension == ".json")
+        success = scene->LoadJSON(srcFile);
+    else
+        success = scene->Load(srcFile);
+    if (!success)
+        ErrorExit("Could not load input scene " + inName);
+
+    PrintLine("Writing packed scene " + outName);
+    File outFile(context_);
+    if (!outFile.Open(outName, FILE_WRITE))
+        ErrorExit("Could not open output file " + outName);
+    if (!scene->SavePacked(outFile))
+        ErrorExit("Could not write packed scene " + outName);
+    outFile.Close();
+    AddOutputFile(outName);
+}
+
+void CompressTexture(const String& inName, const String& outName, CompressedFormat format, CompressionQuality quality, bool sRGB)
+{
+    // Encode on all cores
+    auto* queue = context_->GetSubsystem<WorkQueue>();
+    if (!queue->GetNumThreads())
+        queue->CreateThreads(Max(GetNumLogicalCPUs(), 2U) - 1);
+
+    PrintLine("Reading image " + inName);
+    File srcFile(context_);
+    if (!srcFile.Open(inName))
+        ErrorExit("Could not open input image " + inName);
+
+    SharedPtr<Image> image(new Image(context_));
+    if (!image->Load(srcFile))
+        ErrorExit("Could not load input image " + inName);
+    image->SetSRGB(sRGB);
+
+    if (!image->Compress(format, quality))
+        ErrorExit("Could not compress image " + inName);
+
+    PrintLine("Writing compressed image " + outName);
+    if (!image->SaveDDS(outName))
+        ErrorExit("Could not write compressed image " + outName);
+    AddOutputFile(outName);
+}
+
+void CookCollision(const String& inName, const String& outName, bool triangleMesh, bool convexHull)
+{
+#ifdef URHO3D_PHYSICS
+    PrintLine("Reading model " + inName);
+    File srcFile(context_);
+    if (!srcFile.Open(inName))
+        ErrorExit("Could not open input model " + inName);
+
+    SharedPtr<Model> model(new Model(context_));
+    if (!model->Load(srcFile))
+        ErrorExit("Could not load input model " + inName);
+
+    unsigned numLodLevels = 1;
+    for (unsigned i = 0; i < model->GetNumGeometries(); ++i)
+        numLodLevels = Max(numLodLevels, model->GetNumGeometryLodLevels(i));
+
+    SharedPtr<CollisionModel> collisionModel(new CollisionModel(context_));
+    for (unsigned i = 0; i < numLodLevels; ++i)
+    {
+        PrintLine("Cooking LOD level " + String(i));
+        if (triangleMesh && !collisionModel->Cook(SHAPE_TRIANGLEMESH, model, i))
+            ErrorExit("Could not cook triangle mesh of LOD level " + String(i));
+        if (convexHull && !collisionModel->Cook(SHAPE_CONVEXHULL, model, i))
+            ErrorExit("Could not cook convex hull of LOD level " + String(i));
+    }
+
+    PrintLine("Writing collision model " + outName);
+    File outFile(context_);
+    if (!outFile.Open(outName, FILE_WRITE) || !collisionModel->Save(outFile))
+        ErrorExit("Could not write collision model " + outName);
+    AddOutputFile(outName);
+#else
+    ErrorExit("Cooking collision geometry requires the engine to be built with physics");
+#endif
+}
+
+String GetCacheKey(const Vector<String>& arguments)
+{
+    // Include the contents of the input files in the key
+    PODVector<unsigned> inputArguments;
+    GetInputFileArguments(arguments, inputArguments);
+
+    String options = ToString("AssetImporter %u\n", CACHE_VERSION) + context_->GetSubsystem<FileSystem>()->GetCurrentDir() + "\n";
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+    {
+        options += arguments[i] + "\n";
+        if (inputArguments.Contains(i))
+            options += contentCache_->GetFileKey(GetInternalPath(arguments[i]), String::EMPTY) + "\n";
+    }
+
+    return ContentCache::GetKey(options.CString(), options.Length(), String::EMPTY);
+}
+
+void GetInputFileArguments(const Vector<String>& arguments, PODVector<unsigned>& dest)
+{
+    dest.Clear();
+    String command = arguments[0].ToLower();
+
+    if (command == "lod")
+    {
+        // Syntax: lod <dist0> <mdl0> <dist1> <mdl1> ... <output file>, the models are at the even positions
+        unsigned numLodArguments = 0;
+        while (numLodArguments + 1 < arguments.Size() && arguments[numLodArguments + 1][0] != '-')
+            ++numLodArguments;
+        for (unsigned i = 2; i < numLodArguments; i += 2)
+            dest.Push(i);
+    }
+    else if (arguments.Size() > 1 && arguments[1][0] != '-')
+    {
+        // Other commands read a single input file given first, followed by the output file and for the texture and
+        // collision commands their positional options
+        dest.Push(1);
+    }
+}
+
+bool RestoreCachedOutputs()
+{
+    PODVector<unsigned char> data;
+    if (!contentCache_->Load(cacheKey_, data))
+        return false;
+
+    MemoryBuffer source(data);
+    if (source.ReadFileID() != "UCIM")
+        return false;
+
+    // Other files that were read by the import must not have changed
+    unsigned numDependencies = source.ReadVLE();
+    for (unsigned i = 0; i < numDependencies; ++i)
+    {
+        String fileName = source.ReadString();
+        String fileKey = source.ReadString();
+        if (contentCache_->GetFileKey(fileName, String::EMPTY) != fileKey)
+            return false;
+    }
+
+    auto* fileSystem = context_->GetSubsystem<FileSystem>();
+    unsigned numOutputs = source.ReadVLE();
+    for (unsigned i = 0; i < numOutputs; ++i)
+    {
+        String fileName = source.ReadString();
+        PODVector<unsigned char> contents = source.ReadBuffer();
+
+        PrintLine("Restoring cached file " + fileName);
+        fileSystem->CreateDirsRecursive(GetPath(fileName));
+        File outFile(context_);
+        if (!outFile.Open(fileName, FILE_WRITE) || (contents.Size() && outFile.Write(&contents[0], contents.Size()) != contents.Size()))
+            ErrorExit("Could not write output file " + fileName);
+    }
+
+    return true;
+}
+
+void StoreCachedOutputs()
+{
+    VectorBuffer dest;
+    dest.WriteFileID("UCIM");
+
+    dest.WriteVLE(dependencyFiles_.Size());
+    for (unsigned i = 0; i < dependencyFiles_.Size(); ++i)
+    {
+        dest.WriteString(dependencyFiles_[i]);
+        dest.WriteString(contentCache_->GetFileKey(dependencyFiles_[i], String::EMPTY));
+    }
+
+    dest.WriteVLE(outputFiles_.Size());
+    for (unsigned i = 0; i < outputFiles_.Size(); ++i)
+    {
+        File file(context_);
+        if (!file.Open(outputFiles_[i]))
+        {
+            PrintLine("Warning: could not read output file " + outputFiles_[i] + " for caching");
+            return;
+        }
+
+        PODVector<unsigned char> contents(file.GetSize());
+        if (contents.Size() && file.Read(&contents[0], contents.Size()) != contents.Size())
+        {
+            PrintLine("Warning: could not read output file " + outputFiles_[i] + " for caching");
+            return;
+        }
+        dest.WriteString(outputFiles_[i]);
+        dest.WriteBuffer(contents);
+    }
+
+    if (!contentCache_->Store(cacheKey_, dest.GetData(), dest.GetSize()))
+        PrintLine("Warning: could not store import results to the cache");
+}
+
+void AddOutputFile(const String& fileName)
+{
+    if (contentCache_ && !outputFiles_.Contains(fileName))
+        outputFiles_.Push(fileName);
+}
+
+void AddDependencyFile(const String& fileName)
+{
+    if (contentCache_ && !dependencyFiles_.Contains(fileName))
+        dependencyFiles_.Push(fileName);
+}
+
+aiFile* OpenImportFile(aiFileIO* fileIO, const char* fileName, const char* mode)
+{
+    String name = GetInternalPath(String(fileName));
+    bool write = strchr(mode, 'w') || strchr(mode, 'a');
+
+    // Check for existence first, as Assimp probes for files that may not exist and File would log an error
+    if (!write && !context_->GetSubsystem<FileSystem>()->FileExists(name))
+        return nullptr;
+
+    auto* handle = new File(context_);
+    if (!handle->Open(name, write ? FILE_WRITE : FILE_READ))
+    {
+        delete handle;
+        return nullptr;
+    }
+
+    if (!write)
+        AddDependencyFile(name);
+
+    auto* file = new aiFile();
+    file->ReadProc = ReadImportFile;
+    file->WriteProc = WriteImportFile;
+    file->TellProc = GetImportFilePosition;
+    file->FileSizeProc = GetImportFileSize;
+    file->SeekProc = SeekImportFile;
+    file->FlushProc = FlushImportFile;
+    file->UserData = (aiUserData)handle;
+    return file;
+}
+
+void CloseImportFile(aiFileIO* fileIO, aiFile* file)
+{
+    delete (File*)file->UserData;
+    delete file;
+}
+
+size_t ReadImportFile(aiFile* file, char* buffer, size_t size, size_t count)
+{
+    return size ? ((File*)file->UserData)->Read(buffer, (unsigned)(size * count)) / size : 0;
+}
+
+size_t WriteImportFile(aiFile* file, const char* buffer, size_t size, size_t count)
+{
+    return size ? ((File*)file->UserData)->Write(buffer, (unsigned)(size * count)) / size : 0;
+}
+
+size_t GetImportFilePosition(aiFile* file)
+{
+    return ((File*)file->UserData)->GetPosition();
+}
+
+size_t GetImportFileSize(aiFile* file)
+{
+    return ((File*)file->UserData)->GetSize();
+}
+
+aiReturn SeekImportFile(aiFile* file, size_t offset, aiOrigin origin)
+{
+    auto* handle = (File*)file->UserData;
+
+    // Offsets from the end are negative, the unsigned addition wraps around to the correct position
+    size_t position = offset;
+    if (origin == aiOrigin_CUR)
+        position += handle->GetPosition();
+    else if (origin == aiOrigin_END)
+        position += handle->GetSize();
+
+    if (position > handle->GetSize())
+        return aiReturn_FAILURE;
+    return handle->Seek((unsigned)position) == position ? aiReturn_SUCCESS : aiReturn_FAILURE;
+}
+
+void FlushImportFile(aiFile* file)
+{
+    ((File*)file->UserData)->Flush();
 }
 
 void GetMeshesUnderNode(Vector<Pair<aiNode*, aiMesh*> >& dest, aiNode* node)
@@ -2531,6 +3056,111 @@ PODVector<VertexElement> GetVertexElements(aiMesh* mesh, bool isSkinned)
     return ret;
 }
 
+void QuantizeVertices(Model* model)
+{
+    const Vector<SharedPtr<VertexBuffer> >& buffers = model->GetVertexBuffers();
+
+    // Use one position transform for all vertex buffers, as skinned models apply it in the skin matrices
+    BoundingBox box;
+    for (unsigned i = 0; i < buffers.Size(); ++i)
+    {
+        const VertexElement* position = buffers[i]->GetElement(TYPE_VECTOR3, SEM_POSITION);
+        const unsigned char* data = buffers[i]->GetShadowData();
+        if (!position || !data)
+            continue;
+        for (unsigned j = 0; j < buffers[i]->GetVertexCount(); ++j)
+            box.Merge(*reinterpret_cast<const Vector3*>(data + j * buffers[i]->GetVertexSize() + position->offset_));
+    }
+    if (!box.Defined())
+        return;
+
+    Vector3 offset = box.Center();
+    Vector3 halfSize = box.HalfSize();
+    float scale = Max(Max(halfSize.x_, halfSize.y_), halfSize.z_);
+    if (scale < M_EPSILON)
+        scale = 1.0f;
+
+    Vector<SharedPtr<VertexBuffer> > newBuffers;
+    PODVector<unsigned> morphRangeStarts;
+    PODVector<unsigned> morphRangeCounts;
+    unsigned oldSize = 0;
+    unsigned newSize = 0;
+    for (unsigned i = 0; i < buffers.Size(); ++i)
+    {
+        VertexBuffer* buffer = buffers[i];
+        const PODVector<VertexElement>& elements = buffer->GetElements();
+        PODVector<VertexElement> newElements = elements;
+        for (unsigned j = 0; j < newElements.Size(); ++j)
+        {
+            VertexElement& element = newElements[j];
+            if (element.semantic_ == SEM_POSITION && element.type_ == TYPE_VECTOR3 && !element.index_)
+                element.type_ = TYPE_SHORT4_NORM;
+            else if ((element.semantic_ == SEM_NORMAL || element.semantic_ == SEM_TANGENT) && (element.type_ == TYPE_VECTOR3 ||
+                element.type_ == TYPE_VECTOR4))
+                element.type_ = TYPE_SHORT4_NORM;
+            else if (element.semantic_ == SEM_TEXCOORD && element.type_ == TYPE_VECTOR2)
+                element.type_ = TYPE_HALF2;
+        }
+
+        SharedPtr<VertexBuffer> newBuffer(new VertexBuffer(context_));
+        newBuffer->SetShadowed(true);
+        newBuffer->SetSize(buffer->GetVertexCount(), newElements);
+        if (newBuffer->HasElement(TYPE_SHORT4_NORM, SEM_POSITION))
+            newBuffer->SetPositionTransform(offset, scale);
+
+        const PODVector<VertexElement>& destElements = newBuffer->GetElements();
+        unsigned vertexSize = buffer->GetVertexSize();
+        unsigned newVertexSize = newBuffer->GetVertexSize();
+        PODVector<unsigned char> newData(buffer->GetVertexCount() * newVertexSize);
+        for (unsigned j = 0; j < buffer->GetVertexCount(); ++j)
+        {
+            const unsigned char* src = buffer->GetShadowData() + j * vertexSize;
+            unsigned char* dest = &newData[j * newVertexSize];
+            for (unsigned k = 0; k < elements.Size(); ++k)
+            {
+                const VertexElement& srcElement = elements[k];
+                const VertexElement& destElement = destElements[k];
+                if (srcElement.type_ == destElement.type_)
+                {
+                    memcpy(dest + destElement.offset_, src + srcElement.offset_, ELEMENT_TYPESIZES[srcElement.type_]);
+                    continue;
+                }
+
+                Vector4 value = VertexBuffer::ReadElement(src + srcElement.offset_, srcElement.type_);
+                if (destElement.semantic_ == SEM_POSITION)
+                    value = Vector4((Vector3(value.x_, value.y_, value.z_) - offset) / scale, 1.0f);
+                else if (destElement.semantic_ == SEM_NORMAL)
+                    value.w_ = 0.0f;
+                VertexBuffer::WriteElement(dest + destElement.offset_, destElement.type_, value);
+            }
+        }
+        newBuffer->SetData(&newData[0]);
+
+        newBuffers.Push(newBuffer);
+        morphRangeStarts.Push(model->GetMorphRangeStart(i));
+        morphRangeCounts.Push(model->GetMorphRangeCount(i));
+        oldSize += buffer->GetVertexCount() * vertexSize;
+        newSize += buffer->GetVertexCount() * newVertexSize;
+    }
+
+    for (unsigned i = 0; i < model->GetNumGeometries(); ++i)
+    {
+        for (unsigned j = 0; j < model->GetNumGeometryLodLevels(i); ++j)
+        {
+            Geometry* geometry = model->GetGeometry(i, j);
+            for (unsigned k = 0; k < geometry->GetNumVertexBuffers(); ++k)
+            {
+                unsigned index = buffers.IndexOf(SharedPtr<VertexBuffer>(geometry->GetVertexBuffer(k)));
+                if (index < buffers.Size())
+                    geometry->SetVertexBuffer(k, newBuffers[index]);
+            }
+        }
+    }
+    model->SetVertexBuffers(newBuffers, morphRangeStarts, morphRangeCounts);
+
+    PrintLine("Quantized vertex data " + String(oldSize) + " -> " + String(newSize) + " bytes");
+}
+
 aiNode* GetNode(const String& name, aiNode* rootNode, bool caseSensitive)
 {
     if (!rootNode)
@@ -0,0 +1,287 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/File.h>
+#include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Resource/Decompress.h>
+#include <Urho3D/Resource/Image.h>
+
+#include "ReferenceDecompress.h"
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+/// Compressed image to decompress.
+struct BenchmarkImage
+{
+    /// Format name.
+    String name_;
+    /// Block data.
+    PODVector<unsigned char> blocks_;
+    /// Compressed format.
+    CompressedFormat format_;
+    /// Width in pixels.
+    int width_;
+    /// Height in pixels.
+    int height_;
+    /// Depth in pixels.
+    int depth_;
+};
+
+int atlasSize_ = 4096;
+unsigned numIterations_ = 10;
+String formats_ = "dxt1,dxt3,dxt5,etc1";
+String inputFileName_;
+PODVector<unsigned> threadCounts_;
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+void ParseOptions(const Vector<String>& arguments);
+void Decompress(const BenchmarkImage& image, unsigned char* rgba, bool reference, WorkQueue* queue);
+float Measure(const BenchmarkImage& image, PODVector<unsigned char>& rgba, bool reference, WorkQueue* queue);
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    ParseOptions(arguments);
+    SetRandomSeed(1);
+
+    SharedPtr<Context> context(new Context());
+    auto* log = new Log(context);
+    log->SetLevel(LOG_WARNING);
+    context->RegisterSubsystem(log);
+
+    // Time subsystem calibrates the high-resolution timer used for the measurements
+    context->RegisterSubsystem(new Time(context));
+
+    if (threadCounts_.Empty())
+    {
+        // Default to no worker threads, then powers of two up to one less than the physical CPUs
+        unsigned maxThreads = GetNumPhysicalCPUs() > 1 ? GetNumPhysicalCPUs() - 1 : 0;
+        threadCounts_.Push(0);
+        for (unsigned count = 1; count < maxThreads; count *= 2)
+            threadCounts_.Push(count);
+        if (maxThreads)
+            threadCounts_.Push(maxThreads);
+    }
+
+    Vector<BenchmarkImage> images;
+    if (!inputFileName_.Empty())
+    {
+        // Decompress the top level of a compressed DDS or KTX atlas
+        File file(context);
+        SharedPtr<Image> image(new Image(context));
+        if (!file.Open(inputFileName_) || !image->Load(file))
+            ErrorExit("Could not load image " + inputFileName_);
+        if (!image->IsCompressed())
+            ErrorExit("Image " + inputFileName_ + " is not compressed");
+
+        CompressedLevel level = image->GetCompressedLevel(0);
+        if (level.format_ != CF_DXT1 && level.format_ != CF_DXT3 && level.format_ != CF_DXT5 && level.format_ != CF_ETC1)
+            ErrorExit("Image " + inputFileName_ + " is not DXT or ETC1 compressed");
+
+        BenchmarkImage benchmarkImage;
+        benchmarkImage.name_ = GetFileNameAndExtension(inputFileName_);
+        benchmarkImage.blocks_.Resize(level.dataSize_);
+        memcpy(benchmarkImage.blocks_.Buffer(), level.data_, level.dataSize_);
+        benchmarkImage.format_ = level.format_;
+        benchmarkImage.width_ = level.width_;
+        benchmarkImage.height_ = level.height_;
+        benchmarkImage.depth_ = Max(level.depth_, 1);
+        images.Push(benchmarkImage);
+    }
+    else
+    {
+        // Any block data is valid for these formats, so fill the atlases with random blocks
+        Vector<String> formatNames = formats_.ToLower().Split(',');
+        for (unsigned i = 0; i < formatNames.Size(); ++i)
+        {
+            BenchmarkImage benchmarkImage;
+            if (formatNames[i] == "dxt1")
+                benchmarkImage.format_ = CF_DXT1;
+            else if (formatNames[i] == "dxt3")
+                benchmarkImage.format_ = CF_DXT3;
+            else if (formatNames[i] == "dxt5")
+                benchmarkImage.format_ = CF_DXT5;
+            else if (formatNames[i] == "etc1")
+                benchmarkImage.format_ = CF_ETC1;
+            else
+                ErrorExit("Unrecognized format " + formatNames[i]);
+
+            benchmarkImage.name_ = formatNames[i].ToUpper();
+            benchmarkImage.width_ = benchmarkImage.height_ = atlasSize_;
+            benchmarkImage.depth_ = 1;
+            unsigned blockSize = benchmarkImage.format_ == CF_DXT1 || benchmarkImage.format_ == CF_ETC1 ? 8 : 16;
+            unsigned blocksPerSide = (unsigned)(atlasSize_ + 3) / 4;
+            benchmarkImage.blocks_.Resize(blocksPerSide * blocksPerSide * blockSize);
+            for (unsigned j = 0; j < benchmarkImage.blocks_.Size(); ++j)
+                benchmarkImage.blocks_[j] = (unsigned char)Rand();
+            images.Push(benchmarkImage);
+        }
+    }
+
+    PrintLine("Iterations " + String(numIterations_) + ", physical CPUs " + String(GetNumPhysicalCPUs()));
+
+    for (unsigned i = 0; i < images.Size(); ++i)
+    {
+        const BenchmarkImage& image = images[i];
+        PODVector<unsigned char> referenceRgba((unsigned)(image.width_ * image.height_ * image.depth_ * 4));
+        PODVector<unsigned char> rgba(referenceRgba.Size());
+
+        float referenceMs = Measure(image, referenceRgba, true, nullptr);
+        float currentMs = Measure(image, rgba, false, nullptr);
+        if (rgba != referenceRgba)
+            ErrorExit(image.name_ + ": output differs from the previous decoder");
+
+        PrintLine(Format("{} {}x{}: previous decoder {:.3f} ms, current decoder {:.3f} ms ({:.2f}x)", image.name_,
+            image.width_, image.height_, referenceMs, currentMs, referenceMs / currentMs));
+
+        // Each thread count needs its own work queue, as worker threads can only be created once
+        for (unsigned j = 0; j < threadCounts_.Size(); ++j)
+        {
+            SharedPtr<Context> queueContext(new Context());
+            SharedPtr<WorkQueue> queue(new WorkQueue(queueContext));
+            queue->CreateThreads(threadCounts_[j]);
+
+            memset(rgba.Buffer(), 0, rgba.Size());
+            float threadedMs = Measure(image, rgba, false, queue);
+            if (rgba != referenceRgba)
+                ErrorExit(image.name_ + ": output differs from the previous decoder with worker threads");
+
+            PrintLine(Format("  {} worker threads: {:.3f} ms ({:.2f}x)", threadCounts_[j], threadedMs,
+                referenceMs / threadedMs));
+        }
+    }
+}
+
+void Decompress(const BenchmarkImage& image, unsigned char* rgba, bool reference, WorkQueue* queue)
+{
+    if (image.format_ == CF_ETC1)
+    {
+        if (reference)
+            ReferenceDecompressImageETC(rgba, image.blocks_.Buffer(), image.width_, image.height_);
+        else
+            DecompressImageETC(rgba, image.blocks_.Buffer(), image.width_, image.height_, queue);
+    }
+    else
+    {
+        if (reference)
+            ReferenceDecompressImageDXT(rgba, image.blocks_.Buffer(), image.width_, image.height_, image.depth_, image.format_);
+        else
+            DecompressImageDXT(rgba, image.blocks_.Buffer(), image.width_, image.height_, image.depth_, image.format_, queue);
+    }
+}
+
+float Measure(const BenchmarkImage& image, PODVector<unsigned char>& rgba, bool reference, WorkQueue* queue)
+{
+    // Warm up the caches and the worker threads before measuring
+    Decompress(image, rgba.Buffer(), reference, queue);
+
+    HiresTimer timer;
+    for (unsigned i = 0; i < numIterations_; ++i)
+        Decompress(image, rgba.Buffer(), reference, queue);
+
+    return numIterations_ ? (float)timer.GetUSec(false) / numIterations_ / 1000.0f : 0.0f;
+}
+
+void ParseOptions(const Vector<String>& arguments)
+{
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].Length() < 2 || arguments[i][0] != '-')
+            ErrorExit("Unrecognized argument " + arguments[i]);
+
+        char option = arguments[i][1];
+        if (option == 'h')
+        {
+            ErrorExit(
+                "Usage: DecompressBenchmark [options]\n"
+                "\n"
+                "Decompresses large DXT and ETC1 atlases with the previous and the current software\n"
+                "decoders, and with the current decoder split to a varying number of worker threads.\n"
+                "Checks that all decoders produce the same output.\n"
+                "\n"
+                "Options:\n"
+                "-s <n>    Width and height of the generated atlases, default 4096\n"
+                "-c <list> Comma-separated formats of the generated atlases, default dxt1,dxt3,dxt5,etc1\n"
+                "-i <file> Decompress the top level of a DXT or ETC1 compressed DDS or KTX file instead\n"
+                "-f <n>    Number of measured iterations, default 10\n"
+                "-t <list> Comma-separated worker thread counts, default 0 and powers of two up to\n"
+                "          the number of physical CPUs - 1\n",
+                EXIT_SUCCESS
+            );
+        }
+
+        if (i + 1 >= arguments.Size())
+            ErrorExit("No value for option " + arguments[i]);
+        const String& value = arguments[++i];
+
+        switch (option)
+        {
+        case 's':
+            atlasSize_ = Max(ToInt(value), 4);
+            break;
+        case 'c':
+            formats_ = value;
+            break;
+        case 'i':
+            inputFileName_ = value;
+            break;
+        case 'f':
+            numIterations_ = ToUInt(value);
+            break;
+        case 't':
+            {
+                Vector<String> counts = value.Split(',');
+                for (unsigned j = 0; j < counts.Size(); ++j)
+                    threadCounts_.Push(ToUInt(counts[j]));
+            }
+            break;
+        default:
+            ErrorExit("Unrecognized option " + arguments[i - 1]);
+        }
+    }
+}
@@ -0,0 +1,453 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+// Copies of the DXT and ETC1 decoders from before block decoding was restructured and split to worker threads, kept as
+// the baseline for the benchmark. The ETC1 decoder reads 32-bit words instead of unsigned long, which overran the
+// blocks on LP64 platforms.
+
+#include "ReferenceDecompress.h"
+
+using namespace Urho3D;
+
+// DXT decompression based on the Squish library
+
+/* -----------------------------------------------------------------------------
+
+    Copyright (c) 2006 Simon Brown                          si@sjbrown.co.uk
+
+    Permission is hereby granted, free of charge, to any person obtaining
+    a copy of this software and associated documentation files (the
+    "Software"), to    deal in the Software without restriction, including
+    without limitation the rights to use, copy, modify, merge, publish,
+    distribute, sublicense, and/or sell copies of the Software, and to
+    permit persons to whom the Software is furnished to do so, subject to
+    the following conditions:
+
+    The above copyright notice and this permission notice shall be included
+    in all copies or substantial portions of the Software.
+
+    THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS
+    OR IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF
+    MERCHANTABILITY, FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT.
+    IN NO EVENT SHALL THE AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY
+    CLAIM, DAMAGES OR OTHER LIABILITY, WHETHER IN AN ACTION OF CONTRACT,
+    TORT OR OTHERWISE, ARISING FROM, OUT OF OR IN CONNECTION WITH THE
+    SOFTWARE OR THE USE OR OTHER DEALINGS IN THE SOFTWARE.
+
+   -------------------------------------------------------------------------- */
+
+static int Unpack565(unsigned char const* packed, unsigned char* colour)
+{
+    // build the packed value
+    int value = (int)packed[0] | ((int)packed[1] << 8);
+
+    // get the components in the stored range
+    auto red = (unsigned char)((value >> 11) & 0x1f);
+    auto green = (unsigned char)((value >> 5) & 0x3f);
+    auto blue = (unsigned char)(value & 0x1f);
+
+    // scale up to 8 bits
+    colour[0] = (red << 3) | (red >> 2);
+    colour[1] = (green << 2) | (green >> 4);
+    colour[2] = (blue << 3) | (blue >> 2);
+    colour[3] = 255;
+
+    // return the value
+    return value;
+}
+
+static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isDxt1)
+{
+    // get the block bytes
+    auto const* bytes = reinterpret_cast< unsigned char const* >( block );
+
+    // unpack the endpoints
+    unsigned char codes[16];
+    int a = Unpack565(bytes, codes);
+    int b = Unpack565(bytes + 2, codes + 4);
+
+    // generate the midpoints
+    for (int i = 0; i < 3; ++i)
+    {
+        int c = codes[i];
+        int d = codes[4 + i];
+
+        if (isDxt1 && a <= b)
+        {
+            codes[8 + i] = (unsigned char)((c + d) / 2);
+            codes[12 + i] = 0;
+        }
+        else
+        {
+            codes[8 + i] = (unsigned char)((2 * c + d) / 3);
+            codes[12 + i] = (unsigned char)((c + 2 * d) / 3);
+        }
+    }
+
+    // fill in alpha for the intermediate values
+    codes[8 + 3] = 255;
+    codes[12 + 3] = (unsigned char)((isDxt1 && a <= b) ? 0 : 255);
+
+    // unpack the indices
+    unsigned char indices[16];
+    for (int i = 0; i < 4; ++i)
+    {
+        unsigned char* ind = indices + 4 * i;
+        unsigned char packed = bytes[4 + i];
+
+        ind[0] = (unsigned char)(packed & 0x3);
+        ind[1] = (unsigned char)((packed >> 2) & 0x3);
+        ind[2] = (unsigned char)((packed >> 4) & 0x3);
+        ind[3] = (unsigned char)((packed >> 6) & 0x3);
+    }
+
+    // store out the colours
+    for (int i = 0; i < 16; ++i)
+    {
+        auto offset = (unsigned char)(4 * indices[i]);
+        for (int j = 0; j < 4; ++j)
+            rgba[4 * i + j] = codes[offset + j];
+    }
+}
+
+static void DecompressAlphaDXT3(unsigned char* rgba, void const* block)
+{
+    auto const* bytes = reinterpret_cast< unsigned char const* >( block );
+
+    // unpack the alpha values pairwise
+    for (int i = 0; i < 8; ++i)
+    {
+        // quantise down to 4 bits
+        unsigned char quant = bytes[i];
+
+        // unpack the values
+        auto lo = (unsigned char)(quant & 0x0f);
+        auto hi = (unsigned char)(quant & 0xf0);
+
+        // convert back up to bytes
+        rgba[8 * i + 3] = lo | (lo << 4);
+        rgba[8 * i + 7] = hi | (hi >> 4);
+    }
+}
+
+static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
+{
+    // get the two alpha values
+    auto const* bytes = reinterpret_cast< unsigned char const* >( block );
+    int alpha0 = bytes[0];
+    int alpha1 = bytes[1];
+
+    // compare the values to build the codebook
+    unsigned char codes[8];
+    codes[0] = (unsigned char)alpha0;
+    codes[1] = (unsigned char)alpha1;
+    if (alpha0 <= alpha1)
+    {
+        // use 5-alpha codebook
+        for (int i = 1; i < 5; ++i)
+            codes[1 + i] = (unsigned char)(((5 - i) * alpha0 + i * alpha1) / 5);
+        codes[6] = 0;
+        codes[7] = 255;
+    }
+    else
+    {
+        // use 7-alpha codebook
+        for (int i = 1; i < 7; ++i)
+            codes[1 + i] = (unsigned char)(((7 - i) * alpha0 + i * alpha1) / 7);
+    }
+
+    // decode the indices
+    unsigned char indices[16];
+    unsigned char const* src = bytes + 2;
+    unsigned char* dest = indices;
+    for (int i = 0; i < 2; ++i)
+    {
+        // grab 3 bytes
+        int value = 0;
+        for (int j = 0; j < 3; ++j)
+        {
+            int byte = *src++;
+            value |= (byte << 8 * j);
+        }
+
+        // unpack 8 3-bit values from it
+        for (int j = 0; j < 8; ++j)
+        {
+            int index = (value >> 3 * j) & 0x7;
+            *dest++ = (unsigned char)index;
+        }
+    }
+
+    // write out the indexed codebook values
+    for (int i = 0; i < 16; ++i)
+        rgba[4 * i + 3] = codes[indices[i]];
+}
+
+static void DecompressDXT(unsigned char* rgba, const void* block, CompressedFormat format)
+{
+    // get the block locations
+    void const* colourBlock = block;
+    void const* alphaBock = block;
+    if (format == CF_DXT3 || format == CF_DXT5)
+        colourBlock = reinterpret_cast< unsigned char const* >( block ) + 8;
+
+    // decompress colour
+    DecompressColourDXT(rgba, colourBlock, format == CF_DXT1);
+
+    // decompress alpha separately if necessary
+    if (format == CF_DXT3)
+        DecompressAlphaDXT3(rgba, alphaBock);
+    else if (format == CF_DXT5)
+        DecompressAlphaDXT5(rgba, alphaBock);
+}
+
+void ReferenceDecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format)
+{
+    // initialise the block input
+    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
+    int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+
+    // loop over blocks
+    for (int z = 0; z < depth; ++z)
+    {
+        int sz = width * height * 4 * z;
+        for (int y = 0; y < height; y += 4)
+        {
+            for (int x = 0; x < width; x += 4)
+            {
+                // decompress the block
+                unsigned char targetRgba[4 * 16];
+                DecompressDXT(targetRgba, sourceBlock, format);
+
+                // write the decompressed pixels to the correct image locations
+                unsigned char const* sourcePixel = targetRgba;
+                for (int py = 0; py < 4; ++py)
+                {
+                    for (int px = 0; px < 4; ++px)
+                    {
+                        // get the target location
+                        int sx = x + px;
+                        int sy = y + py;
+                        if (sx < width && sy < height)
+                        {
+                            unsigned char* targetPixel = rgba + sz + 4 * (width * sy + sx);
+
+                            // copy the rgba value
+                            for (int i = 0; i < 4; ++i)
+                                *targetPixel++ = *sourcePixel++;
+                        }
+                        else
+                        {
+                            // skip this pixel as its outside the image
+                            sourcePixel += 4;
+                        }
+                    }
+                }
+
+                // advance
+                sourceBlock += bytesPerBlock;
+            }
+        }
+    }
+}
+
+// ETC decompression based on the Oolong Engine
+
+/*
+Oolong Engine for the iPhone / iPod touch
+Copyright (c) 2007-2008 Wolfgang Engel  http://code.google.com/p/oolongengine/
+
+This software is provided 'as-is', without any express or implied warranty
+In no event will the authors be held liable for any damages arising from the
+use of this software. Permission is granted to anyone to use this software for
+any purpose,  including commercial applications, and to alter it and
+redistribute it freely, subject to the following restrictions:
+
+1. The origin of this software must not be misrepresented; you must not claim
+that you wrote the original software. If you use this software in a product, an
+acknowledgment in the product documentation would be appreciated but is not
+required.
+2. Altered source versions must be plainly marked as such, and must not be
+misrepresented as being the original software.
+3. This notice may not be removed or altered from any source distribution.
+*/
+
+#define _CLAMP_(X, Xmin, Xmax) ( (X)<(Xmax) ? ( (X)<(Xmin)?(Xmin):(X) ) : (Xmax) )
+
+static unsigned ETC_FLIP = 0x01000000;
+static unsigned ETC_DIFF = 0x02000000;
+static const int mod[8][4] = {{2,  8,   -2,  -8},
+                       {5,  17,  -5,  -17},
+                       {9,  29,  -9,  -29},
+                       {13, 42,  -13, -42},
+                       {18, 60,  -18, -60},
+                       {24, 80,  -24, -80},
+                       {33, 106, -33, -106},
+                       {47, 183, -47, -183}};
+
+// lsb: hgfedcba ponmlkji msb: hgfedcba ponmlkji due to endianness
+static unsigned ModifyPixel(int red, int green, int blue, int x, int y, unsigned modBlock, int modTable)
+{
+    int index = x * 4 + y, pixelMod;
+    unsigned mostSig = modBlock << 1;
+    if (index < 8)    //hgfedcba
+        pixelMod = mod[modTable][((modBlock >> (index + 24)) & 0x1) + ((mostSig >> (index + 8)) & 0x2)];
+    else    // ponmlkj
+        pixelMod = mod[modTable][((modBlock >> (index + 8)) & 0x1) + ((mostSig >> (index - 8)) & 0x2)];
+
+    red = _CLAMP_(red + pixelMod, 0, 255);
+    green = _CLAMP_(green + pixelMod, 0, 255);
+    blue = _CLAMP_(blue + pixelMod, 0, 255);
+
+    return ((blue << 16) + (green << 8) + red) | 0xff000000;
+}
+
+static void DecompressETC(unsigned char* pDestData, const void* pSrcData)
+{
+    unsigned blockTop, blockBot, * input = (unsigned*)pSrcData, * output;
+    unsigned char red1, green1, blue1, red2, green2, blue2;
+    bool bFlip, bDiff;
+    int modtable1, modtable2;
+
+    blockTop = *(input++);
+    blockBot = *(input++);
+
+    output = (unsigned*)pDestData;
+    // check flipbit
+    bFlip = (blockTop & ETC_FLIP) != 0;
+    bDiff = (blockTop & ETC_DIFF) != 0;
+
+    if (bDiff)
+    {    // differential mode 5 colour bits + 3 difference bits
+        // get base colour for subblock 1
+        blue1 = (unsigned char)((blockTop & 0xf80000) >> 16);
+        green1 = (unsigned char)((blockTop & 0xf800) >> 8);
+        red1 = (unsigned char)(blockTop & 0xf8);
+
+        // get differential colour for subblock 2
+        signed char blues = (signed char)(blue1 >> 3) + ((signed char)((blockTop & 0x70000) >> 11) >> 5);
+        signed char greens = (signed char)(green1 >> 3) + ((signed char)((blockTop & 0x700) >> 3) >> 5);
+        signed char reds = (signed char)(red1 >> 3) + ((signed char)((blockTop & 0x7) << 5) >> 5);
+
+        blue2 = (unsigned char)blues;
+        green2 = (unsigned char)greens;
+        red2 = (unsigned char)reds;
+
+        red1 = red1 + (red1 >> 5);    // copy bits to lower sig
+        green1 = green1 + (green1 >> 5);    // copy bits to lower sig
+        blue1 = blue1 + (blue1 >> 5);    // copy bits to lower sig
+
+        red2 = (red2 << 3) + (red2 >> 2);    // copy bits to lower sig
+        green2 = (green2 << 3) + (green2 >> 2);    // copy bits to lower sig
+        blue2 = (blue2 << 3) + (blue2 >> 2);    // copy bits to lower sig
+    }
+    else
+    {    // individual mode 4 + 4 colour bits
+        // get base colour for subblock 1
+        blue1 = (unsigned char)((blockTop & 0xf00000) >> 16);
+        blue1 = blue1 + (blue1 >> 4);    // copy bits to lower sig
+        green1 = (unsigned char)((blockTop & 0xf000) >> 8);
+        green1 = green1 + (green1 >> 4);    // copy bits to lower sig
+        red1 = (unsigned char)(blockTop & 0xf0);
+        red1 = red1 + (red1 >> 4);    // copy bits to lower sig
+
+        // get base colour for subblock 2
+        blue2 = (unsigned char)((blockTop & 0xf0000) >> 12);
+        blue2 = blue2 + (blue2 >> 4);    // copy bits to lower sig
+        green2 = (unsigned char)((blockTop & 0xf00) >> 4);
+        green2 = green2 + (green2 >> 4);    // copy bits to lower sig
+        red2 = (unsigned char)((blockTop & 0xf) << 4);
+        red2 = red2 + (red2 >> 4);    // copy bits to lower sig
+    }
+    // get the modtables for each subblock
+    modtable1 = (int)((blockTop >> 29) & 0x7);
+    modtable2 = (int)((blockTop >> 26) & 0x7);
+
+    if (!bFlip)
+    {   // 2 2x4 blocks side by side
+        for (int j = 0; j < 4; j++)    // vertical
+        {
+            for (int k = 0; k < 2; k++)    // horizontal
+            {
+                *(output + j * 4 + k) = ModifyPixel(red1, green1, blue1, k, j, blockBot, modtable1);
+                *(output + j * 4 + k + 2) = ModifyPixel(red2, green2, blue2, k + 2, j, blockBot, modtable2);
+            }
+        }
+    }
+    else
+    {   // 2 4x2 blocks on top of each other
+        for (int j = 0; j < 2; j++)
+        {
+            for (int k = 0; k < 4; k++)
+            {
+                *(output + j * 4 + k) = ModifyPixel(red1, green1, blue1, k, j, blockBot, modtable1);
+                *(output + (j + 2) * 4 + k) = ModifyPixel(red2, green2, blue2, k, j + 2, blockBot, modtable2);
+            }
+        }
+    }
+}
+
+void ReferenceDecompressImageETC(unsigned char* rgba, const void* blocks, int width, int height)
+{
+    // initialise the block input
+    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
+    int bytesPerBlock = 8;
+
+    // loop over blocks
+    for (int y = 0; y < height; y += 4)
+    {
+        for (int x = 0; x < width; x += 4)
+        {
+            // decompress the block
+            unsigned char targetRgba[4 * 16];
+            DecompressETC(targetRgba, sourceBlock);
+
+            // write the decompressed pixels to the correct image locations
+            unsigned char const* sourcePixel = targetRgba;
+            for (int py = 0; py < 4; ++py)
+            {
+                for (int px = 0; px < 4; ++px)
+                {
+                    // get the target location
+                    int sx = x + px;
+                    int sy = y + py;
+                    if (sx < width && sy < height)
+                    {
+                        unsigned char* targetPixel = rgba + 4 * (width * sy + sx);
+
+                        // copy the rgba value
+                        for (int i = 0; i < 4; ++i)
+                            *targetPixel++ = *sourcePixel++;
+                    }
+                    else
+                    {
+                        // skip this pixel as its outside the image
+                        sourcePixel += 4;
+                    }
+                }
+            }
+
+            // advance
+            sourceBlock += bytesPerBlock;
+        }
+    }
+}
@@ -0,0 +1,471 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Network/Connection.h>
+#include <Urho3D/Network/Network.h>
+#include <Urho3D/Resource/ResourceCache.h>
+#include <Urho3D/Scene/Scene.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+/// Maximum wall clock time to wait for the clients to connect and load the scene.
+static const unsigned CONNECT_TIMEOUT_MSEC = 30000;
+/// Maximum wall clock time to wait for the transport to deliver the packets queued during the measurement.
+static const unsigned FLUSH_TIMEOUT_MSEC = 30000;
+/// Time the transferred byte counts must stay unchanged for the transport to be considered flushed.
+static const unsigned FLUSH_SETTLE_MSEC = 250;
+/// Spacing of the nodes on the XZ plane in world units.
+static const float NODE_SPACING = 10.0f;
+/// Speed of the moving nodes in world units per second.
+static const float NODE_SPEED = 5.0f;
+
+/// Client simulated in-process, with its own context and network subsystem.
+struct SimulatedClient
+{
+    /// Context.
+    SharedPtr<Context> context_;
+    /// Client scene.
+    SharedPtr<Scene> scene_;
+    /// Network subsystem.
+    Network* network_{};
+};
+
+/// Timing of a benchmark phase.
+struct PhaseTiming
+{
+    /// Add a sample in microseconds.
+    void Add(long long usec)
+    {
+        total_ += usec;
+        max_ = Max(max_, usec);
+        ++count_;
+    }
+
+    /// Return average in milliseconds.
+    float GetAverageMs() const { return count_ ? (float)total_ / count_ / 1000.0f : 0.0f; }
+
+    /// Return maximum in milliseconds.
+    float GetMaxMs() const { return (float)max_ / 1000.0f; }
+
+    /// Total time in microseconds.
+    long long total_{};
+    /// Maximum time in microseconds.
+    long long max_{};
+    /// Number of samples.
+    unsigned count_{};
+};
+
+unsigned numClients_ = 8;
+unsigned numNodes_ = 1000;
+unsigned numFrames_ = 300;
+unsigned churn_ = 10;
+float movingFraction_ = 0.5f;
+float interestRadius_ = 0.0f;
+float packetLoss_ = 0.0f;
+int numThreads_ = -1;
+unsigned short port_ = 2345;
+float maxUpdateMs_ = 0.0f;
+bool snapshotReplication_ = false;
+bool realTime_ = false;
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+void ParseOptions(const Vector<String>& arguments);
+Node* CreateWorkloadNode(Scene* scene, float areaSize);
+void UpdateNetworks(Network* server, Vector<SimulatedClient>& clients, Scene* scene, float timeStep);
+bool FlushNetworks(Network* server, Vector<SimulatedClient>& clients, const Vector<SharedPtr<Connection> >& connections);
+void GetBytesTransferred(const Vector<SharedPtr<Connection> >& connections, unsigned long long& sent, unsigned long long& received);
+void PrintTiming(const String& name, const PhaseTiming& timing);
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    ParseOptions(arguments);
+    SetRandomSeed(1);
+
+    SharedPtr<Context> context(new Context());
+    auto* log = new Log(context);
+    log->SetLevel(LOG_WARNING);
+    context->RegisterSubsystem(log);
+
+    // Time subsystem calibrates the high-resolution timer used for the measurements
+    context->RegisterSubsystem(new Time(context));
+
+    auto* queue = new WorkQueue(context);
+    queue->CreateThreads(numThreads_ >= 0 ? (unsigned)numThreads_ : GetNumPhysicalCPUs() - 1);
+    context->RegisterSubsystem(queue);
+    RegisterSceneLibrary(context);
+
+    auto* server = new Network(context);
+    context->RegisterSubsystem(server);
+    server->SetSnapshotReplication(snapshotReplication_);
+    server->SetInterestRadius(interestRadius_);
+    server->SetSimulatedPacketLoss(packetLoss_);
+    if (!server->StartServer(port_))
+        ErrorExit("Could not start server on port " + String(port_));
+
+    // Create the workload scene, with the nodes spread evenly on the XZ plane
+    SharedPtr<Scene> scene(new Scene(context));
+    float areaSize = sqrtf((float)numNodes_) * NODE_SPACING;
+    PODVector<Node*> nodes;
+    for (unsigned i = 0; i < numNodes_; ++i)
+        nodes.Push(CreateWorkloadNode(scene, areaSize));
+
+    // Connect the clients, each in its own context as a real client process would have
+    Vector<SimulatedClient> clients(numClients_);
+    for (unsigned i = 0; i < numClients_; ++i)
+    {
+        SimulatedClient& client = clients[i];
+        client.context_ = new Context();
+        RegisterSceneLibrary(client.context_);
+        client.context_->RegisterSubsystem(new ResourceCache(client.context_));
+        client.network_ = new Network(client.context_);
+        client.context_->RegisterSubsystem(client.network_);
+        client.scene_ = new Scene(client.context_);
+        if (!client.network_->Connect("127.0.0.1", port_, client.scene_))
+            ErrorExit("Could not connect client " + String(i));
+    }
+
+    const float timeStep = 1.0f / (float)server->GetUpdateFps();
+    HiresTimer connectTimer;
+    for (;;)
+    {
+        UpdateNetworks(server, clients, scene, timeStep);
+
+        unsigned numLoaded = 0;
+        Vector<SharedPtr<Connection> > connections = server->GetClientConnections();
+        for (unsigned i = 0; i < connections.Size(); ++i)
+        {
+            if (connections[i]->IsSceneLoaded())
+                ++numLoaded;
+        }
+        if (numLoaded == numClients_)
+            break;
+        if (connectTimer.GetUSec(false) > CONNECT_TIMEOUT_MSEC * 1000LL)
+            ErrorExit("Timed out waiting for clients, " + String(numLoaded) + " of " + String(numClients_) + " joined the scene");
+
+        Time::Sleep(1);
+    }
+
+    // Place the observers for interest management
+    for (unsigned i = 0; i < numClients_; ++i)
+    {
+        Connection* connection = clients[i].network_->GetServerConnection();
+        connection->SetPosition(Vector3(Random(areaSize), 0.0f, Random(areaSize)));
+    }
+
+    // Let the scene download finish on the wire so that it is not counted in the measurement
+    Vector<SharedPtr<Connection> > connections = server->GetClientConnections();
+    if (!FlushNetworks(server, clients, connections))
+        ErrorExit("Timed out waiting for the scene download to finish");
+    unsigned long long initialBytesSent;
+    unsigned long long initialBytesReceived;
+    GetBytesTransferred(connections, initialBytesSent, initialBytesReceived);
+
+    PrintLine("Clients " + String(numClients_) + ", nodes " + String(numNodes_) + ", frames " + String(numFrames_) + ", churn " +
+        String(churn_) + " nodes per frame, worker threads " + String(queue->GetNumThreads()) + ", " +
+        (snapshotReplication_ ? "snapshot" : "delta") + " replication, interest radius " + String(interestRadius_));
+
+    PhaseTiming workloadTiming;
+    PhaseTiming receiveTiming;
+    PhaseTiming replicationTiming;
+    PhaseTiming serverTiming;
+    PhaseTiming clientTiming;
+    HiresTimer phaseTimer;
+    HiresTimer frameTimer;
+    unsigned numMoving = (unsigned)(movingFraction_ * numNodes_);
+
+    for (unsigned frame = 0; frame < numFrames_; ++frame)
+    {
+        frameTimer.Reset();
+
+        // Move part of the nodes, then replace random nodes with new ones
+        phaseTimer.Reset();
+        for (unsigned i = 0; i < numMoving && i < nodes.Size(); ++i)
+        {
+            Node* node = nodes[i];
+            Vector3 position = node->GetPosition() + node->GetDirection() * NODE_SPEED * timeStep;
+            if (position.x_ < 0.0f || position.x_ > areaSize || position.z_ < 0.0f || position.z_ > areaSize)
+                node->Yaw(180.0f);
+            else
+                node->SetPosition(position);
+        }
+        for (unsigned i = 0; i < churn_ && nodes.Size(); ++i)
+        {
+            unsigned index = (unsigned)Random((int)nodes.Size());
+            nodes[index]->Remove();
+            nodes[index] = CreateWorkloadNode(scene, areaSize);
+        }
+        workloadTiming.Add(phaseTimer.GetUSec(true));
+
+        server->Update(timeStep);
+        long long receiveTime = phaseTimer.GetUSec(true);
+        receiveTiming.Add(receiveTime);
+        server->PostUpdate(timeStep);
+        long long replicationTime = phaseTimer.GetUSec(true);
+        replicationTiming.Add(replicationTime);
+        serverTiming.Add(receiveTime + replicationTime);
+
+        for (unsigned i = 0; i < clients.Size(); ++i)
+        {
+            clients[i].network_->Update(timeStep);
+            clients[i].network_->PostUpdate(timeStep);
+        }
+        clientTiming.Add(phaseTimer.GetUSec(true));
+
+        if (realTime_)
+        {
+            long long elapsed = frameTimer.GetUSec(false);
+            auto frameTime = (long long)(timeStep * 1000000.0f);
+            if (elapsed < frameTime)
+                Time::Sleep((unsigned)((frameTime - elapsed) / 1000));
+        }
+    }
+
+    // The transport sends on its own thread at the rate its congestion control allows, so without pacing most of the
+    // replicated data is still queued when the frames end. Pump the networks until it has been delivered before reading
+    // the byte counts and the client node counts
+    bool flushed = FlushNetworks(server, clients, connections);
+    unsigned long long bytesSent;
+    unsigned long long bytesReceived;
+    GetBytesTransferred(connections, bytesSent, bytesReceived);
+    bytesSent -= initialBytesSent;
+    bytesReceived -= initialBytesReceived;
+
+    unsigned clientNodes = 0;
+    for (unsigned i = 0; i < clients.Size(); ++i)
+        clientNodes += clients[i].scene_->GetNumChildren();
+
+    float simulatedTime = numFrames_ * timeStep;
+    PrintTiming("Server update", serverTiming);
+    PrintTiming("  Receive", receiveTiming);
+    PrintTiming("  Replication", replicationTiming);
+    PrintTiming("Workload", workloadTiming);
+    PrintTiming("Clients", clientTiming);
+    if (flushed)
+    {
+        PrintLine(Format("Sent per client {:.1f} KB, {:.2f} KB/s", bytesSent / 1024.0f / numClients_,
+            bytesSent / 1024.0f / numClients_ / simulatedTime));
+        PrintLine(Format("Received per client {:.1f} KB, {:.2f} KB/s", bytesReceived / 1024.0f / numClients_,
+            bytesReceived / 1024.0f / numClients_ / simulatedTime));
+        PrintLine(Format("Nodes on server {}, average on clients {:.1f}", scene->GetNumChildren(), (float)clientNodes / numClients_));
+    }
+    else
+        PrintLine("Transport did not finish delivering within " + String(FLUSH_TIMEOUT_MSEC / 1000) + " seconds, bandwidth not measured");
+
+    for (unsigned i = 0; i < clients.Size(); ++i)
+        clients[i].network_->Disconnect();
+    server->StopServer();
+
+    if (maxUpdateMs_ > 0.0f && serverTiming.GetAverageMs() > maxUpdateMs_)
+        ErrorExit(Format("Average server update time {:.3f} ms exceeds the limit of {:.3f} ms", serverTiming.GetAverageMs(), maxUpdateMs_));
+}
+
+void ParseOptions(const Vector<String>& arguments)
+{
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].Length() < 2 || arguments[i][0] != '-')
+            ErrorExit("Unrecognized argument " + arguments[i]);
+
+        char option = arguments[i][1];
+        if (option == 's')
+        {
+            snapshotReplication_ = true;
+            continue;
+        }
+        if (option == 'r')
+        {
+            realTime_ = true;
+            continue;
+        }
+        if (option == 'h')
+        {
+            ErrorExit(
+                "Usage: NetworkBenchmark [options]\n"
+                "\n"
+                "Runs a server and simulated clients in-process over loopback, replicating a scene\n"
+                "with moving, removed and created nodes, and reports the server update time and the\n"
+                "bandwidth per client. The transport delivers the packets on its own thread, so after\n"
+                "the measured frames the networks are updated until all queued data has arrived.\n"
+                "\n"
+                "Options:\n"
+                "-c <n>  Number of clients, default 8\n"
+                "-n <n>  Number of nodes, default 1000\n"
+                "-f <n>  Number of network update frames to measure, default 300\n"
+                "-x <n>  Number of nodes removed and created each frame, default 10\n"
+                "-m <f>  Fraction of moving nodes, default 0.5\n"
+                "-i <r>  Interest management radius, default 0 (disabled)\n"
+                "-l <p>  Simulated packet loss probability on the server, default 0. Only has\n"
+                "        an effect when SLikeNet is built with _DEBUG defined\n"
+                "-t <n>  Number of worker threads, default number of physical CPUs - 1\n"
+                "-p <n>  Server port, default 2345\n"
+                "-a <ms> Exit with an error if the average server update time exceeds this\n"
+                "-s      Use snapshot replication\n"
+                "-r      Pace the frames to the network update rate\n",
+                EXIT_SUCCESS
+            );
+        }
+
+        if (i + 1 >= arguments.Size())
+            ErrorExit("No value for option " + arguments[i]);
+        const String& value = arguments[++i];
+
+        switch (option)
+        {
+        case 'c':
+            numClients_ = Max(ToUInt(value), 1U);
+            break;
+        case 'n':
+            numNodes_ = ToUInt(value);
+            break;
+        case 'f':
+            numFrames_ = ToUInt(value);
+            break;
+        case 'x':
+            churn_ = ToUInt(value);
+            break;
+        case 'm':
+            movingFraction_ = Clamp(ToFloat(value), 0.0f, 1.0f);
+            break;
+        case 'i':
+            interestRadius_ = ToFloat(value);
+            break;
+        case 'l':
+            packetLoss_ = ToFloat(value);
+            break;
+        case 't':
+            numThreads_ = ToInt(value);
+            break;
+        case 'p':
+            port_ = (unsigned short)ToUInt(value);
+            break;
+        case 'a':
+            maxUpdateMs_ = ToFloat(value);
+            break;
+        default:
+            ErrorExit("Unrecognized option " + arguments[i - 1]);
+        }
+    }
+}
+
+Node* CreateWorkloadNode(Scene* scene, float areaSize)
+{
+    Node* node = scene->CreateChild("Node", REPLICATED);
+    node->SetPosition(Vector3(Random(areaSize), 0.0f, Random(areaSize)));
+    node->SetRotation(Quaternion(Random(360.0f), Vector3::UP));
+    return node;
+}
+
+void UpdateNetworks(Network* server, Vector<SimulatedClient>& clients, Scene* scene, float timeStep)
+{
+    server->Update(timeStep);
+
+    // Assign the scene to newly connected clients
+    Vector<SharedPtr<Connection> > connections = server->GetClientConnections();
+    for (unsigned i = 0; i < connections.Size(); ++i)
+    {
+        if (!connections[i]->GetScene())
+            connections[i]->SetScene(scene);
+    }
+
+    server->PostUpdate(timeStep);
+
+    for (unsigned i = 0; i < clients.Size(); ++i)
+    {
+        clients[i].network_->Update(timeStep);
+        clients[i].network_->PostUpdate(timeStep);
+    }
+}
+
+bool FlushNetworks(Network* server, Vector<SimulatedClient>& clients, const Vector<SharedPtr<Connection> >& connections)
+{
+    // Only receive, as PostUpdate() would queue new updates
+    HiresTimer timeoutTimer;
+    HiresTimer settleTimer;
+    unsigned long long lastSent;
+    unsigned long long lastReceived;
+    GetBytesTransferred(connections, lastSent, lastReceived);
+
+    while (timeoutTimer.GetUSec(false) < FLUSH_TIMEOUT_MSEC * 1000LL)
+    {
+        Time::Sleep(1);
+        server->Update(0.0f);
+        for (unsigned i = 0; i < clients.Size(); ++i)
+            clients[i].network_->Update(0.0f);
+
+        unsigned long long sent;
+        unsigned long long received;
+        GetBytesTransferred(connections, sent, received);
+        if (sent != lastSent || received != lastReceived)
+        {
+            lastSent = sent;
+            lastReceived = received;
+            settleTimer.Reset();
+        }
+        else if (settleTimer.GetUSec(false) >= FLUSH_SETTLE_MSEC * 1000LL)
+            return true;
+    }
+
+    return false;
+}
+
+void GetBytesTransferred(const Vector<SharedPtr<Connection> >& connections, unsigned long long& sent, unsigned long long& received)
+{
+    sent = 0;
+    received = 0;
+    for (unsigned i = 0; i < connections.Size(); ++i)
+    {
+        sent += connections[i]->GetBytesSent();
+        received += connections[i]->GetBytesReceived();
+    }
+}
+
+void PrintTiming(const String& name, const PhaseTiming& timing)
+{
+    PrintLine(Format("{}: average {:.3f} ms, max {:.3f} ms", name.CString(), timing.GetAverageMs(), timing.GetMaxMs()));
+}
@@ -23,9 +23,14 @@
 #include <Urho3D/Core/Context.h>
 #include <Urho3D/Container/ArrayPtr.h>
 #include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/ContentCache.h>
 #include <Urho3D/IO/File.h>
 #include <Urho3D/IO/FileSystem.h>
+#include <Urho3D/IO/Log.h>
 #include <Urho3D/IO/PackageFile.h>
+#include <Urho3D/IO/VectorBuffer.h>
 
 #ifdef WIN32
 #include <windows.h>
@@ -39,6 +44,10 @@
 using namespace Urho3D;
 
 static const unsigned COMPRESSED_BLOCK_SIZE = 32768;
+/// Maximum amount of source data to hold in memory while processing files in parallel.
+static const unsigned long long MAX_BATCH_SIZE = 256 * 1024 * 1024;
+/// Version of the cached compressed data. Increment when the compression output changes.
+static const unsigned CACHE_VERSION = 1;
 
 struct FileEntry
 {
@@ -48,8 +57,19 @@ struct FileEntry
     unsigned checksum_{};
 };
 
+struct FileData
+{
+    /// Data to write to the package: file contents or LZ4 compressed blocks.
+    PODVector<unsigned char> data_;
+    /// Whether the compressed data came from the content cache.
+    bool cached_{};
+    /// Error message if processing failed.
+    String error_;
+};
+
 SharedPtr<Context> context_(new Context());
 SharedPtr<FileSystem> fileSystem_(new FileSystem(context_));
+SharedPtr<ContentCache> contentCache_(new ContentCache(context_));
 String basePath_;
 Vector<FileEntry> entries_;
 unsigned checksum_ = 0;
@@ -59,12 +79,14 @@ unsigned blockSize_ = COMPRESSED_BLOCK_SIZE;
 
 String ignoreExtensions_[] = {
     ".bak",
-    ".rule"
+    ".rule",
+    ""
 };
 
 int main(int argc, char** argv);
 void Run(const Vector<String>& arguments);
 void ProcessFile(const String& fileName, const String& rootDir);
+void ProcessFileData(FileEntry& entry, const String& rootDir, FileData& result);
 void WritePackageFile(const String& fileName, const String& rootDir);
 void WriteHeader(File& dest);
 
@@ -78,6 +100,11 @@ int main(int argc, char** argv)
     arguments = ParseArguments(argc, argv);
     #endif
 
+    // Library code logs for example when creating directories, which requires the log subsystem. Show only warnings and errors
+    auto* log = new Log(context_);
+    log->SetLevel(LOG_WARNING);
+    context_->RegisterSubsystem(log);
+    context_->RegisterSubsystem(fileSystem_);
     Run(arguments);
     return 0;
 }
@@ -90,6 +117,8 @@ void Run(const Vector<String>& arguments)
             "\n"
             "Options:\n"
             "-c      Enable package file LZ4 compression\n"
+            "-d <directory> Cache compressed file data in a directory to skip recompressing\n"
+            "        unchanged files. Can be shared by several packages and machines\n"
             "-q      Enable quiet mode\n"
             "\n"
             "Basepath is an optional prefix that will be added to the file entries.\n\n"
@@ -118,6 +147,12 @@ void Run(const Vector<String>& arguments)
                     case 'c':
                         compress_ = true;
                         break;
+                    case 'd':
+                        if (i + 1 >= arguments.Size())
+                            ErrorExit("No cache directory defined");
+                        if (!contentCache_->SetCacheDir(arguments[++i]))
+                            ErrorExit("Could not use cache directory " + arguments[i]);
+                        break;
                     case 'q':
                         quiet_ = true;
                         break;
@@ -131,6 +166,11 @@ void Run(const Vector<String>& arguments)
 
     if (!isOutputMode)
     {
+        // Process files on all cores
+        auto* queue = new WorkQueue(context_);
+        context_->RegisterSubsystem(queue);
+        queue->CreateThreads(Max(GetNumLogicalCPUs(), 2U) - 1);
+
         if (!quiet_)
             PrintLine("Scanning directory " + dirName + " for files");
 
@@ -266,71 +306,70 @@ void WritePackageFile(const String& fileName, const String& rootDir)
         dest.WriteUInt(entries_[i].checksum_);
     }
 
+    auto* queue = context_->GetSubsystem<WorkQueue>();
     unsigned totalDataSize = 0;
-    unsigned lastOffset;
+    unsigned numCached = 0;
 
-    // Write file data, calculate checksums & correct offsets
-    for (unsigned i = 0; i < entries_.Size(); ++i)
+    // Read, checksum and compress files in parallel in batches of limited size, then write them in order
+    for (unsigned first = 0; first < entries_.Size();)
     {
-        lastOffset = entries_[i].offset_ = dest.GetSize();
-        String fileFullPath = rootDir + "/" + entries_[i].name_;
-
-        File srcFile(context_, fileFullPath);
-        if (!srcFile.IsOpen())
-            ErrorExit("Could not open file " + fileFullPath);
+        unsigned last = first;
+        unsigned long long batchSize = 0;
+        while (last < entries_.Size() && (last == first || batchSize + entries_[last].size_ <= MAX_BATCH_SIZE))
+            batchSize += entries_[last++].size_;
 
-        unsigned dataSize = entries_[i].size_;
-        totalDataSize += dataSize;
-        SharedArrayPtr<unsigned char> buffer(new unsigned char[dataSize]);
-
-        if (srcFile.Read(&buffer[0], dataSize) != dataSize)
-            ErrorExit("Could not read file " + fileFullPath);
-        srcFile.Close();
-
-        for (unsigned j = 0; j < dataSize; ++j)
+        Vector<FileData> results(last - first);
+        for (unsigned i = first; i < last; ++i)
         {
-            checksum_ = SDBMHash(checksum_, buffer[j]);
-            entries_[i].checksum_ = SDBMHash(entries_[i].checksum_, buffer[j]);
+            FileEntry* entry = &entries_[i];
+            FileData* result = &results[i - first];
+            queue->AddWorkItem([entry, &rootDir, result]() { ProcessFileData(*entry, rootDir, *result); });
         }
+        queue->Complete(0);
 
-        if (!compress_)
+        for (unsigned i = first; i < last; ++i)
         {
-            if (!quiet_)
-                PrintLine(entries_[i].name_ + " size " + String(dataSize));
-            dest.Write(&buffer[0], entries_[i].size_);
-        }
-        else
-        {
-            SharedArrayPtr<unsigned char> compressBuffer(new unsigned char[LZ4_compressBound(blockSize_)]);
-
-            unsigned pos = 0;
-
-            while (pos < dataSize)
+            const FileData& result = results[i - first];
+            if (!result.error_.Empty())
+                ErrorExit(result.error_);
+
+            unsigned dataSize = entries_[i].size_;
+            totalDataSize += dataSize;
+            entries_[i].offset_ = dest.GetSize();
+            if (result.cached_)
+                ++numCached;
+
+            // The package checksum is the SDBM hash of all file data in order, which is linear in the starting
+            // value, so it can be continued from each file's own checksum
+            unsigned multiplier = 1;
+            unsigned factor = 65599;
+            for (unsigned n = dataSize; n; n >>= 1u)
             {
-                unsigned unpackedSize = blockSize_;
-                if (pos + unpackedSize > dataSize)
-                    unpackedSize = dataSize - pos;
-
-                auto packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)compressBuffer.Get(), unpackedSize, LZ4_compressBound(unpackedSize), 0);
-                if (!packedSize)
-                    ErrorExit("LZ4 compression failed for file " + entries_[i].name_ + " at offset " + String(pos));
-
-                dest.WriteUShort((unsigned short)unpackedSize);
-                dest.WriteUShort((unsigned short)packedSize);
-                dest.Write(compressBuffer.Get(), packedSize);
-
-                pos += unpackedSize;
+                if (n & 1u)
+                    multiplier *= factor;
+                factor *= factor;
             }
+            checksum_ = checksum_ * multiplier + entries_[i].checksum_;
+
+            if (!result.data_.Empty())
+                dest.Write(&result.data_[0], result.data_.Size());
 
             if (!quiet_)
             {
-                unsigned totalPackedBytes = dest.GetSize() - lastOffset;
-                String fileEntry(entries_[i].name_);
-                fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f", dataSize, totalPackedBytes,
-                    totalPackedBytes ? 1.f * dataSize / totalPackedBytes : 0.f);
-                PrintLine(fileEntry);
+                if (!compress_)
+                    PrintLine(entries_[i].name_ + " size " + String(dataSize));
+                else
+                {
+                    unsigned totalPackedBytes = result.data_.Size();
+                    String fileEntry(entries_[i].name_);
+                    fileEntry.AppendWithFormat("\tin: %u\tout: %u\tratio: %f%s", dataSize, totalPackedBytes,
+                        totalPackedBytes ? 1.f * dataSize / totalPackedBytes : 0.f, result.cached_ ? "\t(cached)" : "");
+                    PrintLine(fileEntry);
+                }
             }
         }
+
+        first = last;
     }
 
     // Write package size to the end of file to allow finding it linked to an executable file
@@ -356,9 +395,88 @@ void WritePackageFile(const String& fileName, const String& rootDir)
         PrintLine("Package size: " + String(dest.GetSize()));
         PrintLine("Checksum: " + String(checksum_));
         PrintLine("Compressed: " + String(compress_ ? "yes" : "no"));
+        if (contentCache_->IsEnabled() && compress_)
+            PrintLine("Cached files: " + String(numCached));
     }
 }
 
+void ProcessFileData(FileEntry& entry, const String& rootDir, FileData& result)
+{
+    String fileFullPath = rootDir + "/" + entry.name_;
+    File srcFile(context_, fileFullPath);
+    if (!srcFile.IsOpen())
+    {
+        result.error_ = "Could not open file " + fileFullPath;
+        return;
+    }
+
+    unsigned dataSize = entry.size_;
+    PODVector<unsigned char> buffer(dataSize);
+    if (dataSize && srcFile.Read(&buffer[0], dataSize) != dataSize)
+    {
+        result.error_ = "Could not read file " + fileFullPath;
+        return;
+    }
+    srcFile.Close();
+
+    if (!compress_)
+    {
+        for (unsigned j = 0; j < dataSize; ++j)
+            entry.checksum_ = SDBMHash(entry.checksum_, buffer[j]);
+        result.data_.Swap(buffer);
+        return;
+    }
+
+    // Cache entries hold the file checksum followed by the compressed blocks
+    String cacheKey;
+    if (contentCache_->IsEnabled())
+    {
+        cacheKey = ContentCache::GetKey(buffer.Buffer(), dataSize, ToString("PackageTool LZ4HC %u %u", blockSize_, CACHE_VERSION));
+        PODVector<unsigned char> cached;
+        if (contentCache_->Load(cacheKey, cached) && cached.Size() >= sizeof(unsigned))
+        {
+            memcpy(&entry.checksum_, &cached[0], sizeof(unsigned));
+            result.data_.Insert(result.data_.End(), cached.Begin() + sizeof(unsigned), cached.End());
+            result.cached_ = true;
+            return;
+        }
+    }
+
+    for (unsigned j = 0; j < dataSize; ++j)
+        entry.checksum_ = SDBMHash(entry.checksum_, buffer[j]);
+
+    VectorBuffer packed;
+    packed.WriteUInt(entry.checksum_);
+    SharedArrayPtr<unsigned char> compressBuffer(new unsigned char[LZ4_compressBound(blockSize_)]);
+
+    unsigned pos = 0;
+    while (pos < dataSize)
+    {
+        unsigned unpackedSize = blockSize_;
+        if (pos + unpackedSize > dataSize)
+            unpackedSize = dataSize - pos;
+
+        auto packedSize = (unsigned)LZ4_compress_HC((const char*)&buffer[pos], (char*)compressBuffer.Get(), unpackedSize, LZ4_compressBound(unpackedSize), 0);
+        if (!packedSize)
+        {
+            result.error_ = "LZ4 compression failed for file " + entry.name_ + " at offset " + String(pos);
+            return;
+        }
+
+        packed.WriteUShort((unsigned short)unpackedSize);
+        packed.WriteUShort((unsigned short)packedSize);
+        packed.Write(compressBuffer.Get(), packedSize);
+
+        pos += unpackedSize;
+    }
+
+    if (!cacheKey.Empty())
+        contentCache_->Store(cacheKey, packed.GetData(), packed.GetSize());
+
+    const PODVector<unsigned char>& packedData = packed.GetBuffer();
+    result.data_.Insert(result.data_.End(), packedData.Begin() + sizeof(unsigned), packedData.End());
+}
+
 void WriteHeader(File& dest)
 {
     if (!compress_)
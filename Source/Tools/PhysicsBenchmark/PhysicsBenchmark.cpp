@@ -0,0 +1,262 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include <Urho3D/Core/Context.h>
+#include <Urho3D/Core/ProcessUtils.h>
+#include <Urho3D/Core/StringUtils.h>
+#include <Urho3D/Core/Timer.h>
+#include <Urho3D/Core/WorkQueue.h>
+#include <Urho3D/IO/Log.h>
+#include <Urho3D/Physics/CollisionShape.h>
+#include <Urho3D/Physics/PhysicsWorld.h>
+#include <Urho3D/Physics/RigidBody.h>
+#include <Urho3D/Scene/Scene.h>
+
+#ifdef WIN32
+#include <windows.h>
+#endif
+
+#include <Urho3D/DebugNew.h>
+
+using namespace Urho3D;
+
+/// Spacing of the box stacks on the XZ plane in world units.
+static const float STACK_SPACING = 2.0f;
+
+unsigned numBodies_ = 10000;
+unsigned numFrames_ = 300;
+unsigned stackHeight_ = 5;
+unsigned numQueries_ = 0;
+int numThreads_ = -1;
+float maxStepMs_ = 0.0f;
+bool multithreaded_ = false;
+bool threadedTransformSync_ = false;
+
+int main(int argc, char** argv);
+void Run(const Vector<String>& arguments);
+void ParseOptions(const Vector<String>& arguments);
+
+int main(int argc, char** argv)
+{
+    Vector<String> arguments;
+
+    #ifdef WIN32
+    arguments = ParseArguments(GetCommandLineW());
+    #else
+    arguments = ParseArguments(argc, argv);
+    #endif
+
+    Run(arguments);
+    return 0;
+}
+
+void Run(const Vector<String>& arguments)
+{
+    ParseOptions(arguments);
+    SetRandomSeed(1);
+
+    SharedPtr<Context> context(new Context());
+    auto* log = new Log(context);
+    log->SetLevel(LOG_WARNING);
+    context->RegisterSubsystem(log);
+
+    // Time subsystem calibrates the high-resolution timer used for the measurements
+    context->RegisterSubsystem(new Time(context));
+
+    auto* queue = new WorkQueue(context);
+    queue->CreateThreads(numThreads_ >= 0 ? (unsigned)numThreads_ : GetNumPhysicalCPUs() - 1);
+    context->RegisterSubsystem(queue);
+
+    RegisterSceneLibrary(context);
+    RegisterPhysicsLibrary(context);
+    PhysicsWorld::config.multithreaded_ = multithreaded_;
+
+    SharedPtr<Scene> scene(new Scene(context));
+    auto* physicsWorld = scene->CreateComponent<PhysicsWorld>();
+    physicsWorld->SetInterpolation(false);
+    physicsWorld->SetThreadedTransformSync(threadedTransformSync_);
+
+    // Create boxes in separate stacks on a static floor, so that each stack forms its own simulation island
+    unsigned numStacks = (numBodies_ + stackHeight_ - 1) / stackHeight_;
+    auto stacksPerRow = (unsigned)ceilf(sqrtf((float)numStacks));
+    float areaSize = stacksPerRow * STACK_SPACING;
+
+    Node* floorNode = scene->CreateChild("Floor");
+    floorNode->SetPosition(Vector3(areaSize * 0.5f, -0.5f, areaSize * 0.5f));
+    floorNode->SetScale(Vector3(areaSize + STACK_SPACING, 1.0f, areaSize + STACK_SPACING));
+    floorNode->CreateComponent<RigidBody>();
+    floorNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+
+    for (unsigned i = 0; i < numBodies_; ++i)
+    {
+        unsigned stack = i / stackHeight_;
+        unsigned level = i % stackHeight_;
+        Node* boxNode = scene->CreateChild("Box");
+        boxNode->SetPosition(Vector3((stack % stacksPerRow + 0.5f) * STACK_SPACING, level + 0.5f,
+            (stack / stacksPerRow + 0.5f) * STACK_SPACING));
+        boxNode->SetRotation(Quaternion(Random(10.0f) - 5.0f, Vector3::UP));
+        auto* body = boxNode->CreateComponent<RigidBody>();
+        body->SetMass(1.0f);
+        body->SetFriction(0.75f);
+        boxNode->CreateComponent<CollisionShape>()->SetBox(Vector3::ONE);
+    }
+
+    PrintLine("Bodies " + String(numBodies_) + " in " + String(numStacks) + " stacks, frames " + String(numFrames_) +
+        ", worker threads " + String(queue->GetNumThreads()) + ", " +
+        (physicsWorld->IsMultithreaded() ? "multithreaded" : "single-threaded") + " island solving, " +
+        (threadedTransformSync_ ? "threaded" : "main thread") + " transform sync");
+    if (multithreaded_ && !physicsWorld->IsMultithreaded())
+        PrintLine("Multithreaded physics requested, but the engine was built without threading support");
+
+    const float timeStep = 1.0f / (float)physicsWorld->GetFps();
+    HiresTimer stepTimer;
+    long long totalTime = 0;
+    long long maxTime = 0;
+    long long totalQueryTime = 0;
+    unsigned numHits = 0;
+    Vector<PhysicsCastQuery> queries(numQueries_);
+    PODVector<PhysicsRaycastResult> results;
+
+    for (unsigned frame = 0; frame < numFrames_; ++frame)
+    {
+        // Give the stacks a push halfway through, so that they keep colliding instead of falling asleep
+        if (frame == numFrames_ / 2)
+        {
+            PODVector<RigidBody*> bodies;
+            scene->GetComponents<RigidBody>(bodies, true);
+            for (unsigned i = 0; i < bodies.Size(); ++i)
+            {
+                if (bodies[i]->GetMass() > 0.0f)
+                    bodies[i]->ApplyImpulse(Vector3(Random(2.0f) - 1.0f, 0.0f, Random(2.0f) - 1.0f));
+            }
+        }
+
+        stepTimer.Reset();
+        physicsWorld->Update(timeStep);
+        long long stepTime = stepTimer.GetUSec(false);
+        totalTime += stepTime;
+        maxTime = Max(maxTime, stepTime);
+
+        // Cast line of sight rays between random points above the floor, like AI visibility checks would
+        if (numQueries_)
+        {
+            for (unsigned i = 0; i < numQueries_; ++i)
+            {
+                Vector3 start(Random(areaSize), 1.0f + Random((float)stackHeight_), Random(areaSize));
+                Vector3 end(Random(areaSize), 1.0f + Random((float)stackHeight_), Random(areaSize));
+                queries[i].ray_ = Ray(start, end - start);
+                queries[i].maxDistance_ = (end - start).Length();
+            }
+
+            stepTimer.Reset();
+            physicsWorld->CastBatch(results, queries);
+            totalQueryTime += stepTimer.GetUSec(false);
+
+            for (unsigned i = 0; i < results.Size(); ++i)
+            {
+                if (results[i].body_)
+                    ++numHits;
+            }
+        }
+    }
+
+    float averageMs = numFrames_ ? (float)totalTime / numFrames_ / 1000.0f : 0.0f;
+    PrintLine(Format("Physics step: average {:.3f} ms, max {:.3f} ms", averageMs, (float)maxTime / 1000.0f));
+    if (numQueries_ && numFrames_)
+    {
+        PrintLine(Format("Batched raycasts: {} per frame, average {:.3f} ms, {:.1f}% hit", numQueries_,
+            (float)totalQueryTime / numFrames_ / 1000.0f, 100.0f * numHits / numQueries_ / numFrames_));
+    }
+
+    if (maxStepMs_ > 0.0f && averageMs > maxStepMs_)
+        ErrorExit(Format("Average physics step time {:.3f} ms exceeds the limit of {:.3f} ms", averageMs, maxStepMs_));
+}
+
+void ParseOptions(const Vector<String>& arguments)
+{
+    for (unsigned i = 0; i < arguments.Size(); ++i)
+    {
+        if (arguments[i].Length() < 2 || arguments[i][0] != '-')
+            ErrorExit("Unrecognized argument " + arguments[i]);
+
+        char option = arguments[i][1];
+        if (option == 'm')
+        {
+            multithreaded_ = true;
+            continue;
+        }
+        if (option == 's')
+        {
+            threadedTransformSync_ = true;
+            continue;
+        }
+        if (option == 'h')
+        {
+            ErrorExit(
+                "Usage: PhysicsBenchmark [options]\n"
+                "\n"
+                "Simulates stacks of boxes on a static floor and reports the physics step time.\n"
+                "Run with a varying number of worker threads and -m to measure the scaling of\n"
+                "multithreaded island solving, or with -q to measure batched raycasts.\n"
+                "\n"
+                "Options:\n"
+                "-n <n>  Number of boxes, default 10000\n"
+                "-f <n>  Number of physics frames to measure, default 300\n"
+                "-x <n>  Height of the box stacks, default 5\n"
+                "-q <n>  Number of batched raycasts after each frame, default 0\n"
+                "-t <n>  Number of worker threads, default number of physical CPUs - 1\n"
+                "-a <ms> Exit with an error if the average step time exceeds this\n"
+                "-m      Solve simulation islands in parallel on the worker threads\n"
+                "-s      Apply the simulated transforms to the nodes in the worker threads\n",
+                EXIT_SUCCESS
+            );
+        }
+
+        if (i + 1 >= arguments.Size())
+            ErrorExit("No value for option " + arguments[i]);
+        const String& value = arguments[++i];
+
+        switch (option)
+        {
+        case 'n':
+            numBodies_ = ToUInt(value);
+            break;
+        case 'f':
+            numFrames_ = ToUInt(value);
+            break;
+        case 'x':
+            stackHeight_ = Max(ToUInt(value), 1U);
+            break;
+        case 'q':
+            numQueries_ = ToUInt(value);
+            break;
+        case 't':
+            numThreads_ = ToInt(value);
+            break;
+        case 'a':
+            maxStepMs_ = ToFloat(value);
+            break;
+        default:
+            ErrorExit("Unrecognized option " + arguments[i - 1]);
+        }
+    }
+}
@@ -305,6 +305,8 @@ public:
 // These expose iterators of underlying collection. Iterate object through GetObject() instead.
 %ignore Urho3D::JSONValue::Begin;
 %ignore Urho3D::JSONValue::End;
+// Views are constructed from rapidjson values internally.
+%ignore Urho3D::JSONView::JSONView(const void*);
 %ignore Urho3D::BackgroundLoadItem;
 %ignore Urho3D::BackgroundLoader::ThreadFunction;
 
@@ -314,6 +316,7 @@ public:
 #endif
 %include "Urho3D/Resource/Image.h"
 %include "Urho3D/Resource/JSONValue.h"
+%include "Urho3D/Resource/JSONView.h"
 %include "Urho3D/Resource/JSONFile.h"
 %include "Urho3D/Resource/Localization.h"
 %include "Urho3D/Resource/PListFile.h"
@@ -323,7 +326,8 @@ public:
 
 // --------------------------------------- Scene ---------------------------------------
 %ignore Urho3D::DirtyBits::data_;
-%ignore Urho3D::SceneReplicationState::dirtyNodes_;		// Needs HashSet wrapped
+%ignore Urho3D::IDBitSet;
+%ignore Urho3D::SceneReplicationState::dirtyNodes_;
 %ignore Urho3D::NodeReplicationState::dirtyVars_;		// Needs HashSet wrapped
 %ignore Urho3D::Animatable::animatedNetworkAttributes_; // Needs HashSet wrapped
 %ignore Urho3D::AsyncProgress::resources_;
@@ -533,6 +537,7 @@ public:
 %ignore Urho3D::Network::MakeHttpRequest;
 %ignore Urho3D::PackageDownload;
 %ignore Urho3D::PackageUpload;
+%ignore Urho3D::SnapshotRecord;
 
 %template(ConnectionVector) Urho3D::Vector<Urho3D::SharedPtr<Urho3D::Connection>>;
 
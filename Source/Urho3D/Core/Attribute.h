@@ -107,6 +107,9 @@ struct AttributeInfo
         accessor_ = other.accessor_;
         defaultValue_ = other.defaultValue_;
         mode_ = other.mode_;
+        quantizeBits_ = other.quantizeBits_;
+        quantizeMin_ = other.quantizeMin_;
+        quantizeMax_ = other.quantizeMax_;
         metadata_ = other.metadata_;
         ptr_ = other.ptr_;
         enumNamesStorage_ = other.enumNamesStorage_;
@@ -128,6 +131,23 @@ struct AttributeInfo
         return GetMetadata(key).Get<T>();
     }
 
+    /// Set network quantization range and number of bits per component. Zero bits disables quantization.
+    void SetQuantization(float minValue, float maxValue, unsigned bits)
+    {
+        quantizeBits_ = bits < 32 ? bits : 32;
+        quantizeMin_ = minValue;
+        quantizeMax_ = maxValue > minValue ? maxValue : minValue;
+    }
+
+    /// Return number of bits needed to quantize a range so that the error stays within precision.
+    static unsigned GetQuantizationBits(float range, float precision)
+    {
+        unsigned bits = 1;
+        while (bits < 32 && (double)((1ULL << bits) - 1) * 2.0 * precision < range)
+            ++bits;
+        return bits;
+    }
+
     /// Instance equality operator.
     bool operator ==(const AttributeInfo& rhs) const
     {
@@ -152,6 +172,12 @@ struct AttributeInfo
     Variant defaultValue_;
     /// Attribute mode: whether to use for serialization, network replication, or both.
     AttributeModeFlags mode_ = AM_DEFAULT;
+    /// Number of bits per component to quantize the value to in network replication, or 0 to replicate at full precision. Supported for float, Vector2, Vector3 and Quaternion attributes.
+    unsigned quantizeBits_ = 0;
+    /// Minimum component value for network quantization. Not used for quaternions.
+    float quantizeMin_ = 0.0f;
+    /// Maximum component value for network quantization. Not used for quaternions.
+    float quantizeMax_ = 0.0f;
     /// Attribute metadata.
     VariantMap metadata_;
     /// Attribute data pointer if elsewhere than in the Serializable.
@@ -200,6 +226,22 @@ public:
             networkAttributeInfo_->metadata_[key] = value;
         return *this;
     }
+
+    /// Set network quantization range and number of bits per component (1-32.) Server and clients must use the same quantization.
+    AttributeHandle& SetQuantization(float minValue, float maxValue, unsigned bits)
+    {
+        if (attributeInfo_)
+            attributeInfo_->SetQuantization(minValue, maxValue, bits);
+        if (networkAttributeInfo_)
+            networkAttributeInfo_->SetQuantization(minValue, maxValue, bits);
+        return *this;
+    }
+
+    /// Set network quantization range and the largest allowed error per component, from which the number of bits is calculated.
+    AttributeHandle& SetQuantizationPrecision(float minValue, float maxValue, float precision)
+    {
+        return SetQuantization(minValue, maxValue, AttributeInfo::GetQuantizationBits(maxValue - minValue, precision));
+    }
 };
 
 }
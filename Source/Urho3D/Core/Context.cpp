@@ -207,6 +207,7 @@ void Context::RegisterFactory(ObjectFactory* factory, const char* category)
 void Context::RemoveFactory(StringHash type)
 {
     factories_.Erase(type);
+    jsonViewTypes_.Erase(type);
 }
 
 void Context::RemoveFactory(StringHash type, const char* category)
@@ -248,6 +249,12 @@ AttributeHandle Context::RegisterAttribute(StringHash objectType, const Attribut
     objectAttributes.Push(attr);
     handle.attributeInfo_ = &objectAttributes.Back();
 
+    // Keep the first attribute for a name, matching lookup by linear search
+    HashMap<StringHash, unsigned>& indices = attributeIndices_[objectType];
+    StringHash nameHash(attr.name_);
+    if (!indices.Contains(nameHash))
+        indices[nameHash] = objectAttributes.Size() - 1;
+
     if (attr.mode_ & AM_NET)
     {
         Vector<AttributeInfo>& objectNetworkAttributes = networkAttributes_[objectType];
@@ -261,12 +268,14 @@ void Context::RemoveAttribute(StringHash objectType, const char* name)
 {
     RemoveNamedAttribute(attributes_, objectType, name);
     RemoveNamedAttribute(networkAttributes_, objectType, name);
+    UpdateAttributeIndices(objectType);
 }
 
 void Context::RemoveAllAttributes(StringHash objectType)
 {
     attributes_.Erase(objectType);
     networkAttributes_.Erase(objectType);
+    attributeIndices_.Erase(objectType);
 }
 
 void Context::UpdateAttributeDefaultValue(StringHash objectType, const char* name, const Variant& defaultValue)
@@ -276,6 +285,28 @@ void Context::UpdateAttributeDefaultValue(StringHash objectType, const char* nam
         info->defaultValue_ = defaultValue;
 }
 
+void Context::SetAttributeQuantization(StringHash objectType, const char* name, float minValue, float maxValue, unsigned bits)
+{
+    AttributeInfo* info = GetAttribute(objectType, name);
+    if (!info)
+        return;
+    info->SetQuantization(minValue, maxValue, bits);
+
+    // Network attributes are stored separately
+    HashMap<StringHash, Vector<AttributeInfo> >::Iterator i = networkAttributes_.Find(objectType);
+    if (i != networkAttributes_.End())
+    {
+        for (Vector<AttributeInfo>::Iterator j = i->second_.Begin(); j != i->second_.End(); ++j)
+        {
+            if (!j->name_.Compare(name, true))
+            {
+                j->SetQuantization(minValue, maxValue, bits);
+                break;
+            }
+        }
+    }
+}
+
 VariantMap& Context::GetEventDataMap()
 {
     unsigned nestingLevel = eventSenders_.Size();
@@ -386,6 +417,8 @@ void Context::CopyBaseAttributes(StringHash baseType, StringHash derivedType)
             if (attr.mode_ & AM_NET)
                 networkAttributes_[derivedType].Push(attr);
         }
+
+        UpdateAttributeIndices(derivedType);
     }
 }
 
@@ -441,6 +474,25 @@ AttributeInfo* Context::GetAttribute(StringHash objectType, const char* name)
     return nullptr;
 }
 
+void Context::UpdateAttributeIndices(StringHash objectType)
+{
+    HashMap<StringHash, Vector<AttributeInfo> >::ConstIterator i = attributes_.Find(objectType);
+    if (i == attributes_.End())
+    {
+        attributeIndices_.Erase(objectType);
+        return;
+    }
+
+    HashMap<StringHash, unsigned>& indices = attributeIndices_[objectType];
+    indices.Clear();
+    for (unsigned j = 0; j < i->second_.Size(); ++j)
+    {
+        StringHash nameHash(i->second_[j].name_);
+        if (!indices.Contains(nameHash))
+            indices[nameHash] = j;
+    }
+}
+
 void Context::AddEventReceiver(Object* receiver, StringHash eventType)
 {
     SharedPtr<EventReceiverGroup>& group = eventReceivers_[eventType];
@@ -26,9 +26,28 @@
 #include "../Core/Attribute.h"
 #include "../Core/Object.h"
 
+#include <type_traits>
+
 namespace Urho3D
 {
 
+class JSONValue;
+class JSONView;
+
+#ifndef SWIG
+/// Return the class that declares a LoadJSON overload. Used only in unevaluated context.
+template <class Source, class U> U* GetLoadJSONDeclarer(bool (U::*)(const Source&));
+
+/// Whether a type may load from a JSON view without calling LoadJSON(const JSONValue&): false when the type or one of its bases declares the JSONValue overload below the JSONView overload.
+template <class T, class = void> struct IsJSONViewLoadable : std::false_type { };
+
+/// Specialization for types that have both LoadJSON overloads.
+template <class T> struct IsJSONViewLoadable<T, typename std::enable_if<sizeof(GetLoadJSONDeclarer<JSONValue>(&T::LoadJSON)) &&
+    sizeof(GetLoadJSONDeclarer<JSONView>(&T::LoadJSON))>::type> : std::integral_constant<bool,
+    std::is_base_of<typename std::remove_pointer<decltype(GetLoadJSONDeclarer<JSONValue>(&T::LoadJSON))>::type,
+        typename std::remove_pointer<decltype(GetLoadJSONDeclarer<JSONView>(&T::LoadJSON))>::type>::value> { };
+#endif
+
 /// Tracking structure for event receivers.
 class URHO3D_API EventReceiverGroup : public RefCounted
 {
@@ -100,6 +119,8 @@ public:
     void RemoveAllAttributes(StringHash objectType);
     /// Update object attribute's default value.
     void UpdateAttributeDefaultValue(StringHash objectType, const char* name, const Variant& defaultValue);
+    /// Set network quantization range and number of bits per component of an already registered attribute. Zero bits disables quantization. Server and clients must use the same quantization.
+    void SetAttributeQuantization(StringHash objectType, const char* name, float minValue, float maxValue, unsigned bits);
     /// Return a preallocated map for event data. Used for optimization to avoid constant re-allocation of event data maps.
     VariantMap& GetEventDataMap();
     /// Initialises the specified SDL systems, if not already. Returns true if successful. This call must be matched with ReleaseSDL() when SDL functions are no longer required, even if this call fails.
@@ -137,6 +158,8 @@ public:
     template <class T, class U> void CopyBaseAttributes();
     /// Template version of updating an object attribute's default value.
     template <class T> void UpdateAttributeDefaultValue(const char* name, const Variant& defaultValue);
+    /// Template version of setting network quantization of an already registered attribute.
+    template <class T> void SetAttributeQuantization(const char* name, float minValue, float maxValue, unsigned bits);
 
     /// Return subsystem by type.
     Object* GetSubsystem(StringHash type) const;
@@ -181,6 +204,16 @@ public:
         return i != attributes_.End() ? &i->second_ : nullptr;
     }
 
+    /// Return attribute indices keyed by name hash for an object type, or null if none defined.
+    const HashMap<StringHash, unsigned>* GetAttributeIndices(StringHash type) const
+    {
+        HashMap<StringHash, HashMap<StringHash, unsigned> >::ConstIterator i = attributeIndices_.Find(type);
+        return i != attributeIndices_.End() ? &i->second_ : nullptr;
+    }
+
+    /// Return whether an object type may load from a JSON view directly instead of through its LoadJSON(const JSONValue&). Only types registered with the template RegisterFactory() are checked.
+    bool CanLoadJSONView(StringHash type) const { return jsonViewTypes_.Contains(type); }
+
     /// Return network replication attribute descriptions for an object type, or null if none defined.
     const Vector<AttributeInfo>* GetNetworkAttributes(StringHash type) const
     {
@@ -301,6 +334,8 @@ private:
     /// End event send. Clean up event receivers removed in the meanwhile.
     void EndSendEvent();
 
+    /// Rebuild attribute name index for an object type after its attributes changed.
+    void UpdateAttributeIndices(StringHash objectType);
     /// Set current event handler. Called by Object.
     void SetEventHandler(EventHandler* handler) { eventHandler_ = handler; }
 
@@ -312,6 +347,10 @@ private:
     HashMap<StringHash, Vector<AttributeInfo> > attributes_;
     /// Network replication attribute descriptions per object type.
     HashMap<StringHash, Vector<AttributeInfo> > networkAttributes_;
+    /// Interned attribute name hashes to attribute indices per object type.
+    HashMap<StringHash, HashMap<StringHash, unsigned> > attributeIndices_;
+    /// Object types that may load from a JSON view directly.
+    HashSet<StringHash> jsonViewTypes_;
     /// Event receivers for non-specific events.
     HashMap<StringHash, SharedPtr<EventReceiverGroup> > eventReceivers_;
     /// Event receivers for specific senders' events.
@@ -377,12 +416,16 @@ template <> inline void Context::RemoveFactory<>(const char* category) { }
 template <class T, class... Rest> void Context::RegisterFactory()
 {
     RegisterFactory(new ObjectFactoryImpl<T>(this));
+    if (IsJSONViewLoadable<T>::value)
+        jsonViewTypes_.Insert(T::GetTypeStatic());
     RegisterFactory<Rest...>();
 }
 
 template <class T, class... Rest> void Context::RegisterFactory(const char* category)
 {
     RegisterFactory(new ObjectFactoryImpl<T>(this), category);
+    if (IsJSONViewLoadable<T>::value)
+        jsonViewTypes_.Insert(T::GetTypeStatic());
     RegisterFactory<Rest...>(category);
 }
 
@@ -425,4 +468,9 @@ template <class T> void Context::UpdateAttributeDefaultValue(const char* name, c
     UpdateAttributeDefaultValue(T::GetTypeStatic(), name, defaultValue);
 }
 
+template <class T> void Context::SetAttributeQuantization(const char* name, float minValue, float maxValue, unsigned bits)
+{
+    SetAttributeQuantization(T::GetTypeStatic(), name, minValue, maxValue, bits);
+}
+
 }
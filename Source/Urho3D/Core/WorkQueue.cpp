@@ -306,6 +306,28 @@ void WorkQueue::Complete(unsigned priority)
     completing_ = false;
 }
 
+void WorkQueue::ParallelFor(unsigned count, const std::function<void(unsigned, unsigned)>& function)
+{
+    if (!count)
+        return;
+
+    if (threads_.Empty() || completing_ || count < 2 || !Thread::IsMainThread())
+    {
+        function(0, count);
+        return;
+    }
+
+    unsigned numParts = Min(threads_.Size() + 1, count);
+    unsigned partSize = (count + numParts - 1) / numParts;
+    for (unsigned start = 0; start < count; start += partSize)
+    {
+        unsigned end = Min(start + partSize, count);
+        AddWorkItem([&function, start, end]() { function(start, end); }, M_MAX_UNSIGNED);
+    }
+
+    Complete(M_MAX_UNSIGNED);
+}
+
 unsigned WorkQueue::GetNumIncomplete(unsigned priority) const
 {
     unsigned incomplete = 0;
@@ -98,6 +98,8 @@ public:
     void Resume();
     /// Finish all queued work which has at least the specified priority. Main thread will also execute priority work. Pause worker threads if no more work remains.
     void Complete(unsigned priority);
+    /// Split a range of items to the worker threads and the calling thread, and wait for all of them to finish. The function is called with the start and end of each part. Runs as a single call in the calling thread when there are no worker threads, when not called from the main thread or when already completing work.
+    void ParallelFor(unsigned count, const std::function<void(unsigned, unsigned)>& function);
 
     /// Set the pool telerance before it starts deleting pool items.
     void SetTolerance(int tolerance) { tolerance_ = tolerance; }
@@ -38,6 +38,7 @@
 #include "../Engine/EngineDefs.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/Renderer.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../Input/Input.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -192,6 +193,7 @@ bool Engine::Initialize(const VariantMap& parameters)
     {
         context_->RegisterSubsystem(new Graphics(context_));
         context_->RegisterSubsystem(new Renderer(context_));
+        context_->RegisterSubsystem(new TextureStreaming(context_));
         context_->graphics_ = context_->GetSubsystem<Graphics>();
         context_->renderer_ = context_->GetSubsystem<Renderer>();
     }
@@ -285,6 +287,10 @@ bool Engine::Initialize(const VariantMap& parameters)
         renderer->SetTextureFilterMode((TextureFilterMode)GetParameter(parameters, EP_TEXTURE_FILTER_MODE, FILTER_TRILINEAR).GetInt());
         renderer->SetTextureAnisotropy(GetParameter(parameters, EP_TEXTURE_ANISOTROPY, 4).GetInt());
 
+        auto* textureStreaming = GetSubsystem<TextureStreaming>();
+        textureStreaming->SetEnabled(GetParameter(parameters, EP_TEXTURE_STREAMING, false).GetBool());
+        textureStreaming->SetMemoryBudget((unsigned long long)GetParameter(parameters, EP_TEXTURE_STREAMING_BUDGET, 0).GetInt() * 1024 * 1024);
+
         if (GetParameter(parameters, EP_SOUND, true).GetBool())
         {
             GetSubsystem<Audio>()->SetMode(
@@ -65,6 +65,8 @@ static const String EP_SOUND_STEREO = "SoundStereo";
 static const String EP_TEXTURE_ANISOTROPY = "TextureAnisotropy";
 static const String EP_TEXTURE_FILTER_MODE = "TextureFilterMode";
 static const String EP_TEXTURE_QUALITY = "TextureQuality";
+static const String EP_TEXTURE_STREAMING = "TextureStreaming";
+static const String EP_TEXTURE_STREAMING_BUDGET = "TextureStreamingBudget";
 static const String EP_TIME_OUT = "TimeOut";
 static const String EP_TOUCH_EMULATION = "TouchEmulation";
 static const String EP_TRIPLE_BUFFER = "TripleBuffer";
@@ -38,6 +38,7 @@
 #include "../Graphics/Octree.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../IO/Log.h"
+#include "../Resource/JSONView.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Scene/Scene.h"
@@ -67,6 +68,19 @@ static bool CompareAnimationOrder(const SharedPtr<AnimationState>& lhs, const Sh
 
 static const unsigned MAX_ANIMATION_STATES = 256;
 
+/// Return the legacy mask of the morphable elements in a vertex buffer by semantic, regardless of the element types.
+static VertexMaskFlags GetMorphableElements(const VertexBuffer* buffer)
+{
+    VertexMaskFlags mask = MASK_NONE;
+    if (buffer->HasElement(SEM_POSITION))
+        mask |= MASK_POSITION;
+    if (buffer->HasElement(SEM_NORMAL))
+        mask |= MASK_NORMAL;
+    if (buffer->HasElement(SEM_TANGENT))
+        mask |= MASK_TANGENT;
+    return mask;
+}
+
 AnimatedModel::AnimatedModel(Context* context) :
     StaticModel(context),
     animationLodFrameNumber_(0),
@@ -152,6 +166,18 @@ bool AnimatedModel::LoadJSON(const JSONValue& source)
     return success;
 }
 
+bool AnimatedModel::LoadJSON(const JSONView& source)
+{
+    if (!CanLoadJSONView())
+        return LoadJSONValueCopy(source);
+
+    loading_ = true;
+    bool success = Component::LoadJSON(source);
+    loading_ = false;
+
+    return success;
+}
+
 void AnimatedModel::ApplyAttributes()
 {
     if (assignBonesPending_)
@@ -1113,9 +1139,11 @@ void AnimatedModel::CloneGeometries()
         VertexBuffer* original = originalVertexBuffers[i];
         if (model_->GetMorphRangeCount(i))
         {
+            // The morphable elements are always cloned as floats, but stay in the space of the original positions
             SharedPtr<VertexBuffer> clone(context_->CreateObject<VertexBuffer>());
             clone->SetShadowed(true);
-            clone->SetSize(original->GetVertexCount(), morphElementMask_ & original->GetElementMask(), true);
+            clone->SetSize(original->GetVertexCount(), morphElementMask_ & GetMorphableElements(original), true);
+            clone->SetPositionTransform(original->GetPositionOffset(), original->GetPositionScale());
             void* dest = clone->Lock(0, original->GetVertexCount());
             if (dest)
             {
@@ -1169,6 +1197,16 @@ void AnimatedModel::CloneGeometries()
             clone->SetDrawRange(original->GetPrimitiveType(), original->GetIndexStart(), original->GetIndexCount());
             clone->SetLodDistance(original->GetLodDistance());
 
+            // Keep decoded positions of quantized models for CPU-side operations
+            SharedArrayPtr<unsigned char> rawVertexData;
+            SharedArrayPtr<unsigned char> rawIndexData;
+            unsigned rawVertexSize;
+            unsigned rawIndexSize;
+            const PODVector<VertexElement>* rawElements;
+            original->GetRawDataShared(rawVertexData, rawVertexSize, rawIndexData, rawIndexSize, rawElements);
+            if (rawVertexData && originalBuffers.Size() && rawVertexData.Get() != originalBuffers[0]->GetShadowData())
+                clone->SetRawVertexData(rawVertexData, *rawElements);
+
             geometries_[i][j] = clone;
         }
     }
@@ -1181,38 +1219,40 @@ void AnimatedModel::CloneGeometries()
 void AnimatedModel::CopyMorphVertices(void* destVertexData, void* srcVertexData, unsigned vertexCount, VertexBuffer* destBuffer,
     VertexBuffer* srcBuffer)
 {
-    unsigned mask = destBuffer->GetElementMask() & srcBuffer->GetElementMask();
-    unsigned normalOffset = srcBuffer->GetElementOffset(SEM_NORMAL);
-    unsigned tangentOffset = srcBuffer->GetElementOffset(SEM_TANGENT);
+    unsigned mask = destBuffer->GetElementMask() & GetMorphableElements(srcBuffer);
+    const VertexElement* position = srcBuffer->GetElement(SEM_POSITION);
+    const VertexElement* normal = srcBuffer->GetElement(SEM_NORMAL);
+    const VertexElement* tangent = srcBuffer->GetElement(SEM_TANGENT);
     unsigned vertexSize = srcBuffer->GetVertexSize();
     auto* dest = (float*)destVertexData;
     auto* src = (unsigned char*)srcVertexData;
 
+    // Quantized elements are converted to floats
     while (vertexCount--)
     {
         if (mask & MASK_POSITION)
         {
-            auto* posSrc = (float*)src;
-            dest[0] = posSrc[0];
-            dest[1] = posSrc[1];
-            dest[2] = posSrc[2];
+            Vector4 value = VertexBuffer::ReadElement(src + position->offset_, position->type_);
+            dest[0] = value.x_;
+            dest[1] = value.y_;
+            dest[2] = value.z_;
             dest += 3;
         }
         if (mask & MASK_NORMAL)
         {
-            auto* normalSrc = (float*)(src + normalOffset);
-            dest[0] = normalSrc[0];
-            dest[1] = normalSrc[1];
-            dest[2] = normalSrc[2];
+            Vector4 value = VertexBuffer::ReadElement(src + normal->offset_, normal->type_);
+            dest[0] = value.x_;
+            dest[1] = value.y_;
+            dest[2] = value.z_;
             dest += 3;
         }
         if (mask & MASK_TANGENT)
         {
-            auto* tangentSrc = (float*)(src + tangentOffset);
-            dest[0] = tangentSrc[0];
-            dest[1] = tangentSrc[1];
-            dest[2] = tangentSrc[2];
-            dest[3] = tangentSrc[3];
+            Vector4 value = VertexBuffer::ReadElement(src + tangent->offset_, tangent->type_);
+            dest[0] = value.x_;
+            dest[1] = value.y_;
+            dest[2] = value.z_;
+            dest[3] = value.w_;
             dest += 4;
         }
 
@@ -1307,6 +1347,19 @@ void AnimatedModel::UpdateSkinning()
     // Use model's world transform in case a bone is missing
     const Matrix3x4& worldTransform = node_->GetWorldTransform();
 
+    // Bake also the transform of quantized positions. The vertex buffers of a skinned model are expected to share it
+    const VertexBuffer* positionBuffer = nullptr;
+    if (model_)
+    {
+        const Vector<SharedPtr<VertexBuffer> >& buffers = model_->GetVertexBuffers();
+        for (unsigned i = 0; i < buffers.Size() && !positionBuffer; ++i)
+        {
+            if (buffers[i]->HasPositionTransform())
+                positionBuffer = buffers[i];
+        }
+    }
+    Matrix3x4 positionTransform = positionBuffer ? positionBuffer->GetPositionTransform() : Matrix3x4::IDENTITY;
+
     // Skinning with global matrices only
     if (!geometrySkinMatrices_.Size())
     {
@@ -1317,6 +1370,8 @@ void AnimatedModel::UpdateSkinning()
                 skinMatrices_[i] = bone.node_->GetWorldTransform() * bone.offsetMatrix_;
             else
                 skinMatrices_[i] = worldTransform;
+            if (positionBuffer)
+                skinMatrices_[i] = skinMatrices_[i] * positionTransform;
         }
     }
     // Skinning with per-geometry matrices
@@ -1329,6 +1384,8 @@ void AnimatedModel::UpdateSkinning()
                 skinMatrices_[i] = bone.node_->GetWorldTransform() * bone.offsetMatrix_;
             else
                 skinMatrices_[i] = worldTransform;
+            if (positionBuffer)
+                skinMatrices_[i] = skinMatrices_[i] * positionTransform;
 
             // Copy the skin matrix to per-geometry matrices as needed
             for (unsigned j = 0; j < geometrySkinMatrixPtrs_[i].Size(); ++j)
@@ -1391,6 +1448,8 @@ void AnimatedModel::ApplyMorph(VertexBuffer* buffer, void* destVertexData, unsig
     unsigned normalOffset = buffer->GetElementOffset(SEM_NORMAL);
     unsigned tangentOffset = buffer->GetElementOffset(SEM_TANGENT);
     unsigned vertexSize = buffer->GetVertexSize();
+    // Position deltas are in model space, while the positions may be stored with a position transform
+    float positionWeight = weight / buffer->GetPositionScale();
 
     unsigned char* srcData = morph.morphData_;
     auto* destData = (unsigned char*)destVertexData;
@@ -1404,9 +1463,9 @@ void AnimatedModel::ApplyMorph(VertexBuffer* buffer, void* destVertexData, unsig
         {
             auto* dest = (float*)(destData + vertexIndex * vertexSize);
             auto* src = (float*)srcData;
-            dest[0] += src[0] * weight;
-            dest[1] += src[1] * weight;
-            dest[2] += src[2] * weight;
+            dest[0] += src[0] * positionWeight;
+            dest[1] += src[1] * positionWeight;
+            dest[2] += src[2] * positionWeight;
             srcData += 3 * sizeof(float);
         }
         if (elementMask & MASK_NORMAL)
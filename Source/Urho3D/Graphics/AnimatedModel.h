@@ -53,6 +53,8 @@ public:
     bool LoadXML(const XMLElement& source) override;
     /// Load from JSON data. Return true if successful.
     bool LoadJSON(const JSONValue& source) override;
+    /// Load from a read-only view of JSON data. Return true if successful.
+    bool LoadJSON(const JSONView& source) override;
     /// Apply attribute changes that can not be applied immediately. Called after scene load or a network update.
     void ApplyAttributes() override;
     /// Process octree raycast. May be called from a worker thread.
@@ -198,12 +198,12 @@ bool Animation::BeginLoad(Deserializer& source)
         for (unsigned i = 0; i < triggerArray.Size(); i++)
         {
             const JSONValue& triggerValue = triggerArray.At(i);
-            JSONValue normalizedTimeValue = triggerValue.Get("normalizedTime");
+            const JSONValue& normalizedTimeValue = triggerValue.Get("normalizedTime");
             if (!normalizedTimeValue.IsNull())
                 AddTrigger(normalizedTimeValue.GetFloat(), true, triggerValue.GetVariant());
             else
             {
-                JSONValue timeVal = triggerValue.Get("time");
+                const JSONValue& timeVal = triggerValue.Get("time");
                 if (!timeVal.IsNull())
                     AddTrigger(timeVal.GetFloat(), false, triggerValue.GetVariant());
             }
@@ -40,6 +40,18 @@
 namespace Urho3D
 {
 
+/// Return the vertex buffer whose position transform applies to a geometry, or null if positions are stored in model space.
+static const VertexBuffer* GetPositionTransformBuffer(const Geometry* geometry)
+{
+    const Vector<SharedPtr<VertexBuffer> >& buffers = geometry->GetVertexBuffers();
+    for (unsigned i = 0; i < buffers.Size(); ++i)
+    {
+        if (buffers[i] && buffers[i]->HasPositionTransform())
+            return buffers[i];
+    }
+    return nullptr;
+}
+
 inline bool CompareBatchesState(Batch* lhs, Batch* rhs)
 {
     if (lhs->renderOrder_ != rhs->renderOrder_)
@@ -247,6 +259,13 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
             graphics->SetShaderParameter(VSP_SKINMATRICES, reinterpret_cast<const float*>(worldTransform_),
                 12 * numWorldTransforms_);
         }
+        else if (const VertexBuffer* positionBuffer = GetPositionTransformBuffer(geometry_))
+        {
+            // Skinned models fold the position transform into the skin matrices themselves. As the model matrix now
+            // depends on the geometry, do not let the next batch with the same world transform skip its update
+            graphics->SetShaderParameter(VSP_MODEL, *worldTransform_ * positionBuffer->GetPositionTransform());
+            graphics->ClearParameterSource(SP_OBJECT);
+        }
         else
             graphics->SetShaderParameter(VSP_MODEL, *worldTransform_);
 
@@ -260,6 +279,15 @@ void Batch::Prepare(View* view, Camera* camera, bool setModelTransform, bool all
         }
     }
 
+    // Shaders that use model space positions directly, like vegetation and skybox, decode quantized positions
+    // themselves with the offset in xyz and the scale in w
+    if (graphics->HasShaderParameter(VSP_POSITIONDEQUANTIZE))
+    {
+        const VertexBuffer* positionBuffer = GetPositionTransformBuffer(geometry_);
+        graphics->SetShaderParameter(VSP_POSITIONDEQUANTIZE, positionBuffer ?
+            Vector4(positionBuffer->GetPositionOffset(), positionBuffer->GetPositionScale()) : Vector4(0.0f, 0.0f, 0.0f, 1.0f));
+    }
+
     // Set zone-related shader parameters
     BlendMode blend = graphics->GetBlendMode();
     // If the pass is additive, override fog color to black so that shaders do not need a separate additive path
@@ -650,12 +678,19 @@ void BatchGroup::SetInstancingData(void* lockedData, unsigned stride, unsigned&
 
     startIndex_ = freeIndex;
     unsigned char* buffer = static_cast<unsigned char*>(lockedData) + startIndex_ * stride;
+    const VertexBuffer* positionBuffer = GetPositionTransformBuffer(geometry_);
 
     for (unsigned i = 0; i < instances_.Size(); ++i)
     {
         const InstanceData& instance = instances_[i];
 
-        memcpy(buffer, instance.worldTransform_, sizeof(Matrix3x4));
+        if (positionBuffer)
+        {
+            Matrix3x4 transform = *instance.worldTransform_ * positionBuffer->GetPositionTransform();
+            memcpy(buffer, &transform, sizeof(Matrix3x4));
+        }
+        else
+            memcpy(buffer, instance.worldTransform_, sizeof(Matrix3x4));
         if (instance.instancingData_)
             memcpy(buffer + sizeof(Matrix3x4), instance.instancingData_, stride - sizeof(Matrix3x4));
 
@@ -680,10 +715,16 @@ void BatchGroup::Draw(View* view, Camera* camera, bool allowDepthWrite) const
 
             graphics->SetIndexBuffer(geometry_->GetIndexBuffer());
             graphics->SetVertexBuffers(geometry_->GetVertexBuffers());
+            const VertexBuffer* positionBuffer = GetPositionTransformBuffer(geometry_);
 
             for (unsigned i = 0; i < instances_.Size(); ++i)
             {
-                if (graphics->NeedParameterUpdate(SP_OBJECT, instances_[i].worldTransform_))
+                if (positionBuffer)
+                {
+                    graphics->SetShaderParameter(VSP_MODEL, *instances_[i].worldTransform_ * positionBuffer->GetPositionTransform());
+                    graphics->ClearParameterSource(SP_OBJECT);
+                }
+                else if (graphics->NeedParameterUpdate(SP_OBJECT, instances_[i].worldTransform_))
                     graphics->SetShaderParameter(VSP_MODEL, *instances_[i].worldTransform_);
 
                 graphics->Draw(geometry_->GetPrimitiveType(), geometry_->GetIndexStart(), geometry_->GetIndexCount(),
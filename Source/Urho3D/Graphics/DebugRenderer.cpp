@@ -460,13 +460,19 @@ void DebugRenderer::AddTriangleMesh(Node* node, const Color& color, bool depthTe
         for (auto index = 0; index < staticModel->GetBatches().Size(); index++)
         {
             const auto& geometry = staticModel->GetLodGeometry(index, -1);
-            const auto& ib = geometry->GetIndexBuffer();
-            for (const auto& vb : geometry->GetVertexBuffers())
-            {
-                AddTriangleMesh(vb->GetShadowData(), vb->GetVertexSize(), geometry->GetVertexStart(),
-                                ib->GetShadowData(), ib->GetIndexSize(), geometry->GetIndexStart(),
-                                geometry->GetIndexCount(), node->GetWorldTransform(), color, depthTest);
-            }
+
+            // Use the raw data, which has float positions also for quantized models
+            const unsigned char* vertexData;
+            const unsigned char* indexData;
+            unsigned vertexSize;
+            unsigned indexSize;
+            const PODVector<VertexElement>* elements;
+            geometry->GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+            if (!vertexData || !indexData || VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) != 0)
+                continue;
+
+            AddTriangleMesh(vertexData, vertexSize, geometry->GetVertexStart(), indexData, indexSize, geometry->GetIndexStart(),
+                            geometry->GetIndexCount(), node->GetWorldTransform(), color, depthTest);
         }
     }
 }
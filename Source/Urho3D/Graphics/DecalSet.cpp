@@ -60,6 +60,16 @@ static const VertexMaskFlags STATIC_ELEMENT_MASK = MASK_POSITION | MASK_NORMAL |
 static const VertexMaskFlags SKINNED_ELEMENT_MASK = MASK_POSITION | MASK_NORMAL | MASK_TEXCOORD1 | MASK_TANGENT |
     MASK_BLENDWEIGHTS | MASK_BLENDINDICES;
 
+/// Read a vertex normal, which may be quantized.
+static Vector3 ReadNormal(const unsigned char* data, VertexElementType type)
+{
+    if (type == TYPE_VECTOR3)
+        return *((const Vector3*)data);
+
+    Vector4 normal = VertexBuffer::ReadElement(data, type);
+    return Vector3(normal.x_, normal.y_, normal.z_);
+}
+
 static DecalVertex ClipEdge(const DecalVertex& v0, const DecalVertex& v1, float d0, float d1, bool skinned)
 {
     DecalVertex ret;
@@ -710,6 +720,7 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
     unsigned normalStride = 0;
     unsigned skinningStride = 0;
     unsigned indexStride = 0;
+    VertexElementType normalType = TYPE_VECTOR3;
 
     IndexBuffer* ib = geometry->GetIndexBuffer();
     if (ib)
@@ -730,15 +741,18 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
         if (!data)
             continue;
 
-        if (elementMask & MASK_POSITION)
+        // Quantized positions are used through the geometry's raw data instead
+        if ((elementMask & MASK_POSITION) && !vb->HasPositionTransform())
         {
             positionData = data;
             positionStride = vb->GetVertexSize();
         }
         if (elementMask & MASK_NORMAL)
         {
-            normalData = data + vb->GetElementOffset(SEM_NORMAL);
+            const VertexElement* element = vb->GetElement(SEM_NORMAL);
+            normalData = data + element->offset_;
             normalStride = vb->GetVertexSize();
+            normalType = element->type_;
         }
         if (elementMask & MASK_BLENDWEIGHTS)
         {
@@ -774,7 +788,7 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
             while (indices < indicesEnd)
             {
                 GetFace(faces, target, batchIndex, indices[0], indices[1], indices[2], positionData, normalData, skinningData,
-                    positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
+                    positionStride, normalStride, skinningStride, normalType, frustum, decalNormal, normalCutoff);
                 indices += 3;
             }
         }
@@ -787,7 +801,7 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
             while (indices < indicesEnd)
             {
                 GetFace(faces, target, batchIndex, indices[0], indices[1], indices[2], positionData, normalData, skinningData,
-                    positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
+                    positionStride, normalStride, skinningStride, normalType, frustum, decalNormal, normalCutoff);
                 indices += 3;
             }
         }
@@ -801,7 +815,7 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
         while (indices + 2 < indicesEnd)
         {
             GetFace(faces, target, batchIndex, indices, indices + 1, indices + 2, positionData, normalData, skinningData,
-                positionStride, normalStride, skinningStride, frustum, decalNormal, normalCutoff);
+                positionStride, normalStride, skinningStride, normalType, frustum, decalNormal, normalCutoff);
             indices += 3;
         }
     }
@@ -809,8 +823,8 @@ void DecalSet::GetFaces(Vector<PODVector<DecalVertex> >& faces, Drawable* target
 
 void DecalSet::GetFace(Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, unsigned i0, unsigned i1,
     unsigned i2, const unsigned char* positionData, const unsigned char* normalData, const unsigned char* skinningData,
-    unsigned positionStride, unsigned normalStride, unsigned skinningStride, const Frustum& frustum, const Vector3& decalNormal,
-    float normalCutoff)
+    unsigned positionStride, unsigned normalStride, unsigned skinningStride, VertexElementType normalType, const Frustum& frustum,
+    const Vector3& decalNormal, float normalCutoff)
 {
     bool hasNormals = normalData != nullptr;
     bool hasSkinning = skinned_ && skinningData != nullptr;
@@ -828,9 +842,9 @@ void DecalSet::GetFace(Vector<PODVector<DecalVertex> >& faces, Drawable* target,
         faceNormal = (dist1.CrossProduct(dist2)).Normalized();
     }
 
-    const Vector3& n0 = hasNormals ? *((const Vector3*)(&normalData[i0 * normalStride])) : faceNormal;
-    const Vector3& n1 = hasNormals ? *((const Vector3*)(&normalData[i1 * normalStride])) : faceNormal;
-    const Vector3& n2 = hasNormals ? *((const Vector3*)(&normalData[i2 * normalStride])) : faceNormal;
+    const Vector3 n0 = hasNormals ? ReadNormal(&normalData[i0 * normalStride], normalType) : faceNormal;
+    const Vector3 n1 = hasNormals ? ReadNormal(&normalData[i1 * normalStride], normalType) : faceNormal;
+    const Vector3 n2 = hasNormals ? ReadNormal(&normalData[i2 * normalStride], normalType) : faceNormal;
 
     const unsigned char* s0 = hasSkinning ? &skinningData[i0 * skinningStride] : nullptr;
     const unsigned char* s1 = hasSkinning ? &skinningData[i1 * skinningStride] : nullptr;
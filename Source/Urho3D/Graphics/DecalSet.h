@@ -198,8 +198,8 @@ private:
     void GetFace
         (Vector<PODVector<DecalVertex> >& faces, Drawable* target, unsigned batchIndex, unsigned i0, unsigned i1, unsigned i2,
             const unsigned char* positionData, const unsigned char* normalData, const unsigned char* skinningData,
-            unsigned positionStride, unsigned normalStride, unsigned skinningStride, const Frustum& frustum,
-            const Vector3& decalNormal, float normalCutoff);
+            unsigned positionStride, unsigned normalStride, unsigned skinningStride, VertexElementType normalType,
+            const Frustum& frustum, const Vector3& decalNormal, float normalCutoff);
     /// Get bones referenced by skinning data and remap the skinning indices. Return true if successful.
     bool GetBones(Drawable* target, unsigned batchIndex, const float* blendWeights, const unsigned char* blendIndices,
         unsigned char* newBlendIndices);
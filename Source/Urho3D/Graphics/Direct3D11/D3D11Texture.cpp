@@ -208,6 +208,11 @@ unsigned Texture::GetExternalFormat(unsigned format)
     return 0;
 }
 
+bool Texture::NeedRGBAConversion(unsigned components, bool useAlpha)
+{
+    return (components == 1 && !useAlpha) || components == 2 || components == 3;
+}
+
 unsigned Texture::GetDataType(unsigned format)
 {
     return 0;
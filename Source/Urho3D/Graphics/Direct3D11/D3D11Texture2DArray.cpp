@@ -24,6 +24,7 @@
 
 #include "../../Core/Context.h"
 #include "../../Core/Profiler.h"
+#include "../../Core/WorkQueue.h"
 #include "../../Graphics/Graphics.h"
 #include "../../Graphics/GraphicsEvents.h"
 #include "../../Graphics/GraphicsImpl.h"
@@ -207,7 +208,7 @@ bool Texture2DArray::SetData(unsigned layer, Image* image, bool useAlpha)
     {
         // Convert unsuitable formats to RGBA
         unsigned components = image->GetComponents();
-        if ((components == 1 && !useAlpha) || components == 2 || components == 3)
+        if (NeedRGBAConversion(components, useAlpha))
         {
             mipImage = image->ConvertToRGBA(); image = mipImage;
             if (!image)
@@ -332,7 +333,7 @@ bool Texture2DArray::SetData(unsigned layer, Image* image, bool useAlpha)
             else
             {
                 unsigned char* rgbaData = new unsigned char[level.width_ * level.height_ * 4];
-                level.Decompress(rgbaData);
+                level.Decompress(rgbaData, GetSubsystem<WorkQueue>());
                 SetData(layer, i, 0, 0, level.width_, level.height_, rgbaData);
                 memoryUse += level.width_ * level.height_ * 4;
                 delete[] rgbaData;
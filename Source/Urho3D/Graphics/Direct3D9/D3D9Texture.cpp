@@ -135,4 +135,10 @@ unsigned Texture::GetDataType(unsigned format)
     return 0;
 }
 
+bool Texture::NeedRGBAConversion(unsigned components, bool useAlpha)
+{
+    // All component counts are swizzled to a supported format on upload
+    return false;
+}
+
 }
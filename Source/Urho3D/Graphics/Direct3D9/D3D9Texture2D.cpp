@@ -24,6 +24,7 @@
 
 #include "../../Core/Context.h"
 #include "../../Core/Profiler.h"
+#include "../../Core/WorkQueue.h"
 #include "../../Graphics/Graphics.h"
 #include "../../Graphics/GraphicsEvents.h"
 #include "../../Graphics/GraphicsImpl.h"
@@ -230,7 +231,8 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
         unsigned format = 0;
 
         // Discard unnecessary mip levels
-        for (unsigned i = 0; i < mipsToSkip_[quality]; ++i)
+        const unsigned mipsToSkip = GetLoadMipsToSkip(quality, GetLoadLevels(image));
+        for (unsigned i = 0; i < mipsToSkip; ++i)
         {
             mipImage = image->GetNextLevel(); image = mipImage;
             levelData = image->GetData();
@@ -295,7 +297,7 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
             needDecompress = true;
         }
 
-        unsigned mipsToSkip = mipsToSkip_[quality];
+        unsigned mipsToSkip = GetLoadMipsToSkip(quality, levels);
         if (mipsToSkip >= levels)
             mipsToSkip = levels - 1;
         while (mipsToSkip && (width / (1 << mipsToSkip) < 4 || height / (1 << mipsToSkip) < 4))
@@ -318,7 +320,7 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
             else
             {
                 unsigned char* rgbaData = new unsigned char[level.width_ * level.height_ * 4];
-                level.Decompress(rgbaData);
+                level.Decompress(rgbaData, GetSubsystem<WorkQueue>());
                 SetData(i, 0, 0, level.width_, level.height_, rgbaData);
                 memoryUse += level.width_ * level.height_ * 4;
                 delete[] rgbaData;
@@ -183,6 +183,11 @@ void Geometry::SetRawIndexData(const SharedArrayPtr<unsigned char>& data, unsign
     rawIndexSize_ = indexSize;
 }
 
+void Geometry::SetClusters(const PODVector<GeometryCluster>& clusters)
+{
+    clusters_ = clusters;
+}
+
 void Geometry::Draw(Graphics* graphics)
 {
     if (indexBuffer_ && indexCount_ > 0)
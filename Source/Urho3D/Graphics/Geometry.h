@@ -25,6 +25,7 @@
 #include "../Container/ArrayPtr.h"
 #include "../Core/Object.h"
 #include "../Graphics/GraphicsDefs.h"
+#include "../Math/BoundingBox.h"
 
 namespace Urho3D
 {
@@ -34,6 +35,21 @@ class Ray;
 class Graphics;
 class VertexBuffer;
 
+/// Cluster of triangles in a geometry's draw range, for culling parts of large geometries.
+struct GeometryCluster
+{
+    /// Start index in the index buffer.
+    unsigned indexStart_;
+    /// Number of indices.
+    unsigned indexCount_;
+    /// Bounding box in model space.
+    BoundingBox boundingBox_;
+    /// Axis of the cone containing the triangle normals.
+    Vector3 coneAxis_;
+    /// Sine of the cone half angle. 1 if the triangles can not all face away from the viewer at the same time.
+    float coneCutoff_;
+};
+
 /// Defines one or more vertex buffers, an index buffer and a draw range.
 class URHO3D_API Geometry : public Object
 {
@@ -67,6 +83,8 @@ public:
     void SetRawVertexData(const SharedArrayPtr<unsigned char>& data, unsigned elementMask);
     /// Override raw index data to be returned for CPU-side operations.
     void SetRawIndexData(const SharedArrayPtr<unsigned char>& data, unsigned indexSize);
+    /// Set triangle clusters for culling parts of the geometry. The clusters should cover the draw range.
+    void SetClusters(const PODVector<GeometryCluster>& clusters);
     /// Draw.
     void Draw(Graphics* graphics);
 
@@ -100,6 +118,9 @@ public:
     /// Return LOD distance.
     float GetLodDistance() const { return lodDistance_; }
 
+    /// Return triangle clusters.
+    const PODVector<GeometryCluster>& GetClusters() const { return clusters_; }
+
     /// Return buffers' combined hash value for state sorting.
     unsigned short GetBufferHash() const;
     /// Return raw vertex and index data for CPU operations, or null pointers if not available. Will return data of the first vertex buffer if override data not set.
@@ -142,6 +163,8 @@ private:
     unsigned rawVertexSize_;
     /// Raw index data override size.
     unsigned rawIndexSize_;
+    /// Triangle clusters.
+    PODVector<GeometryCluster> clusters_;
 };
 
 }
@@ -48,6 +48,7 @@ extern URHO3D_API const StringHash VSP_GBUFFEROFFSETS("GBufferOffsets");
 extern URHO3D_API const StringHash VSP_LIGHTDIR("LightDir");
 extern URHO3D_API const StringHash VSP_LIGHTPOS("LightPos");
 extern URHO3D_API const StringHash VSP_NORMALOFFSETSCALE("NormalOffsetScale");
+extern URHO3D_API const StringHash VSP_POSITIONDEQUANTIZE("PositionDequantize");
 extern URHO3D_API const StringHash VSP_MODEL("Model");
 extern URHO3D_API const StringHash VSP_VIEW("View");
 extern URHO3D_API const StringHash VSP_VIEWINV("ViewInv");
@@ -118,7 +119,9 @@ extern URHO3D_API const unsigned ELEMENT_TYPESIZES[] =
     3 * sizeof(float),
     4 * sizeof(float),
     sizeof(unsigned),
-    sizeof(unsigned)
+    sizeof(unsigned),
+    4 * sizeof(short),
+    2 * sizeof(short)
 };
 
 
@@ -159,6 +159,8 @@ enum VertexElementType
     TYPE_VECTOR4,
     TYPE_UBYTE4,
     TYPE_UBYTE4_NORM,
+    TYPE_SHORT4_NORM,
+    TYPE_HALF2,
     MAX_VERTEX_ELEMENT_TYPES
 };
 
@@ -396,6 +398,7 @@ extern URHO3D_API const StringHash VSP_GBUFFEROFFSETS;
 extern URHO3D_API const StringHash VSP_LIGHTDIR;
 extern URHO3D_API const StringHash VSP_LIGHTPOS;
 extern URHO3D_API const StringHash VSP_NORMALOFFSETSCALE;
+extern URHO3D_API const StringHash VSP_POSITIONDEQUANTIZE;
 extern URHO3D_API const StringHash VSP_MODEL;
 extern URHO3D_API const StringHash VSP_VIEW;
 extern URHO3D_API const StringHash VSP_VIEWINV;
@@ -217,7 +217,7 @@ bool Material::EndLoad()
 
     if (loadJSONFile_)
     {
-        JSONValue rootVal = loadJSONFile_->GetRoot();
+        const JSONValue& rootVal = loadJSONFile_->GetRoot();
         success = Load(rootVal);
     }
 
@@ -298,14 +298,14 @@ bool Material::BeginLoadJSON(Deserializer& source)
             auto* cache = GetSubsystem<ResourceCache>();
             const JSONValue& rootVal = loadJSONFile_->GetRoot();
 
-            JSONArray techniqueArray = rootVal.Get("techniques").GetArray();
+            const JSONArray& techniqueArray = rootVal.Get("techniques").GetArray();
             for (unsigned i = 0; i < techniqueArray.Size(); i++)
             {
                 const JSONValue& techVal = techniqueArray[i];
                 cache->BackgroundLoadResource<Technique>(techVal.Get("name").GetString(), true, this);
             }
 
-            JSONObject textureObject = rootVal.Get("textures").GetObject();
+            const JSONObject& textureObject = rootVal.Get("textures").GetObject();
             for (JSONObject::ConstIterator it = textureObject.Begin(); it != textureObject.End(); it++)
             {
                 String unitString = it->first_;
@@ -522,7 +522,7 @@ bool Material::Load(const JSONValue& source)
     }
 
     // Load techniques
-    JSONArray techniquesArray = source.Get("techniques").GetArray();
+    const JSONArray& techniquesArray = source.Get("techniques").GetArray();
     techniques_.Clear();
     techniques_.Reserve(techniquesArray.Size());
 
@@ -534,10 +534,10 @@ bool Material::Load(const JSONValue& source)
         {
             TechniqueEntry newTechnique;
             newTechnique.technique_ = newTechnique.original_ = tech;
-            JSONValue qualityVal = techVal.Get("quality");
+            const JSONValue& qualityVal = techVal.Get("quality");
             if (!qualityVal.IsNull())
                 newTechnique.qualityLevel_ = (MaterialQuality)qualityVal.GetInt();
-            JSONValue lodDistanceVal = techVal.Get("loddistance");
+            const JSONValue& lodDistanceVal = techVal.Get("loddistance");
             if (!lodDistanceVal.IsNull())
                 newTechnique.lodDistance_ = lodDistanceVal.GetFloat();
             techniques_.Push(newTechnique);
@@ -548,7 +548,7 @@ bool Material::Load(const JSONValue& source)
     ApplyShaderDefines();
 
     // Load textures
-    JSONObject textureObject = source.Get("textures").GetObject();
+    const JSONObject& textureObject = source.Get("textures").GetObject();
     for (JSONObject::ConstIterator it = textureObject.Begin(); it != textureObject.End(); it++)
     {
         String textureUnit = it->first_;
@@ -582,7 +582,7 @@ bool Material::Load(const JSONValue& source)
 
     // Get shader parameters
     batchedParameterUpdate_ = true;
-    JSONObject parameterObject = source.Get("shaderParameters").GetObject();
+    const JSONObject& parameterObject = source.Get("shaderParameters").GetObject();
 
     for (JSONObject::ConstIterator it = parameterObject.Begin(); it != parameterObject.End(); it++)
     {
@@ -598,7 +598,7 @@ bool Material::Load(const JSONValue& source)
     batchedParameterUpdate_ = false;
 
     // Load shader parameter animations
-    JSONObject paramAnimationsObject = source.Get("shaderParameterAnimations").GetObject();
+    const JSONObject& paramAnimationsObject = source.Get("shaderParameterAnimations").GetObject();
     for (JSONObject::ConstIterator it = paramAnimationsObject.Begin(); it != paramAnimationsObject.End(); it++)
     {
         String name = it->first_;
@@ -626,35 +626,35 @@ bool Material::Load(const JSONValue& source)
         SetShaderParameterAnimation(name, animation, wrapMode, speed);
     }
 
-    JSONValue cullVal = source.Get("cull");
+    const JSONValue& cullVal = source.Get("cull");
     if (!cullVal.IsNull())
         SetCullMode((CullMode)GetStringListIndex(cullVal.GetString().CString(), cullModeNames, CULL_CCW));
 
-    JSONValue shadowCullVal = source.Get("shadowcull");
+    const JSONValue& shadowCullVal = source.Get("shadowcull");
     if (!shadowCullVal.IsNull())
         SetShadowCullMode((CullMode)GetStringListIndex(shadowCullVal.GetString().CString(), cullModeNames, CULL_CCW));
 
-    JSONValue fillVal = source.Get("fill");
+    const JSONValue& fillVal = source.Get("fill");
     if (!fillVal.IsNull())
         SetFillMode((FillMode)GetStringListIndex(fillVal.GetString().CString(), fillModeNames, FILL_SOLID));
 
-    JSONValue depthBiasVal = source.Get("depthbias");
+    const JSONValue& depthBiasVal = source.Get("depthbias");
     if (!depthBiasVal.IsNull())
         SetDepthBias(BiasParameters(depthBiasVal.Get("constant").GetFloat(), depthBiasVal.Get("slopescaled").GetFloat()));
 
-    JSONValue alphaToCoverageVal = source.Get("alphatocoverage");
+    const JSONValue& alphaToCoverageVal = source.Get("alphatocoverage");
     if (!alphaToCoverageVal.IsNull())
         SetAlphaToCoverage(alphaToCoverageVal.GetBool());
 
-    JSONValue lineAntiAliasVal = source.Get("lineantialias");
+    const JSONValue& lineAntiAliasVal = source.Get("lineantialias");
     if (!lineAntiAliasVal.IsNull())
         SetLineAntiAlias(lineAntiAliasVal.GetBool());
 
-    JSONValue renderOrderVal = source.Get("renderorder");
+    const JSONValue& renderOrderVal = source.Get("renderorder");
     if (!renderOrderVal.IsNull())
         SetRenderOrder((unsigned char)renderOrderVal.GetUInt());
 
-    JSONValue occlusionVal = source.Get("occlusion");
+    const JSONValue& occlusionVal = source.Get("occlusion");
     if (!occlusionVal.IsNull())
         SetOcclusion(occlusionVal.GetBool());
 
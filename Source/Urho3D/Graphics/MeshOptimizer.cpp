@@ -0,0 +1,1093 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/HashMap.h"
+#include "../Container/Sort.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/MeshOptimizer.h"
+#include "../Math/Vector3.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Cache size assumed by the vertex cache optimization.
+static const unsigned FORSYTH_CACHE_SIZE = 32;
+/// Highest remaining triangle count with a precalculated valence score.
+static const unsigned FORSYTH_MAX_VALENCE = 32;
+/// Cache size used for splitting clusters in the overdraw optimization.
+static const unsigned OVERDRAW_CACHE_SIZE = 16;
+/// Value for a vertex not in the cache.
+static const unsigned NOT_IN_CACHE = M_MAX_UNSIGNED;
+/// Minimum dot product of a triangle normal with the cluster's average normal, so that the normal cones stay narrow enough for backface culling.
+static const float CLUSTER_MIN_NORMAL_DOT = 0.5f;
+/// Value for a triangle not in a cluster.
+static const unsigned NO_CLUSTER = M_MAX_UNSIGNED;
+
+/// Score tables of the vertex cache optimization.
+struct ForsythScores
+{
+    /// Construct.
+    ForsythScores()
+    {
+        const float cacheDecayPower = 1.5f;
+        const float lastTriangleScore = 0.75f;
+        const float valenceBoostScale = 2.0f;
+        const float valenceBoostPower = 0.5f;
+
+        for (unsigned i = 0; i < FORSYTH_CACHE_SIZE; ++i)
+        {
+            // The vertices of the last triangle get a fixed score so that the next triangle does not prefer them
+            if (i < 3)
+                cache_[i] = lastTriangleScore;
+            else
+                cache_[i] = powf(1.0f - (float)(i - 3) / (FORSYTH_CACHE_SIZE - 3), cacheDecayPower);
+        }
+
+        // Boost vertices with few triangles left to avoid leaving lone triangles behind
+        valence_[0] = 0.0f;
+        for (unsigned i = 1; i <= FORSYTH_MAX_VALENCE; ++i)
+            valence_[i] = valenceBoostScale * powf((float)i, -valenceBoostPower);
+    }
+
+    /// Return score of a vertex.
+    float GetScore(unsigned cachePosition, unsigned remainingTriangles) const
+    {
+        if (!remainingTriangles)
+            return -1.0f;
+        float score = cachePosition < FORSYTH_CACHE_SIZE ? cache_[cachePosition] : 0.0f;
+        return score + valence_[Min(remainingTriangles, FORSYTH_MAX_VALENCE)];
+    }
+
+    /// Scores by cache position.
+    float cache_[FORSYTH_CACHE_SIZE];
+    /// Scores by remaining triangle count.
+    float valence_[FORSYTH_MAX_VALENCE + 1];
+};
+
+/// Cluster of triangles for the overdraw optimization.
+struct OverdrawCluster
+{
+    /// Sort by decreasing sort key.
+    bool operator <(const OverdrawCluster& rhs) const { return sortKey_ > rhs.sortKey_; }
+
+    /// First triangle.
+    unsigned start_;
+    /// Triangle count.
+    unsigned count_;
+    /// How much the cluster faces away from the mesh center.
+    float sortKey_;
+};
+
+/// Simulate a FIFO cache using per-vertex timestamps. Return number of cache misses of a triangle.
+static unsigned SimulateTriangle(const unsigned* triangle, PODVector<unsigned>& timestamps, unsigned& time, unsigned cacheSize)
+{
+    unsigned misses = 0;
+    for (unsigned i = 0; i < 3; ++i)
+    {
+        unsigned vertex = triangle[i];
+        if (time - timestamps[vertex] > cacheSize)
+        {
+            timestamps[vertex] = time++;
+            ++misses;
+        }
+    }
+    return misses;
+}
+
+/// Vertex kind of the mesh simplification.
+enum SimplifyVertexKind
+{
+    /// Interior vertex that can collapse onto any neighbor.
+    SIMPLIFY_MANIFOLD = 0,
+    /// Vertex on an open border that can only collapse along the border.
+    SIMPLIFY_BORDER,
+    /// Vertex on an attribute seam that can only collapse along the seam, together with its pair on the other side.
+    SIMPLIFY_SEAM,
+    /// Vertex that is kept, such as a corner where borders or seams meet.
+    SIMPLIFY_LOCKED
+};
+
+/// Quadric error of the mesh simplification: weighted sum of squared distances to planes, as a symmetric 4x4 matrix.
+struct SimplifyQuadric
+{
+    /// Add a plane.
+    void AddPlane(const Vector3& normal, float distance, float weight)
+    {
+        a2_ += normal.x_ * normal.x_ * weight;
+        b2_ += normal.y_ * normal.y_ * weight;
+        c2_ += normal.z_ * normal.z_ * weight;
+        d2_ += distance * distance * weight;
+        ab_ += normal.x_ * normal.y_ * weight;
+        ac_ += normal.x_ * normal.z_ * weight;
+        ad_ += normal.x_ * distance * weight;
+        bc_ += normal.y_ * normal.z_ * weight;
+        bd_ += normal.y_ * distance * weight;
+        cd_ += normal.z_ * distance * weight;
+        weight_ += weight;
+    }
+
+    /// Add another quadric.
+    void Add(const SimplifyQuadric& rhs)
+    {
+        a2_ += rhs.a2_;
+        b2_ += rhs.b2_;
+        c2_ += rhs.c2_;
+        d2_ += rhs.d2_;
+        ab_ += rhs.ab_;
+        ac_ += rhs.ac_;
+        ad_ += rhs.ad_;
+        bc_ += rhs.bc_;
+        bd_ += rhs.bd_;
+        cd_ += rhs.cd_;
+        weight_ += rhs.weight_;
+    }
+
+    /// Return the weighted average squared distance of a position to the planes.
+    float GetError(const Vector3& v) const
+    {
+        float rx = a2_ * v.x_ + ab_ * v.y_ + ac_ * v.z_;
+        float ry = ab_ * v.x_ + b2_ * v.y_ + bc_ * v.z_;
+        float rz = ac_ * v.x_ + bc_ * v.y_ + c2_ * v.z_;
+        float r = rx * v.x_ + ry * v.y_ + rz * v.z_ + 2.0f * (ad_ * v.x_ + bd_ * v.y_ + cd_ * v.z_) + d2_;
+        return weight_ > 0.0f ? Abs(r) / weight_ : 0.0f;
+    }
+
+    float a2_, b2_, c2_, d2_, ab_, ac_, ad_, bc_, bd_, cd_;
+    /// Sum of plane weights.
+    float weight_;
+};
+
+/// Edge collapse candidate of the mesh simplification.
+struct SimplifyCollapse
+{
+    /// Sort by increasing error.
+    bool operator <(const SimplifyCollapse& rhs) const { return error_ < rhs.error_; }
+
+    /// Vertex that is removed.
+    unsigned from_;
+    /// Vertex that remains.
+    unsigned to_;
+    /// Squared error of the collapse.
+    float error_;
+};
+
+void OptimizeVertexCache(unsigned* indices, unsigned indexCount, unsigned vertexCount)
+{
+    static const ForsythScores scores;
+
+    unsigned triangleCount = indexCount / 3;
+    if (triangleCount < 2 || !vertexCount)
+        return;
+
+    // Build vertex to triangle adjacency
+    PODVector<unsigned> remaining(vertexCount);
+    PODVector<unsigned> offsets(vertexCount + 1);
+    memset(&remaining[0], 0, vertexCount * sizeof(unsigned));
+    for (unsigned i = 0; i < triangleCount * 3; ++i)
+        ++remaining[indices[i]];
+
+    offsets[0] = 0;
+    for (unsigned i = 0; i < vertexCount; ++i)
+        offsets[i + 1] = offsets[i] + remaining[i];
+
+    PODVector<unsigned> adjacency(triangleCount * 3);
+    PODVector<unsigned> fill(&offsets[0], vertexCount);
+    for (unsigned i = 0; i < triangleCount; ++i)
+    {
+        for (unsigned j = 0; j < 3; ++j)
+            adjacency[fill[indices[i * 3 + j]]++] = i;
+    }
+
+    PODVector<unsigned> cachePositions(vertexCount);
+    PODVector<float> vertexScores(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        cachePositions[i] = NOT_IN_CACHE;
+        vertexScores[i] = scores.GetScore(NOT_IN_CACHE, remaining[i]);
+    }
+
+    PODVector<float> triangleScores(triangleCount);
+    PODVector<bool> emitted(triangleCount);
+    for (unsigned i = 0; i < triangleCount; ++i)
+    {
+        const unsigned* triangle = &indices[i * 3];
+        triangleScores[i] = vertexScores[triangle[0]] + vertexScores[triangle[1]] + vertexScores[triangle[2]];
+        emitted[i] = false;
+    }
+
+    PODVector<unsigned> output(triangleCount * 3);
+    unsigned cache[FORSYTH_CACHE_SIZE + 3];
+    unsigned cacheSize = 0;
+    unsigned newCache[FORSYTH_CACHE_SIZE + 3];
+    unsigned scanPosition = 0;
+
+    unsigned bestTriangle = 0;
+    for (unsigned i = 1; i < triangleCount; ++i)
+    {
+        if (triangleScores[i] > triangleScores[bestTriangle])
+            bestTriangle = i;
+    }
+
+    for (unsigned emittedCount = 0; emittedCount < triangleCount; ++emittedCount)
+    {
+        const unsigned* triangle = &indices[bestTriangle * 3];
+        memcpy(&output[emittedCount * 3], triangle, 3 * sizeof(unsigned));
+        emitted[bestTriangle] = true;
+
+        // Remove the triangle from the active adjacency of its vertices
+        for (unsigned i = 0; i < 3; ++i)
+        {
+            unsigned vertex = triangle[i];
+            unsigned* begin = &adjacency[offsets[vertex]];
+            unsigned count = remaining[vertex];
+            for (unsigned j = 0; j < count; ++j)
+            {
+                if (begin[j] == bestTriangle)
+                {
+                    begin[j] = begin[count - 1];
+                    break;
+                }
+            }
+            --remaining[vertex];
+        }
+
+        // Push the triangle's vertices to the front of the cache. Vertices that fall out stay in the list for score update
+        unsigned newCacheSize = 0;
+        for (unsigned i = 0; i < 3; ++i)
+            newCache[newCacheSize++] = triangle[i];
+        for (unsigned i = 0; i < cacheSize; ++i)
+        {
+            unsigned vertex = cache[i];
+            if (vertex != triangle[0] && vertex != triangle[1] && vertex != triangle[2])
+                newCache[newCacheSize++] = vertex;
+        }
+
+        for (unsigned i = 0; i < newCacheSize; ++i)
+        {
+            unsigned vertex = newCache[i];
+            cachePositions[vertex] = i < FORSYTH_CACHE_SIZE ? i : NOT_IN_CACHE;
+            vertexScores[vertex] = scores.GetScore(cachePositions[vertex], remaining[vertex]);
+        }
+
+        // Update the scores of the triangles using the cached vertices and pick the best of them as the next one
+        float bestScore = -1.0f;
+        bestTriangle = M_MAX_UNSIGNED;
+        for (unsigned i = 0; i < newCacheSize; ++i)
+        {
+            unsigned vertex = newCache[i];
+            const unsigned* begin = &adjacency[offsets[vertex]];
+            for (unsigned j = 0; j < remaining[vertex]; ++j)
+            {
+                unsigned adjacent = begin[j];
+                const unsigned* adjacentTriangle = &indices[adjacent * 3];
+                float score = vertexScores[adjacentTriangle[0]] + vertexScores[adjacentTriangle[1]] + vertexScores[adjacentTriangle[2]];
+                triangleScores[adjacent] = score;
+                if (score > bestScore)
+                {
+                    bestScore = score;
+                    bestTriangle = adjacent;
+                }
+            }
+        }
+
+        cacheSize = Min(newCacheSize, FORSYTH_CACHE_SIZE);
+        memcpy(cache, newCache, cacheSize * sizeof(unsigned));
+
+        // When no triangle is connected to the cache, continue from the next unemitted triangle in input order
+        if (bestTriangle == M_MAX_UNSIGNED)
+        {
+            while (scanPosition < triangleCount && emitted[scanPosition])
+                ++scanPosition;
+            if (scanPosition == triangleCount)
+                break;
+            bestTriangle = scanPosition;
+        }
+    }
+
+    memcpy(indices, &output[0], triangleCount * 3 * sizeof(unsigned));
+}
+
+void OptimizeOverdraw(unsigned* indices, unsigned indexCount, const void* vertexData, unsigned vertexSize, unsigned positionOffset,
+    unsigned vertexCount, float threshold)
+{
+    unsigned triangleCount = indexCount / 3;
+    if (triangleCount < 2 || !vertexCount)
+        return;
+
+    // Split to clusters at triangles where all vertices miss the cache
+    PODVector<unsigned> timestamps(vertexCount);
+    memset(&timestamps[0], 0, vertexCount * sizeof(unsigned));
+    unsigned time = OVERDRAW_CACHE_SIZE + 1;
+
+    PODVector<unsigned> hardBoundaries;
+    for (unsigned i = 0; i < triangleCount; ++i)
+    {
+        if (SimulateTriangle(&indices[i * 3], timestamps, time, OVERDRAW_CACHE_SIZE) == 3 || !i)
+            hardBoundaries.Push(i);
+    }
+    hardBoundaries.Push(triangleCount);
+
+    // Split further where the cache efficiency up to that point is within the threshold of the whole cluster's
+    PODVector<unsigned> boundaries;
+    for (unsigned i = 0; i + 1 < hardBoundaries.Size(); ++i)
+    {
+        unsigned start = hardBoundaries[i];
+        unsigned end = hardBoundaries[i + 1];
+
+        time += OVERDRAW_CACHE_SIZE + 1;
+        unsigned clusterMisses = 0;
+        for (unsigned j = start; j < end; ++j)
+            clusterMisses += SimulateTriangle(&indices[j * 3], timestamps, time, OVERDRAW_CACHE_SIZE);
+        float clusterThreshold = threshold * clusterMisses / (end - start);
+
+        boundaries.Push(start);
+        time += OVERDRAW_CACHE_SIZE + 1;
+        unsigned softStart = start;
+        unsigned misses = 0;
+        for (unsigned j = start; j < end; ++j)
+        {
+            misses += SimulateTriangle(&indices[j * 3], timestamps, time, OVERDRAW_CACHE_SIZE);
+            if (j + 1 < end && (float)misses / (j + 1 - softStart) <= clusterThreshold)
+            {
+                boundaries.Push(j + 1);
+                softStart = j + 1;
+                misses = 0;
+                time += OVERDRAW_CACHE_SIZE + 1;
+            }
+        }
+    }
+    boundaries.Push(triangleCount);
+
+    if (boundaries.Size() < 3)
+        return;
+
+    auto GetPosition = [&](unsigned vertex) -> const Vector3&
+    {
+        return *reinterpret_cast<const Vector3*>(static_cast<const unsigned char*>(vertexData) + vertex * vertexSize + positionOffset);
+    };
+
+    Vector3 meshCenter = Vector3::ZERO;
+    for (unsigned i = 0; i < vertexCount; ++i)
+        meshCenter += GetPosition(i);
+    meshCenter /= (float)vertexCount;
+
+    // Sort the clusters by how much their area weighted normal points away from the mesh center
+    PODVector<OverdrawCluster> clusters(boundaries.Size() - 1);
+    for (unsigned i = 0; i < clusters.Size(); ++i)
+    {
+        OverdrawCluster& cluster = clusters[i];
+        cluster.start_ = boundaries[i];
+        cluster.count_ = boundaries[i + 1] - boundaries[i];
+
+        Vector3 center = Vector3::ZERO;
+        Vector3 normal = Vector3::ZERO;
+        float area = 0.0f;
+        for (unsigned j = cluster.start_; j < cluster.start_ + cluster.count_; ++j)
+        {
+            const Vector3& v0 = GetPosition(indices[j * 3]);
+            const Vector3& v1 = GetPosition(indices[j * 3 + 1]);
+            const Vector3& v2 = GetPosition(indices[j * 3 + 2]);
+            Vector3 triangleNormal = (v1 - v0).CrossProduct(v2 - v0);
+            float triangleArea = triangleNormal.Length();
+            center += (v0 + v1 + v2) * (triangleArea / 3.0f);
+            normal += triangleNormal;
+            area += triangleArea;
+        }
+
+        if (area > M_EPSILON)
+            center /= area;
+        cluster.sortKey_ = (center - meshCenter).DotProduct(normal.Normalized());
+    }
+
+    Sort(clusters.Begin(), clusters.End());
+
+    PODVector<unsigned> output(triangleCount * 3);
+    unsigned* dest = &output[0];
+    for (unsigned i = 0; i < clusters.Size(); ++i)
+    {
+        memcpy(dest, &indices[clusters[i].start_ * 3], clusters[i].count_ * 3 * sizeof(unsigned));
+        dest += clusters[i].count_ * 3;
+    }
+
+    memcpy(indices, &output[0], triangleCount * 3 * sizeof(unsigned));
+}
+
+void OptimizeVertexFetch(void* vertexData, unsigned vertexSize, unsigned vertexCount, unsigned* indices, unsigned indexCount)
+{
+    if (!vertexCount)
+        return;
+
+    PODVector<unsigned> remap(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+        remap[i] = NOT_IN_CACHE;
+
+    unsigned nextVertex = 0;
+    for (unsigned i = 0; i < indexCount; ++i)
+    {
+        unsigned& newIndex = remap[indices[i]];
+        if (newIndex == NOT_IN_CACHE)
+            newIndex = nextVertex++;
+        indices[i] = newIndex;
+    }
+
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        if (remap[i] == NOT_IN_CACHE)
+            remap[i] = nextVertex++;
+    }
+
+    auto* vertices = static_cast<unsigned char*>(vertexData);
+    PODVector<unsigned char> original(vertices, vertexCount * vertexSize);
+    for (unsigned i = 0; i < vertexCount; ++i)
+        memcpy(vertices + remap[i] * vertexSize, &original[i * vertexSize], vertexSize);
+}
+
+float GetACMR(const unsigned* indices, unsigned indexCount, unsigned vertexCount, unsigned cacheSize)
+{
+    unsigned triangleCount = indexCount / 3;
+    if (!triangleCount || !vertexCount)
+        return 0.0f;
+
+    // Simulate an exact FIFO cache
+    PODVector<unsigned> fifo(cacheSize);
+    PODVector<bool> cached(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+        cached[i] = false;
+    unsigned oldest = 0;
+    unsigned size = 0;
+    unsigned misses = 0;
+
+    for (unsigned i = 0; i < triangleCount * 3; ++i)
+    {
+        unsigned vertex = indices[i];
+        if (cached[vertex])
+            continue;
+
+        ++misses;
+        cached[vertex] = true;
+        if (size < cacheSize)
+            fifo[size++] = vertex;
+        else
+        {
+            cached[fifo[oldest]] = false;
+            fifo[oldest] = vertex;
+            oldest = (oldest + 1) % cacheSize;
+        }
+    }
+
+    return (float)misses / triangleCount;
+}
+
+unsigned SimplifyMesh(unsigned* dest, const unsigned* indices, unsigned indexCount, const void* vertexData, unsigned vertexSize,
+    unsigned positionOffset, unsigned vertexCount, unsigned targetIndexCount, float targetError, float* resultError)
+{
+    indexCount -= indexCount % 3;
+    if (resultError)
+        *resultError = 0.0f;
+    if (!indexCount || !vertexCount)
+        return 0;
+
+    memcpy(dest, indices, indexCount * sizeof(unsigned));
+    if (indexCount <= targetIndexCount)
+        return indexCount;
+
+    auto GetPosition = [&](unsigned vertex) -> const Vector3&
+    {
+        return *reinterpret_cast<const Vector3*>(static_cast<const unsigned char*>(vertexData) + vertex * vertexSize + positionOffset);
+    };
+
+    // Link vertices of the same position to circular lists, and remap each to the first one for position based data
+    PODVector<unsigned> remap(vertexCount);
+    PODVector<unsigned> wedges(vertexCount);
+    HashMap<Vector3, unsigned> firstVertices;
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        HashMap<Vector3, unsigned>::Iterator j = firstVertices.Find(GetPosition(i));
+        if (j == firstVertices.End())
+        {
+            firstVertices[GetPosition(i)] = i;
+            remap[i] = i;
+            wedges[i] = i;
+        }
+        else
+        {
+            remap[i] = j->second_;
+            wedges[i] = wedges[j->second_];
+            wedges[j->second_] = i;
+        }
+    }
+
+    // Scale to the unit cube so that the error is relative to the mesh size
+    Vector3 minPosition(M_INFINITY, M_INFINITY, M_INFINITY);
+    Vector3 maxPosition(-M_INFINITY, -M_INFINITY, -M_INFINITY);
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        minPosition = VectorMin(minPosition, GetPosition(i));
+        maxPosition = VectorMax(maxPosition, GetPosition(i));
+    }
+    Vector3 extent = maxPosition - minPosition;
+    float maxExtent = Max(Max(extent.x_, extent.y_), extent.z_);
+    float scale = maxExtent > 0.0f ? 1.0f / maxExtent : 1.0f;
+    PODVector<Vector3> positions(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+        positions[i] = (GetPosition(i) - minPosition) * scale;
+
+    // Half-edges by start vertex
+    PODVector<unsigned> edgeOffsets(vertexCount + 1);
+    PODVector<unsigned> edgeTargets(indexCount);
+    memset(&edgeOffsets[0], 0, (vertexCount + 1) * sizeof(unsigned));
+    for (unsigned i = 0; i < indexCount; ++i)
+        ++edgeOffsets[dest[i] + 1];
+    for (unsigned i = 0; i < vertexCount; ++i)
+        edgeOffsets[i + 1] += edgeOffsets[i];
+    {
+        PODVector<unsigned> fill(&edgeOffsets[0], vertexCount);
+        for (unsigned i = 0; i < indexCount; i += 3)
+        {
+            for (unsigned k = 0; k < 3; ++k)
+                edgeTargets[fill[dest[i + k]]++] = dest[i + (k + 1) % 3];
+        }
+    }
+
+    auto HasEdge = [&](unsigned from, unsigned to)
+    {
+        for (unsigned i = edgeOffsets[from]; i < edgeOffsets[from + 1]; ++i)
+        {
+            if (edgeTargets[i] == to)
+                return true;
+        }
+        return false;
+    };
+
+    // Find the open edges of each vertex: edges that the opposite triangle does not share by vertex index
+    const unsigned noEdge = M_MAX_UNSIGNED;
+    const unsigned multipleEdges = M_MAX_UNSIGNED - 1;
+    PODVector<unsigned> openOut(vertexCount);
+    PODVector<unsigned> openIn(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+        openOut[i] = openIn[i] = noEdge;
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        for (unsigned j = edgeOffsets[i]; j < edgeOffsets[i + 1]; ++j)
+        {
+            unsigned target = edgeTargets[j];
+            if (!HasEdge(target, i))
+            {
+                openOut[i] = openOut[i] == noEdge ? target : multipleEdges;
+                openIn[target] = openIn[target] == noEdge ? i : multipleEdges;
+            }
+        }
+    }
+
+    auto IsSingle = [&](unsigned edge) { return edge < multipleEdges; };
+
+    // Classify the vertices. A seam needs exactly two vertices of the same position whose open edges mirror each other
+    PODVector<unsigned char> kinds(vertexCount);
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        if (remap[i] != i)
+            continue;
+
+        SimplifyVertexKind kind = SIMPLIFY_LOCKED;
+        unsigned other = wedges[i];
+        if (other == i)
+        {
+            if (openOut[i] == noEdge && openIn[i] == noEdge)
+                kind = SIMPLIFY_MANIFOLD;
+            else if (IsSingle(openOut[i]) && IsSingle(openIn[i]))
+                kind = SIMPLIFY_BORDER;
+        }
+        else if (wedges[other] == i && IsSingle(openOut[i]) && IsSingle(openIn[i]) && IsSingle(openOut[other]) &&
+            IsSingle(openIn[other]) && remap[openOut[i]] == remap[openIn[other]] && remap[openIn[i]] == remap[openOut[other]])
+            kind = SIMPLIFY_SEAM;
+
+        unsigned vertex = i;
+        do
+        {
+            kinds[vertex] = (unsigned char)kind;
+            vertex = wedges[vertex];
+        } while (vertex != i);
+    }
+
+    // Accumulate the quadrics of the triangle planes, and of planes perpendicular to open edges to keep borders and seams in place
+    const float edgeWeight = 10.0f;
+    PODVector<SimplifyQuadric> quadrics(vertexCount);
+    memset(&quadrics[0], 0, vertexCount * sizeof(SimplifyQuadric));
+    for (unsigned i = 0; i < indexCount; i += 3)
+    {
+        const Vector3& p0 = positions[dest[i]];
+        Vector3 normal = (positions[dest[i + 1]] - p0).CrossProduct(positions[dest[i + 2]] - p0);
+        float length = normal.Length();
+        if (length <= 0.0f)
+            continue;
+        normal /= length;
+
+        for (unsigned k = 0; k < 3; ++k)
+            quadrics[remap[dest[i + k]]].AddPlane(normal, -normal.DotProduct(p0), length * 0.5f);
+
+        for (unsigned k = 0; k < 3; ++k)
+        {
+            unsigned from = dest[i + k];
+            unsigned to = dest[i + (k + 1) % 3];
+            if (HasEdge(to, from))
+                continue;
+
+            Vector3 edge = positions[to] - positions[from];
+            float edgeLength = edge.Length();
+            if (edgeLength <= 0.0f)
+                continue;
+            Vector3 edgeNormal = edge.CrossProduct(normal) / edgeLength;
+            float distance = -edgeNormal.DotProduct(positions[from]);
+            quadrics[remap[from]].AddPlane(edgeNormal, distance, edgeLength * edgeLength * edgeWeight);
+            quadrics[remap[to]].AddPlane(edgeNormal, distance, edgeLength * edgeLength * edgeWeight);
+        }
+    }
+
+    auto CanCollapse = [&](unsigned from, unsigned to)
+    {
+        switch (kinds[from])
+        {
+        case SIMPLIFY_MANIFOLD:
+            return true;
+
+        case SIMPLIFY_BORDER:
+            return kinds[to] == SIMPLIFY_BORDER && (openOut[from] == to || openIn[from] == to);
+
+        case SIMPLIFY_SEAM:
+            {
+                if (kinds[to] != SIMPLIFY_SEAM || (openOut[from] != to && openIn[from] != to))
+                    return false;
+                // The pair on the other side must be connected by the seam as well
+                unsigned otherFrom = wedges[from];
+                unsigned otherTo = wedges[to];
+                return openOut[otherFrom] == otherTo || openIn[otherFrom] == otherTo;
+            }
+
+        default:
+            return false;
+        }
+    };
+
+    // Triangles around each position, rebuilt on each pass to test the collapses for flipped triangles
+    PODVector<unsigned> triangleOffsets(vertexCount + 1);
+    PODVector<unsigned> vertexTriangles(indexCount);
+
+    auto HasFlippedTriangles = [&](unsigned from, unsigned to)
+    {
+        unsigned fromPosition = remap[from];
+        unsigned toPosition = remap[to];
+        const Vector3& newPosition = positions[to];
+        for (unsigned i = triangleOffsets[fromPosition]; i < triangleOffsets[fromPosition + 1]; ++i)
+        {
+            const unsigned* triangle = &dest[vertexTriangles[i] * 3];
+            unsigned r0 = remap[triangle[0]];
+            unsigned r1 = remap[triangle[1]];
+            unsigned r2 = remap[triangle[2]];
+            // Triangles that share the edge are removed by the collapse
+            if (r0 == toPosition || r1 == toPosition || r2 == toPosition)
+                continue;
+
+            const Vector3& p0 = positions[triangle[0]];
+            const Vector3& p1 = positions[triangle[1]];
+            const Vector3& p2 = positions[triangle[2]];
+            Vector3 oldNormal = (p1 - p0).CrossProduct(p2 - p0);
+            const Vector3& q0 = r0 == fromPosition ? newPosition : p0;
+            const Vector3& q1 = r1 == fromPosition ? newPosition : p1;
+            const Vector3& q2 = r2 == fromPosition ? newPosition : p2;
+            Vector3 newNormal = (q1 - q0).CrossProduct(q2 - q0);
+            if (oldNormal.DotProduct(newNormal) <= 0.0f)
+                return true;
+        }
+        return false;
+    };
+
+    float maxErrorSquared = targetError * targetError;
+    float worstError = 0.0f;
+    PODVector<SimplifyCollapse> collapses;
+    PODVector<unsigned> collapseRemap(vertexCount);
+    PODVector<bool> collapseLocked(vertexCount);
+
+    while (indexCount > targetIndexCount)
+    {
+        memset(&triangleOffsets[0], 0, (vertexCount + 1) * sizeof(unsigned));
+        for (unsigned i = 0; i < indexCount; ++i)
+            ++triangleOffsets[remap[dest[i]] + 1];
+        for (unsigned i = 0; i < vertexCount; ++i)
+            triangleOffsets[i + 1] += triangleOffsets[i];
+        {
+            PODVector<unsigned> fill(&triangleOffsets[0], vertexCount);
+            for (unsigned i = 0; i < indexCount; ++i)
+                vertexTriangles[fill[remap[dest[i]]]++] = i / 3;
+        }
+
+        // Pick the cheaper allowed direction of each edge
+        collapses.Clear();
+        for (unsigned i = 0; i < indexCount; i += 3)
+        {
+            for (unsigned k = 0; k < 3; ++k)
+            {
+                unsigned v0 = dest[i + k];
+                unsigned v1 = dest[i + (k + 1) % 3];
+                if (remap[v0] == remap[v1])
+                    continue;
+
+                bool forward = CanCollapse(v0, v1);
+                bool backward = CanCollapse(v1, v0);
+                if (!forward && !backward)
+                    continue;
+
+                float forwardError = forward ? quadrics[remap[v0]].GetError(positions[v1]) : M_INFINITY;
+                float backwardError = backward ? quadrics[remap[v1]].GetError(positions[v0]) : M_INFINITY;
+                SimplifyCollapse collapse;
+                collapse.from_ = forwardError <= backwardError ? v0 : v1;
+                collapse.to_ = forwardError <= backwardError ? v1 : v0;
+                collapse.error_ = Min(forwardError, backwardError);
+                collapses.Push(collapse);
+            }
+        }
+        if (collapses.Empty())
+            break;
+
+        Sort(collapses.Begin(), collapses.End());
+
+        for (unsigned i = 0; i < vertexCount; ++i)
+        {
+            collapseRemap[i] = i;
+            collapseLocked[i] = false;
+        }
+
+        // Collapse the cheaper half of the edges at most, so that the quadrics of the remaining ones get updated between passes.
+        // Each vertex and its neighbors take part in one collapse per pass
+        unsigned triangleGoal = (indexCount - targetIndexCount) / 3;
+        unsigned removedTriangles = 0;
+        unsigned candidates = Max(collapses.Size() / 2, 1U);
+        for (unsigned i = 0; i < candidates && removedTriangles < triangleGoal; ++i)
+        {
+            const SimplifyCollapse& collapse = collapses[i];
+            if (collapse.error_ > maxErrorSquared)
+                break;
+
+            unsigned from = collapse.from_;
+            unsigned to = collapse.to_;
+            if (collapseLocked[remap[from]] || collapseLocked[remap[to]] || HasFlippedTriangles(from, to))
+                continue;
+
+            collapseRemap[from] = to;
+            quadrics[remap[to]].Add(quadrics[remap[from]]);
+            // Lock the neighbors too, as their flip tests would otherwise see the triangles before this collapse
+            unsigned fromPosition = remap[from];
+            for (unsigned j = triangleOffsets[fromPosition]; j < triangleOffsets[fromPosition + 1]; ++j)
+            {
+                const unsigned* triangle = &dest[vertexTriangles[j] * 3];
+                for (unsigned k = 0; k < 3; ++k)
+                    collapseLocked[remap[triangle[k]]] = true;
+            }
+            worstError = Max(worstError, collapse.error_);
+
+            // Keep the open edge links of borders and seams up to date, on both sides of a seam
+            unsigned char kind = kinds[from];
+            if (kind == SIMPLIFY_BORDER || kind == SIMPLIFY_SEAM)
+            {
+                unsigned sideFrom = from;
+                unsigned sideTo = to;
+                do
+                {
+                    if (openOut[sideFrom] == sideTo)
+                    {
+                        unsigned previous = openIn[sideFrom];
+                        if (IsSingle(previous))
+                            openOut[previous] = sideTo;
+                        openIn[sideTo] = previous;
+                    }
+                    else
+                    {
+                        unsigned next = openOut[sideFrom];
+                        if (IsSingle(next))
+                            openIn[next] = sideTo;
+                        openOut[sideTo] = next;
+                    }
+                    collapseRemap[sideFrom] = sideTo;
+                    sideFrom = wedges[sideFrom];
+                    sideTo = wedges[sideTo];
+                } while (sideFrom != from);
+            }
+
+            removedTriangles += kind == SIMPLIFY_BORDER ? 1 : 2;
+        }
+        if (!removedTriangles)
+            break;
+
+        // Apply the collapses and remove the triangles that became degenerate
+        unsigned newIndexCount = 0;
+        for (unsigned i = 0; i < indexCount; i += 3)
+        {
+            unsigned v0 = collapseRemap[dest[i]];
+            unsigned v1 = collapseRemap[dest[i + 1]];
+            unsigned v2 = collapseRemap[dest[i + 2]];
+            if (v0 != v1 && v0 != v2 && v1 != v2)
+            {
+                dest[newIndexCount++] = v0;
+                dest[newIndexCount++] = v1;
+                dest[newIndexCount++] = v2;
+            }
+        }
+        indexCount = newIndexCount;
+    }
+
+    if (resultError)
+        *resultError = sqrtf(worstError);
+    return indexCount;
+}
+
+void BuildMeshClusters(PODVector<GeometryCluster>& dest, unsigned* indices, unsigned indexCount, const void* vertexData,
+    unsigned vertexSize, unsigned positionOffset, unsigned vertexCount, unsigned maxTriangles)
+{
+    dest.Clear();
+    indexCount -= indexCount % 3;
+    unsigned triangleCount = indexCount / 3;
+    if (!triangleCount || !vertexCount)
+        return;
+    maxTriangles = Max(maxTriangles, 1U);
+
+    auto GetPosition = [&](unsigned vertex) -> const Vector3&
+    {
+        return *reinterpret_cast<const Vector3*>(static_cast<const unsigned char*>(vertexData) + vertex * vertexSize + positionOffset);
+    };
+
+    // Remap vertices of the same position to the first one, so that seams do not break the adjacency
+    PODVector<unsigned> remap(vertexCount);
+    HashMap<Vector3, unsigned> firstVertices;
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        HashMap<Vector3, unsigned>::Iterator j = firstVertices.Find(GetPosition(i));
+        if (j == firstVertices.End())
+        {
+            firstVertices[GetPosition(i)] = i;
+            remap[i] = i;
+        }
+        else
+            remap[i] = j->second_;
+    }
+
+    // Triangles by vertex
+    PODVector<unsigned> triangleOffsets(vertexCount + 1);
+    PODVector<unsigned> vertexTriangles(indexCount);
+    memset(&triangleOffsets[0], 0, (vertexCount + 1) * sizeof(unsigned));
+    for (unsigned i = 0; i < indexCount; ++i)
+        ++triangleOffsets[remap[indices[i]] + 1];
+    for (unsigned i = 0; i < vertexCount; ++i)
+        triangleOffsets[i + 1] += triangleOffsets[i];
+    {
+        PODVector<unsigned> fill(triangleOffsets);
+        for (unsigned i = 0; i < indexCount; ++i)
+            vertexTriangles[fill[remap[indices[i]]]++] = i / 3;
+    }
+
+    // Unit normals and centers of the triangles. Degenerate triangles have a zero normal
+    PODVector<Vector3> normals(triangleCount);
+    PODVector<Vector3> centers(triangleCount);
+    for (unsigned i = 0; i < triangleCount; ++i)
+    {
+        const Vector3& v0 = GetPosition(indices[i * 3]);
+        const Vector3& v1 = GetPosition(indices[i * 3 + 1]);
+        const Vector3& v2 = GetPosition(indices[i * 3 + 2]);
+        Vector3 normal = (v1 - v0).CrossProduct(v2 - v0);
+        float length = normal.Length();
+        normals[i] = length > M_EPSILON ? normal / length : Vector3::ZERO;
+        centers[i] = (v0 + v1 + v2) / 3.0f;
+    }
+
+    // Grow each cluster from the first free triangle, adding the adjacent triangle closest to the cluster center and normal
+    PODVector<unsigned> triangleClusters(triangleCount, NO_CLUSTER);
+    PODVector<unsigned> candidateClusters(triangleCount, NO_CLUSTER);
+    PODVector<unsigned> order;
+    PODVector<unsigned> clusterTriangles;
+    PODVector<unsigned> candidates;
+    order.Reserve(triangleCount);
+    unsigned seed = 0;
+
+    while (order.Size() < triangleCount)
+    {
+        while (triangleClusters[seed] != NO_CLUSTER)
+            ++seed;
+
+        unsigned cluster = dest.Size();
+        clusterTriangles.Clear();
+        candidates.Clear();
+        Vector3 normalSum = Vector3::ZERO;
+        Vector3 centerSum = Vector3::ZERO;
+        BoundingBox box;
+        unsigned triangle = seed;
+
+        while (triangle != NO_CLUSTER)
+        {
+            triangleClusters[triangle] = cluster;
+            clusterTriangles.Push(triangle);
+            normalSum += normals[triangle];
+            centerSum += centers[triangle];
+            for (unsigned i = 0; i < 3; ++i)
+                box.Merge(GetPosition(indices[triangle * 3 + i]));
+            if (clusterTriangles.Size() >= maxTriangles)
+                break;
+
+            for (unsigned i = 0; i < 3; ++i)
+            {
+                unsigned vertex = remap[indices[triangle * 3 + i]];
+                for (unsigned j = triangleOffsets[vertex]; j < triangleOffsets[vertex + 1]; ++j)
+                {
+                    unsigned neighbor = vertexTriangles[j];
+                    if (triangleClusters[neighbor] == NO_CLUSTER && candidateClusters[neighbor] != cluster)
+                    {
+                        candidateClusters[neighbor] = cluster;
+                        candidates.Push(neighbor);
+                    }
+                }
+            }
+
+            Vector3 axis = normalSum.Normalized();
+            Vector3 center = centerSum / (float)clusterTriangles.Size();
+            float radius = Max(box.HalfSize().Length(), M_EPSILON);
+            unsigned best = NO_CLUSTER;
+            unsigned bestIndex = 0;
+            float bestScore = M_INFINITY;
+            for (unsigned i = 0; i < candidates.Size(); ++i)
+            {
+                unsigned candidate = candidates[i];
+                float normalDot = normals[candidate] != Vector3::ZERO ? normals[candidate].DotProduct(axis) : 1.0f;
+                if (normalDot < CLUSTER_MIN_NORMAL_DOT)
+                    continue;
+                float score = (centers[candidate] - center).Length() / radius + (1.0f - normalDot);
+                if (score < bestScore)
+                {
+                    best = candidate;
+                    bestIndex = i;
+                    bestScore = score;
+                }
+            }
+
+            if (best != NO_CLUSTER)
+            {
+                candidates[bestIndex] = candidates.Back();
+                candidates.Pop();
+            }
+            triangle = best;
+        }
+
+        // Keep the original triangle order within the cluster for the vertex cache
+        Sort(clusterTriangles.Begin(), clusterTriangles.End());
+
+        GeometryCluster newCluster;
+        newCluster.indexStart_ = order.Size() * 3;
+        newCluster.indexCount_ = clusterTriangles.Size() * 3;
+        newCluster.boundingBox_ = box;
+        newCluster.coneAxis_ = normalSum.Normalized();
+        float minDot = 1.0f;
+        for (unsigned i = 0; i < clusterTriangles.Size(); ++i)
+        {
+            if (normals[clusterTriangles[i]] != Vector3::ZERO)
+                minDot = Min(minDot, normals[clusterTriangles[i]].DotProduct(newCluster.coneAxis_));
+        }
+        newCluster.coneCutoff_ = newCluster.coneAxis_ != Vector3::ZERO && minDot > 0.0f ? sqrtf(1.0f - minDot * minDot) : 1.0f;
+        dest.Push(newCluster);
+
+        order.Push(clusterTriangles);
+    }
+
+    PODVector<unsigned> reordered(indexCount);
+    for (unsigned i = 0; i < triangleCount; ++i)
+    {
+        for (unsigned j = 0; j < 3; ++j)
+            reordered[i * 3 + j] = indices[order[i] * 3 + j];
+    }
+    memcpy(indices, &reordered[0], indexCount * sizeof(unsigned));
+}
+
+void OptimizeMesh(void* vertexData, unsigned vertexSize, unsigned positionOffset, void* indexData, unsigned indexSize,
+    unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount, float overdrawThreshold,
+    float* acmrBefore, float* acmrAfter)
+{
+    indexCount -= indexCount % 3;
+    if (!indexCount || !vertexCount)
+        return;
+
+    // Work on 32-bit indices relative to the first vertex
+    PODVector<unsigned> indices(indexCount);
+    if (indexSize == sizeof(unsigned short))
+    {
+        const unsigned short* src = static_cast<const unsigned short*>(indexData) + indexStart;
+        for (unsigned i = 0; i < indexCount; ++i)
+            indices[i] = src[i] - vertexStart;
+    }
+    else
+    {
+        const unsigned* src = static_cast<const unsigned*>(indexData) + indexStart;
+        for (unsigned i = 0; i < indexCount; ++i)
+            indices[i] = src[i] - vertexStart;
+    }
+
+    void* vertices = static_cast<unsigned char*>(vertexData) + vertexStart * vertexSize;
+
+    // The input may already be optimized for the vertex cache, for example by the importer. Fall back to the vertex cache
+    // order without the overdraw pass, or to the input order, if the result would be worse for the vertex cache than the input
+    const float acmrInput = GetACMR(&indices[0], indexCount, vertexCount);
+    if (acmrBefore)
+        *acmrBefore = acmrInput;
+
+    PODVector<unsigned> inputIndices(indices);
+    OptimizeVertexCache(&indices[0], indexCount, vertexCount);
+    PODVector<unsigned> cacheIndices(indices);
+    OptimizeOverdraw(&indices[0], indexCount, vertices, vertexSize, positionOffset, vertexCount, overdrawThreshold);
+
+    if (GetACMR(&indices[0], indexCount, vertexCount) > acmrInput)
+    {
+        if (GetACMR(&cacheIndices[0], indexCount, vertexCount) <= acmrInput)
+            indices = cacheIndices;
+        else
+            indices = inputIndices;
+    }
+
+    OptimizeVertexFetch(vertices, vertexSize, vertexCount, &indices[0], indexCount);
+
+    if (acmrAfter)
+        *acmrAfter = GetACMR(&indices[0], indexCount, vertexCount);
+
+    if (indexSize == sizeof(unsigned short))
+    {
+        unsigned short* dest = static_cast<unsigned short*>(indexData) + indexStart;
+        for (unsigned i = 0; i < indexCount; ++i)
+            dest[i] = (unsigned short)(indices[i] + vertexStart);
+    }
+    else
+    {
+        unsigned* dest = static_cast<unsigned*>(indexData) + indexStart;
+        for (unsigned i = 0; i < indexCount; ++i)
+            dest[i] = indices[i] + vertexStart;
+    }
+}
+
+}
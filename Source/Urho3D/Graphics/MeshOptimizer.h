@@ -0,0 +1,61 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#ifdef URHO3D_IS_BUILDING
+#include "Urho3D.h"
+#else
+#include <Urho3D/Urho3D.h>
+#endif
+
+#include "../Container/Vector.h"
+
+namespace Urho3D
+{
+
+struct GeometryCluster;
+
+/// Reorder the triangles of an indexed triangle list for the post-transform vertex cache, using Tom Forsyth's linear-speed algorithm. Indices must be less than the vertex count.
+URHO3D_API void OptimizeVertexCache(unsigned* indices, unsigned indexCount, unsigned vertexCount);
+/// Reorder clusters of triangles, split where the vertex cache would be cold anyway, so that clusters facing away from the mesh center are drawn first to reduce overdraw. Threshold is the allowed vertex cache efficiency loss for splitting clusters further, 1 to not split.
+URHO3D_API void OptimizeOverdraw(unsigned* indices, unsigned indexCount, const void* vertexData, unsigned vertexSize, unsigned positionOffset,
+    unsigned vertexCount, float threshold = 1.05f);
+/// Reorder vertices in the order the triangles first use them and remap the indices to match. Unused vertices are moved to the end.
+URHO3D_API void OptimizeVertexFetch(void* vertexData, unsigned vertexSize, unsigned vertexCount, unsigned* indices, unsigned indexCount);
+/// Return the average number of vertex shader invocations per triangle (ACMR) for a FIFO post-transform cache of the given size.
+URHO3D_API float GetACMR(const unsigned* indices, unsigned indexCount, unsigned vertexCount, unsigned cacheSize = 16);
+
+/// Simplify an indexed triangle list by collapsing edges onto existing vertices in order of least quadric error, so that the result shares the original vertex data. Vertices on open borders and on seams, where vertices of the same position have different attributes such as UVs or skin weights, only collapse along the border or seam, and vertices where these meet are kept. Write the indices to the destination, which must have room for index count indices, and return the new index count. Simplification stops at the target index count or when the error relative to the mesh size would exceed the target error. Optionally return the resulting relative error.
+URHO3D_API unsigned SimplifyMesh(unsigned* dest, const unsigned* indices, unsigned indexCount, const void* vertexData, unsigned vertexSize,
+    unsigned positionOffset, unsigned vertexCount, unsigned targetIndexCount, float targetError = 1.0f, float* resultError = nullptr);
+
+/// Split an indexed triangle list into clusters of adjacent triangles with similar normals, and reorder the triangles so that each cluster is contiguous. Triangles keep their relative order within a cluster. Return the bounding boxes and normal cones of the clusters, with index starts relative to the indices.
+URHO3D_API void BuildMeshClusters(PODVector<GeometryCluster>& dest, unsigned* indices, unsigned indexCount, const void* vertexData,
+    unsigned vertexSize, unsigned positionOffset, unsigned vertexCount, unsigned maxTriangles = 128);
+
+/// Optimize a range of an indexed triangle list in place for vertex cache, overdraw and vertex fetch, in that order. The overdraw pass, and if necessary the vertex cache pass, is discarded when the result has a worse ACMR than the input. The vertices from vertex start must be used only by the index range. Optionally return the ACMR before and after.
+URHO3D_API void OptimizeMesh(void* vertexData, unsigned vertexSize, unsigned positionOffset, void* indexData, unsigned indexSize,
+    unsigned indexStart, unsigned indexCount, unsigned vertexStart, unsigned vertexCount, float overdrawThreshold = 1.05f,
+    float* acmrBefore = nullptr, float* acmrAfter = nullptr);
+
+}
@@ -26,6 +26,7 @@
 #include "../Core/Profiler.h"
 #include "../Graphics/Geometry.h"
 #include "../Graphics/IndexBuffer.h"
+#include "../Graphics/MeshOptimizer.h"
 #include "../Graphics/Model.h"
 #include "../Graphics/Graphics.h"
 #include "../Graphics/VertexBuffer.h"
@@ -60,6 +61,59 @@ unsigned LookupIndexBuffer(IndexBuffer* buffer, const Vector<SharedPtr<IndexBuff
     return 0;
 }
 
+/// Return whether vertex elements have quantized positions, which are stored with a position transform.
+static bool HasQuantizedPositions(const PODVector<VertexElement>& elements)
+{
+    for (unsigned i = 0; i < elements.Size(); ++i)
+    {
+        if (elements[i].semantic_ == SEM_POSITION && elements[i].index_ == 0)
+            return elements[i].type_ != TYPE_VECTOR3;
+    }
+    return false;
+}
+
+/// Decode quantized positions and the first texture coordinates to floats for CPU-side operations, such as raycasts that return UVs.
+static SharedArrayPtr<unsigned char> DecodeRawVertexData(const unsigned char* data, unsigned vertexCount,
+    const PODVector<VertexElement>& elements, const Vector3& offset, float scale, PODVector<VertexElement>& rawElements)
+{
+    PODVector<VertexElement> offsetElements = elements;
+    VertexBuffer::UpdateOffsets(offsetElements);
+    const VertexElement* position = nullptr;
+    const VertexElement* texCoord = nullptr;
+    for (unsigned i = 0; i < offsetElements.Size(); ++i)
+    {
+        if (offsetElements[i].semantic_ == SEM_POSITION && offsetElements[i].index_ == 0 && !position)
+            position = &offsetElements[i];
+        else if (offsetElements[i].semantic_ == SEM_TEXCOORD && offsetElements[i].index_ == 0 && !texCoord)
+            texCoord = &offsetElements[i];
+    }
+
+    rawElements.Clear();
+    rawElements.Push(VertexElement(TYPE_VECTOR3, SEM_POSITION));
+    if (texCoord)
+        rawElements.Push(VertexElement(TYPE_VECTOR2, SEM_TEXCOORD));
+    VertexBuffer::UpdateOffsets(rawElements);
+
+    unsigned vertexSize = VertexBuffer::GetVertexSize(elements);
+    unsigned rawVertexSize = VertexBuffer::GetVertexSize(rawElements);
+    SharedArrayPtr<unsigned char> rawData(new unsigned char[vertexCount * rawVertexSize]);
+    for (unsigned i = 0; i < vertexCount; ++i)
+    {
+        const unsigned char* src = data + i * vertexSize;
+        unsigned char* dest = rawData.Get() + i * rawVertexSize;
+
+        Vector4 value = VertexBuffer::ReadElement(src + position->offset_, position->type_);
+        *reinterpret_cast<Vector3*>(dest) = offset + Vector3(value.x_, value.y_, value.z_) * scale;
+        if (texCoord)
+        {
+            value = VertexBuffer::ReadElement(src + texCoord->offset_, texCoord->type_);
+            *reinterpret_cast<Vector2*>(dest + sizeof(Vector3)) = Vector2(value.x_, value.y_);
+        }
+    }
+
+    return rawData;
+}
+
 Model::Model(Context* context) :
     ResourceWithMetadata(context)
 {
@@ -120,6 +174,12 @@ bool Model::BeginLoad(Deserializer& source)
                 auto type = (VertexElementType)(elementDesc & 0xffu);
                 auto semantic = (VertexElementSemantic)((elementDesc >> 8u) & 0xffu);
                 auto index = (unsigned char)((elementDesc >> 16u) & 0xffu);
+                if (type >= MAX_VERTEX_ELEMENT_TYPES)
+                {
+                    URHO3D_LOGERROR("Unsupported vertex element type in " + source.GetName());
+                    loadVBData_.Clear();
+                    return false;
+                }
                 desc.vertexElements_.Push(VertexElement(type, semantic, index));
             }
         }
@@ -148,6 +208,21 @@ bool Model::BeginLoad(Deserializer& source)
             buffer->Unlock();
         }
 
+        // Quantized positions are followed by their transform. Decode them for raycasts, occlusion, physics etc.
+        desc.positionOffset_ = Vector3::ZERO;
+        desc.positionScale_ = 1.0f;
+        desc.rawData_.Reset();
+        desc.rawElements_.Clear();
+        if (HasQuantizedPositions(desc.vertexElements_))
+        {
+            desc.positionOffset_ = source.ReadVector3();
+            desc.positionScale_ = source.ReadFloat();
+            buffer->SetPositionTransform(desc.positionOffset_, desc.positionScale_);
+            desc.rawData_ = DecodeRawVertexData(async ? desc.data_.Get() : buffer->GetShadowData(), desc.vertexCount_,
+                desc.vertexElements_, desc.positionOffset_, desc.positionScale_, desc.rawElements_);
+            memoryUse += desc.vertexCount_ * VertexBuffer::GetVertexSize(desc.rawElements_);
+        }
+
         memoryUse += sizeof(VertexBuffer) + desc.vertexCount_ * vertexSize;
         vertexBuffers_.Push(buffer);
     }
@@ -307,6 +382,28 @@ bool Model::BeginLoad(Deserializer& source)
         geometryCenters_.Push(Vector3::ZERO);
     memoryUse += sizeof(Vector3) * geometries_.Size();
 
+    // Read geometry clusters, if any
+    if (!source.IsEof())
+    {
+        for (unsigned i = 0; i < geometries_.Size(); ++i)
+        {
+            for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+            {
+                PODVector<GeometryCluster> clusters(source.ReadUInt());
+                for (unsigned k = 0; k < clusters.Size(); ++k)
+                {
+                    clusters[k].indexStart_ = source.ReadUInt();
+                    clusters[k].indexCount_ = source.ReadUInt();
+                    clusters[k].boundingBox_ = source.ReadBoundingBox();
+                    clusters[k].coneAxis_ = source.ReadVector3();
+                    clusters[k].coneCutoff_ = source.ReadFloat();
+                }
+                geometries_[i][j]->SetClusters(clusters);
+                memoryUse += clusters.Size() * sizeof(GeometryCluster);
+            }
+        }
+    }
+
     // Read metadata
     auto* cache = GetSubsystem<ResourceCache>();
     String xmlName = ReplaceExtension(GetName(), ".xml");
@@ -356,6 +453,9 @@ bool Model::EndLoad()
             geometry->SetVertexBuffer(0, vertexBuffers_[desc.vbRef_]);
             geometry->SetIndexBuffer(indexBuffers_[desc.ibRef_]);
             geometry->SetDrawRange(desc.type_, desc.indexStart_, desc.indexCount_);
+            const VertexBufferDesc& vbDesc = loadVBData_[desc.vbRef_];
+            if (vbDesc.rawData_)
+                geometry->SetRawVertexData(vbDesc.rawData_, vbDesc.rawElements_);
         }
     }
 
@@ -389,6 +489,11 @@ bool Model::Save(Serializer& dest) const
         dest.WriteUInt(morphRangeStarts_[i]);
         dest.WriteUInt(morphRangeCounts_[i]);
         dest.Write(buffer->GetShadowData(), buffer->GetVertexCount() * buffer->GetVertexSize());
+        if (HasQuantizedPositions(elements))
+        {
+            dest.WriteVector3(buffer->GetPositionOffset());
+            dest.WriteFloat(buffer->GetPositionScale());
+        }
     }
     // Write index buffers
     dest.WriteUInt(indexBuffers_.Size());
@@ -461,6 +566,33 @@ bool Model::Save(Serializer& dest) const
     for (unsigned i = 0; i < geometryCenters_.Size(); ++i)
         dest.WriteVector3(geometryCenters_[i]);
 
+    // Write geometry clusters, if any
+    bool hasClusters = false;
+    for (unsigned i = 0; i < geometries_.Size() && !hasClusters; ++i)
+    {
+        for (unsigned j = 0; j < geometries_[i].Size() && !hasClusters; ++j)
+            hasClusters = !geometries_[i][j]->GetClusters().Empty();
+    }
+    if (hasClusters)
+    {
+        for (unsigned i = 0; i < geometries_.Size(); ++i)
+        {
+            for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+            {
+                const PODVector<GeometryCluster>& clusters = geometries_[i][j]->GetClusters();
+                dest.WriteUInt(clusters.Size());
+                for (unsigned k = 0; k < clusters.Size(); ++k)
+                {
+                    dest.WriteUInt(clusters[k].indexStart_);
+                    dest.WriteUInt(clusters[k].indexCount_);
+                    dest.WriteBoundingBox(clusters[k].boundingBox_);
+                    dest.WriteVector3(clusters[k].coneAxis_);
+                    dest.WriteFloat(clusters[k].coneCutoff_);
+                }
+            }
+        }
+    }
+
     // Write metadata
     if (HasMetadata())
     {
@@ -614,6 +746,230 @@ void Model::SetMorphs(const Vector<ModelMorph>& morphs)
     morphs_ = morphs;
 }
 
+bool Model::GenerateLodLevels(const PODVector<float>& triangleRatios, const PODVector<float>& lodDistances, float maxError)
+{
+    URHO3D_PROFILE("GenerateModelLodLevels");
+
+    if (triangleRatios.Size() != lodDistances.Size())
+    {
+        URHO3D_LOGERROR("LOD triangle ratio and distance counts do not match");
+        return false;
+    }
+
+    unsigned memoryUse = GetMemoryUse();
+
+    for (unsigned i = 0; i < geometries_.Size(); ++i)
+    {
+        Geometry* geometry = geometries_[i].Size() ? geometries_[i][0].Get() : nullptr;
+        if (!geometry)
+            continue;
+
+        // Read positions from the raw data, which has them decoded to floats if they are quantized
+        SharedArrayPtr<unsigned char> rawVertexData;
+        SharedArrayPtr<unsigned char> rawIndexData;
+        unsigned vertexSize;
+        unsigned rawIndexSize;
+        const PODVector<VertexElement>* elements;
+        geometry->GetRawDataShared(rawVertexData, vertexSize, rawIndexData, rawIndexSize, elements);
+        unsigned positionOffset = elements ? VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) : M_MAX_UNSIGNED;
+        IndexBuffer* indexBuffer = geometry->GetIndexBuffer();
+        if (geometry->GetPrimitiveType() != TRIANGLE_LIST || !rawVertexData || positionOffset == M_MAX_UNSIGNED || !indexBuffer ||
+            !indexBuffer->GetShadowData())
+        {
+            URHO3D_LOGWARNING("Can not generate LOD levels for geometry " + String(i) + " of model " + GetName());
+            continue;
+        }
+
+        // Simplify indices relative to the used vertex range
+        unsigned indexStart = geometry->GetIndexStart();
+        unsigned indexCount = geometry->GetIndexCount();
+        if (!indexCount)
+            continue;
+        PODVector<unsigned> indices(indexCount);
+        const unsigned char* indexData = indexBuffer->GetShadowData();
+        for (unsigned j = 0; j < indexCount; ++j)
+        {
+            if (indexBuffer->GetIndexSize() == sizeof(unsigned))
+                indices[j] = reinterpret_cast<const unsigned*>(indexData)[indexStart + j];
+            else
+                indices[j] = reinterpret_cast<const unsigned short*>(indexData)[indexStart + j];
+        }
+
+        unsigned minVertex = M_MAX_UNSIGNED;
+        unsigned maxVertex = 0;
+        for (unsigned j = 0; j < indexCount; ++j)
+        {
+            minVertex = Min(minVertex, indices[j]);
+            maxVertex = Max(maxVertex, indices[j]);
+        }
+        for (unsigned j = 0; j < indexCount; ++j)
+            indices[j] -= minVertex;
+
+        unsigned vertexCount = maxVertex - minVertex + 1;
+        const unsigned char* vertexData = rawVertexData.Get() + minVertex * vertexSize;
+
+        // Simplify each level from the highest detail level, as the quadrics of the original surface give the best result
+        PODVector<unsigned> simplified(indexCount);
+        PODVector<unsigned> lodIndices;
+        PODVector<unsigned> levelStarts;
+        PODVector<unsigned> levelCounts;
+        PODVector<float> levelDistances;
+        unsigned lastCount = indexCount;
+        for (unsigned j = 0; j < triangleRatios.Size(); ++j)
+        {
+            unsigned targetCount = (unsigned)(indexCount / 3 * Clamp(triangleRatios[j], 0.0f, 1.0f)) * 3;
+            unsigned count = SimplifyMesh(&simplified[0], &indices[0], indexCount, vertexData, vertexSize, positionOffset,
+                vertexCount, targetCount, maxError);
+            if (!count || count >= lastCount)
+                break;
+
+            OptimizeVertexCache(&simplified[0], count, vertexCount);
+            levelStarts.Push(lodIndices.Size());
+            levelCounts.Push(count);
+            levelDistances.Push(lodDistances[j]);
+            for (unsigned k = 0; k < count; ++k)
+                lodIndices.Push(simplified[k] + minVertex);
+            lastCount = count;
+        }
+
+        geometries_[i].Resize(levelCounts.Size() + 1);
+        if (levelCounts.Empty())
+            continue;
+
+        SharedPtr<IndexBuffer> lodBuffer(new IndexBuffer(context_));
+        bool largeIndices = maxVertex > 65535;
+        lodBuffer->SetShadowed(true);
+        lodBuffer->SetSize(lodIndices.Size(), largeIndices);
+        if (largeIndices)
+            lodBuffer->SetData(&lodIndices[0]);
+        else
+        {
+            PODVector<unsigned short> shortIndices(lodIndices.Size());
+            for (unsigned j = 0; j < lodIndices.Size(); ++j)
+                shortIndices[j] = (unsigned short)lodIndices[j];
+            lodBuffer->SetData(&shortIndices[0]);
+        }
+        indexBuffers_.Push(lodBuffer);
+        memoryUse += lodIndices.Size() * lodBuffer->GetIndexSize() + (unsigned)sizeof(Geometry) * levelCounts.Size();
+
+        for (unsigned j = 0; j < levelCounts.Size(); ++j)
+        {
+            SharedPtr<Geometry> lodGeometry(new Geometry(context_));
+            lodGeometry->SetNumVertexBuffers(geometry->GetNumVertexBuffers());
+            for (unsigned k = 0; k < geometry->GetNumVertexBuffers(); ++k)
+                lodGeometry->SetVertexBuffer(k, geometry->GetVertexBuffer(k));
+            lodGeometry->SetIndexBuffer(lodBuffer);
+            lodGeometry->SetDrawRange(TRIANGLE_LIST, levelStarts[j], levelCounts[j]);
+            if (!geometry->GetVertexBuffer(0) || rawVertexData.Get() != geometry->GetVertexBuffer(0)->GetShadowData())
+                lodGeometry->SetRawVertexData(rawVertexData, *elements);
+            lodGeometry->SetLodDistance(levelDistances[j]);
+            geometries_[i][j + 1] = lodGeometry;
+        }
+    }
+
+    // Drop index buffers that only the replaced levels used
+    for (unsigned i = indexBuffers_.Size() - 1; i < indexBuffers_.Size(); --i)
+    {
+        bool used = false;
+        for (unsigned j = 0; j < geometries_.Size() && !used; ++j)
+        {
+            for (unsigned k = 0; k < geometries_[j].Size() && !used; ++k)
+                used = geometries_[j][k] && geometries_[j][k]->GetIndexBuffer() == indexBuffers_[i];
+        }
+        if (!used)
+            indexBuffers_.Erase(i);
+    }
+
+    SetMemoryUse(memoryUse);
+    return true;
+}
+
+bool Model::GenerateClusters(unsigned maxTriangles, unsigned minTriangles)
+{
+    URHO3D_PROFILE("GenerateModelClusters");
+
+    unsigned memoryUse = GetMemoryUse();
+
+    for (unsigned i = 0; i < geometries_.Size(); ++i)
+    {
+        for (unsigned j = 0; j < geometries_[i].Size(); ++j)
+        {
+            Geometry* geometry = geometries_[i][j];
+            if (!geometry || geometry->GetPrimitiveType() != TRIANGLE_LIST || geometry->GetIndexCount() / 3 < minTriangles)
+                continue;
+            unsigned indexStart = geometry->GetIndexStart();
+            unsigned indexCount = geometry->GetIndexCount();
+
+            // Do not reorder an index range already clustered for another geometry
+            bool shared = false;
+            for (unsigned k = 0; k <= i && !shared; ++k)
+            {
+                for (unsigned l = 0; l < geometries_[k].Size() && (k < i || l < j) && !shared; ++l)
+                {
+                    Geometry* other = geometries_[k][l];
+                    if (other && other->GetIndexBuffer() == geometry->GetIndexBuffer() && other->GetIndexStart() == indexStart &&
+                        other->GetIndexCount() == indexCount)
+                    {
+                        geometry->SetClusters(other->GetClusters());
+                        shared = true;
+                    }
+                }
+            }
+            if (shared)
+                continue;
+
+            // Read positions from the raw data, which has them decoded to floats if they are quantized
+            const unsigned char* vertexData;
+            const unsigned char* rawIndexData;
+            unsigned vertexSize;
+            unsigned rawIndexSize;
+            const PODVector<VertexElement>* elements;
+            geometry->GetRawData(vertexData, vertexSize, rawIndexData, rawIndexSize, elements);
+            unsigned positionOffset = elements ? VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) : M_MAX_UNSIGNED;
+            IndexBuffer* indexBuffer = geometry->GetIndexBuffer();
+            if (!vertexData || positionOffset == M_MAX_UNSIGNED || !indexBuffer || !indexBuffer->GetShadowData())
+            {
+                URHO3D_LOGWARNING("Can not generate clusters for geometry " + String(i) + " of model " + GetName());
+                continue;
+            }
+
+            PODVector<unsigned> indices(indexCount);
+            const unsigned char* indexData = indexBuffer->GetShadowData();
+            bool largeIndices = indexBuffer->GetIndexSize() == sizeof(unsigned);
+            unsigned vertexCount = 0;
+            for (unsigned k = 0; k < indexCount; ++k)
+            {
+                if (largeIndices)
+                    indices[k] = reinterpret_cast<const unsigned*>(indexData)[indexStart + k];
+                else
+                    indices[k] = reinterpret_cast<const unsigned short*>(indexData)[indexStart + k];
+                vertexCount = Max(vertexCount, indices[k] + 1);
+            }
+
+            PODVector<GeometryCluster> clusters;
+            BuildMeshClusters(clusters, &indices[0], indexCount, vertexData, vertexSize, positionOffset, vertexCount, maxTriangles);
+            for (unsigned k = 0; k < clusters.Size(); ++k)
+                clusters[k].indexStart_ += indexStart;
+
+            if (largeIndices)
+                indexBuffer->SetDataRange(&indices[0], indexStart, indexCount);
+            else
+            {
+                PODVector<unsigned short> shortIndices(indexCount);
+                for (unsigned k = 0; k < indexCount; ++k)
+                    shortIndices[k] = (unsigned short)indices[k];
+                indexBuffer->SetDataRange(&shortIndices[0], indexStart, indexCount);
+            }
+
+            memoryUse += (clusters.Size() - geometry->GetClusters().Size()) * sizeof(GeometryCluster);
+            geometry->SetClusters(clusters);
+        }
+    }
+
+    SetMemoryUse(memoryUse);
+    return true;
+}
+
 SharedPtr<Model> Model::Clone(const String& cloneName) const
 {
     SharedPtr<Model> ret(context_->CreateObject<Model>());
@@ -637,8 +993,9 @@ SharedPtr<Model> Model::Clone(const String& cloneName) const
         if (origBuffer)
         {
             cloneBuffer = context_->CreateObject<VertexBuffer>();
-            cloneBuffer->SetSize(origBuffer->GetVertexCount(), origBuffer->GetElementMask(), origBuffer->IsDynamic());
+            cloneBuffer->SetSize(origBuffer->GetVertexCount(), origBuffer->GetElements(), origBuffer->IsDynamic());
             cloneBuffer->SetShadowed(origBuffer->IsShadowed());
+            cloneBuffer->SetPositionTransform(origBuffer->GetPositionOffset(), origBuffer->GetPositionScale());
             if (origBuffer->IsShadowed())
                 cloneBuffer->SetData(origBuffer->GetShadowData());
             else
@@ -705,6 +1062,17 @@ SharedPtr<Model> Model::Clone(const String& cloneName) const
                 cloneGeometry->SetDrawRange(origGeometry->GetPrimitiveType(), origGeometry->GetIndexStart(),
                     origGeometry->GetIndexCount(), origGeometry->GetVertexStart(), origGeometry->GetVertexCount(), false);
                 cloneGeometry->SetLodDistance(origGeometry->GetLodDistance());
+                cloneGeometry->SetClusters(origGeometry->GetClusters());
+
+                // Share the decoded positions of quantized geometry, as they are not modified
+                SharedArrayPtr<unsigned char> rawVertexData;
+                SharedArrayPtr<unsigned char> rawIndexData;
+                unsigned rawVertexSize;
+                unsigned rawIndexSize;
+                const PODVector<VertexElement>* rawElements;
+                origGeometry->GetRawDataShared(rawVertexData, rawVertexSize, rawIndexData, rawIndexSize, rawElements);
+                if (rawVertexData && numVbs && rawVertexData.Get() != origGeometry->GetVertexBuffer(0)->GetShadowData())
+                    cloneGeometry->SetRawVertexData(rawVertexData, *rawElements);
             }
 
             ret->geometries_[i][j] = cloneGeometry;
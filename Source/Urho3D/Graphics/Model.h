@@ -86,6 +86,14 @@ struct VertexBufferDesc
     unsigned dataSize_;
     /// Vertex data.
     SharedArrayPtr<unsigned char> data_;
+    /// Offset of quantized positions.
+    Vector3 positionOffset_;
+    /// Scale of quantized positions.
+    float positionScale_;
+    /// Positions and first texture coordinates decoded to floats for CPU-side operations, if positions are quantized.
+    SharedArrayPtr<unsigned char> rawData_;
+    /// Vertex declaration of the decoded data.
+    PODVector<VertexElement> rawElements_;
 };
 
 /// Description of index buffer data for asynchronous loading.
@@ -157,6 +165,10 @@ public:
     void SetGeometryBoneMappings(const Vector<PODVector<unsigned> >& geometryBoneMappings);
     /// Set vertex morphs.
     void SetMorphs(const Vector<ModelMorph>& morphs);
+    /// Generate LOD levels for all geometries by simplifying their highest detail level, replacing existing lower detail levels. Each ratio is the fraction of triangles to keep on a level and each distance is the LOD distance of the level. Simplification stops early when the error relative to the geometry size would exceed max error, and levels that could not be reduced further are left out. The levels share the vertices of the highest detail level, so skinning and bone mappings apply to them unchanged. Requires triangle lists with a float position in the first vertex buffer. Should be called before assigning the model to drawables. Return true if successful.
+    bool GenerateLodLevels(const PODVector<float>& triangleRatios, const PODVector<float>& lodDistances, float maxError = 1.0f);
+    /// Split the triangle lists of all geometry LOD levels with at least min triangles into clusters of at most max triangles with bounds and normal cones, so that the renderer can cull parts of large geometries. Reorders the triangles in the index buffers. Return true if successful.
+    bool GenerateClusters(unsigned maxTriangles = 128, unsigned minTriangles = 1024);
     /// Clone the model. The geometry data is deep-copied and can be modified in the clone without affecting the original.
     SharedPtr<Model> Clone(const String& cloneName = String::EMPTY) const;
 
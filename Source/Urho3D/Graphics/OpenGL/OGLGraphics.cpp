@@ -155,7 +155,13 @@ static const unsigned glElementTypes[] =
     GL_FLOAT,
     GL_FLOAT,
     GL_UNSIGNED_BYTE,
-    GL_UNSIGNED_BYTE
+    GL_UNSIGNED_BYTE,
+    GL_SHORT,
+#if defined(GL_ES_VERSION_2_0) && !defined(GL_ES_VERSION_3_0)
+    GL_HALF_FLOAT_OES
+#else
+    GL_HALF_FLOAT
+#endif
 };
 
 static const unsigned glElementComponents[] =
@@ -166,7 +172,9 @@ static const unsigned glElementComponents[] =
     3,
     4,
     4,
-    4
+    4,
+    4,
+    2
 };
 
 #ifdef GL_ES_VERSION_2_0
@@ -3180,7 +3188,7 @@ void Graphics::PrepareDraw()
 
                     SetVBO(buffer->GetGPUObjectName());
                     glVertexAttribPointer(location, glElementComponents[element.type_], glElementTypes[element.type_],
-                        element.type_ == TYPE_UBYTE4_NORM ? GL_TRUE : GL_FALSE, (unsigned)buffer->GetVertexSize(),
+                        element.type_ == TYPE_UBYTE4_NORM || element.type_ == TYPE_SHORT4_NORM ? GL_TRUE : GL_FALSE, (unsigned)buffer->GetVertexSize(),
                         (const void *)(size_t)dataStart);
                 }
             }
@@ -279,6 +279,11 @@ unsigned Texture::GetExternalFormat(unsigned format)
 #endif
 }
 
+bool Texture::NeedRGBAConversion(unsigned components, bool useAlpha)
+{
+    return Graphics::GetGL3Support() && ((components == 1 && !useAlpha) || components == 2);
+}
+
 unsigned Texture::GetDataType(unsigned format)
 {
 #ifndef GL_ES_VERSION_2_0
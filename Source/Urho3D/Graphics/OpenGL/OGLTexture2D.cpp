@@ -25,6 +25,7 @@
 #include "../../Core/Context.h"
 #include "../../Core/Profiler.h"
 #include "../../Core/Macros.h"
+#include "../../Core/WorkQueue.h"
 #include "../../Graphics/Graphics.h"
 #include "../../Graphics/GraphicsEvents.h"
 #include "../../Graphics/GraphicsImpl.h"
@@ -187,7 +188,7 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
     {
         // Convert unsuitable formats to RGBA
         unsigned components = image->GetComponents();
-        if (Graphics::GetGL3Support() && ((components == 1 && !useAlpha) || components == 2))
+        if (NeedRGBAConversion(components, useAlpha))
         {
             mipImage = image->ConvertToRGBA(); image = mipImage;
             if (!image)
@@ -201,7 +202,8 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
         unsigned format = 0;
 
         // Discard unnecessary mip levels
-        for (unsigned i = 0; i < mipsToSkip_[quality]; ++i)
+        const unsigned mipsToSkip = GetLoadMipsToSkip(quality, GetLoadLevels(image));
+        for (unsigned i = 0; i < mipsToSkip; ++i)
         {
             mipImage = image->GetNextLevel(); image = mipImage;
             levelData = image->GetData();
@@ -268,9 +270,7 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
             needDecompress = true;
         }
 
-        unsigned mipsToSkip = 0;
-        if (quality < URHO3D_ARRAYSIZE(mipsToSkip_))
-            mipsToSkip = mipsToSkip_[quality];
+        unsigned mipsToSkip = GetLoadMipsToSkip(quality, levels);
         if (mipsToSkip >= levels)
             mipsToSkip = levels - 1;
         while (mipsToSkip && (width / (1u << mipsToSkip) < 4 || height / (1u << mipsToSkip) < 4))
@@ -293,7 +293,7 @@ bool Texture2D::SetData(Image* image, bool useAlpha)
             else
             {
                 auto* rgbaData = new unsigned char[level.width_ * level.height_ * 4];
-                level.Decompress(rgbaData);
+                level.Decompress(rgbaData, GetSubsystem<WorkQueue>());
                 SetData(i, 0, 0, level.width_, level.height_, rgbaData);
                 memoryUse += level.width_ * level.height_ * 4;
                 delete[] rgbaData;
@@ -524,6 +524,11 @@ void Renderer::SetThreadedOcclusion(bool enable)
     }
 }
 
+void Renderer::SetClusterCulling(bool enable)
+{
+    clusterCulling_ = enable;
+}
+
 void Renderer::ReloadShaders()
 {
     shadersDirty_ = true;
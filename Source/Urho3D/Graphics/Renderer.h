@@ -238,6 +238,8 @@ public:
     void SetOccluderSizeThreshold(float screenSize);
     /// Set whether to thread occluder rendering. Default false.
     void SetThreadedOcclusion(bool enable);
+    /// Set culling of the triangle clusters of large static geometries against the view frustum, backfacing and occlusion. Default true.
+    void SetClusterCulling(bool enable);
     /// Set shadow depth bias multiplier for mobile platforms to counteract possible worse shadow map precision. Default 1.0 (no effect.)
     void SetMobileShadowBiasMul(float mul);
     /// Set shadow depth bias addition for mobile platforms to counteract possible worse shadow map precision. Default 0.0 (no effect.)
@@ -328,6 +330,9 @@ public:
     /// Return whether occlusion rendering is threaded.
     bool GetThreadedOcclusion() const { return threadedOcclusion_; }
 
+    /// Return whether triangle clusters are culled.
+    bool GetClusterCulling() const { return clusterCulling_; }
+
     /// Return shadow depth bias multiplier for mobile platforms.
     float GetMobileShadowBiasMul() const { return mobileShadowBiasMul_; }
 
@@ -594,6 +599,8 @@ private:
     int numExtraInstancingBufferElements_{};
     /// Threaded occlusion rendering flag.
     bool threadedOcclusion_{};
+    /// Cluster culling flag.
+    bool clusterCulling_{true};
     /// Shaders need reloading flag.
     bool shadersDirty_{true};
     /// Initialized flag.
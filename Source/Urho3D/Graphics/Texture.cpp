@@ -27,6 +27,7 @@
 #include "../Graphics/Material.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../Resource/Image.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/XMLFile.h"
 
@@ -126,6 +127,17 @@ int Texture::GetMipsToSkip(MaterialQuality quality) const
     return (quality >= QUALITY_LOW && quality < MAX_TEXTURE_QUALITY_LEVELS) ? mipsToSkip_[quality] : 0;
 }
 
+unsigned Texture::GetLoadLevels(Image* image) const
+{
+    if (!image)
+        return 0;
+    if (image->IsCompressed())
+        return image->GetNumCompressedLevels();
+
+    // SetData() resets the requested levels of a previously compressed texture, as they were taken from the image
+    return CheckMaxLevels(image->GetWidth(), image->GetHeight(), IsCompressed() && requestedLevels_ > 1 ? 0 : requestedLevels_);
+}
+
 int Texture::GetLevelWidth(unsigned level) const
 {
     if (level > levels_)
@@ -223,6 +235,9 @@ void Texture::SetParameters(const XMLElement& element)
 
         if (name == "srgb")
             SetSRGB(paramElem.GetBool("enable"));
+
+        if (name == "streaming")
+            SetStreaming(paramElem.GetBool("enable"));
     }
 }
 
@@ -270,6 +285,30 @@ unsigned Texture::CheckMaxLevels(int width, int height, int depth, unsigned requ
         return requestedLevels;
 }
 
+SharedPtr<Image> Texture::GetUploadImage(Graphics* graphics, Image* image, bool useAlpha)
+{
+    // Multi-image data is converted by SetData() as before
+    if (!graphics || !image || image->GetDepth() > 1 || image->GetNextSibling())
+        return SharedPtr<Image>(image);
+
+    if (image->IsCompressed())
+    {
+        if (graphics->GetFormat(image->GetCompressedFormat()))
+            return SharedPtr<Image>(image);
+
+        SharedPtr<Image> decompressed = image->GetDecompressedImage();
+        return decompressed ? decompressed : SharedPtr<Image>(image);
+    }
+
+    if (NeedRGBAConversion(image->GetComponents(), useAlpha))
+    {
+        SharedPtr<Image> converted = image->ConvertToRGBA();
+        return converted ? converted : SharedPtr<Image>(image);
+    }
+
+    return SharedPtr<Image>(image);
+}
+
 void Texture::CheckTextureBudget(StringHash type)
 {
     auto* cache = GetSubsystem<ResourceCache>();
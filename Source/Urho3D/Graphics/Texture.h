@@ -32,6 +32,7 @@ namespace Urho3D
 
 static const int MAX_TEXTURE_QUALITY_LEVELS = 3;
 
+class Image;
 class XMLElement;
 class XMLFile;
 
@@ -68,6 +69,10 @@ public:
     void SetBackupTexture(Texture* texture);
     /// Set mip levels to skip on a quality setting when loading. Ensures higher quality levels do not skip more.
     void SetMipsToSkip(MaterialQuality quality, int toSkip);
+    /// Set mip levels to skip on top of the quality setting, as chosen by texture streaming. Takes effect on the next load.
+    void SetStreamedMipsToSkip(unsigned toSkip) { streamedMipsToSkip_ = toSkip; }
+    /// Set whether texture streaming may drop the top mip levels while they are not needed. Only 2D textures loaded from images are streamed. Takes effect on the next load.
+    void SetStreaming(bool enable) { streaming_ = enable; }
 
     /// Return API-specific texture format.
     unsigned GetFormat() const { return format_; }
@@ -122,6 +127,12 @@ public:
 
     /// Return mip levels to skip on a quality setting when loading.
     int GetMipsToSkip(MaterialQuality quality) const;
+    /// Return mip levels to skip chosen by texture streaming.
+    unsigned GetStreamedMipsToSkip() const { return streamedMipsToSkip_; }
+    /// Return whether texture streaming may drop the top mip levels.
+    bool GetStreaming() const { return streaming_; }
+    /// Return number of mip levels the texture has when loaded from an image at full resolution.
+    unsigned GetLoadLevels(Image* image) const;
     /// Return mip level width, or 0 if level does not exist.
     int GetLevelWidth(unsigned level) const;
     /// Return mip level width, or 0 if level does not exist.
@@ -188,6 +199,10 @@ public:
     static unsigned GetExternalFormat(unsigned format);
     /// Return the data type corresponding to an OpenGL internal format.
     static unsigned GetDataType(unsigned format);
+    /// Return whether an uncompressed image with the given number of components must be converted to RGBA before the rendering API can use it.
+    static bool NeedRGBAConversion(unsigned components, bool useAlpha);
+    /// Return an image that SetData() can upload without conversion: formats the rendering API can not use are converted to RGBA, and compressed formats the GPU does not support are decompressed with their mip levels. Returns the image itself if already suitable. Only queries the graphics capabilities, so it may be called from a worker thread.
+    static SharedPtr<Image> GetUploadImage(Graphics* graphics, Image* image, bool useAlpha = false);
 
     using GPUObject::GetGraphics;
 protected:
@@ -195,6 +210,8 @@ protected:
     void CheckTextureBudget(StringHash type);
     /// Create the GPU texture. Implemented in subclasses.
     virtual bool Create() { return true; }
+    /// Return mip levels to skip when loading, combining the quality setting and texture streaming. Streaming never skips past the last of the texture's mip levels.
+    unsigned GetLoadMipsToSkip(MaterialQuality quality, unsigned levels) const { return Max((unsigned)GetMipsToSkip(quality), Min(streamedMipsToSkip_, levels ? levels - 1 : 0)); }
 
     /// OpenGL target.
     unsigned target_{};
@@ -230,6 +247,10 @@ protected:
     unsigned anisotropy_{};
     /// Mip levels to skip when loading per texture quality setting.
     unsigned mipsToSkip_[MAX_TEXTURE_QUALITY_LEVELS]{2, 1, 0};
+    /// Mip levels to skip when loading as chosen by texture streaming.
+    unsigned streamedMipsToSkip_{};
+    /// Texture streaming allowed flag.
+    bool streaming_{};
     /// Border color.
     Color borderColor_;
     /// Multisampling level.
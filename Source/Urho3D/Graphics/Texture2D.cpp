@@ -29,6 +29,7 @@
 #include "../Graphics/GraphicsImpl.h"
 #include "../Graphics/Renderer.h"
 #include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
@@ -72,22 +73,40 @@ bool Texture2D::BeginLoad(Deserializer& source)
     }
 
     // Load the image data for EndLoad()
-    loadImage_ = context_->CreateObject<Image>();
-    if (!loadImage_->Load(source))
     {
-        loadImage_.Reset();
-        return false;
+        URHO3D_PROFILE("DecodeTexture");
+        loadImage_ = context_->CreateObject<Image>();
+        if (!loadImage_->Load(source))
+        {
+            loadImage_.Reset();
+            return false;
+        }
     }
 
-    // Precalculate mip levels if async loading
-    if (GetAsyncLoadState() == ASYNC_LOADING)
-        loadImage_->PrecalculateLevels();
-
     // Load the optional parameters file
     auto* cache = GetSubsystem<ResourceCache>();
     String xmlName = ReplaceExtension(GetName(), ".xml");
     loadParameters_ = cache->GetTempResource<XMLFile>(xmlName, false);
 
+    // Mip levels of sRGB textures are averaged in linear space, so pass the setting to the image before they are calculated
+    if (loadParameters_)
+    {
+        XMLElement srgbElem = loadParameters_->GetRoot().GetChild("srgb");
+        if (srgbElem)
+            loadImage_->SetSRGB(srgbElem.GetBool("enable"));
+    }
+
+    // Convert or decompress now so that EndLoad() only uploads. Decompressed images already have their mip levels
+    {
+        URHO3D_PROFILE("ConvertTexture");
+        bool wasCompressed = loadImage_->IsCompressed();
+        loadImage_ = GetUploadImage(graphics_, loadImage_);
+
+        // Precalculate mip levels if async loading
+        if (!wasCompressed && GetAsyncLoadState() == ASYNC_LOADING)
+            loadImage_->PrecalculateLevels();
+    }
+
     return true;
 }
 
@@ -101,7 +120,17 @@ bool Texture2D::EndLoad()
     CheckTextureBudget(GetTypeStatic());
 
     SetParameters(loadParameters_);
-    bool success = SetData(loadImage_);
+
+    // Let texture streaming decide how many of the top mip levels to upload initially
+    auto* textureStreaming = GetSubsystem<TextureStreaming>();
+    if (textureStreaming)
+        textureStreaming->RegisterTexture(this, loadImage_);
+
+    bool success;
+    {
+        URHO3D_PROFILE("UploadTexture");
+        success = SetData(loadImage_);
+    }
 
     loadImage_.Reset();
     loadParameters_.Reset();
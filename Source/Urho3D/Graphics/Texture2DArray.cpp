@@ -109,12 +109,16 @@ bool Texture2DArray::BeginLoad(Deserializer& source)
         layerElem = layerElem.GetNext("layer");
     }
 
-    // Precalculate mip levels if async loading
-    if (GetAsyncLoadState() == ASYNC_LOADING)
+    // Convert or decompress now so that EndLoad() only uploads, and precalculate mip levels if async loading
     {
+        URHO3D_PROFILE("ConvertTexture");
         for (unsigned i = 0; i < loadImages_.Size(); ++i)
         {
-            if (loadImages_[i])
+            if (!loadImages_[i])
+                continue;
+            bool wasCompressed = loadImages_[i]->IsCompressed();
+            loadImages_[i] = GetUploadImage(graphics_, loadImages_[i]);
+            if (!wasCompressed && GetAsyncLoadState() == ASYNC_LOADING)
                 loadImages_[i]->PrecalculateLevels();
         }
     }
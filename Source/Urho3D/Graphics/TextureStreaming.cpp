@@ -0,0 +1,419 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Container/Sort.h"
+#include "../Core/CoreEvents.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../Core/WorkQueue.h"
+#include "../Graphics/Camera.h"
+#include "../Graphics/Graphics.h"
+#include "../Graphics/Material.h"
+#include "../Graphics/Renderer.h"
+#include "../Graphics/Texture2D.h"
+#include "../Graphics/TextureStreaming.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../Resource/Image.h"
+#include "../Resource/ResourceCache.h"
+
+#include <algorithm>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+unsigned long long TextureStreamingEntry::GetMemoryUse(unsigned mipLevel) const
+{
+    unsigned long long memoryUse = 0;
+    for (unsigned i = mipLevel; i < levels_; ++i)
+        memoryUse += Max(topLevelMemory_ >> (2 * i), 1ULL);
+    return memoryUse;
+}
+
+TextureStreaming::TextureStreaming(Context* context) :
+    Object(context)
+{
+    SubscribeToEvent(E_ENDFRAME, URHO3D_HANDLER(TextureStreaming, HandleEndFrame));
+}
+
+TextureStreaming::~TextureStreaming() = default;
+
+void TextureStreaming::SetEnabled(bool enable)
+{
+    if (enable == enabled_)
+        return;
+
+    enabled_ = enable;
+
+    // When disabled, bring all streamed textures back to full resolution and stop tracking them
+    if (!enabled_)
+    {
+        auto* cache = GetSubsystem<ResourceCache>();
+        for (auto i = entries_.Begin(); i != entries_.End(); ++i)
+        {
+            Texture2D* texture = i->second_.texture_;
+            if (!texture || !texture->GetStreamedMipsToSkip())
+                continue;
+
+            texture->SetStreamedMipsToSkip(0);
+            SharedPtr<Image> image = cache->GetTempResource<Image>(texture->GetName());
+            if (image)
+                texture->SetData(image);
+        }
+
+        entries_.Clear();
+        numPendingLoads_ = 0;
+    }
+}
+
+const TextureStreamingEntry* TextureStreaming::GetEntry(Texture2D* texture) const
+{
+    auto i = entries_.Find(texture);
+    return i != entries_.End() ? &i->second_ : nullptr;
+}
+
+bool TextureStreaming::RegisterTexture(Texture2D* texture, int width, int height, unsigned levels, unsigned long long topLevelMemory,
+    bool compressed)
+{
+    if (!texture)
+        return false;
+
+    // Textures without enough levels to drop gain nothing from streaming
+    if (width <= 0 || height <= 0 || levels <= Max(minResidentLevels_, 1U))
+    {
+        UnregisterTexture(texture);
+        return false;
+    }
+
+    TextureStreamingEntry& entry = entries_[texture];
+    if (entry.load_)
+    {
+        // A reload supersedes the load in flight; let the worker finish but ignore the result
+        entry.load_.Reset();
+        --numPendingLoads_;
+    }
+
+    entry.texture_ = texture;
+    entry.width_ = width;
+    entry.height_ = height;
+    entry.levels_ = levels;
+    entry.topLevelMemory_ = topLevelMemory;
+
+    const Variant& uvDensity = texture->GetMetadata(TEXTURE_STREAMING_UV_DENSITY);
+    entry.uvDensity_ = uvDensity.IsEmpty() ? 1.0f : Max(uvDensity.GetFloat(), M_EPSILON);
+
+    // Limit the levels the same way SetData() does: never skip fewer levels than the quality setting, and never
+    // shrink compressed textures below 4x4 blocks. Otherwise the resident level could never reach the target
+    auto* renderer = GetSubsystem<Renderer>();
+    const MaterialQuality quality = renderer ? renderer->GetTextureQuality() : QUALITY_HIGH;
+    entry.minLevel_ = Min((unsigned)texture->GetMipsToSkip(quality), levels - 1);
+    entry.maxLevel_ = levels - minResidentLevels_;
+    if (compressed)
+    {
+        while (entry.minLevel_ && ((width >> entry.minLevel_) < 4 || (height >> entry.minLevel_) < 4))
+            --entry.minLevel_;
+        while (entry.maxLevel_ && ((width >> entry.maxLevel_) < 4 || (height >> entry.maxLevel_) < 4))
+            --entry.maxLevel_;
+    }
+    entry.maxLevel_ = Max(entry.maxLevel_, entry.minLevel_);
+
+    // Start from full resolution, so that textures no view reports still look right. Unused levels are evicted later
+    entry.residentLevel_ = entry.minLevel_;
+    entry.targetLevel_ = entry.residentLevel_;
+    entry.requiredLevel_ = M_MAX_UNSIGNED;
+    auto* time = GetSubsystem<Time>();
+    entry.lastUsedFrame_ = time ? time->GetFrameNumber() : 0;
+
+    return true;
+}
+
+void TextureStreaming::RegisterTexture(Texture2D* texture, Image* image)
+{
+    if (!texture || !image)
+        return;
+
+    // A reloaded texture starts from full resolution again
+    texture->SetStreamedMipsToSkip(0);
+
+    // Only named static textures that opt in are streamed. Arrays, cubemaps and volumes are not
+    if (!enabled_ || !texture->GetStreaming() || texture->GetName().Empty() || texture->GetUsage() != TEXTURE_STATIC ||
+        image->GetDepth() > 1 || image->GetNextSibling())
+    {
+        UnregisterTexture(texture);
+        return;
+    }
+
+    const unsigned levels = texture->GetLoadLevels(image);
+    unsigned long long topLevelMemory;
+    if (image->IsCompressed())
+        topLevelMemory = levels ? image->GetCompressedLevel(0).dataSize_ : 0;
+    else
+        topLevelMemory = (unsigned long long)image->GetWidth() * image->GetHeight() * Max(image->GetComponents(), 1U);
+
+    RegisterTexture(texture, image->GetWidth(), image->GetHeight(), levels, topLevelMemory, image->IsCompressed());
+}
+
+void TextureStreaming::UnregisterTexture(Texture2D* texture)
+{
+    auto i = entries_.Find(texture);
+    if (i == entries_.End())
+        return;
+
+    if (i->second_.load_)
+        --numPendingLoads_;
+    entries_.Erase(i);
+}
+
+void TextureStreaming::RequestLevel(Texture2D* texture, unsigned mipLevel)
+{
+    auto i = entries_.Find(texture);
+    if (i != entries_.End())
+        i->second_.requiredLevel_ = Min(i->second_.requiredLevel_, mipLevel);
+}
+
+void TextureStreaming::RequestMaterial(Material* material, const Camera* camera, int viewHeight, float worldSize, float distance)
+{
+    if (!material || entries_.Empty())
+        return;
+
+    const float projectedSize = GetProjectedSize(camera, viewHeight, worldSize, distance);
+
+    const HashMap<TextureUnit, SharedPtr<Texture> >& textures = material->GetTextures();
+    for (auto i = textures.Begin(); i != textures.End(); ++i)
+    {
+        Texture* texture = i->second_.Get();
+        if (!texture || texture->GetType() != Texture2D::GetTypeStatic())
+            continue;
+
+        auto j = entries_.Find(static_cast<Texture2D*>(texture));
+        if (j == entries_.End())
+            continue;
+
+        TextureStreamingEntry& entry = j->second_;
+        const unsigned level = GetRequiredLevel(entry.width_, entry.height_, entry.levels_, projectedSize, entry.uvDensity_, mipBias_);
+        entry.requiredLevel_ = Min(entry.requiredLevel_, level);
+    }
+}
+
+void TextureStreaming::UpdateResidency(unsigned frameNumber)
+{
+    URHO3D_PROFILE("UpdateTextureResidency");
+
+    targetMemoryUse_ = 0;
+
+    // Candidates for dropping a level when over budget, as (memory saved, entry) pairs
+    PODVector<Pair<unsigned long long, TextureStreamingEntry*> > candidates;
+
+    for (auto i = entries_.Begin(); i != entries_.End(); ++i)
+    {
+        TextureStreamingEntry& entry = i->second_;
+        const unsigned minLevel = entry.GetMinMipLevel();
+        const unsigned maxLevel = entry.GetMaxMipLevel();
+
+        if (entry.requiredLevel_ != M_MAX_UNSIGNED)
+        {
+            entry.lastUsedFrame_ = frameNumber;
+            entry.targetLevel_ = Clamp(entry.requiredLevel_, minLevel, maxLevel);
+        }
+        else if (frameNumber - entry.lastUsedFrame_ > evictionFrames_)
+            entry.targetLevel_ = maxLevel;
+        else
+            entry.targetLevel_ = Clamp(entry.residentLevel_, minLevel, maxLevel);
+
+        entry.requiredLevel_ = M_MAX_UNSIGNED;
+        targetMemoryUse_ += entry.GetMemoryUse(entry.targetLevel_);
+
+        if (memoryBudget_ && entry.targetLevel_ < maxLevel)
+            candidates.Push(MakePair(entry.GetMemoryUse(entry.targetLevel_) - entry.GetMemoryUse(entry.targetLevel_ + 1), &entry));
+    }
+
+    if (!memoryBudget_ || targetMemoryUse_ <= memoryBudget_)
+        return;
+
+    // Over budget: repeatedly drop the top level that frees the most memory. Large top levels are the least
+    // detail lost per byte, since the view already asked for the level below being at least half as sharp
+    auto compare = [](const Pair<unsigned long long, TextureStreamingEntry*>& lhs,
+        const Pair<unsigned long long, TextureStreamingEntry*>& rhs) { return lhs.first_ < rhs.first_; };
+
+    std::make_heap(candidates.Buffer(), candidates.Buffer() + candidates.Size(), compare);
+    while (targetMemoryUse_ > memoryBudget_ && !candidates.Empty())
+    {
+        std::pop_heap(candidates.Buffer(), candidates.Buffer() + candidates.Size(), compare);
+        Pair<unsigned long long, TextureStreamingEntry*> candidate = candidates.Back();
+        candidates.Pop();
+
+        TextureStreamingEntry& entry = *candidate.second_;
+        targetMemoryUse_ -= candidate.first_;
+        ++entry.targetLevel_;
+
+        if (entry.targetLevel_ < entry.GetMaxMipLevel())
+        {
+            candidates.Push(MakePair(entry.GetMemoryUse(entry.targetLevel_) - entry.GetMemoryUse(entry.targetLevel_ + 1), &entry));
+            std::push_heap(candidates.Buffer(), candidates.Buffer() + candidates.Size(), compare);
+        }
+    }
+}
+
+void TextureStreaming::Update(unsigned frameNumber)
+{
+    if (!enabled_)
+        return;
+
+    URHO3D_PROFILE("UpdateTextureStreaming");
+
+    // Forget textures that have been destroyed
+    for (auto i = entries_.Begin(); i != entries_.End();)
+    {
+        if (i->second_.texture_.Expired())
+        {
+            if (i->second_.load_)
+                --numPendingLoads_;
+            i = entries_.Erase(i);
+        }
+        else
+            ++i;
+    }
+
+    UpdateResidency(frameNumber);
+
+    // Upload finished loads, then issue new ones for textures not at their target level. Textures needing
+    // the most detail first
+    PODVector<Pair<int, TextureStreamingEntry*> > pending;
+    unsigned numUploads = 0;
+
+    for (auto i = entries_.Begin(); i != entries_.End(); ++i)
+    {
+        TextureStreamingEntry& entry = i->second_;
+        if (entry.load_)
+        {
+            if (entry.load_->ready_ && numUploads < maxUploadsPerFrame_)
+            {
+                FinishLoad(entry);
+                ++numUploads;
+            }
+        }
+        else if (entry.targetLevel_ != entry.residentLevel_)
+            pending.Push(MakePair((int)entry.targetLevel_ - (int)entry.residentLevel_, &entry));
+    }
+
+    if (pending.Empty() || numPendingLoads_ >= maxPendingLoads_)
+        return;
+
+    Sort(pending.Begin(), pending.End(), [](const Pair<int, TextureStreamingEntry*>& lhs,
+        const Pair<int, TextureStreamingEntry*>& rhs) { return lhs.first_ < rhs.first_; });
+
+    for (unsigned i = 0; i < pending.Size() && numPendingLoads_ < maxPendingLoads_; ++i)
+        QueueLoad(*pending[i].second_);
+}
+
+float TextureStreaming::GetProjectedSize(const Camera* camera, int viewHeight, float worldSize, float distance)
+{
+    if (!camera)
+        return (float)viewHeight;
+
+    // Half view size is the tangent of half FOV for perspective cameras, and half of the ortho size otherwise
+    const float halfViewSize = camera->GetHalfViewSize();
+    const float viewExtent = 2.0f * halfViewSize * (camera->IsOrthographic() ? 1.0f : Max(distance, M_EPSILON));
+    return worldSize * (float)viewHeight / Max(viewExtent, M_EPSILON);
+}
+
+unsigned TextureStreaming::GetRequiredLevel(int width, int height, unsigned levels, float projectedSize, float uvDensity, float bias)
+{
+    if (!levels)
+        return 0;
+
+    // Texels sampled across the object vs. texels in the texture; every halving of the ratio drops a level
+    const float neededTexels = Max(projectedSize * uvDensity, 1.0f);
+    const float textureSize = (float)Max(width, height);
+    const float level = log2f(textureSize / neededTexels) + bias;
+    if (level <= 0.0f)
+        return 0;
+
+    return Min((unsigned)level, levels - 1);
+}
+
+void TextureStreaming::HandleEndFrame(StringHash eventType, VariantMap& eventData)
+{
+    using namespace EndFrame;
+
+    if (enabled_ && !entries_.Empty())
+        Update(GetSubsystem<Time>()->GetFrameNumber());
+}
+
+void TextureStreaming::QueueLoad(TextureStreamingEntry& entry)
+{
+    Texture2D* texture = entry.texture_;
+    if (!texture)
+        return;
+
+    SharedPtr<TextureStreamingLoad> load(new TextureStreamingLoad());
+    load->name_ = texture->GetName();
+    load->mipLevel_ = entry.targetLevel_;
+    entry.load_ = load;
+    ++numPendingLoads_;
+
+    // Decode and convert on a worker; the upload happens on the main thread once the load reports ready
+    auto* cache = GetSubsystem<ResourceCache>();
+    auto* graphics = GetSubsystem<Graphics>();
+    Context* context = context_;
+    GetSubsystem<WorkQueue>()->AddWorkItem([load, cache, graphics, context]()
+    {
+        SharedPtr<File> file = cache->GetFile(load->name_, false);
+        if (file)
+        {
+            auto image = MakeShared<Image>(context);
+            if (image->Load(*file))
+                load->image_ = Texture::GetUploadImage(graphics, image);
+        }
+        load->ready_ = true;
+    });
+}
+
+bool TextureStreaming::FinishLoad(TextureStreamingEntry& entry)
+{
+    SharedPtr<TextureStreamingLoad> load = entry.load_;
+    entry.load_.Reset();
+    --numPendingLoads_;
+
+    Texture2D* texture = entry.texture_;
+    if (!texture || !load->image_)
+    {
+        URHO3D_LOGWARNING("Failed to stream texture " + load->name_);
+        return false;
+    }
+
+    texture->SetStreamedMipsToSkip(load->mipLevel_);
+    if (!texture->SetData(load->image_))
+        return false;
+
+    // Take the resident level from the uploaded size, in case SetData() clamped the levels to skip
+    entry.residentLevel_ = 0;
+    while (entry.residentLevel_ + 1 < entry.levels_ && Max(entry.width_ >> entry.residentLevel_, 1) > texture->GetWidth())
+        ++entry.residentLevel_;
+    return true;
+}
+
+}
@@ -0,0 +1,191 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Container/Ptr.h"
+#include "../Core/Object.h"
+
+#include <atomic>
+
+namespace Urho3D
+{
+
+class Camera;
+class Image;
+class Material;
+class Texture2D;
+
+/// Metadata key of a texture holding the UV density hint (how many times the texture repeats across an object) for streaming.
+static const char* TEXTURE_STREAMING_UV_DENSITY = "StreamingUVDensity";
+
+/// Pending background load of a streamed texture.
+struct TextureStreamingLoad : public RefCounted
+{
+    /// Resource name of the texture.
+    String name_;
+    /// Mip level the load was issued for.
+    unsigned mipLevel_{};
+    /// Loaded image. Valid when ready.
+    SharedPtr<Image> image_;
+    /// Set by the worker thread when the load has finished, successfully or not.
+    std::atomic<bool> ready_{};
+};
+
+/// Streaming state of a single texture.
+struct URHO3D_API TextureStreamingEntry
+{
+    /// Return memory required to keep the texture resident from a mip level downwards.
+    unsigned long long GetMemoryUse(unsigned mipLevel) const;
+    /// Return the highest quality mip level the texture quality setting allows.
+    unsigned GetMinMipLevel() const { return minLevel_; }
+    /// Return the lowest quality mip level streaming is allowed to drop to.
+    unsigned GetMaxMipLevel() const { return maxLevel_; }
+
+    /// Texture.
+    WeakPtr<Texture2D> texture_;
+    /// Full resolution width.
+    int width_{};
+    /// Full resolution height.
+    int height_{};
+    /// Number of mip levels in the full resolution texture.
+    unsigned levels_{};
+    /// Highest quality mip level allowed by the texture quality setting.
+    unsigned minLevel_{};
+    /// Lowest quality mip level streaming may drop to.
+    unsigned maxLevel_{};
+    /// Memory use of the full resolution top level.
+    unsigned long long topLevelMemory_{};
+    /// UV density hint.
+    float uvDensity_{1.0f};
+    /// Currently resident mip level.
+    unsigned residentLevel_{};
+    /// Mip level required by the views during the current frame.
+    unsigned requiredLevel_{M_MAX_UNSIGNED};
+    /// Mip level chosen to be resident under the memory budget.
+    unsigned targetLevel_{};
+    /// Frame number when the texture was last used by a view.
+    unsigned lastUsedFrame_{};
+    /// Background load in flight.
+    SharedPtr<TextureStreamingLoad> load_;
+};
+
+/// %Texture streaming subsystem. Keeps only the mip levels of 2D textures that the views need resident, under a memory budget. Textures opt in through their parameters.
+class URHO3D_API TextureStreaming : public Object
+{
+    URHO3D_OBJECT(TextureStreaming, Object);
+
+public:
+    /// Construct.
+    explicit TextureStreaming(Context* context);
+    /// Destruct.
+    ~TextureStreaming() override;
+
+    /// Enable or disable streaming. Disabling restores full resolution on all streamed textures.
+    void SetEnabled(bool enable);
+    /// Set memory budget for streamed textures in bytes. Zero means unlimited.
+    void SetMemoryBudget(unsigned long long budget) { memoryBudget_ = budget; }
+    /// Set number of frames a texture may go unused before its high mip levels are evicted.
+    void SetEvictionFrames(unsigned frames) { evictionFrames_ = Max(frames, 1U); }
+    /// Set maximum number of streamed texture uploads per frame.
+    void SetMaxUploadsPerFrame(unsigned uploads) { maxUploadsPerFrame_ = Max(uploads, 1U); }
+    /// Set maximum number of background loads in flight.
+    void SetMaxPendingLoads(unsigned loads) { maxPendingLoads_ = Max(loads, 1U); }
+    /// Set number of smallest mip levels that always stay resident.
+    void SetMinResidentLevels(unsigned levels) { minResidentLevels_ = levels; }
+    /// Set global bias added to the required mip level. Positive values reduce quality.
+    void SetMipBias(float bias) { mipBias_ = bias; }
+
+    /// Return whether streaming is enabled.
+    bool IsEnabled() const { return enabled_; }
+    /// Return memory budget in bytes.
+    unsigned long long GetMemoryBudget() const { return memoryBudget_; }
+    /// Return number of frames before unused mip levels are evicted.
+    unsigned GetEvictionFrames() const { return evictionFrames_; }
+    /// Return maximum number of uploads per frame.
+    unsigned GetMaxUploadsPerFrame() const { return maxUploadsPerFrame_; }
+    /// Return maximum number of background loads in flight.
+    unsigned GetMaxPendingLoads() const { return maxPendingLoads_; }
+    /// Return number of smallest mip levels that always stay resident.
+    unsigned GetMinResidentLevels() const { return minResidentLevels_; }
+    /// Return global mip bias.
+    float GetMipBias() const { return mipBias_; }
+    /// Return memory use of the target residency chosen on the last update.
+    unsigned long long GetTargetMemoryUse() const { return targetMemoryUse_; }
+    /// Return number of streamed textures.
+    unsigned GetNumTextures() const { return entries_.Size(); }
+    /// Return streaming entry of a texture, or null if not streamed.
+    const TextureStreamingEntry* GetEntry(Texture2D* texture) const;
+
+    /// Register a texture with explicit full resolution dimensions. It starts resident at the full resolution the quality setting allows. Compressed textures keep their levels at least 4x4. Return true if the texture is streamed.
+    bool RegisterTexture(Texture2D* texture, int width, int height, unsigned levels, unsigned long long topLevelMemory, bool compressed = false);
+    /// Register a texture being loaded from an image if it has opted in to streaming, or unregister it otherwise. Called by Texture2D.
+    void RegisterTexture(Texture2D* texture, Image* image);
+    /// Unregister a texture and stop streaming it.
+    void UnregisterTexture(Texture2D* texture);
+
+    /// Request a mip level of a texture for the current frame.
+    void RequestLevel(Texture2D* texture, unsigned mipLevel);
+    /// Request the textures of a material for an object with the given world size and view distance. Called by View.
+    void RequestMaterial(Material* material, const Camera* camera, int viewHeight, float worldSize, float distance);
+    /// Choose resident levels for the current frame under the memory budget. Performs no GPU work. Called from Update().
+    void UpdateResidency(unsigned frameNumber);
+    /// Update residency, issue background loads and upload finished ones. Called at the end of each frame.
+    void Update(unsigned frameNumber);
+
+    /// Return size of an object on screen in pixels.
+    static float GetProjectedSize(const Camera* camera, int viewHeight, float worldSize, float distance);
+    /// Return the mip level needed to sample a texture covering a number of screen pixels.
+    static unsigned GetRequiredLevel(int width, int height, unsigned levels, float projectedSize, float uvDensity, float bias);
+
+private:
+    /// Handle end of frame.
+    void HandleEndFrame(StringHash eventType, VariantMap& eventData);
+    /// Queue a background load of a texture to reach its target level.
+    void QueueLoad(TextureStreamingEntry& entry);
+    /// Upload a finished load to the texture. Return true if successful.
+    bool FinishLoad(TextureStreamingEntry& entry);
+
+    /// Streamed textures.
+    HashMap<Texture2D*, TextureStreamingEntry> entries_;
+    /// Memory budget in bytes.
+    unsigned long long memoryBudget_{};
+    /// Memory use of the target residency.
+    unsigned long long targetMemoryUse_{};
+    /// Frames before unused mip levels are evicted.
+    unsigned evictionFrames_{60};
+    /// Maximum uploads per frame.
+    unsigned maxUploadsPerFrame_{4};
+    /// Maximum background loads in flight.
+    unsigned maxPendingLoads_{8};
+    /// Number of background loads in flight.
+    unsigned numPendingLoads_{};
+    /// Number of smallest mip levels that always stay resident.
+    unsigned minResidentLevels_{6};
+    /// Global mip bias.
+    float mipBias_{};
+    /// Enabled flag.
+    bool enabled_{};
+};
+
+}
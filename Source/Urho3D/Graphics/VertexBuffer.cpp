@@ -97,6 +97,12 @@ bool VertexBuffer::SetSize(unsigned vertexCount, const PODVector<VertexElement>&
     return Create();
 }
 
+void VertexBuffer::SetPositionTransform(const Vector3& offset, float scale)
+{
+    positionOffset_ = offset;
+    positionScale_ = scale;
+}
+
 void VertexBuffer::UpdateOffsets()
 {
     unsigned elementOffset = 0;
@@ -212,4 +218,91 @@ void VertexBuffer::UpdateOffsets(PODVector<VertexElement>& elements)
     }
 }
 
+Vector4 VertexBuffer::ReadElement(const void* data, VertexElementType type)
+{
+    const auto* floats = static_cast<const float*>(data);
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    const auto* shorts = static_cast<const short*>(data);
+    const auto* halves = static_cast<const unsigned short*>(data);
+
+    switch (type)
+    {
+    case TYPE_INT:
+        return Vector4((float)*static_cast<const int*>(data), 0.0f, 0.0f, 0.0f);
+
+    case TYPE_FLOAT:
+        return Vector4(floats[0], 0.0f, 0.0f, 0.0f);
+
+    case TYPE_VECTOR2:
+        return Vector4(floats[0], floats[1], 0.0f, 0.0f);
+
+    case TYPE_VECTOR3:
+        return Vector4(floats[0], floats[1], floats[2], 0.0f);
+
+    case TYPE_VECTOR4:
+        return Vector4(floats);
+
+    case TYPE_UBYTE4:
+        return Vector4(bytes[0], bytes[1], bytes[2], bytes[3]);
+
+    case TYPE_UBYTE4_NORM:
+        return Vector4(bytes[0], bytes[1], bytes[2], bytes[3]) / 255.0f;
+
+    case TYPE_SHORT4_NORM:
+        // Both -32768 and -32767 map to -1
+        return VectorMax(Vector4(shorts[0], shorts[1], shorts[2], shorts[3]) / 32767.0f, -Vector4::ONE);
+
+    case TYPE_HALF2:
+        return Vector4(HalfToFloat(halves[0]), HalfToFloat(halves[1]), 0.0f, 0.0f);
+
+    default:
+        return Vector4::ZERO;
+    }
+}
+
+void VertexBuffer::WriteElement(void* data, VertexElementType type, const Vector4& value)
+{
+    auto* floats = static_cast<float*>(data);
+    auto* bytes = static_cast<unsigned char*>(data);
+    auto* shorts = static_cast<short*>(data);
+    auto* halves = static_cast<unsigned short*>(data);
+
+    switch (type)
+    {
+    case TYPE_INT:
+        *static_cast<int*>(data) = RoundToInt(value.x_);
+        break;
+
+    case TYPE_FLOAT:
+    case TYPE_VECTOR2:
+    case TYPE_VECTOR3:
+    case TYPE_VECTOR4:
+        memcpy(floats, value.Data(), ELEMENT_TYPESIZES[type]);
+        break;
+
+    case TYPE_UBYTE4:
+        for (unsigned i = 0; i < 4; ++i)
+            bytes[i] = (unsigned char)Clamp(RoundToInt(value.Data()[i]), 0, 255);
+        break;
+
+    case TYPE_UBYTE4_NORM:
+        for (unsigned i = 0; i < 4; ++i)
+            bytes[i] = (unsigned char)RoundToInt(Clamp(value.Data()[i], 0.0f, 1.0f) * 255.0f);
+        break;
+
+    case TYPE_SHORT4_NORM:
+        for (unsigned i = 0; i < 4; ++i)
+            shorts[i] = (short)RoundToInt(Clamp(value.Data()[i], -1.0f, 1.0f) * 32767.0f);
+        break;
+
+    case TYPE_HALF2:
+        halves[0] = FloatToHalf(value.x_);
+        halves[1] = FloatToHalf(value.y_);
+        break;
+
+    default:
+        break;
+    }
+}
+
 }
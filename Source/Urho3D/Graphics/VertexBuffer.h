@@ -26,6 +26,7 @@
 #include "../Core/Object.h"
 #include "../Graphics/GPUObject.h"
 #include "../Graphics/GraphicsDefs.h"
+#include "../Math/Matrix3x4.h"
 
 namespace Urho3D
 {
@@ -67,6 +68,8 @@ public:
     void* Lock(unsigned start, unsigned count, bool discard = false);
     /// Unlock the buffer and apply changes to the GPU buffer.
     void Unlock();
+    /// Set the transform from stored to model space positions: model position = offset + position * scale. Used with quantized positions, such as TYPE_SHORT4_NORM positions in the range -1 to 1. The transform is folded into the model and skin matrices when rendering, and models decode positions with it for CPU-side operations.
+    void SetPositionTransform(const Vector3& offset, float scale);
 
     /// Return whether CPU memory shadowing is enabled.
     bool IsShadowed() const { return shadowed_; }
@@ -113,6 +116,18 @@ public:
     /// Return shared array pointer to the CPU memory shadow data.
     SharedArrayPtr<unsigned char> GetShadowDataShared() const { return shadowData_; }
 
+    /// Return position offset.
+    const Vector3& GetPositionOffset() const { return positionOffset_; }
+
+    /// Return position scale.
+    float GetPositionScale() const { return positionScale_; }
+
+    /// Return whether positions are stored with a position transform.
+    bool HasPositionTransform() const { return positionOffset_ != Vector3::ZERO || positionScale_ != 1.0f; }
+
+    /// Return the position transform as a matrix.
+    Matrix3x4 GetPositionTransform() const { return Matrix3x4(positionOffset_, Quaternion::IDENTITY, positionScale_); }
+
     /// Return buffer hash for building vertex declarations. Used internally.
     unsigned long long GetBufferHash(unsigned streamIndex) { return elementHash_ << (streamIndex * 16); }
 
@@ -137,6 +152,11 @@ public:
     /// Update offsets of vertex elements.
     static void UpdateOffsets(PODVector<VertexElement>& elements);
 
+    /// Read a vertex element as a Vector4, converting normalized and half float types to float. Missing components are zero.
+    static Vector4 ReadElement(const void* data, VertexElementType type);
+    /// Write a vertex element from a Vector4, converting to normalized and half float types with rounding and clamping.
+    static void WriteElement(void* data, VertexElementType type, const Vector4& value);
+
 private:
     /// Update offsets of vertex elements.
     void UpdateOffsets();
@@ -161,6 +181,10 @@ private:
     unsigned long long elementHash_{};
     /// Vertex element legacy bitmask.
     VertexMaskFlags elementMask_{};
+    /// Position offset.
+    Vector3 positionOffset_;
+    /// Position scale.
+    float positionScale_{1.0f};
     /// Buffer locking state.
     LockState lockState_{LOCK_NONE};
     /// Lock start vertex.
@@ -31,6 +31,7 @@
 #include "../Graphics/Graphics.h"
 #include "../Graphics/GraphicsEvents.h"
 #include "../Graphics/GraphicsImpl.h"
+#include "../Graphics/IndexBuffer.h"
 #include "../Graphics/Material.h"
 #include "../Graphics/OcclusionBuffer.h"
 #include "../Graphics/Octree.h"
@@ -43,6 +44,7 @@
 #include "../Graphics/Texture2DArray.h"
 #include "../Graphics/Texture3D.h"
 #include "../Graphics/TextureCube.h"
+#include "../Graphics/TextureStreaming.h"
 #include "../Graphics/VertexBuffer.h"
 #include "../Graphics/View.h"
 #include "../IO/FileSystem.h"
@@ -557,6 +559,10 @@ void View::Update(const FrameInfo& frame)
     vertexLightQueues_.Clear();
     for (HashMap<unsigned, BatchQueue>::Iterator i = batchQueues_.Begin(); i != batchQueues_.End(); ++i)
         i->second_.Clear(maxSortedInstances);
+    clusterCulledGeometries_.Clear();
+    numClusterGeometries_ = 0;
+    clusterIndices_.Clear();
+    maxClusterIndex_ = 0;
 
     if (hasScenePasses_ && (!cullCamera_ || !octree_))
     {
@@ -969,6 +975,7 @@ void View::GetBatches()
     ProcessLights();
     GetLightBatches();
     GetBaseBatches();
+    PrepareClusterIndexBuffer();
 }
 
 void View::ProcessLights()
@@ -1190,6 +1197,11 @@ void View::GetBaseBatches()
 {
     URHO3D_PROFILE("GetBaseBatches");
 
+    // Report the mip levels needed by the rendered materials to texture streaming
+    auto* textureStreaming = GetSubsystem<TextureStreaming>();
+    if (textureStreaming && !textureStreaming->IsEnabled())
+        textureStreaming = nullptr;
+
     for (PODVector<Drawable*>::ConstIterator i = geometries_.Begin(); i != geometries_.End(); ++i)
     {
         Drawable* drawable = *i;
@@ -1215,6 +1227,17 @@ void View::GetBaseBatches()
             if (!srcBatch.geometry_ || !srcBatch.numWorldTransforms_ || !tech)
                 continue;
 
+            Geometry* geometry = GetClusterCulledGeometry(drawable, j, srcBatch);
+            if (!geometry)
+                continue;
+
+            if (textureStreaming)
+            {
+                const Vector3 size = drawable->GetWorldBoundingBox().Size();
+                textureStreaming->RequestMaterial(srcBatch.material_, cullCamera_, viewSize_.y_,
+                    Max(Max(size.x_, size.y_), size.z_), srcBatch.distance_);
+            }
+
             // Check each of the scene passes
             for (unsigned k = 0; k < scenePasses_.Size(); ++k)
             {
@@ -1228,6 +1251,7 @@ void View::GetBaseBatches()
                     continue;
 
                 Batch destBatch(srcBatch);
+                destBatch.geometry_ = geometry;
                 destBatch.pass_ = pass;
                 destBatch.zone_ = GetZone(drawable);
                 destBatch.isBase_ = true;
@@ -1395,7 +1419,12 @@ void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQ
         if (gBufferPassIndex_ != M_MAX_UNSIGNED && tech->HasPass(gBufferPassIndex_))
             continue;
 
+        Geometry* geometry = GetClusterCulledGeometry(drawable, i, srcBatch);
+        if (!geometry)
+            continue;
+
         Batch destBatch(srcBatch);
+        destBatch.geometry_ = geometry;
         bool isLitAlpha = false;
 
         // Check for lit base pass. Because it uses the replace blend mode, it must be ensured to be the first light
@@ -1444,6 +1473,155 @@ void View::GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQ
     }
 }
 
+Geometry* View::GetClusterCulledGeometry(Drawable* drawable, unsigned batchIndex, const SourceBatch& srcBatch)
+{
+    Geometry* geometry = srcBatch.geometry_;
+    const PODVector<GeometryCluster>& clusters = geometry->GetClusters();
+    // Instanced and skinned geometries may be transformed differently per vertex, so only single static instances are culled
+    if (clusters.Size() < 2 || srcBatch.geometryType_ != GEOM_STATIC || srcBatch.numWorldTransforms_ != 1 ||
+        !renderer_->GetClusterCulling())
+        return geometry;
+
+    IndexBuffer* indexBuffer = geometry->GetIndexBuffer();
+    const unsigned char* indexData = indexBuffer ? indexBuffer->GetShadowData() : nullptr;
+    if (!indexData)
+        return geometry;
+
+    // Reuse the result for the other passes and lights of the batch
+    Pair<Drawable*, unsigned> key(drawable, batchIndex);
+    HashMap<Pair<Drawable*, unsigned>, Geometry*>::ConstIterator i = clusterCulledGeometries_.Find(key);
+    if (i != clusterCulledGeometries_.End())
+        return i->second_;
+
+    // Test backfacing in model space, where the triangle normals are defined. Two-sided materials can not be culled
+    const Matrix3x4& worldTransform = *srcBatch.worldTransform_;
+    Matrix3x4 worldInverse = worldTransform.Inverse();
+    Matrix3x4 cameraTransform = cullCamera_->GetEffectiveWorldTransform();
+    bool orthographic = cullCamera_->IsOrthographic();
+    Vector3 cameraPosition = worldInverse * cameraTransform.Translation();
+    Vector3 cameraDirection = (worldInverse * Vector4(cameraTransform * Vector4(Vector3::FORWARD, 0.0f), 0.0f)).Normalized();
+    bool cullBackfaces = srcBatch.material_ && srcBatch.material_->GetCullMode() == CULL_CCW;
+    const Frustum& frustum = cullCamera_->GetFrustum();
+    OcclusionBuffer* occlusionBuffer = drawable->IsOccludee() ? occlusionBuffer_ : nullptr;
+
+    unsigned start = clusterIndices_.Size();
+    bool allVisible = true;
+    bool largeIndices = indexBuffer->GetIndexSize() == sizeof(unsigned);
+
+    for (unsigned j = 0; j < clusters.Size(); ++j)
+    {
+        const GeometryCluster& cluster = clusters[j];
+
+        if (cullBackfaces)
+        {
+            // All triangles face away when the view direction is within the normal cone, widened by the cluster's bounding sphere
+            Vector3 center = cluster.boundingBox_.Center();
+            float radius = cluster.boundingBox_.HalfSize().Length();
+            bool backfacing;
+            if (orthographic)
+                backfacing = cameraDirection.DotProduct(cluster.coneAxis_) >= cluster.coneCutoff_;
+            else
+            {
+                Vector3 toCenter = center - cameraPosition;
+                backfacing = toCenter.DotProduct(cluster.coneAxis_) >= cluster.coneCutoff_ * toCenter.Length() + radius;
+            }
+            if (backfacing)
+            {
+                allVisible = false;
+                continue;
+            }
+        }
+
+        BoundingBox worldBox = cluster.boundingBox_.Transformed(worldTransform);
+        if (frustum.IsInsideFast(worldBox) == OUTSIDE || (occlusionBuffer && !occlusionBuffer->IsVisible(worldBox)))
+        {
+            allVisible = false;
+            continue;
+        }
+
+        unsigned offset = clusterIndices_.Size();
+        clusterIndices_.Resize(offset + cluster.indexCount_);
+        unsigned* dest = &clusterIndices_[offset];
+        if (largeIndices)
+        {
+            const unsigned* src = reinterpret_cast<const unsigned*>(indexData) + cluster.indexStart_;
+            for (unsigned k = 0; k < cluster.indexCount_; ++k)
+            {
+                dest[k] = src[k];
+                maxClusterIndex_ = Max(maxClusterIndex_, src[k]);
+            }
+        }
+        else
+        {
+            const unsigned short* src = reinterpret_cast<const unsigned short*>(indexData) + cluster.indexStart_;
+            for (unsigned k = 0; k < cluster.indexCount_; ++k)
+            {
+                dest[k] = src[k];
+                maxClusterIndex_ = Max(maxClusterIndex_, (unsigned)src[k]);
+            }
+        }
+    }
+
+    Geometry* result;
+    if (allVisible)
+    {
+        clusterIndices_.Resize(start);
+        result = geometry;
+    }
+    else if (clusterIndices_.Size() == start)
+        result = nullptr;
+    else
+    {
+        if (!clusterIndexBuffer_)
+        {
+            clusterIndexBuffer_ = new IndexBuffer(context_);
+            clusterIndexBuffer_->SetShadowed(false);
+        }
+        if (numClusterGeometries_ >= clusterGeometries_.Size())
+            clusterGeometries_.Push(SharedPtr<Geometry>(new Geometry(context_)));
+
+        result = clusterGeometries_[numClusterGeometries_++];
+        result->SetNumVertexBuffers(geometry->GetNumVertexBuffers());
+        for (unsigned j = 0; j < geometry->GetNumVertexBuffers(); ++j)
+            result->SetVertexBuffer(j, geometry->GetVertexBuffer(j));
+        result->SetIndexBuffer(clusterIndexBuffer_);
+        result->SetDrawRange(TRIANGLE_LIST, start, clusterIndices_.Size() - start, geometry->GetVertexStart(),
+            geometry->GetVertexCount(), false);
+    }
+
+    clusterCulledGeometries_[key] = result;
+    return result;
+}
+
+void View::PrepareClusterIndexBuffer()
+{
+    if (clusterIndices_.Empty())
+        return;
+
+    URHO3D_PROFILE("PrepareClusterIndexBuffer");
+
+    // Grow the buffer in steps to avoid recreating it each frame
+    unsigned indexCount = clusterIndices_.Size();
+    bool largeIndices = maxClusterIndex_ > 65535;
+    if (clusterIndexBuffer_->GetIndexCount() < indexCount || (clusterIndexBuffer_->GetIndexSize() == sizeof(unsigned)) != largeIndices)
+        clusterIndexBuffer_->SetSize(Max(NextPowerOfTwo(indexCount), clusterIndexBuffer_->GetIndexCount()), largeIndices, true);
+
+    void* dest = clusterIndexBuffer_->Lock(0, indexCount, true);
+    if (!dest)
+        return;
+
+    if (largeIndices)
+        memcpy(dest, &clusterIndices_[0], indexCount * sizeof(unsigned));
+    else
+    {
+        auto* shortDest = static_cast<unsigned short*>(dest);
+        for (unsigned i = 0; i < indexCount; ++i)
+            shortDest[i] = (unsigned short)clusterIndices_[i];
+    }
+
+    clusterIndexBuffer_->Unlock();
+}
+
 void View::ExecuteRenderPathCommands()
 {
     View* actualView = sourceView_ ? sourceView_ : this;
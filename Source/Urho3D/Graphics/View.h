@@ -38,6 +38,7 @@ class DebugRenderer;
 class Light;
 class Drawable;
 class Graphics;
+class IndexBuffer;
 class OcclusionBuffer;
 class Octree;
 class Renderer;
@@ -208,6 +209,10 @@ private:
     void UpdateGeometries();
     /// Get pixel lit batches for a certain light and drawable.
     void GetLitBatches(Drawable* drawable, LightBatchQueue& lightQueue, BatchQueue* alphaQueue);
+    /// Cull the triangle clusters of a batch's geometry against the view frustum, backfacing and occlusion. Return a geometry that draws the compacted indices of the visible clusters, the original geometry if all are visible or it has no clusters, or null if none are visible.
+    Geometry* GetClusterCulledGeometry(Drawable* drawable, unsigned batchIndex, const SourceBatch& srcBatch);
+    /// Upload the compacted indices of the visible clusters.
+    void PrepareClusterIndexBuffer();
     /// Execute render commands.
     void ExecuteRenderPathCommands();
     /// Set rendertargets for current render command.
@@ -415,6 +420,18 @@ private:
     HashMap<unsigned long long, LightBatchQueue> vertexLightQueues_;
     /// Batch queues by pass index.
     HashMap<unsigned, BatchQueue> batchQueues_;
+    /// Cluster culling results by drawable and batch index for the current frame.
+    HashMap<Pair<Drawable*, unsigned>, Geometry*> clusterCulledGeometries_;
+    /// Geometries for drawing visible clusters, reused between frames.
+    Vector<SharedPtr<Geometry> > clusterGeometries_;
+    /// Number of cluster geometries in use in the current frame.
+    unsigned numClusterGeometries_{};
+    /// Compacted indices of the visible clusters.
+    PODVector<unsigned> clusterIndices_;
+    /// Highest index of the visible clusters.
+    unsigned maxClusterIndex_{};
+    /// Dynamic index buffer for the visible clusters.
+    SharedPtr<IndexBuffer> clusterIndexBuffer_;
     /// Index of the GBuffer pass.
     unsigned gBufferPassIndex_{};
     /// Index of the opaque forward base pass.
@@ -0,0 +1,107 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/BitStream.h"
+#include "../IO/Deserializer.h"
+#include "../IO/Serializer.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+BitWriter::BitWriter(Serializer& dest) :
+    dest_(dest),
+    buffer_(0),
+    bufferBits_(0),
+    numBits_(0)
+{
+}
+
+BitWriter::~BitWriter()
+{
+    Flush();
+}
+
+void BitWriter::Write(unsigned value, unsigned numBits)
+{
+    if (!numBits)
+        return;
+    if (numBits > 32)
+        numBits = 32;
+
+    unsigned long long mask = (1ULL << numBits) - 1;
+    buffer_ |= ((unsigned long long)value & mask) << bufferBits_;
+    bufferBits_ += numBits;
+    numBits_ += numBits;
+
+    while (bufferBits_ >= 8)
+    {
+        dest_.WriteUByte((unsigned char)(buffer_ & 0xffu));
+        buffer_ >>= 8u;
+        bufferBits_ -= 8;
+    }
+}
+
+void BitWriter::Flush()
+{
+    if (bufferBits_)
+    {
+        dest_.WriteUByte((unsigned char)(buffer_ & 0xffu));
+        numBits_ += 8 - bufferBits_;
+        buffer_ = 0;
+        bufferBits_ = 0;
+    }
+}
+
+BitReader::BitReader(Deserializer& source) :
+    source_(source),
+    buffer_(0),
+    bufferBits_(0)
+{
+}
+
+unsigned BitReader::Read(unsigned numBits)
+{
+    if (!numBits)
+        return 0;
+    if (numBits > 32)
+        numBits = 32;
+
+    while (bufferBits_ < numBits)
+    {
+        unsigned char byte = 0;
+        source_.Read(&byte, 1);
+        buffer_ |= (unsigned long long)byte << bufferBits_;
+        bufferBits_ += 8;
+    }
+
+    unsigned long long mask = (1ULL << numBits) - 1;
+    auto value = (unsigned)(buffer_ & mask);
+    buffer_ >>= numBits;
+    bufferBits_ -= numBits;
+    return value;
+}
+
+}
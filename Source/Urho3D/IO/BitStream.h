@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+namespace Urho3D
+{
+
+class Deserializer;
+class Serializer;
+
+/// Writer of bit-packed values to a serializer. Bits are written from the least significant end of each byte. Flush() must be called after the last value.
+class URHO3D_API BitWriter
+{
+public:
+    /// Construct with a destination serializer.
+    explicit BitWriter(Serializer& dest);
+    /// Destruct. Flushes remaining bits.
+    ~BitWriter();
+
+    /// Write the lowest bits of a value. At most 32 bits can be written at a time.
+    void Write(unsigned value, unsigned numBits);
+    /// Write a bool as one bit.
+    void WriteBool(bool value) { Write(value ? 1 : 0, 1); }
+    /// Write the remaining partial byte, padded with zero bits.
+    void Flush();
+
+    /// Return number of bits written.
+    unsigned GetNumBits() const { return numBits_; }
+
+private:
+    /// Destination serializer.
+    Serializer& dest_;
+    /// Bits not yet written to the serializer.
+    unsigned long long buffer_;
+    /// Number of bits in the buffer.
+    unsigned bufferBits_;
+    /// Number of bits written in total.
+    unsigned numBits_;
+};
+
+/// Reader of bit-packed values written by BitWriter. Reading past the end of the source returns zero bits.
+class URHO3D_API BitReader
+{
+public:
+    /// Construct with a source deserializer.
+    explicit BitReader(Deserializer& source);
+
+    /// Read a value of at most 32 bits.
+    unsigned Read(unsigned numBits);
+    /// Read a bool from one bit.
+    bool ReadBool() { return Read(1) != 0; }
+
+private:
+    /// Source deserializer.
+    Deserializer& source_;
+    /// Bits read from the source but not yet returned.
+    unsigned long long buffer_;
+    /// Number of bits in the buffer.
+    unsigned bufferBits_;
+};
+
+}
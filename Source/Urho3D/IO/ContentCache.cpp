@@ -0,0 +1,171 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/ProcessUtils.h"
+#include "../IO/ContentCache.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryMappedFile.h"
+
+#ifdef _WIN32
+#include <windows.h>
+#endif
+
+#include <atomic>
+#include <cstdio>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Counter for unique temporary file names of the entries stored by this process.
+static std::atomic<unsigned> tempFileCounter{};
+
+/// Move a file over another, replacing it atomically if it exists. Return true if successful.
+static bool ReplaceFile(const String& srcFileName, const String& destFileName)
+{
+#ifdef _WIN32
+    return MoveFileExW(GetWideNativePath(srcFileName).CString(), GetWideNativePath(destFileName).CString(),
+        MOVEFILE_REPLACE_EXISTING) != 0;
+#else
+    return rename(GetNativePath(srcFileName).CString(), GetNativePath(destFileName).CString()) == 0;
+#endif
+}
+
+ContentCache::ContentCache(Context* context) :
+    Object(context)
+{
+}
+
+ContentCache::~ContentCache() = default;
+
+bool ContentCache::SetCacheDir(const String& pathName)
+{
+    String cacheDir = AddTrailingSlash(pathName);
+    if (!GetSubsystem<FileSystem>()->CreateDirsRecursive(cacheDir))
+    {
+        URHO3D_LOGERROR("Could not create content cache directory " + cacheDir);
+        return false;
+    }
+
+    cacheDir_ = cacheDir;
+    return true;
+}
+
+bool ContentCache::Load(const String& key, PODVector<unsigned char>& dest) const
+{
+    if (cacheDir_.Empty() || key.Empty())
+        return false;
+
+    String entryName = GetEntryName(key);
+    if (!GetSubsystem<FileSystem>()->FileExists(entryName))
+        return false;
+
+    File file(context_);
+    if (!file.Open(entryName))
+        return false;
+
+    dest.Resize(file.GetSize());
+    return dest.Empty() || file.Read(&dest[0], dest.Size()) == dest.Size();
+}
+
+bool ContentCache::Store(const String& key, const void* data, unsigned size) const
+{
+    if (cacheDir_.Empty() || key.Empty())
+        return false;
+
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    String entryName = GetEntryName(key);
+    fileSystem->CreateDir(GetPath(entryName));
+
+    // Write under a name unique to this process and call, then move in place. Replacing the entry in one step means other
+    // processes never see it missing or partially written
+    String tempName = entryName + ToString(".%u.%u.tmp", GetCurrentProcessID(), tempFileCounter++);
+    {
+        File file(context_);
+        if (!file.Open(tempName, FILE_WRITE) || file.Write(data, size) != size)
+        {
+            URHO3D_LOGERROR("Could not write content cache entry " + tempName);
+            file.Close();
+            fileSystem->Delete(tempName);
+            return false;
+        }
+    }
+
+    if (!ReplaceFile(tempName, entryName))
+    {
+        // On Windows replacing fails if another process has the entry open. Its contents are the same, so keep it
+        fileSystem->Delete(tempName);
+        return fileSystem->FileExists(entryName);
+    }
+
+    return true;
+}
+
+String ContentCache::GetFileKey(const String& fileName, const String& options) const
+{
+    // Missing files are expected for dependencies that did not exist, do not log an error for them
+    if (!GetSubsystem<FileSystem>()->FileExists(fileName))
+        return String::EMPTY;
+
+    File file(context_);
+    if (!file.Open(fileName))
+        return String::EMPTY;
+
+    MemoryMappedFile contents;
+    if (!contents.Open(&file))
+        return String::EMPTY;
+
+    return GetKey(contents.GetData(), contents.GetSize(), options);
+}
+
+String ContentCache::GetKey(const void* data, unsigned size, const String& options)
+{
+    // String formatting does not support width specifiers, so format the fixed-width hex key with the C library
+    char key[41];
+    snprintf(key, sizeof key, "%016llx%08x%016llx", Hash(data, size), size, Hash(options.CString(), options.Length()));
+    return String(key);
+}
+
+unsigned long long ContentCache::Hash(const void* data, unsigned size, unsigned long long hash)
+{
+    const auto* bytes = static_cast<const unsigned char*>(data);
+    for (unsigned i = 0; i < size; ++i)
+    {
+        hash ^= bytes[i];
+        hash *= 0x100000001b3ULL;
+    }
+    return hash;
+}
+
+String ContentCache::GetEntryName(const String& key) const
+{
+    // Spread the entries over subdirectories by the first characters of the key to keep directories small
+    return cacheDir_ + key.Substring(0, 2) + "/" + key;
+}
+
+}
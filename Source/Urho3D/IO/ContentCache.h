@@ -0,0 +1,68 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Object.h"
+
+namespace Urho3D
+{
+
+/// On-disk cache of processed content, addressed by a hash of the source data and the options it was processed with. Used by the asset tools to skip processing inputs that have not changed. Entries are written to a temporary file and moved over the old entry in one step, so that several processes can share a cache directory. Load and store may be called from worker threads.
+class URHO3D_API ContentCache : public Object
+{
+    URHO3D_OBJECT(ContentCache, Object);
+
+public:
+    /// Construct.
+    explicit ContentCache(Context* context);
+    /// Destruct.
+    ~ContentCache() override;
+
+    /// Set the cache directory and create it if necessary. Return true if successful.
+    bool SetCacheDir(const String& pathName);
+    /// Read a cached entry. Return true if found.
+    bool Load(const String& key, PODVector<unsigned char>& dest) const;
+    /// Store an entry, replacing an existing one. Return true if successful.
+    bool Store(const String& key, const void* data, unsigned size) const;
+    /// Return key of a source file processed with the given options, or empty if the file can not be read.
+    String GetFileKey(const String& fileName, const String& options) const;
+
+    /// Return the cache directory.
+    const String& GetCacheDir() const { return cacheDir_; }
+    /// Return whether a cache directory has been set.
+    bool IsEnabled() const { return !cacheDir_.Empty(); }
+
+    /// Return key of source data processed with the given options.
+    static String GetKey(const void* data, unsigned size, const String& options);
+    /// Return 64-bit FNV-1a hash of data, continuing from a previous hash.
+    static unsigned long long Hash(const void* data, unsigned size, unsigned long long hash = 0xcbf29ce484222325ULL);
+
+private:
+    /// Return file name of an entry.
+    String GetEntryName(const String& key) const;
+
+    /// Cache directory with trailing slash.
+    String cacheDir_;
+};
+
+}
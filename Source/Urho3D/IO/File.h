@@ -108,6 +108,12 @@ public:
     /// Return whether the file originates from a package.
     bool IsPackaged() const { return offset_ != 0; }
 
+    /// Return start position within a package file, 0 for regular files.
+    unsigned GetOffset() const { return offset_; }
+
+    /// Return whether the file data is compressed within a package.
+    bool IsCompressed() const { return compressed_; }
+
     /// Reads a text file, ensuring data from file is 0 terminated
     virtual void ReadText(String& text);
 
@@ -0,0 +1,156 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryMappedFile.h"
+
+#include <cstdio>
+
+#ifdef _WIN32
+#include <windows.h>
+#include <io.h>
+#elif !defined(__EMSCRIPTEN__)
+#include <sys/mman.h>
+#include <unistd.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+MemoryMappedFile::~MemoryMappedFile()
+{
+    Close();
+}
+
+bool MemoryMappedFile::Open(File* file, bool copyOnWrite)
+{
+    Close();
+    copyOnWrite_ = copyOnWrite;
+
+    if (!file || !file->IsOpen() || file->GetMode() == FILE_WRITE)
+    {
+        URHO3D_LOGERROR("File not open for reading, can not map");
+        return false;
+    }
+
+    size_ = file->GetSize();
+    if (!size_)
+        return true;
+
+    if (Map(file))
+        return true;
+
+    // Fall back to reading the whole file into memory
+    buffer_ = new unsigned char[size_];
+    file->Seek(0);
+    if (file->Read(buffer_.Get(), size_) != size_)
+    {
+        URHO3D_LOGERROR("Could not read file " + file->GetName());
+        Close();
+        return false;
+    }
+
+    data_ = buffer_.Get();
+    return true;
+}
+
+void MemoryMappedFile::Close()
+{
+#ifdef _WIN32
+    if (mapping_)
+        UnmapViewOfFile(mapping_);
+    if (mappingHandle_)
+        CloseHandle((HANDLE)mappingHandle_);
+    mappingHandle_ = nullptr;
+#elif !defined(__EMSCRIPTEN__)
+    if (mapping_)
+        munmap(mapping_, mappingSize_);
+#endif
+
+    mapping_ = nullptr;
+    mappingSize_ = 0;
+    buffer_.Reset();
+    data_ = nullptr;
+    size_ = 0;
+}
+
+bool MemoryMappedFile::Map(File* file)
+{
+#if defined(__EMSCRIPTEN__)
+    return false;
+#else
+    // Compressed package entries have to be decompressed through the file, and Android assets have no file descriptor
+    auto* handle = (FILE*)file->GetHandle();
+    if (!handle || file->IsCompressed())
+        return false;
+
+    const unsigned offset = file->GetOffset();
+
+#ifdef _WIN32
+    SYSTEM_INFO systemInfo;
+    GetSystemInfo(&systemInfo);
+    const unsigned alignedOffset = offset - offset % systemInfo.dwAllocationGranularity;
+
+    auto fileHandle = (HANDLE)_get_osfhandle(_fileno(handle));
+    if (fileHandle == INVALID_HANDLE_VALUE)
+        return false;
+
+    HANDLE mappingHandle = CreateFileMappingW(fileHandle, nullptr, copyOnWrite_ ? PAGE_WRITECOPY : PAGE_READONLY, 0, 0, nullptr);
+    if (!mappingHandle)
+        return false;
+
+    mappingSize_ = size_ + offset - alignedOffset;
+    mapping_ = MapViewOfFile(mappingHandle, copyOnWrite_ ? FILE_MAP_COPY : FILE_MAP_READ, 0, alignedOffset, mappingSize_);
+    if (!mapping_)
+    {
+        CloseHandle(mappingHandle);
+        mappingSize_ = 0;
+        return false;
+    }
+    mappingHandle_ = mappingHandle;
+#else
+    const auto pageSize = (unsigned)sysconf(_SC_PAGESIZE);
+    const unsigned alignedOffset = offset - offset % pageSize;
+
+    mappingSize_ = size_ + offset - alignedOffset;
+    // Private mappings are copy-on-write when writable
+    void* mapping = mmap(nullptr, mappingSize_, copyOnWrite_ ? PROT_READ | PROT_WRITE : PROT_READ, MAP_PRIVATE, fileno(handle),
+        alignedOffset);
+    if (mapping == MAP_FAILED)
+    {
+        mappingSize_ = 0;
+        return false;
+    }
+    mapping_ = mapping;
+#endif
+
+    data_ = static_cast<const unsigned char*>(mapping_) + (offset - alignedOffset);
+    return true;
+#endif
+}
+
+}
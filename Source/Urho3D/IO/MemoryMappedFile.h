@@ -0,0 +1,78 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/ArrayPtr.h"
+#include "../Container/RefCounted.h"
+
+namespace Urho3D
+{
+
+class File;
+
+/// Read-only view of a file's contents in memory. Maps the file when possible, otherwise reads it into a buffer (compressed packages, Android assets, Web.)
+class URHO3D_API MemoryMappedFile : public RefCounted
+{
+public:
+    /// Construct.
+    MemoryMappedFile() = default;
+    /// Destruct. Unmap the file.
+    ~MemoryMappedFile() override;
+
+    /// Map the whole contents of an open file, regardless of its current position. Return true if successful. A copy-on-write mapping allows modifying the contents in place without affecting the file.
+    bool Open(File* file, bool copyOnWrite = false);
+    /// Unmap the file or free the buffer.
+    void Close();
+
+    /// Return the file contents.
+    const unsigned char* GetData() const { return data_; }
+    /// Return the file contents for modifying in place, or null if not opened copy-on-write.
+    unsigned char* GetWritableData() const { return copyOnWrite_ ? const_cast<unsigned char*>(data_) : nullptr; }
+    /// Return size of the file contents.
+    unsigned GetSize() const { return size_; }
+    /// Return whether the contents are memory mapped instead of read to a buffer.
+    bool IsMapped() const { return mapping_ != nullptr; }
+
+private:
+    /// Map the file. Return true if successful.
+    bool Map(File* file);
+
+    /// Start of the file contents.
+    const unsigned char* data_{};
+    /// Size of the file contents.
+    unsigned size_{};
+    /// Start of the mapped view, aligned to the allocation granularity.
+    void* mapping_{};
+    /// Size of the mapped view.
+    unsigned mappingSize_{};
+    /// Copy-on-write flag.
+    bool copyOnWrite_{};
+#ifdef _WIN32
+    /// File mapping object handle.
+    void* mappingHandle_{};
+#endif
+    /// Fallback buffer when the file can not be mapped.
+    SharedArrayPtr<unsigned char> buffer_;
+};
+
+}
@@ -186,6 +186,18 @@ public:
     /// Return as string.
     String ToString() const;
 
+    /// Convert a color component from sRGB gamma space to linear space.
+    static float ConvertGammaToLinear(float value)
+    {
+        return value <= 0.04045f ? value / 12.92f : Pow((value + 0.055f) / 1.055f, 2.4f);
+    }
+
+    /// Convert a color component from linear space to sRGB gamma space.
+    static float ConvertLinearToGamma(float value)
+    {
+        return value <= 0.0031308f ? value * 12.92f : 1.055f * Pow(value, 1.0f / 2.4f) - 0.055f;
+    }
+
     /// Return color packed to a 32-bit integer, with B component in the lowest 8 bits. Components are clamped to [0, 1] range.
     unsigned ToUIntArgb() const;
     
@@ -56,6 +56,14 @@ namespace Urho3D
 {
 
 static const int STATS_INTERVAL_MSEC = 2000;
+/// Already replicated nodes are removed from the client only outside this multiple of the interest radius, to avoid nodes near the border being repeatedly removed and recreated.
+static const float INTEREST_REMOVE_RADIUS_FACTOR = 1.25f;
+
+/// Return whether a snapshot sequence number is newer than another, taking wraparound into account.
+static bool IsNewerSnapshot(unsigned short sequence, unsigned short other)
+{
+    return sequence != other && (unsigned short)(sequence - other) < 0x8000;
+}
 
 PackageDownload::PackageDownload() :
     totalFragments_(0),
@@ -75,9 +83,13 @@ Connection::Connection(Context* context) :
     timeStamp_(0),
     peer_(nullptr),
     sendMode_(OPSM_NONE),
+    snapshotSequence_(0),
+    numNodesConsidered_(0),
+    numNodesSent_(0),
     isClient_(false),
     connectPending_(false),
     sceneLoaded_(false),
+    snapshotReplication_(false),
     logStatistics_(false),
     address_(nullptr)
 {
@@ -187,9 +199,18 @@ void Connection::SetScene(Scene* newScene)
     sceneLoaded_ = false;
     UnsubscribeFromEvent(E_ASYNCLOADFINISHED);
 
+    // Restart the snapshot sequence
+    snapshotNodes_.Clear();
+    snapshots_.Clear();
+    snapshotAcks_.Clear();
+    snapshotSequence_ = 0;
+
     if (!scene_)
         return;
 
+    // Latch the replication mode, as switching it during replication would lose changes
+    snapshotReplication_ = GetSubsystem<Network>()->GetSnapshotReplication();
+
     if (isClient_)
     {
         sceneState_.Clear();
@@ -263,19 +284,74 @@ void Connection::SendServerUpdate()
 
     // Always check the root node (scene) first so that the scene-wide components get sent first,
     // and all other replicated nodes get added to the dirty set for sending the initial state
+    numNodesConsidered_ = 0;
+    numNodesSent_ = 0;
+
     unsigned sceneID = scene_->GetID();
     nodesToProcess_.Insert(sceneID);
     ProcessNode(sceneID);
 
+    // Limit the dirtied nodes to the ones relevant to the observer, if using interest management
+    const NetworkInterestGrid* grid = GetSubsystem<Network>()->GetInterestGrid(scene_);
+    if (grid)
+        UpdateInterest(grid);
+
     // Then go through all dirtied nodes
     nodesToProcess_.Insert(sceneState_.dirtyNodes_);
     nodesToProcess_.Erase(sceneID); // Do not process the root node twice
 
-    while (nodesToProcess_.Size())
-    {
-        unsigned nodeID = nodesToProcess_.Front();
+    // Nodes are processed in ID order. Processing may also process and erase later nodes due to dependencies
+    for (unsigned nodeID = nodesToProcess_.FindNext(0); nodeID != M_MAX_UNSIGNED; nodeID = nodesToProcess_.FindNext(nodeID + 1))
         ProcessNode(nodeID);
+
+    if (snapshotReplication_)
+        SendSnapshot();
+}
+
+void Connection::FinishServerUpdate()
+{
+    for (PODVector<unsigned>::ConstIterator i = removedNodeStates_.Begin(); i != removedNodeStates_.End(); ++i)
+    {
+        HashMap<unsigned, NodeReplicationState>::Iterator j = sceneState_.nodeStates_.Find(*i);
+        if (j == sceneState_.nodeStates_.End())
+            continue;
+
+        NodeReplicationState& nodeState = j->second_;
+        Node* node = nodeState.node_;
+        if (node)
+            node->RemoveReplicationState(&nodeState);
+        for (HashMap<unsigned, ComponentReplicationState>::Iterator k = nodeState.componentStates_.Begin();
+             k != nodeState.componentStates_.End(); ++k)
+        {
+            Component* component = k->second_.component_;
+            if (component)
+                component->RemoveReplicationState(&k->second_);
+        }
+
+        sceneState_.nodeStates_.Erase(j);
+    }
+
+    for (PODVector<Pair<NodeReplicationState*, unsigned> >::ConstIterator i = removedComponentStates_.Begin();
+         i != removedComponentStates_.End(); ++i)
+        i->first_->componentStates_.Erase(i->second_);
+
+    for (PODVector<Pair<NodeReplicationState*, Node*> >::ConstIterator i = newNodeStates_.Begin(); i != newNodeStates_.End(); ++i)
+    {
+        i->first_->node_ = i->second_;
+        i->second_->AddReplicationState(i->first_);
     }
+
+    for (PODVector<Pair<ComponentReplicationState*, Component*> >::ConstIterator i = newComponentStates_.Begin();
+         i != newComponentStates_.End(); ++i)
+    {
+        i->first_->component_ = i->second_;
+        i->second_->AddReplicationState(i->first_);
+    }
+
+    removedNodeStates_.Clear();
+    removedComponentStates_.Clear();
+    newNodeStates_.Clear();
+    newComponentStates_.Clear();
 }
 
 void Connection::SendClientUpdate()
@@ -295,6 +371,15 @@ void Connection::SendClientUpdate()
         msg_.WritePackedQuaternion(rotation_);
     SendMessage(MSG_CONTROLS, false, false, msg_, CONTROLS_CONTENT_ID);
 
+    if (!snapshotAcks_.Empty())
+    {
+        msg_.Clear();
+        for (unsigned i = 0; i < snapshotAcks_.Size(); ++i)
+            msg_.WriteUShort(snapshotAcks_[i]);
+        SendMessage(MSG_SNAPSHOTACK, false, false, msg_);
+        snapshotAcks_.Clear();
+    }
+
     ++timeStamp_;
 }
 
@@ -305,12 +390,14 @@ void Connection::SendRemoteEvents()
     {
         statsTimer_.Reset();
         char statsBuffer[256];
-        sprintf(statsBuffer, "RTT %.3f ms Pkt in %i Pkt out %i Data in %.3f KB/s Data out %.3f KB/s, Last heard %u", GetRoundTripTime(),
+        sprintf(statsBuffer, "RTT %.3f ms Pkt in %i Pkt out %i Data in %.3f KB/s Data out %.3f KB/s, Last heard %u, Nodes %u/%u", GetRoundTripTime(),
             GetPacketsInPerSec(),
             GetPacketsOutPerSec(),
             GetBytesInPerSec(),
             GetBytesOutPerSec(),
-            GetLastHeardTime());
+            GetLastHeardTime(),
+            numNodesSent_,
+            numNodesConsidered_);
         URHO3D_LOGINFO(statsBuffer);
     }
 #endif
@@ -466,6 +553,14 @@ bool Connection::ProcessMessage(int msgID, MemoryBuffer& msg)
         ProcessPackageInfo(msgID, msg);
         break;
 
+    case MSG_SNAPSHOT:
+        ProcessSnapshot(msgID, msg);
+        break;
+
+    case MSG_SNAPSHOTACK:
+        ProcessSnapshotAck(msgID, msg);
+        break;
+
     default:
         processed = false;
         break;
@@ -1065,6 +1160,28 @@ float Connection::GetBytesOutPerSec() const
     return 0.0f;
 }
 
+unsigned long long Connection::GetBytesReceived() const
+{
+    if (peer_)
+    {
+        SLNet::RakNetStatistics stats{};
+        if (peer_->GetStatistics(address_->systemAddress, &stats))
+            return stats.runningTotal[SLNet::ACTUAL_BYTES_RECEIVED];
+    }
+    return 0;
+}
+
+unsigned long long Connection::GetBytesSent() const
+{
+    if (peer_)
+    {
+        SLNet::RakNetStatistics stats{};
+        if (peer_->GetStatistics(address_->systemAddress, &stats))
+            return stats.runningTotal[SLNet::ACTUAL_BYTES_SENT];
+    }
+    return 0;
+}
+
 int Connection::GetPacketsInPerSec() const
 {
     return packetCounter_.x_;
@@ -1148,12 +1265,111 @@ void Connection::HandleAsyncLoadFinished(StringHash eventType, VariantMap& event
     SendMessage(MSG_SCENELOADED, true, true, msg_);
 }
 
+void Connection::UpdateInterest(const NetworkInterestGrid* grid)
+{
+    URHO3D_PROFILE("UpdateInterest");
+
+    auto* network = GetSubsystem<Network>();
+    const NetworkInterestFilter& filter = network->GetInterestFilter();
+    float radius = network->GetInterestRadius();
+    float removeRadius = radius * INTEREST_REMOVE_RADIUS_FACTOR;
+    Vector2 center(position_.x_, position_.z_);
+
+    relevantNodes_.Clear();
+    interestNodes_.Clear();
+    grid->Query(position_, removeRadius, interestNodes_);
+
+    for (PODVector<Node*>::ConstIterator i = interestNodes_.Begin(); i != interestNodes_.End(); ++i)
+    {
+        Node* node = *i;
+        Vector3 position = node->GetWorldPosition();
+        float distance = (Vector2(position.x_, position.z_) - center).Length();
+        if (distance > radius && (distance > removeRadius || !sceneState_.nodeStates_.Contains(node->GetID())))
+            continue;
+        if (filter && !filter(this, node))
+            continue;
+
+        relevantNodes_.Insert(node->GetID());
+    }
+
+    const PODVector<Node*>& alwaysRelevantNodes = grid->GetAlwaysRelevantNodes();
+    for (PODVector<Node*>::ConstIterator i = alwaysRelevantNodes.Begin(); i != alwaysRelevantNodes.End(); ++i)
+        relevantNodes_.Insert((*i)->GetID());
+
+    const PODVector<Node*>& ownedNodes = grid->GetOwnedNodes();
+    for (PODVector<Node*>::ConstIterator i = ownedNodes.Begin(); i != ownedNodes.End(); ++i)
+    {
+        if ((*i)->GetOwner() == this)
+            relevantNodes_.Insert((*i)->GetID());
+    }
+
+    // Remove the nodes that are no longer relevant from the client. Removed nodes are left for ProcessNode
+    for (HashMap<unsigned, NodeReplicationState>::ConstIterator i = sceneState_.nodeStates_.Begin(); i != sceneState_.nodeStates_.End(); ++i)
+    {
+        Node* node = i->second_.node_;
+        if (!node || node == scene_ || IsRelevant(node))
+            continue;
+
+        msg_.Clear();
+        msg_.WriteNetID(i->first_);
+        SendMessage(MSG_REMOVENODE, true, true, msg_);
+
+        sceneState_.dirtyNodes_.Erase(i->first_);
+        snapshotNodes_.Erase(i->first_);
+        removedNodeStates_.Push(i->first_);
+    }
+
+    // Drop the changes of nodes the client does not have and that are not relevant
+    IDBitSet& dirtyNodes = sceneState_.dirtyNodes_;
+    for (unsigned id = dirtyNodes.FindNext(0); id != M_MAX_UNSIGNED; id = dirtyNodes.FindNext(id + 1))
+    {
+        Node* node = sceneState_.nodeStates_.Contains(id) ? nullptr : scene_->GetNode(id);
+        if (node && !IsRelevant(node))
+            dirtyNodes.Erase(id);
+    }
+
+    // Queue the nodes that have become relevant, including their children
+    for (HashSet<unsigned>::ConstIterator i = relevantNodes_.Begin(); i != relevantNodes_.End(); ++i)
+    {
+        if (sceneState_.nodeStates_.Contains(*i))
+            continue;
+
+        Node* node = scene_->GetNode(*i);
+        if (!node)
+            continue;
+
+        sceneState_.dirtyNodes_.Insert(*i);
+        interestNodes_.Clear();
+        node->GetChildren(interestNodes_, true);
+        for (PODVector<Node*>::ConstIterator j = interestNodes_.Begin(); j != interestNodes_.End(); ++j)
+        {
+            if ((*j)->IsReplicated())
+                sceneState_.dirtyNodes_.Insert((*j)->GetID());
+        }
+    }
+}
+
+bool Connection::IsRelevant(Node* node) const
+{
+    // Relevancy is decided by the root level node, so that hierarchies are added and removed as a whole
+    Node* parent = node->GetParent();
+    while (parent && parent != scene_)
+    {
+        node = parent;
+        parent = node->GetParent();
+    }
+
+    return relevantNodes_.Contains(node->GetID());
+}
+
 void Connection::ProcessNode(unsigned nodeID)
 {
     // Check that we have not already processed this due to dependency recursion
     if (!nodesToProcess_.Erase(nodeID))
         return;
 
+    ++numNodesConsidered_;
+
     // Find replication state for the node
     HashMap<unsigned, NodeReplicationState>::Iterator i = sceneState_.nodeStates_.Find(nodeID);
     if (i != sceneState_.nodeStates_.End())
@@ -1169,7 +1385,8 @@ void Connection::ProcessNode(unsigned nodeID)
             // would be enough. However, this may be better due to the client not possibly having updated parenting
             // information at the time of receiving this message
             SendMessage(MSG_REMOVENODE, true, true, msg_);
-            sceneState_.nodeStates_.Erase(nodeID);
+            snapshotNodes_.Erase(nodeID);
+            removedNodeStates_.Push(nodeID);
         }
         else
             ProcessExistingNode(node, i->second_);
@@ -1199,14 +1416,16 @@ void Connection::ProcessNewNode(Node* node)
             ProcessNode(nodeID);
     }
 
+    ++numNodesSent_;
+
     msg_.Clear();
     msg_.WriteNetID(node->GetID());
 
     NodeReplicationState& nodeState = sceneState_.nodeStates_[node->GetID()];
     nodeState.connection_ = this;
     nodeState.sceneState_ = &sceneState_;
-    nodeState.node_ = node;
-    node->AddReplicationState(&nodeState);
+    nodeState.createdFrame_ = scene_->GetNetworkFrame();
+    newNodeStates_.Push(MakePair(&nodeState, node));
 
     // Write node's attributes
     node->WriteInitialDeltaUpdate(msg_, timeStamp_);
@@ -1233,8 +1452,8 @@ void Connection::ProcessNewNode(Node* node)
         ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
         componentState.connection_ = this;
         componentState.nodeState_ = &nodeState;
-        componentState.component_ = component;
-        component->AddReplicationState(&componentState);
+        componentState.createdFrame_ = nodeState.createdFrame_;
+        newComponentStates_.Push(MakePair(&componentState, component));
 
         msg_.WriteStringHash(component->GetType());
         msg_.WriteNetID(component->GetID());
@@ -1258,6 +1477,25 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             ProcessNode(nodeID);
     }
 
+    // When using snapshots, attribute changes are sent with the next snapshots until acknowledged. This is not subject to
+    // the update priority, as the snapshots are relative to the last state acknowledged for all nodes
+    if (snapshotReplication_)
+    {
+        bool changed = nodeState.dirtyAttributes_.Count() != 0;
+        nodeState.dirtyAttributes_.ClearAll();
+        for (HashMap<unsigned, ComponentReplicationState>::Iterator i = nodeState.componentStates_.Begin();
+             i != nodeState.componentStates_.End(); ++i)
+        {
+            if (i->second_.dirtyAttributes_.Count())
+            {
+                changed = true;
+                i->second_.dirtyAttributes_.ClearAll();
+            }
+        }
+        if (changed)
+            snapshotNodes_.Insert(node->GetID());
+    }
+
     // Check from the interest management component, if exists, whether should update
     /// \todo Searching for the component is a potential CPU hotspot. It should be cached
     auto* priority = node->GetComponent<NetworkPriority>();
@@ -1268,6 +1506,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
             return;
     }
 
+    ++numNodesSent_;
+
     // Check if attributes have changed
     if (nodeState.dirtyAttributes_.Count() || nodeState.dirtyVars_.Size())
     {
@@ -1329,6 +1569,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     }
 
     // Check for removed or changed components
+    unsigned numRemovedComponents = 0;
     for (HashMap<unsigned, ComponentReplicationState>::Iterator i = nodeState.componentStates_.Begin();
          i != nodeState.componentStates_.End();)
     {
@@ -1337,12 +1578,13 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
         Component* component = componentState.component_;
         if (!component)
         {
-            // Removed component
+            // Removed component. The state is erased in FinishServerUpdate()
             msg_.Clear();
             msg_.WriteNetID(current->first_);
 
             SendMessage(MSG_REMOVECOMPONENT, true, true, msg_);
-            nodeState.componentStates_.Erase(current);
+            removedComponentStates_.Push(MakePair(&nodeState, current->first_));
+            ++numRemovedComponents;
         }
         else
         {
@@ -1388,7 +1630,7 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     }
 
     // Check for new components
-    if (nodeState.componentStates_.Size() != node->GetNumNetworkComponents())
+    if (nodeState.componentStates_.Size() - numRemovedComponents != node->GetNumNetworkComponents())
     {
         const Vector<SharedPtr<Component> >& components = node->GetComponents();
         for (unsigned i = 0; i < components.Size(); ++i)
@@ -1405,8 +1647,8 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
                 ComponentReplicationState& componentState = nodeState.componentStates_[component->GetID()];
                 componentState.connection_ = this;
                 componentState.nodeState_ = &nodeState;
-                componentState.component_ = component;
-                component->AddReplicationState(&componentState);
+                componentState.createdFrame_ = scene_->GetNetworkFrame();
+                newComponentStates_.Push(MakePair(&componentState, component));
 
                 msg_.Clear();
                 msg_.WriteNetID(node->GetID());
@@ -1423,6 +1665,205 @@ void Connection::ProcessExistingNode(Node* node, NodeReplicationState& nodeState
     sceneState_.dirtyNodes_.Erase(node->GetID());
 }
 
+void Connection::SendSnapshot()
+{
+    if (snapshotNodes_.Empty())
+        return;
+
+    URHO3D_PROFILE("SendSnapshot");
+
+    if (snapshots_.Empty())
+        snapshots_.Resize(SNAPSHOT_HISTORY_SIZE);
+
+    SnapshotRecord* snapshot = nullptr;
+    unsigned numSnapshots = 0;
+    PODVector<unsigned> sentNodes;
+
+    // Write each node and component with attribute changes after the state the client is known to have, which is either
+    // the last acknowledged snapshot containing the node or the creation. Nodes without such changes no longer need to be sent
+    for (HashSet<unsigned>::Iterator i = snapshotNodes_.Begin(); i != snapshotNodes_.End();)
+    {
+        HashMap<unsigned, NodeReplicationState>::Iterator j = sceneState_.nodeStates_.Find(*i);
+        Node* node = j != sceneState_.nodeStates_.End() ? j->second_.node_.Get() : nullptr;
+        if (!node)
+        {
+            i = snapshotNodes_.Erase(i);
+            continue;
+        }
+
+        NodeReplicationState& nodeState = j->second_;
+        snapshotNode_.Clear();
+        bool pending = WriteSnapshotEntry(snapshotNode_, node, *i, false, Max(nodeState.ackedSnapshotFrame_,
+            nodeState.createdFrame_));
+
+        for (HashMap<unsigned, ComponentReplicationState>::Iterator k = nodeState.componentStates_.Begin();
+             k != nodeState.componentStates_.End(); ++k)
+        {
+            Component* component = k->second_.component_;
+            if (component && WriteSnapshotEntry(snapshotNode_, component, k->first_, true, Max(nodeState.ackedSnapshotFrame_,
+                k->second_.createdFrame_)))
+                pending = true;
+        }
+
+        if (!pending)
+        {
+            i = snapshotNodes_.Erase(i);
+            continue;
+        }
+
+        // Unreliable messages that exceed the datagram size are fragmented and lost as a whole if any fragment is lost,
+        // so start another snapshot instead. The node and its components always go to the same snapshot
+        if (snapshot && msg_.GetSize() + snapshotNode_.GetSize() > SNAPSHOT_MAX_SIZE)
+        {
+            SendMessage(MSG_SNAPSHOT, false, false, msg_);
+            snapshot = nullptr;
+        }
+
+        if (!snapshot)
+        {
+            // Nodes left over are sent on the next update
+            if (numSnapshots == SNAPSHOT_MAX_PER_UPDATE)
+                break;
+
+            ++numSnapshots;
+            ++snapshotSequence_;
+            snapshot = &snapshots_[snapshotSequence_ % SNAPSHOT_HISTORY_SIZE];
+            snapshot->frame_ = scene_->GetNetworkFrame();
+            snapshot->nodes_.Clear();
+            msg_.Clear();
+            msg_.WriteUShort(snapshotSequence_);
+        }
+
+        msg_.Write(snapshotNode_.GetData(), snapshotNode_.GetSize());
+        snapshot->nodes_.Push(*i);
+        sentNodes.Push(*i);
+        i = snapshotNodes_.Erase(i);
+    }
+
+    if (snapshot)
+        SendMessage(MSG_SNAPSHOT, false, false, msg_);
+
+    // Move the sent nodes behind the ones that did not fit, so that those are sent first on the next update
+    for (unsigned i = 0; i < sentNodes.Size(); ++i)
+        snapshotNodes_.Insert(sentNodes[i]);
+}
+
+bool Connection::WriteSnapshotEntry(Serializer& dest, Serializable* serializable, unsigned id, bool isComponent, unsigned baseFrame)
+{
+    NetworkState* networkState = serializable->GetNetworkState();
+    if (!networkState || networkState->lastChangedFrame_ <= baseFrame)
+        return false;
+
+    DirtyBits attributeBits;
+    const PODVector<unsigned>& changedFrames = networkState->changedFrames_;
+    for (unsigned i = 0; i < changedFrames.Size(); ++i)
+    {
+        if (changedFrames[i] > baseFrame)
+            attributeBits.Set(i);
+    }
+    if (!attributeBits.Count())
+        return false;
+
+    snapshotEntry_.Clear();
+    serializable->WriteDeltaUpdate(snapshotEntry_, attributeBits, timeStamp_);
+
+    // The entry size is stored with the component flag in the lowest bit, so that entries of unknown objects can be skipped
+    dest.WriteNetID(id);
+    dest.WriteVLE(snapshotEntry_.GetSize() << 1u | (isComponent ? 1u : 0u));
+    dest.Write(snapshotEntry_.GetData(), snapshotEntry_.GetSize());
+    return true;
+}
+
+void Connection::ProcessSnapshot(int msgID, MemoryBuffer& msg)
+{
+    if (IsClient())
+    {
+        URHO3D_LOGWARNING("Received unexpected Snapshot message from client " + ToString());
+        return;
+    }
+
+    if (!scene_)
+        return;
+
+    // Snapshots older than the last one received are dropped, as they could overwrite newer changes. The server sends
+    // their changes again until acknowledged
+    unsigned short sequence = msg.ReadUShort();
+    if (!IsNewerSnapshot(sequence, snapshotSequence_))
+        return;
+    snapshotSequence_ = sequence;
+
+    // Entries of nodes or components that have not been created yet are skipped. The snapshot is then not acknowledged,
+    // so that the server keeps sending their changes
+    bool complete = true;
+    while (!msg.IsEof())
+    {
+        unsigned id = msg.ReadNetID();
+        unsigned header = msg.ReadVLE();
+        unsigned size = header >> 1u;
+        unsigned position = msg.GetPosition();
+        if (size > msg.GetSize() - position)
+        {
+            URHO3D_LOGERROR("Malformed Snapshot message");
+            return;
+        }
+
+        MemoryBuffer entry(msg.GetData() + position, size);
+        msg.Seek(position + size);
+
+        if (header & 1u)
+        {
+            Component* component = scene_->GetComponent(id);
+            if (!component)
+                complete = false;
+            else if (component->ReadDeltaUpdate(entry))
+                component->ApplyAttributes();
+        }
+        else
+        {
+            Node* node = scene_->GetNode(id);
+            if (!node)
+                complete = false;
+            else
+            {
+                node->ReadDeltaUpdate(entry);
+                // ApplyAttributes() is deliberately skipped, as Node has no attributes that require late applying.
+                // Furthermore it would propagate to components and child nodes, which is not desired in this case
+            }
+        }
+    }
+
+    if (complete)
+        snapshotAcks_.Push(sequence);
+}
+
+void Connection::ProcessSnapshotAck(int msgID, MemoryBuffer& msg)
+{
+    if (!IsClient())
+    {
+        URHO3D_LOGWARNING("Received unexpected SnapshotAck message from server");
+        return;
+    }
+
+    if (snapshots_.Empty())
+        return;
+
+    // Each acknowledged snapshot that is still remembered becomes the new baseline of the nodes it contained
+    while (!msg.IsEof())
+    {
+        unsigned short sequence = msg.ReadUShort();
+        if ((unsigned short)(snapshotSequence_ - sequence) >= SNAPSHOT_HISTORY_SIZE)
+            continue;
+
+        const SnapshotRecord& snapshot = snapshots_[sequence % SNAPSHOT_HISTORY_SIZE];
+        for (unsigned i = 0; i < snapshot.nodes_.Size(); ++i)
+        {
+            HashMap<unsigned, NodeReplicationState>::Iterator j = sceneState_.nodeStates_.Find(snapshot.nodes_[i]);
+            if (j != sceneState_.nodeStates_.End())
+                j->second_.ackedSnapshotFrame_ = Max(j->second_.ackedSnapshotFrame_, snapshot.frame_);
+        }
+    }
+}
+
 bool Connection::RequestNeededPackages(unsigned numPackages, MemoryBuffer& msg)
 {
     auto* cache = GetSubsystem<ResourceCache>();
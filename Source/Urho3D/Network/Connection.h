@@ -42,8 +42,10 @@ namespace SLNet
 namespace Urho3D
 {
 
+class Component;
 class File;
 class MemoryBuffer;
+class NetworkInterestGrid;
 class Node;
 class Scene;
 class Serializable;
@@ -96,6 +98,15 @@ struct PackageUpload
     unsigned totalFragments_;
 };
 
+/// Sent snapshot message, remembered for matching its acknowledgement.
+struct SnapshotRecord
+{
+    /// Scene network frame at which the snapshot was sent.
+    unsigned frame_{};
+    /// ID's of the nodes whose changes were written to the snapshot.
+    PODVector<unsigned> nodes_;
+};
+
 /// Send modes for observer position/rotation. Activated by the client setting either position or rotation.
 enum ObserverPositionSendMode
 {
@@ -144,8 +155,10 @@ public:
     void SetLogStatistics(bool enable);
     /// Disconnect. If wait time is non-zero, will block while waiting for disconnect to finish.
     void Disconnect(int waitMSec = 0);
-    /// Send scene update messages. Called by Network.
+    /// Send scene update messages. Only reads the attribute values and world transforms prepared by Scene::PrepareNetworkUpdate() and does not modify the scene, so that different connections can be updated concurrently from worker threads. Called by Network.
     void SendServerUpdate();
+    /// Register and unregister the replication states that were created or removed during SendServerUpdate() to the scene objects. Must be called from the main thread afterward. Called by Network.
+    void FinishServerUpdate();
     /// Send latest controls from the client. Called by Network.
     void SendClientUpdate();
     /// Send queued remote events. Called by Network.
@@ -196,6 +209,12 @@ public:
     /// Return whether to log data in/out statistics.
     bool GetLogStatistics() const { return logStatistics_; }
 
+    /// Return number of nodes considered for replication during the last server update.
+    unsigned GetNumNodesConsidered() const { return numNodesConsidered_; }
+
+    /// Return number of nodes sent during the last server update.
+    unsigned GetNumNodesSent() const { return numNodesSent_; }
+
     /// Return remote address.
     String GetAddress() const;
 
@@ -214,6 +233,12 @@ public:
     /// Return bytes sent per second.
     float GetBytesOutPerSec() const;
 
+    /// Return total bytes received.
+    unsigned long long GetBytesReceived() const;
+
+    /// Return total bytes sent.
+    unsigned long long GetBytesSent() const;
+
     /// Return packets received per second.
     int GetPacketsInPerSec() const;
 
@@ -260,12 +285,24 @@ private:
     void ProcessSceneLoaded(int msgID, MemoryBuffer& msg);
     /// Process a remote event message from the client or server. Called by Network.
     void ProcessRemoteEvent(int msgID, MemoryBuffer& msg);
+    /// Find the root level nodes relevant to the observer, remove nodes that are no longer relevant from the client and queue the nodes that have become relevant.
+    void UpdateInterest(const NetworkInterestGrid* grid);
+    /// Return whether a node belongs to a relevant root level node.
+    bool IsRelevant(Node* node) const;
     /// Process a node for sending a network update. Recurses to process depended on node(s) first.
     void ProcessNode(unsigned nodeID);
     /// Process a node that the client has not yet received.
     void ProcessNewNode(Node* node);
     /// Process a node that the client has already received.
     void ProcessExistingNode(Node* node, NodeReplicationState& nodeState);
+    /// Write the attribute changes of the nodes and components with unacknowledged changes to size limited snapshots and send them.
+    void SendSnapshot();
+    /// Write the attributes of a node or component that changed after a scene network frame as a snapshot entry. Return false if there are none.
+    bool WriteSnapshotEntry(Serializer& dest, Serializable* serializable, unsigned id, bool isComponent, unsigned baseFrame);
+    /// Process a snapshot message from the server.
+    void ProcessSnapshot(int msgID, MemoryBuffer& msg);
+    /// Process a snapshot acknowledgement from the client.
+    void ProcessSnapshotAck(int msgID, MemoryBuffer& msg);
     /// Process a SyncPackagesInfo message from server.
     void ProcessPackageInfo(int msgID, MemoryBuffer& msg);
     /// Check a package list received from server and initiate package downloads as necessary. Return true on success, or false if failed to initialze downloads (cache dir not set)
@@ -293,8 +330,30 @@ private:
     HashMap<unsigned, PODVector<unsigned char> > nodeLatestData_;
     /// Pending latest data for not yet received components.
     HashMap<unsigned, PODVector<unsigned char> > componentLatestData_;
+    /// Node ID's with attribute changes not yet acknowledged by the client when using snapshot replication.
+    HashSet<unsigned> snapshotNodes_;
+    /// Sent snapshots, indexed by sequence number.
+    Vector<SnapshotRecord> snapshots_;
+    /// Snapshot sequence numbers to acknowledge on the client.
+    PODVector<unsigned short> snapshotAcks_;
+    /// Reusable snapshot entry buffer.
+    VectorBuffer snapshotEntry_;
+    /// Reusable buffer for the snapshot entries of one node and its components.
+    VectorBuffer snapshotNode_;
     /// Node ID's to process during a replication update.
-    HashSet<unsigned> nodesToProcess_;
+    IDBitSet nodesToProcess_;
+    /// Relevant root level node ID's during a replication update when using interest management.
+    HashSet<unsigned> relevantNodes_;
+    /// Interest management candidate nodes.
+    PODVector<Node*> interestNodes_;
+    /// Node replication states created during the server update, to be registered to their nodes.
+    PODVector<Pair<NodeReplicationState*, Node*> > newNodeStates_;
+    /// Component replication states created during the server update, to be registered to their components.
+    PODVector<Pair<ComponentReplicationState*, Component*> > newComponentStates_;
+    /// Node ID's whose replication states were removed during the server update.
+    PODVector<unsigned> removedNodeStates_;
+    /// Component ID's whose replication states were removed during the server update, along with the node replication state.
+    PODVector<Pair<NodeReplicationState*, unsigned> > removedComponentStates_;
     /// Reusable message buffer.
     VectorBuffer msg_;
     /// Queued remote events.
@@ -311,12 +370,20 @@ private:
     Quaternion rotation_;
     /// Send mode for the observer position & rotation.
     ObserverPositionSendMode sendMode_;
+    /// Sequence number of the last snapshot sent on the server, or received on the client.
+    unsigned short snapshotSequence_;
+    /// Number of nodes considered during the last server update.
+    unsigned numNodesConsidered_;
+    /// Number of nodes sent during the last server update.
+    unsigned numNodesSent_;
     /// Client connection flag.
     bool isClient_;
     /// Connection pending flag.
     bool connectPending_;
     /// Scene loaded flag.
     bool sceneLoaded_;
+    /// Snapshot replication flag, latched when the scene is set.
+    bool snapshotReplication_;
     /// Show statistics flag.
     bool logStatistics_;
     /// Address of this connection.
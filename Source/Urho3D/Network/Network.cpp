@@ -25,6 +25,7 @@
 #include "../Core/Context.h"
 #include "../Core/CoreEvents.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Engine/EngineEvents.h"
 #include "../IO/FileSystem.h"
 #include "../Input/InputEvents.h"
@@ -191,8 +192,14 @@ static const char* RAKNET_MESSAGEID_STRINGS[] = {
 };
 
 static const int DEFAULT_UPDATE_FPS = 30;
+static const float DEFAULT_INTEREST_CELL_SIZE = 50.0f;
 static const int SERVER_TIMEOUT_TIME = 10000;
 
+static void SendServerUpdateWork(const WorkItem* item, unsigned threadIndex)
+{
+    reinterpret_cast<Connection*>(item->aux_)->SendServerUpdate();
+}
+
 Network::Network(Context* context) :
     Object(context),
     updateFps_(DEFAULT_UPDATE_FPS),
@@ -200,7 +207,10 @@ Network::Network(Context* context) :
     simulatedPacketLoss_(0.0f),
     updateInterval_(1.0f / (float)DEFAULT_UPDATE_FPS),
     updateAcc_(0.0f),
+    interestRadius_(0.0f),
+    interestCellSize_(DEFAULT_INTEREST_CELL_SIZE),
     isServer_(false),
+    snapshotReplication_(false),
     scene_(nullptr),
     natPunchServerAddress_(nullptr),
     remoteGUID_(nullptr)
@@ -598,6 +608,28 @@ void Network::SetSimulatedPacketLoss(float probability)
     ConfigureNetworkSimulator();
 }
 
+void Network::SetInterestRadius(float radius)
+{
+    interestRadius_ = Max(radius, 0.0f);
+    if (interestRadius_ == 0.0f)
+        interestGrids_.Clear();
+}
+
+void Network::SetInterestCellSize(float size)
+{
+    interestCellSize_ = Max(size, M_EPSILON);
+}
+
+void Network::SetInterestFilter(const NetworkInterestFilter& filter)
+{
+    interestFilter_ = filter;
+}
+
+void Network::SetSnapshotReplication(bool enable)
+{
+    snapshotReplication_ = enable;
+}
+
 void Network::RegisterRemoteEvent(StringHash eventType)
 {
     if (blacklistedRemoteEvents_.Find(eventType) != blacklistedRemoteEvents_.End())
@@ -660,6 +692,15 @@ void Network::BanAddress(const String& address)
     rakPeer_->AddToBanList(address.CString(), 0);
 }
 
+const NetworkInterestGrid* Network::GetInterestGrid(Scene* scene) const
+{
+    if (interestRadius_ == 0.0f)
+        return nullptr;
+
+    HashMap<Scene*, NetworkInterestGrid>::ConstIterator i = interestGrids_.Find(scene);
+    return i != interestGrids_.End() ? &i->second_ : nullptr;
+}
+
 Connection* Network::GetConnection(const SLNet::AddressOrGUID& connection) const
 {
     if (serverConnection_ && serverConnection_->GetAddressOrGUID() == connection)
@@ -949,14 +990,54 @@ void Network::PostUpdate(float timeStep)
                     (*i)->PrepareNetworkUpdate();
             }
 
+            // Sort the nodes of the networked scenes for interest management, shared by all connections
+            if (interestRadius_ > 0.0f)
+            {
+                URHO3D_PROFILE("BuildInterestGrids");
+
+                for (HashMap<Scene*, NetworkInterestGrid>::Iterator i = interestGrids_.Begin(); i != interestGrids_.End();)
+                {
+                    if (!networkScenes_.Contains(i->first_))
+                        i = interestGrids_.Erase(i);
+                    else
+                        ++i;
+                }
+
+                for (HashSet<Scene*>::ConstIterator i = networkScenes_.Begin(); i != networkScenes_.End(); ++i)
+                    interestGrids_[*i].Build(*i, interestCellSize_);
+            }
+
             {
                 URHO3D_PROFILE("SendServerUpdate");
 
-                // Then send server updates for each client connection
+                // Then send server updates for each client connection. The connections only read the prepared attribute
+                // values and world transforms, so they can be processed in worker threads
+                auto* queue = GetSubsystem<WorkQueue>();
+                if (queue && queue->GetNumThreads() && clientConnections_.Size() > 1)
+                {
+                    for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+                         i != clientConnections_.End(); ++i)
+                    {
+                        SharedPtr<WorkItem> item = queue->GetFreeItem();
+                        item->priority_ = M_MAX_UNSIGNED;
+                        item->workFunction_ = SendServerUpdateWork;
+                        item->aux_ = i->second_.Get();
+                        queue->AddWorkItem(item);
+                    }
+
+                    queue->Complete(M_MAX_UNSIGNED);
+                }
+                else
+                {
+                    for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
+                         i != clientConnections_.End(); ++i)
+                        i->second_->SendServerUpdate();
+                }
+
                 for (HashMap<SLNet::AddressOrGUID, SharedPtr<Connection> >::Iterator i = clientConnections_.Begin();
                      i != clientConnections_.End(); ++i)
                 {
-                    i->second_->SendServerUpdate();
+                    i->second_->FinishServerUpdate();
                     i->second_->SendRemoteEvents();
                     i->second_->SendPackages();
                 }
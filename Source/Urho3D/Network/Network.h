@@ -26,6 +26,7 @@
 #include "../Core/Object.h"
 #include "../IO/VectorBuffer.h"
 #include "../Network/Connection.h"
+#include "../Network/NetworkInterest.h"
 
 namespace Urho3D
 {
@@ -86,10 +87,18 @@ public:
     void BroadcastRemoteEvent(Node* node, StringHash eventType, bool inOrder, const VariantMap& eventData = Variant::emptyVariantMap);
     /// Set network update FPS.
     void SetUpdateFps(int fps);
-    /// Set simulated latency in milliseconds. This adds a fixed delay before sending each packet.
+    /// Set simulated latency in milliseconds. This adds a fixed delay before sending each packet. Has no effect unless SLikeNet is compiled with _DEBUG defined.
     void SetSimulatedLatency(int ms);
-    /// Set simulated packet loss probability between 0.0 - 1.0.
+    /// Set simulated packet loss probability between 0.0 - 1.0. Has no effect unless SLikeNet is compiled with _DEBUG defined.
     void SetSimulatedPacketLoss(float probability);
+    /// Set interest management radius on the XZ plane around each connection's observer position. Only root level nodes within the radius, along with their children, are replicated to the connection. Nodes that leave a slightly larger radius are removed from the client. Zero (default) disables interest management.
+    void SetInterestRadius(float radius);
+    /// Set cell size of the interest management grid. Should be in the order of the interest radius. Default 50.
+    void SetInterestCellSize(float size);
+    /// Set custom relevancy check for root level nodes within the interest radius. May be called from worker threads during the server update.
+    void SetInterestFilter(const NetworkInterestFilter& filter);
+    /// Set whether to replicate attribute changes as unreliable snapshots against the last state acknowledged by each client, instead of reliable delta and latest data messages. Creation and removal of nodes and components, and user variables, are still sent reliably. Default false.
+    void SetSnapshotReplication(bool enable);
     /// Register a remote event as allowed to be received. There is also a fixed blacklist of events that can not be allowed in any case, such as ConsoleCommand.
     void RegisterRemoteEvent(StringHash eventType);
     /// Unregister a remote event as allowed to received.
@@ -113,6 +122,21 @@ public:
     /// Return simulated packet loss probability.
     float GetSimulatedPacketLoss() const { return simulatedPacketLoss_; }
 
+    /// Return interest management radius.
+    float GetInterestRadius() const { return interestRadius_; }
+
+    /// Return cell size of the interest management grid.
+    float GetInterestCellSize() const { return interestCellSize_; }
+
+    /// Return custom relevancy check.
+    const NetworkInterestFilter& GetInterestFilter() const { return interestFilter_; }
+
+    /// Return whether snapshot replication is used.
+    bool GetSnapshotReplication() const { return snapshotReplication_; }
+
+    /// Return the interest management grid of a networked scene, or null if interest management is disabled. Valid during the server update.
+    const NetworkInterestGrid* GetInterestGrid(Scene* scene) const;
+
     /// Return a client or server connection by RakNet connection address, or null if none exist.
     Connection* GetConnection(const SLNet::AddressOrGUID& connection) const;
     /// Return the connection to the server. Null if not connected.
@@ -160,6 +184,10 @@ private:
     HashSet<StringHash> blacklistedRemoteEvents_;
     /// Networked scenes.
     HashSet<Scene*> networkScenes_;
+    /// Interest management grids of networked scenes.
+    HashMap<Scene*, NetworkInterestGrid> interestGrids_;
+    /// Custom relevancy check.
+    NetworkInterestFilter interestFilter_;
     /// Update FPS.
     int updateFps_;
     /// Simulated latency (send delay) in milliseconds.
@@ -170,10 +198,16 @@ private:
     float updateInterval_;
     /// Update time accumulator.
     float updateAcc_;
+    /// Interest management radius.
+    float interestRadius_;
+    /// Interest management grid cell size.
+    float interestCellSize_;
     /// Package cache directory.
     String packageCacheDir_;
     /// Whether we started as server or not.
     bool isServer_;
+    /// Snapshot replication flag.
+    bool snapshotReplication_;
     /// Server/Client password used for connecting.
     String password_;
     /// Scene which will be used for NAT punchtrough connections.
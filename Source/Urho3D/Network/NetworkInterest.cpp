@@ -0,0 +1,114 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Network/NetworkInterest.h"
+#include "../Network/NetworkPriority.h"
+#include "../Scene/Scene.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+NetworkInterestGrid::NetworkInterestGrid() :
+    scene_(nullptr),
+    cellSize_(1.0f),
+    numNodes_(0)
+{
+}
+
+void NetworkInterestGrid::Build(Scene* scene, float cellSize)
+{
+    // Clear the cells but keep their storage, as the same cells are likely to be occupied on the next update
+    for (HashMap<IntVector2, PODVector<Node*> >::Iterator i = cells_.Begin(); i != cells_.End(); ++i)
+        i->second_.Clear();
+    alwaysRelevantNodes_.Clear();
+    ownedNodes_.Clear();
+    numNodes_ = 0;
+
+    if (scene_ != scene || cellSize_ != cellSize)
+    {
+        cells_.Clear();
+        scene_ = scene;
+        cellSize_ = Max(cellSize, M_EPSILON);
+    }
+
+    if (!scene_)
+        return;
+
+    const Vector<SharedPtr<Node> >& children = scene_->GetChildren();
+    for (Vector<SharedPtr<Node> >::ConstIterator i = children.Begin(); i != children.End(); ++i)
+    {
+        Node* node = *i;
+        if (!node->IsReplicated())
+            continue;
+
+        if (node->GetOwner())
+            ownedNodes_.Push(node);
+
+        auto* priority = node->GetComponent<NetworkPriority>();
+        if (priority && priority->GetAlwaysRelevant())
+            alwaysRelevantNodes_.Push(node);
+        else
+        {
+            cells_[GetCellCoords(node->GetWorldPosition())].Push(node);
+            ++numNodes_;
+        }
+    }
+}
+
+void NetworkInterestGrid::Query(const Vector3& center, float radius, PODVector<Node*>& dest) const
+{
+    IntVector2 minCoords = GetCellCoords(center - Vector3(radius, 0.0f, radius));
+    IntVector2 maxCoords = GetCellCoords(center + Vector3(radius, 0.0f, radius));
+
+    // If the area covers more cells than there are allocated, go through the allocated cells instead
+    if ((unsigned long long)(maxCoords.x_ - minCoords.x_ + 1) * (maxCoords.y_ - minCoords.y_ + 1) > cells_.Size())
+    {
+        for (HashMap<IntVector2, PODVector<Node*> >::ConstIterator i = cells_.Begin(); i != cells_.End(); ++i)
+        {
+            const IntVector2& coords = i->first_;
+            if (coords.x_ >= minCoords.x_ && coords.x_ <= maxCoords.x_ && coords.y_ >= minCoords.y_ && coords.y_ <= maxCoords.y_)
+                dest.Push(i->second_);
+        }
+        return;
+    }
+
+    for (int y = minCoords.y_; y <= maxCoords.y_; ++y)
+    {
+        for (int x = minCoords.x_; x <= maxCoords.x_; ++x)
+        {
+            HashMap<IntVector2, PODVector<Node*> >::ConstIterator i = cells_.Find(IntVector2(x, y));
+            if (i != cells_.End())
+                dest.Push(i->second_);
+        }
+    }
+}
+
+IntVector2 NetworkInterestGrid::GetCellCoords(const Vector3& position) const
+{
+    return IntVector2(FloorToInt(position.x_ / cellSize_), FloorToInt(position.z_ / cellSize_));
+}
+
+}
@@ -0,0 +1,82 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Container/HashMap.h"
+#include "../Math/Vector2.h"
+#include "../Math/Vector3.h"
+
+#include <functional>
+
+namespace Urho3D
+{
+
+class Connection;
+class Node;
+class Scene;
+
+/// Custom relevancy check of a root level node within a connection's interest radius. Return false to not replicate the node to the connection.
+using NetworkInterestFilter = std::function<bool(Connection*, Node*)>;
+
+/// Spatial grid of a scene's replicated root level nodes on the XZ plane. Rebuilt by Network once per server update, and used by connections to find the nodes near their observer position instead of replicating the whole scene.
+class URHO3D_API NetworkInterestGrid
+{
+public:
+    /// Construct.
+    NetworkInterestGrid();
+
+    /// Sort the replicated root level nodes of a scene into cells. Nodes marked always relevant in their NetworkPriority component and nodes with an owner connection are stored separately.
+    void Build(Scene* scene, float cellSize);
+    /// Return the nodes of the cells overlapping a circle on the XZ plane. The nodes are not tested for the exact distance.
+    void Query(const Vector3& center, float radius, PODVector<Node*>& dest) const;
+
+    /// Return the scene.
+    Scene* GetScene() const { return scene_; }
+    /// Return cell size.
+    float GetCellSize() const { return cellSize_; }
+    /// Return number of nodes sorted into cells.
+    unsigned GetNumNodes() const { return numNodes_; }
+    /// Return the nodes that are relevant to all connections.
+    const PODVector<Node*>& GetAlwaysRelevantNodes() const { return alwaysRelevantNodes_; }
+    /// Return the nodes that have an owner connection. These are always relevant to their owner.
+    const PODVector<Node*>& GetOwnedNodes() const { return ownedNodes_; }
+
+private:
+    /// Return cell coordinates of a position.
+    IntVector2 GetCellCoords(const Vector3& position) const;
+
+    /// Nodes by cell coordinates. Cells are kept allocated between rebuilds.
+    HashMap<IntVector2, PODVector<Node*> > cells_;
+    /// Always relevant nodes.
+    PODVector<Node*> alwaysRelevantNodes_;
+    /// Nodes with an owner connection.
+    PODVector<Node*> ownedNodes_;
+    /// Scene.
+    Scene* scene_;
+    /// Cell size.
+    float cellSize_;
+    /// Number of nodes in cells.
+    unsigned numNodes_;
+};
+
+}
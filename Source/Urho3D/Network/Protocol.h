@@ -63,10 +63,20 @@ static const int MSG_REMOTEEVENT = 0x96;
 static const int MSG_REMOTENODEEVENT = 0x97;
 /// Server->client: info about package.
 static const int MSG_PACKAGEINFO = 0x98;
+/// Server->client: attribute changes of nodes and components since the last acknowledged snapshot.
+static const int MSG_SNAPSHOT = 0x99;
+/// Client->server: acknowledge received snapshots.
+static const int MSG_SNAPSHOTACK = 0x9a;
 
 /// Fixed content ID for client controls update.
 static const unsigned CONTROLS_CONTENT_ID = 1;
 /// Package file fragment size.
 static const unsigned PACKAGE_FRAGMENT_SIZE = 1024;
+/// Number of sent snapshots remembered for matching acknowledgements.
+static const unsigned SNAPSHOT_HISTORY_SIZE = 64;
+/// Snapshot message size above which the changes are split to another snapshot, to stay within one datagram.
+static const unsigned SNAPSHOT_MAX_SIZE = 1200;
+/// Maximum number of snapshots sent per network update, so that the history covers the acknowledgements of several updates.
+static const unsigned SNAPSHOT_MAX_PER_UPDATE = 8;
 
 }
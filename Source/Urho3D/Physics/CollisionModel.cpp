@@ -0,0 +1,439 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Graphics/Geometry.h"
+#include "../Graphics/Model.h"
+#include "../Graphics/VertexBuffer.h"
+#include "../IO/ContentCache.h"
+#include "../IO/File.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/MemoryMappedFile.h"
+#include "../IO/VectorBuffer.h"
+#include "../Physics/CollisionModel.h"
+#include "../Physics/PhysicsUtils.h"
+
+#include <Bullet/BulletCollision/CollisionShapes/btBvhTriangleMeshShape.h>
+#include <Bullet/BulletCollision/CollisionShapes/btOptimizedBvh.h>
+#include <Bullet/BulletCollision/CollisionShapes/btTriangleInfoMap.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Alignment of the in-place BVH data, in the file and in memory.
+static const unsigned BVH_ALIGNMENT = 16;
+/// Size of the common part of an entry in the file: shape type, LOD level, triangle and vertex counts and geometry hash.
+static const unsigned ENTRY_HEADER_SIZE = 1 + 3 * sizeof(unsigned) + sizeof(unsigned long long);
+/// Size of a triangle info in the file: key, flags and three edge angles.
+static const unsigned TRIANGLE_INFO_SIZE = 2 * sizeof(int) + 3 * sizeof(float);
+
+/// Allocate storage aligned for a BVH. Return the aligned start.
+static unsigned char* AllocateAligned(SharedArrayPtr<unsigned char>& storage, unsigned size)
+{
+    storage = new unsigned char[size + BVH_ALIGNMENT - 1];
+    return storage.Get() + ((BVH_ALIGNMENT - ((size_t)storage.Get() & (BVH_ALIGNMENT - 1))) & (BVH_ALIGNMENT - 1));
+}
+
+/// Return whether a buffer has at least the given number of bytes left.
+static bool HasRemaining(const MemoryBuffer& buffer, unsigned long long size)
+{
+    return buffer.GetSize() - buffer.GetPosition() >= size;
+}
+
+/// Count the triangles and vertices of a model's LOD level and hash their positions and indices, for detecting a changed model.
+static void GetGeometryInfo(Model* model, unsigned lodLevel, unsigned& numTriangles, unsigned& numVertices,
+    unsigned long long& hash)
+{
+    numTriangles = 0;
+    numVertices = 0;
+    hash = ContentCache::Hash(nullptr, 0);
+
+    for (unsigned i = 0; i < model->GetNumGeometries(); ++i)
+    {
+        Geometry* geometry = model->GetGeometry(i, lodLevel);
+        if (!geometry)
+            continue;
+        numTriangles += geometry->GetIndexCount() / 3;
+        numVertices += geometry->GetVertexCount();
+
+        const unsigned char* vertexData;
+        const unsigned char* indexData;
+        unsigned vertexSize;
+        unsigned indexSize;
+        const PODVector<VertexElement>* elements;
+        geometry->GetRawData(vertexData, vertexSize, indexData, indexSize, elements);
+
+        const unsigned positionOffset = elements ? VertexBuffer::GetElementOffset(*elements, TYPE_VECTOR3, SEM_POSITION) :
+            M_MAX_UNSIGNED;
+        if (vertexData && positionOffset != M_MAX_UNSIGNED)
+        {
+            const unsigned char* position = vertexData + geometry->GetVertexStart() * vertexSize + positionOffset;
+            for (unsigned j = 0; j < geometry->GetVertexCount(); ++j, position += vertexSize)
+                hash = ContentCache::Hash(position, sizeof(Vector3), hash);
+        }
+        if (indexData)
+        {
+            hash = ContentCache::Hash(indexData + geometry->GetIndexStart() * indexSize, geometry->GetIndexCount() * indexSize,
+                hash);
+        }
+    }
+}
+
+CollisionModel::CollisionModel(Context* context) :
+    Resource(context)
+{
+}
+
+CollisionModel::~CollisionModel() = default;
+
+void CollisionModel::RegisterObject(Context* context)
+{
+    context->RegisterFactory<CollisionModel>();
+}
+
+bool CollisionModel::BeginLoad(Deserializer& source)
+{
+    URHO3D_PROFILE("LoadCollisionModel");
+
+    entries_.Clear();
+
+    // Map files directly, so that the BVHs can be used in place. The mapping is copy-on-write, as the BVH headers are fixed
+    // up when deserializing. Other sources are read into memory whole
+    SharedPtr<MemoryMappedFile> mappedFile;
+    SharedArrayPtr<unsigned char> storage;
+    unsigned char* data = nullptr;
+    unsigned size = 0;
+
+    auto* file = dynamic_cast<File*>(&source);
+    if (file && !source.GetPosition())
+    {
+        mappedFile = new MemoryMappedFile();
+        if (mappedFile->Open(file, true))
+        {
+            data = mappedFile->GetWritableData();
+            size = mappedFile->GetSize();
+        }
+        else
+        {
+            mappedFile.Reset();
+            source.Seek(0);
+        }
+    }
+
+    if (!data)
+    {
+        size = source.GetSize() - source.GetPosition();
+        data = AllocateAligned(storage, size);
+        if (source.Read(data, size) != size)
+        {
+            URHO3D_LOGERROR("Could not read collision model from " + source.GetName());
+            return false;
+        }
+    }
+
+    MemoryBuffer buffer(data, size);
+    if (buffer.ReadFileID() != "UCOL")
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid collision model file");
+        return false;
+    }
+
+    // The BVH is stored as its in-memory layout, which depends on the platform and the Bullet build
+    if (buffer.ReadUInt() != sizeof(btQuantizedBvh))
+    {
+        URHO3D_LOGWARNING(source.GetName() + " was cooked for a different platform, collision geometry will be built at runtime");
+        entries_.Clear();
+        return true;
+    }
+
+    // Counts read from the file are checked against the remaining data before use, so that a corrupt file can not cause
+    // huge allocations or reads past the end
+    unsigned numEntries = buffer.ReadUInt();
+    for (unsigned i = 0; i < numEntries; ++i)
+    {
+        if (!HasRemaining(buffer, ENTRY_HEADER_SIZE))
+        {
+            URHO3D_LOGERROR("Truncated collision model " + source.GetName());
+            entries_.Clear();
+            return false;
+        }
+
+        SharedPtr<Entry> entry(new Entry());
+        entry->shapeType_ = (ShapeType)buffer.ReadUByte();
+        entry->lodLevel_ = buffer.ReadUInt();
+        entry->numTriangles_ = buffer.ReadUInt();
+        entry->numVertices_ = buffer.ReadUInt();
+        entry->geometryHash_ = buffer.ReadUInt64();
+
+        if (entry->shapeType_ == SHAPE_TRIANGLEMESH)
+        {
+            entry->boundingBox_ = buffer.ReadBoundingBox();
+
+            entry->loadedInfoMap_ = new btTriangleInfoMap();
+            unsigned numInfos = buffer.ReadUInt();
+            if (!HasRemaining(buffer, (unsigned long long)numInfos * TRIANGLE_INFO_SIZE))
+            {
+                URHO3D_LOGERROR("Truncated triangle info data in collision model " + source.GetName());
+                entries_.Clear();
+                return false;
+            }
+            for (unsigned j = 0; j < numInfos; ++j)
+            {
+                int key = buffer.ReadInt();
+                btTriangleInfo info;
+                info.m_flags = buffer.ReadInt();
+                info.m_edgeV0V1Angle = buffer.ReadFloat();
+                info.m_edgeV1V2Angle = buffer.ReadFloat();
+                info.m_edgeV2V0Angle = buffer.ReadFloat();
+                entry->loadedInfoMap_->insert(key, info);
+            }
+            entry->infoMap_ = entry->loadedInfoMap_.Get();
+
+            unsigned bvhSize = buffer.ReadUInt();
+            buffer.Seek((buffer.GetPosition() + BVH_ALIGNMENT - 1) & ~(BVH_ALIGNMENT - 1));
+            if (!HasRemaining(buffer, bvhSize))
+            {
+                URHO3D_LOGERROR("Truncated BVH data in collision model " + source.GetName());
+                entries_.Clear();
+                return false;
+            }
+
+            // Copy the BVH only if the source data is not aligned, for example when mapped from a package
+            unsigned char* bvhData = data + buffer.GetPosition();
+            if ((size_t)bvhData & (BVH_ALIGNMENT - 1))
+            {
+                unsigned char* alignedData = AllocateAligned(entry->storage_, bvhSize);
+                memcpy(alignedData, bvhData, bvhSize);
+                bvhData = alignedData;
+            }
+            else
+            {
+                entry->mappedFile_ = mappedFile;
+                entry->storage_ = storage;
+            }
+
+            entry->bvh_ = static_cast<btOptimizedBvh*>(btOptimizedBvh::deSerializeInPlace(bvhData, bvhSize, false));
+            if (!entry->bvh_)
+            {
+                URHO3D_LOGERROR("Invalid BVH data in collision model " + source.GetName());
+                entries_.Clear();
+                return false;
+            }
+            buffer.Seek(buffer.GetPosition() + bvhSize);
+        }
+        else if (entry->shapeType_ == SHAPE_CONVEXHULL)
+        {
+            entry->vertexCount_ = buffer.ReadUInt();
+            if (!HasRemaining(buffer, (unsigned long long)entry->vertexCount_ * sizeof(Vector3) + sizeof(unsigned)))
+            {
+                URHO3D_LOGERROR("Truncated convex hull data in collision model " + source.GetName());
+                entries_.Clear();
+                return false;
+            }
+            entry->vertexData_ = new Vector3[entry->vertexCount_];
+            buffer.Read(entry->vertexData_.Get(), entry->vertexCount_ * sizeof(Vector3));
+
+            entry->indexCount_ = buffer.ReadUInt();
+            if (!HasRemaining(buffer, (unsigned long long)entry->indexCount_ * sizeof(unsigned)))
+            {
+                URHO3D_LOGERROR("Truncated convex hull data in collision model " + source.GetName());
+                entries_.Clear();
+                return false;
+            }
+            entry->indexData_ = new unsigned[entry->indexCount_];
+            buffer.Read(entry->indexData_.Get(), entry->indexCount_ * sizeof(unsigned));
+
+            for (unsigned j = 0; j < entry->indexCount_; ++j)
+            {
+                if (entry->indexData_[j] >= entry->vertexCount_)
+                {
+                    URHO3D_LOGERROR("Invalid convex hull index in collision model " + source.GetName());
+                    entries_.Clear();
+                    return false;
+                }
+            }
+        }
+        else
+        {
+            URHO3D_LOGERROR("Unsupported shape type in collision model " + source.GetName());
+            entries_.Clear();
+            return false;
+        }
+
+        entries_.Push(entry);
+    }
+
+    SetMemoryUse(sizeof(CollisionModel) + size);
+    return true;
+}
+
+bool CollisionModel::Save(Serializer& dest) const
+{
+    // Write to a buffer first, so that the BVHs can be aligned relative to the start of the file
+    VectorBuffer buffer;
+    buffer.WriteFileID("UCOL");
+    buffer.WriteUInt(sizeof(btQuantizedBvh));
+    buffer.WriteUInt(entries_.Size());
+
+    for (unsigned i = 0; i < entries_.Size(); ++i)
+    {
+        const Entry& entry = *entries_[i];
+        buffer.WriteUByte((unsigned char)entry.shapeType_);
+        buffer.WriteUInt(entry.lodLevel_);
+        buffer.WriteUInt(entry.numTriangles_);
+        buffer.WriteUInt(entry.numVertices_);
+        buffer.WriteUInt64(entry.geometryHash_);
+
+        if (entry.shapeType_ == SHAPE_TRIANGLEMESH)
+        {
+            buffer.WriteBoundingBox(entry.boundingBox_);
+
+            unsigned numInfos = (unsigned)entry.infoMap_->size();
+            buffer.WriteUInt(numInfos);
+            for (unsigned j = 0; j < numInfos; ++j)
+            {
+                const btTriangleInfo* info = entry.infoMap_->getAtIndex(j);
+                buffer.WriteInt(entry.infoMap_->getKeyAtIndex(j).getUid1());
+                buffer.WriteInt(info->m_flags);
+                buffer.WriteFloat(info->m_edgeV0V1Angle);
+                buffer.WriteFloat(info->m_edgeV1V2Angle);
+                buffer.WriteFloat(info->m_edgeV2V0Angle);
+            }
+
+            unsigned bvhSize = entry.bvh_->calculateSerializeBufferSize();
+            buffer.WriteUInt(bvhSize);
+            while (buffer.GetPosition() & (BVH_ALIGNMENT - 1))
+                buffer.WriteUByte(0);
+
+            SharedArrayPtr<unsigned char> storage;
+            unsigned char* bvhData = AllocateAligned(storage, bvhSize);
+            entry.bvh_->serialize(bvhData, bvhSize, false);
+            buffer.Write(bvhData, bvhSize);
+        }
+        else
+        {
+            buffer.WriteUInt(entry.vertexCount_);
+            buffer.Write(entry.vertexData_.Get(), entry.vertexCount_ * sizeof(Vector3));
+            buffer.WriteUInt(entry.indexCount_);
+            buffer.Write(entry.indexData_.Get(), entry.indexCount_ * sizeof(unsigned));
+        }
+    }
+
+    return dest.Write(buffer.GetData(), buffer.GetSize()) == buffer.GetSize();
+}
+
+bool CollisionModel::Cook(ShapeType shapeType, Model* model, unsigned lodLevel)
+{
+    if (!model)
+    {
+        URHO3D_LOGERROR("Null model, can not cook collision geometry");
+        return false;
+    }
+    if (shapeType != SHAPE_TRIANGLEMESH && shapeType != SHAPE_CONVEXHULL)
+    {
+        URHO3D_LOGERROR("Only triangle mesh and convex hull collision geometry can be cooked");
+        return false;
+    }
+
+    URHO3D_PROFILE("CookCollisionModel");
+
+    SharedPtr<Entry> entry(new Entry());
+    entry->shapeType_ = shapeType;
+    entry->lodLevel_ = lodLevel;
+    GetGeometryInfo(model, lodLevel, entry->numTriangles_, entry->numVertices_, entry->geometryHash_);
+
+    if (shapeType == SHAPE_TRIANGLEMESH)
+    {
+        entry->cookedGeometry_ = new TriangleMeshData(model, lodLevel);
+        btBvhTriangleMeshShape* shape = entry->cookedGeometry_->shape_.Get();
+        entry->bvh_ = shape->getOptimizedBvh();
+        entry->infoMap_ = entry->cookedGeometry_->infoMap_.Get();
+        entry->boundingBox_ = BoundingBox(ToVector3(shape->getLocalAabbMin()), ToVector3(shape->getLocalAabbMax()));
+        if (!entry->bvh_)
+        {
+            URHO3D_LOGERROR("Could not build triangle mesh BVH of model " + model->GetName());
+            return false;
+        }
+    }
+    else
+    {
+        SharedPtr<ConvexData> convex(new ConvexData(model, lodLevel));
+        entry->vertexData_ = convex->vertexData_;
+        entry->vertexCount_ = convex->vertexCount_;
+        entry->indexData_ = convex->indexData_;
+        entry->indexCount_ = convex->indexCount_;
+    }
+
+    // Replace an earlier entry, geometry data created from it keeps it alive
+    for (unsigned i = 0; i < entries_.Size(); ++i)
+    {
+        if (entries_[i]->shapeType_ == shapeType && entries_[i]->lodLevel_ == lodLevel)
+        {
+            entries_[i] = entry;
+            return true;
+        }
+    }
+
+    entries_.Push(entry);
+    return true;
+}
+
+CollisionGeometryData* CollisionModel::CreateGeometryData(ShapeType shapeType, Model* model, unsigned lodLevel)
+{
+    Entry* entry = FindEntry(shapeType, lodLevel);
+    if (!entry || !model)
+        return nullptr;
+
+    unsigned numTriangles, numVertices;
+    unsigned long long hash;
+    GetGeometryInfo(model, lodLevel, numTriangles, numVertices, hash);
+    if (numTriangles != entry->numTriangles_ || numVertices != entry->numVertices_ || hash != entry->geometryHash_)
+    {
+        URHO3D_LOGWARNING("Collision model " + GetName() + " does not match model " + model->GetName() +
+            ", collision geometry will be built at runtime");
+        return nullptr;
+    }
+
+    if (shapeType == SHAPE_TRIANGLEMESH)
+        return new TriangleMeshData(model, lodLevel, entry, entry->bvh_, entry->infoMap_, entry->boundingBox_);
+    else
+        return new ConvexData(entry->vertexData_, entry->vertexCount_, entry->indexData_, entry->indexCount_);
+}
+
+CollisionModel::Entry* CollisionModel::FindEntry(ShapeType shapeType, unsigned lodLevel) const
+{
+    for (unsigned i = 0; i < entries_.Size(); ++i)
+    {
+        if (entries_[i]->shapeType_ == shapeType && entries_[i]->lodLevel_ == lodLevel)
+            return entries_[i].Get();
+    }
+
+    return nullptr;
+}
+
+}
@@ -0,0 +1,104 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Physics/CollisionShape.h"
+#include "../Resource/Resource.h"
+
+namespace Urho3D
+{
+
+class MemoryMappedFile;
+
+/// Precooked collision geometry of a model: triangle mesh BVHs and convex hulls per LOD level. When saved next to a model with the .col extension, CollisionShape uses it instead of building the geometry at load time.
+class URHO3D_API CollisionModel : public Resource
+{
+    URHO3D_OBJECT(CollisionModel, Resource);
+
+public:
+    /// Construct.
+    explicit CollisionModel(Context* context);
+    /// Destruct.
+    ~CollisionModel() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Save resource. Return true if successful.
+    bool Save(Serializer& dest) const override;
+
+    /// Cook triangle mesh or convex hull geometry of a model's LOD level. Replaces earlier data of the same shape type and LOD level. Return true if successful.
+    bool Cook(ShapeType shapeType, Model* model, unsigned lodLevel);
+    /// Create collision geometry data for a model's LOD level from the precooked data. Return null if not cooked, or if the model no longer matches the cooked data.
+    CollisionGeometryData* CreateGeometryData(ShapeType shapeType, Model* model, unsigned lodLevel);
+
+    /// Return number of cooked entries.
+    unsigned GetNumEntries() const { return entries_.Size(); }
+
+private:
+    /// Cooked geometry of one shape type and LOD level. Reference counted, as triangle mesh data created from it uses its BVH in place, also across reloads of the collision model.
+    struct Entry : public RefCounted
+    {
+        /// Shape type, either triangle mesh or convex hull.
+        ShapeType shapeType_{};
+        /// Model LOD level.
+        unsigned lodLevel_{};
+        /// Number of triangles in the source geometry, for detecting a changed model.
+        unsigned numTriangles_{};
+        /// Number of vertices in the source geometry, for detecting a changed model.
+        unsigned numVertices_{};
+        /// Hash of the source geometry positions and indices, for detecting a changed model.
+        unsigned long long geometryHash_{};
+        /// Triangle mesh bounding box.
+        BoundingBox boundingBox_;
+        /// Triangle mesh BVH. Points to the loaded data or to the cooked geometry.
+        btOptimizedBvh* bvh_{};
+        /// Triangle info map. Points to the loaded map or to the cooked geometry.
+        btTriangleInfoMap* infoMap_{};
+        /// Triangle info map deserialized on load.
+        UniquePtr<btTriangleInfoMap> loadedInfoMap_;
+        /// Geometry cooked from a model, which owns the BVH and the triangle info map.
+        SharedPtr<TriangleMeshData> cookedGeometry_;
+        /// Mapped file the loaded BVH points to.
+        SharedPtr<MemoryMappedFile> mappedFile_;
+        /// Storage the loaded BVH points to when the file could not be mapped or the data was not aligned.
+        SharedArrayPtr<unsigned char> storage_;
+        /// Convex hull vertex data.
+        SharedArrayPtr<Vector3> vertexData_;
+        /// Number of convex hull vertices.
+        unsigned vertexCount_{};
+        /// Convex hull index data.
+        SharedArrayPtr<unsigned> indexData_;
+        /// Number of convex hull indices.
+        unsigned indexCount_{};
+    };
+
+    /// Return the entry for a shape type and LOD level, or null if not cooked.
+    Entry* FindEntry(ShapeType shapeType, unsigned lodLevel) const;
+
+    /// Cooked entries.
+    Vector<SharedPtr<Entry> > entries_;
+};
+
+}
@@ -32,7 +32,9 @@
 #include "../Graphics/Model.h"
 #include "../Graphics/Terrain.h"
 #include "../Graphics/VertexBuffer.h"
+#include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../Physics/CollisionModel.h"
 #include "../Physics/CollisionShape.h"
 #include "../Physics/PhysicsUtils.h"
 #include "../Physics/PhysicsWorld.h"
@@ -214,6 +216,18 @@ TriangleMeshData::TriangleMeshData(CustomGeometry* custom)
     btGenerateInternalEdgeInfo(shape_.Get(), infoMap_.Get());
 }
 
+TriangleMeshData::TriangleMeshData(Model* model, unsigned lodLevel, RefCounted* cookedData, btOptimizedBvh* bvh,
+    btTriangleInfoMap* infoMap, const BoundingBox& boundingBox) :
+    cookedData_(cookedData)
+{
+    meshInterface_ = new TriangleMeshInterface(model, lodLevel);
+    // Skip both the BVH build and the bounding box calculation over all triangles
+    meshInterface_->setPremadeAabb(ToBtVector3(boundingBox.min_), ToBtVector3(boundingBox.max_));
+    shape_ = new btBvhTriangleMeshShape(meshInterface_.Get(), meshInterface_->useQuantize_, false);
+    shape_->setOptimizedBvh(bvh);
+    shape_->setTriangleInfoMap(infoMap);
+}
+
 GImpactMeshData::GImpactMeshData(Model* model, unsigned lodLevel)
 {
     meshInterface_ = new TriangleMeshInterface(model, lodLevel);
@@ -279,6 +293,15 @@ ConvexData::ConvexData(CustomGeometry* custom)
     BuildHull(vertices);
 }
 
+ConvexData::ConvexData(const SharedArrayPtr<Vector3>& vertexData, unsigned vertexCount, const SharedArrayPtr<unsigned>& indexData,
+    unsigned indexCount) :
+    vertexData_(vertexData),
+    vertexCount_(vertexCount),
+    indexData_(indexData),
+    indexCount_(indexCount)
+{
+}
+
 void ConvexData::BuildHull(const PODVector<Vector3>& vertices)
 {
     if (vertices.Size())
@@ -409,6 +432,21 @@ CollisionGeometryData* CreateCollisionGeometryData(ShapeType shapeType, Model* m
     }
 }
 
+CollisionGeometryData* CreateCookedCollisionGeometryData(ShapeType shapeType, Model* model, unsigned lodLevel)
+{
+    if ((shapeType != SHAPE_TRIANGLEMESH && shapeType != SHAPE_CONVEXHULL) || model->GetName().Empty())
+        return nullptr;
+
+    // Precooked collision geometry is stored next to the model with the same name
+    auto* cache = model->GetSubsystem<ResourceCache>();
+    String cookedName = ReplaceExtension(model->GetName(), ".col");
+    if (!cache->Exists(cookedName))
+        return nullptr;
+
+    auto* cookedModel = cache->GetResource<CollisionModel>(cookedName);
+    return cookedModel ? cookedModel->CreateGeometryData(shapeType, model, lodLevel) : nullptr;
+}
+
 CollisionGeometryData* CreateCollisionGeometryData(ShapeType shapeType, CustomGeometry* custom)
 {
     switch (shapeType)
@@ -1122,10 +1160,13 @@ void CollisionShape::UpdateCachedGeometryShape(CollisionGeometryDataCache& cache
             geometry_ = cachedGeometry->second_;
         else
         {
-            geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_);
+            // Check if model has dynamic buffers, do not use precooked geometry or cache in that case
+            bool dynamic = HasDynamicBuffers(model_, lodLevel_);
+            geometry_ = !dynamic ? CreateCookedCollisionGeometryData(shapeType_, model_, lodLevel_) : nullptr;
+            if (!geometry_)
+                geometry_ = CreateCollisionGeometryData(shapeType_, model_, lodLevel_);
             assert(geometry_);
-            // Check if model has dynamic buffers, do not cache in that case
-            if (!HasDynamicBuffers(model_, lodLevel_))
+            if (!dynamic)
                 cache[id] = geometry_;
         }
 
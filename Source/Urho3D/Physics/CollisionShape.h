@@ -31,6 +31,7 @@ class btBvhTriangleMeshShape;
 class btCollisionShape;
 class btCompoundShape;
 class btGImpactMeshShape;
+class btOptimizedBvh;
 class btTriangleMesh;
 
 struct btTriangleInfoMap;
@@ -77,13 +78,18 @@ struct TriangleMeshData : public CollisionGeometryData
     TriangleMeshData(Model* model, unsigned lodLevel);
     /// Construct from a custom geometry.
     explicit TriangleMeshData(CustomGeometry* custom);
+    /// Construct from a model using a precooked BVH and triangle info map, which are owned by the precooked data.
+    TriangleMeshData(Model* model, unsigned lodLevel, RefCounted* cookedData, btOptimizedBvh* bvh, btTriangleInfoMap* infoMap,
+        const BoundingBox& boundingBox);
 
     /// Bullet triangle mesh interface.
     UniquePtr<TriangleMeshInterface> meshInterface_;
     /// Bullet triangle mesh collision shape.
     UniquePtr<btBvhTriangleMeshShape> shape_;
-    /// Bullet triangle info map.
+    /// Bullet triangle info map. Null when using precooked data.
     UniquePtr<btTriangleInfoMap> infoMap_;
+    /// Precooked data that owns the BVH and the triangle info map, if any.
+    SharedPtr<RefCounted> cookedData_;
 };
 
 /// Triangle mesh geometry data.
@@ -105,6 +111,9 @@ struct ConvexData : public CollisionGeometryData
     ConvexData(Model* model, unsigned lodLevel);
     /// Construct from a custom geometry.
     explicit ConvexData(CustomGeometry* custom);
+    /// Construct from precooked hull vertices and indices.
+    ConvexData(const SharedArrayPtr<Vector3>& vertexData, unsigned vertexCount, const SharedArrayPtr<unsigned>& indexData,
+        unsigned indexCount);
 
     /// Build the convex hull from vertices.
     void BuildHull(const PODVector<Vector3>& vertices);
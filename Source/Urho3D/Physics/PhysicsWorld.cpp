@@ -25,10 +25,13 @@
 #include "../Core/Context.h"
 #include "../Core/Mutex.h"
 #include "../Core/Profiler.h"
+#include "../Core/Thread.h"
+#include "../Core/WorkQueue.h"
 #include "../Graphics/DebugRenderer.h"
 #include "../Graphics/Model.h"
 #include "../IO/Log.h"
 #include "../Math/Ray.h"
+#include "../Physics/CollisionModel.h"
 #include "../Physics/CollisionShape.h"
 #include "../Physics/Constraint.h"
 #include "../Physics/PhysicsEvents.h"
@@ -47,6 +50,8 @@
 #include <Bullet/BulletCollision/Gimpact/btGImpactCollisionAlgorithm.h>
 #include <Bullet/BulletDynamics/ConstraintSolver/btSequentialImpulseConstraintSolver.h>
 #include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorld.h>
+#include <Bullet/BulletDynamics/Dynamics/btDiscreteDynamicsWorldMt.h>
+#include <Bullet/BulletDynamics/Dynamics/btSimulationIslandManagerMt.h>
 
 extern ContactAddedCallback gContactAddedCallback;
 
@@ -57,6 +62,7 @@ const char* PHYSICS_CATEGORY = "Physics";
 extern const char* SUBSYSTEM_CATEGORY;
 
 static const int MAX_SOLVER_ITERATIONS = 256;
+static const unsigned MIN_THREADED_TRANSFORMS = 64;
 static const Vector3 DEFAULT_GRAVITY = Vector3(0.0f, -9.81f, 0.0f);
 
 PhysicsWorldConfig PhysicsWorld::config;
@@ -66,6 +72,66 @@ static bool CompareRaycastResults(const PhysicsRaycastResult& lhs, const Physics
     return lhs.distance_ < rhs.distance_;
 }
 
+static void RaycastSingleImpl(btDiscreteDynamicsWorld* world, PhysicsRaycastResult& result, const Ray& ray, float maxDistance,
+    unsigned collisionMask)
+{
+    btCollisionWorld::ClosestRayResultCallback
+        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
+    rayCallback.m_collisionFilterGroup = (short)0xffff;
+    rayCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
+
+    if (rayCallback.hasHit())
+    {
+        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
+        result.distance_ = (result.position_ - ray.origin_).Length();
+        result.hitFraction_ = rayCallback.m_closestHitFraction;
+        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
+    }
+    else
+    {
+        result.position_ = Vector3::ZERO;
+        result.normal_ = Vector3::ZERO;
+        result.distance_ = M_INFINITY;
+        result.hitFraction_ = 0.0f;
+        result.body_ = nullptr;
+    }
+}
+
+static void SphereCastImpl(btDiscreteDynamicsWorld* world, PhysicsRaycastResult& result, const Ray& ray, float radius,
+    float maxDistance, unsigned collisionMask)
+{
+    btSphereShape shape(radius);
+    Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
+
+    btCollisionWorld::ClosestConvexResultCallback
+        convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
+    convexCallback.m_collisionFilterGroup = (short)0xffff;
+    convexCallback.m_collisionFilterMask = (short)collisionMask;
+
+    world->convexSweepTest(&shape, btTransform(btQuaternion::getIdentity(), convexCallback.m_convexFromWorld),
+        btTransform(btQuaternion::getIdentity(), convexCallback.m_convexToWorld), convexCallback);
+
+    if (convexCallback.hasHit())
+    {
+        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
+        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
+        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
+        result.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
+        result.hitFraction_ = convexCallback.m_closestHitFraction;
+    }
+    else
+    {
+        result.body_ = nullptr;
+        result.position_ = Vector3::ZERO;
+        result.normal_ = Vector3::ZERO;
+        result.distance_ = M_INFINITY;
+        result.hitFraction_ = 0.0f;
+    }
+}
+
 void InternalPreTickCallback(btDynamicsWorld* world, btScalar timeStep)
 {
     static_cast<PhysicsWorld*>(world->getWorldUserInfo())->PreStep(timeStep);
@@ -95,6 +161,18 @@ static bool CustomMaterialCombinerCallback(btManifoldPoint& cp, const btCollisio
     return true;
 }
 
+static void RemoveWorldTransform(PODVector<DelayedWorldTransform>& transforms, RigidBody* body)
+{
+    for (unsigned i = 0; i < transforms.Size(); ++i)
+    {
+        if (transforms[i].rigidBody_ == body)
+        {
+            transforms.Erase(i);
+            return;
+        }
+    }
+}
+
 void RemoveCachedGeometryImpl(CollisionGeometryDataCache& cache, Model* model)
 {
     for (auto i = cache.Begin(); i != cache.End();)
@@ -144,6 +222,107 @@ struct PhysicsQueryCallback : public btCollisionWorld::ContactResultCallback
     unsigned collisionMask_;
 };
 
+#ifdef URHO3D_THREADING
+/// Work queue to solve the simulation islands on. Assigned before each step, as the Bullet island dispatch function has no user data.
+static WorkQueue* islandWorkQueue = nullptr;
+
+/// Constraint solver holding several sequential impulse solvers, so that simulation islands can be solved in parallel.
+class ConstraintSolverPool : public btConstraintSolver
+{
+public:
+    /// Construct with the number of solvers, which should match the number of threads solving islands.
+    explicit ConstraintSolverPool(unsigned numSolvers) :
+        solvers_(numSolvers),
+        mutexes_(numSolvers)
+    {
+        for (unsigned i = 0; i < numSolvers; ++i)
+            solvers_[i] = new btSequentialImpulseConstraintSolver();
+    }
+
+    /// Prepare all solvers for a step.
+    void prepareSolve(int numBodies, int numManifolds) override
+    {
+        for (unsigned i = 0; i < solvers_.Size(); ++i)
+            solvers_[i]->prepareSolve(numBodies, numManifolds);
+    }
+
+    /// Solve an island with the first solver not in use by another thread.
+    btScalar solveGroup(btCollisionObject** bodies, int numBodies, btPersistentManifold** manifolds, int numManifolds,
+        btTypedConstraint** constraints, int numConstraints, const btContactSolverInfo& info, btIDebugDraw* debugDrawer,
+        btDispatcher* dispatcher) override
+    {
+        for (unsigned i = 0;; i = (i + 1) % solvers_.Size())
+        {
+            if (mutexes_[i].tryLock())
+            {
+                btScalar result = solvers_[i]->solveGroup(bodies, numBodies, manifolds, numManifolds, constraints, numConstraints,
+                    info, debugDrawer, dispatcher);
+                mutexes_[i].unlock();
+                return result;
+            }
+        }
+    }
+
+    /// Finish the step on all solvers.
+    void allSolved(const btContactSolverInfo& info, btIDebugDraw* debugDrawer) override
+    {
+        for (unsigned i = 0; i < solvers_.Size(); ++i)
+            solvers_[i]->allSolved(info, debugDrawer);
+    }
+
+    /// Reset all solvers.
+    void reset() override
+    {
+        for (unsigned i = 0; i < solvers_.Size(); ++i)
+            solvers_[i]->reset();
+    }
+
+    /// Return solver type.
+    btConstraintSolverType getSolverType() const override { return BT_SEQUENTIAL_IMPULSE_SOLVER; }
+
+private:
+    /// Solvers.
+    Vector<UniquePtr<btSequentialImpulseConstraintSolver> > solvers_;
+    /// Per-solver locks.
+    Vector<btSpinMutex> mutexes_;
+};
+
+static void SolveIslandWork(const WorkItem* item, unsigned /*threadIndex*/)
+{
+    auto* island = reinterpret_cast<btSimulationIslandManagerMt::Island*>(item->start_);
+    auto* callback = reinterpret_cast<btSimulationIslandManagerMt::IslandCallback*>(item->aux_);
+
+    callback->processIsland(&island->bodyArray[0], island->bodyArray.size(),
+        island->manifoldArray.size() ? &island->manifoldArray[0] : nullptr, island->manifoldArray.size(),
+        island->constraintArray.size() ? &island->constraintArray[0] : nullptr, island->constraintArray.size(), island->id);
+}
+
+static void WorkQueueIslandDispatch(btAlignedObjectArray<btSimulationIslandManagerMt::Island*>* islands,
+    btSimulationIslandManagerMt::IslandCallback* callback)
+{
+    WorkQueue* queue = islandWorkQueue;
+    if (!queue || !queue->GetNumThreads() || islands->size() < 2 || !Thread::IsMainThread())
+    {
+        btSimulationIslandManagerMt::defaultIslandDispatch(islands, callback);
+        return;
+    }
+
+    URHO3D_PROFILE("SolvePhysicsIslands");
+
+    for (int i = 0; i < islands->size(); ++i)
+    {
+        SharedPtr<WorkItem> item = queue->GetFreeItem();
+        item->priority_ = M_MAX_UNSIGNED;
+        item->workFunction_ = SolveIslandWork;
+        item->start_ = (*islands)[i];
+        item->aux_ = callback;
+        queue->AddWorkItem(item);
+    }
+
+    queue->Complete(M_MAX_UNSIGNED);
+}
+#endif
+
 PhysicsWorld::PhysicsWorld(Context* context) :
     Component(context),
     fps_(DEFAULT_FPS),
@@ -160,8 +339,26 @@ PhysicsWorld::PhysicsWorld(Context* context) :
     btGImpactCollisionAlgorithm::registerAlgorithm(static_cast<btCollisionDispatcher*>(collisionDispatcher_.Get()));
 
     broadphase_ = new btDbvtBroadphase();
-    solver_ = new btSequentialImpulseConstraintSolver();
-    world_ = new btDiscreteDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+
+#ifdef URHO3D_THREADING
+    if (PhysicsWorld::config.multithreaded_)
+    {
+        // One solver for each worker thread and the main thread, which also executes work items while waiting
+        auto* queue = GetSubsystem<WorkQueue>();
+        solver_ = new ConstraintSolverPool((queue ? queue->GetNumThreads() : 0) + 1);
+        auto* world = new btDiscreteDynamicsWorldMt(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(),
+            collisionConfiguration_);
+        static_cast<btSimulationIslandManagerMt*>(world->getSimulationIslandManager())->setIslandDispatchFunction(
+            WorkQueueIslandDispatch);
+        world_ = world;
+        multithreaded_ = true;
+    }
+    else
+#endif
+    {
+        solver_ = new btSequentialImpulseConstraintSolver();
+        world_ = new btDiscreteDynamicsWorld(collisionDispatcher_.Get(), broadphase_.Get(), solver_.Get(), collisionConfiguration_);
+    }
 
     world_->setGravity(ToBtVector3(DEFAULT_GRAVITY));
     world_->getDispatchInfo().m_useContinuous = true;
@@ -268,16 +465,28 @@ void PhysicsWorld::Update(float timeStep)
         maxSubSteps = Min(maxSubSteps, maxSubSteps_);
 
     delayedWorldTransforms_.Clear();
+    worldTransforms_.Clear();
+    mainThreadWorldTransforms_.Clear();
     simulating_ = true;
 
+#ifdef URHO3D_THREADING
+    if (multithreaded_)
+        islandWorkQueue = GetSubsystem<WorkQueue>();
+#endif
+
     if (interpolation_)
+    {
         world_->stepSimulation(timeStep, maxSubSteps, internalTimeStep);
+        ApplyWorldTransforms();
+    }
     else
     {
         timeAcc_ += timeStep;
         while (timeAcc_ >= internalTimeStep && maxSubSteps > 0)
         {
             world_->stepSimulation(internalTimeStep, 0, internalTimeStep);
+            // Apply before the next step, so that its pre-step logic sees the current transforms
+            ApplyWorldTransforms();
             timeAcc_ -= internalTimeStep;
             --maxSubSteps;
         }
@@ -362,6 +571,11 @@ void PhysicsWorld::SetSplitImpulse(bool enable)
     MarkNetworkUpdate();
 }
 
+void PhysicsWorld::SetThreadedTransformSync(bool enable)
+{
+    threadedTransformSync_ = enable;
+}
+
 void PhysicsWorld::SetMaxNetworkAngularVelocity(float velocity)
 {
     maxNetworkAngularVelocity_ = Clamp(velocity, 1.0f, 32767.0f);
@@ -404,29 +618,7 @@ void PhysicsWorld::RaycastSingle(PhysicsRaycastResult& result, const Ray& ray, f
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics raycast is not supported");
 
-    btCollisionWorld::ClosestRayResultCallback
-        rayCallback(ToBtVector3(ray.origin_), ToBtVector3(ray.origin_ + maxDistance * ray.direction_));
-    rayCallback.m_collisionFilterGroup = (short)0xffff;
-    rayCallback.m_collisionFilterMask = (short)collisionMask;
-
-    world_->rayTest(rayCallback.m_rayFromWorld, rayCallback.m_rayToWorld, rayCallback);
-
-    if (rayCallback.hasHit())
-    {
-        result.position_ = ToVector3(rayCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(rayCallback.m_hitNormalWorld);
-        result.distance_ = (result.position_ - ray.origin_).Length();
-        result.hitFraction_ = rayCallback.m_closestHitFraction;
-        result.body_ = static_cast<RigidBody*>(rayCallback.m_collisionObject->getUserPointer());
-    }
-    else
-    {
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-        result.body_ = nullptr;
-    }
+    RaycastSingleImpl(world_.Get(), result, ray, maxDistance, collisionMask);
 }
 
 void PhysicsWorld::RaycastSingleSegmented(PhysicsRaycastResult& result, const Ray& ray, float maxDistance, float segmentDistance, unsigned collisionMask, float overlapDistance)
@@ -488,33 +680,45 @@ void PhysicsWorld::SphereCast(PhysicsRaycastResult& result, const Ray& ray, floa
     if (maxDistance >= M_INFINITY)
         URHO3D_LOGWARNING("Infinite maxDistance in physics sphere cast is not supported");
 
-    btSphereShape shape(radius);
-    Vector3 endPos = ray.origin_ + maxDistance * ray.direction_;
-
-    btCollisionWorld::ClosestConvexResultCallback
-        convexCallback(ToBtVector3(ray.origin_), ToBtVector3(endPos));
-    convexCallback.m_collisionFilterGroup = (short)0xffff;
-    convexCallback.m_collisionFilterMask = (short)collisionMask;
+    SphereCastImpl(world_.Get(), result, ray, radius, maxDistance, collisionMask);
+}
 
-    world_->convexSweepTest(&shape, btTransform(btQuaternion::getIdentity(), convexCallback.m_convexFromWorld),
-        btTransform(btQuaternion::getIdentity(), convexCallback.m_convexToWorld), convexCallback);
+void PhysicsWorld::CastBatch(PODVector<PhysicsRaycastResult>& results, const Vector<PhysicsCastQuery>& queries,
+    const PhysicsCastCallback& callback)
+{
+    URHO3D_PROFILE("PhysicsCastBatch");
+    URHO3D_PROFILE_VALUE("Physics cast batch queries", (int64_t)queries.Size());
 
-    if (convexCallback.hasHit())
+    if (simulating_)
     {
-        result.body_ = static_cast<RigidBody*>(convexCallback.m_hitCollisionObject->getUserPointer());
-        result.position_ = ToVector3(convexCallback.m_hitPointWorld);
-        result.normal_ = ToVector3(convexCallback.m_hitNormalWorld);
-        result.distance_ = convexCallback.m_closestHitFraction * (endPos - ray.origin_).Length();
-        result.hitFraction_ = convexCallback.m_closestHitFraction;
+        URHO3D_LOGERROR("Can not execute physics queries during the simulation step");
+        return;
     }
-    else
+
+    results.Resize(queries.Size());
+
+    auto castQueries = [&](unsigned start, unsigned end)
     {
-        result.body_ = nullptr;
-        result.position_ = Vector3::ZERO;
-        result.normal_ = Vector3::ZERO;
-        result.distance_ = M_INFINITY;
-        result.hitFraction_ = 0.0f;
-    }
+        URHO3D_PROFILE("PhysicsCastBatchPart");
+
+        for (unsigned i = start; i < end; ++i)
+        {
+            const PhysicsCastQuery& query = queries[i];
+            if (query.radius_ > 0.0f)
+                SphereCastImpl(world_.Get(), results[i], query.ray_, query.radius_, query.maxDistance_, query.collisionMask_);
+            else
+                RaycastSingleImpl(world_.Get(), results[i], query.ray_, query.maxDistance_, query.collisionMask_);
+
+            if (callback)
+                callback(i, results[i]);
+        }
+    };
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (queue)
+        queue->ParallelFor(queries.Size(), castQueries);
+    else
+        castQueries(0, queries.Size());
 }
 
 void PhysicsWorld::ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos,
@@ -723,8 +927,10 @@ void PhysicsWorld::AddRigidBody(RigidBody* body)
 void PhysicsWorld::RemoveRigidBody(RigidBody* body)
 {
     rigidBodies_.Remove(body);
-    // Remove possible dangling pointer from the delayedWorldTransforms structure
+    // Remove possible dangling pointers from the delayed world transforms
     delayedWorldTransforms_.Erase(body);
+    RemoveWorldTransform(worldTransforms_, body);
+    RemoveWorldTransform(mainThreadWorldTransforms_, body);
 }
 
 void PhysicsWorld::AddCollisionShape(CollisionShape* shape)
@@ -752,6 +958,14 @@ void PhysicsWorld::AddDelayedWorldTransform(const DelayedWorldTransform& transfo
     delayedWorldTransforms_[transform.rigidBody_] = transform;
 }
 
+void PhysicsWorld::AddWorldTransform(const DelayedWorldTransform& transform, bool threadSafe)
+{
+    if (threadSafe)
+        worldTransforms_.Push(transform);
+    else
+        mainThreadWorldTransforms_.Push(transform);
+}
+
 void PhysicsWorld::DrawDebugGeometry(bool depthTest)
 {
     auto* debug = GetComponent<DebugRenderer>();
@@ -826,6 +1040,44 @@ void PhysicsWorld::PostStep(float timeStep)
     SendEvent(E_PHYSICSPOSTSTEP, eventData);
 }
 
+void PhysicsWorld::ApplyWorldTransforms()
+{
+    if (worldTransforms_.Empty() && mainThreadWorldTransforms_.Empty())
+        return;
+
+    URHO3D_PROFILE("ApplyPhysicsTransforms");
+
+    // Keep the flag set for the whole pass instead of toggling it per body, as the bodies may be applied in parallel
+    applyingTransforms_ = true;
+
+    auto applyTransforms = [](const PODVector<DelayedWorldTransform>& transforms, unsigned start, unsigned end)
+    {
+        for (unsigned i = start; i < end; ++i)
+            transforms[i].rigidBody_->ApplyWorldTransform(transforms[i].worldPosition_, transforms[i].worldRotation_);
+    };
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    if (threadedTransformSync_ && queue && queue->GetNumThreads() && scene_ && worldTransforms_.Size() >= MIN_THREADED_TRANSFORMS)
+    {
+        // Notify the scene so that components listening to the nodes defer non-threadsafe work
+        scene_->BeginThreadedUpdate();
+        queue->ParallelFor(worldTransforms_.Size(), [&](unsigned start, unsigned end)
+        {
+            URHO3D_PROFILE("ApplyPhysicsTransformsPart");
+            applyTransforms(worldTransforms_, start, end);
+        });
+        scene_->EndThreadedUpdate();
+    }
+    else
+        applyTransforms(worldTransforms_, 0, worldTransforms_.Size());
+
+    applyTransforms(mainThreadWorldTransforms_, 0, mainThreadWorldTransforms_.Size());
+
+    applyingTransforms_ = false;
+    worldTransforms_.Clear();
+    mainThreadWorldTransforms_.Clear();
+}
+
 void PhysicsWorld::SendCollisionEvents()
 {
     URHO3D_PROFILE("SendCollisionEvents");
@@ -1074,6 +1326,7 @@ void PhysicsWorld::SendCollisionEvents()
 
 void RegisterPhysicsLibrary(Context* context)
 {
+    CollisionModel::RegisterObject(context);
     CollisionShape::RegisterObject(context);
     RigidBody::RegisterObject(context);
     Constraint::RegisterObject(context);
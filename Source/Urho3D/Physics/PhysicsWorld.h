@@ -25,12 +25,15 @@
 #include "../Container/HashSet.h"
 #include "../IO/VectorBuffer.h"
 #include "../Math/BoundingBox.h"
+#include "../Math/Ray.h"
 #include "../Math/Sphere.h"
 #include "../Math/Vector3.h"
 #include "../Scene/Component.h"
 
 #include <Bullet/LinearMath/btIDebugDraw.h>
 
+#include <functional>
+
 class btCollisionConfiguration;
 class btCollisionShape;
 class btBroadphaseInterface;
@@ -48,7 +51,6 @@ class Deserializer;
 class Constraint;
 class Model;
 class Node;
-class Ray;
 class RigidBody;
 class Scene;
 class Serializer;
@@ -77,7 +79,23 @@ struct URHO3D_API PhysicsRaycastResult
     RigidBody* body_{};
 };
 
-/// Delayed world transform assignment for parented rigidbodies.
+/// Physics raycast or sphere cast query for batched execution.
+struct URHO3D_API PhysicsCastQuery
+{
+    /// Ray to cast.
+    Ray ray_;
+    /// Maximum distance along the ray.
+    float maxDistance_{};
+    /// Sphere radius for a sphere cast, or zero for a raycast.
+    float radius_{};
+    /// Collision mask.
+    unsigned collisionMask_{M_MAX_UNSIGNED};
+};
+
+/// Callback for batched physics cast results, called with the query index and the closest hit.
+using PhysicsCastCallback = std::function<void(unsigned, const PhysicsRaycastResult&)>;
+
+/// Delayed world transform assignment for rigidbodies after the simulation step.
 struct DelayedWorldTransform
 {
     /// Rigid body.
@@ -110,12 +128,15 @@ struct ManifoldPair
 struct PhysicsWorldConfig
 {
     PhysicsWorldConfig() :
-        collisionConfig_(nullptr)
+        collisionConfig_(nullptr),
+        multithreaded_(false)
     {
     }
 
     /// Override for the collision configuration (default btDefaultCollisionConfiguration).
     btCollisionConfiguration* collisionConfig_;
+    /// Solve simulation islands in parallel on the work queue threads. Requires building with threading enabled.
+    bool multithreaded_;
 };
 
 static const int DEFAULT_FPS = 60;
@@ -183,6 +204,8 @@ public:
     void SetSplitImpulse(bool enable);
     /// Set maximum angular velocity for network replication.
     void SetMaxNetworkAngularVelocity(float velocity);
+    /// Set whether to apply the simulated transforms of rigid bodies parented to the scene root in worker threads. Requires all components listening to the body nodes to handle threaded scene update. Disabled by default.
+    void SetThreadedTransformSync(bool enable);
     /// Perform a physics world raycast and return all hits.
     void Raycast
         (PODVector<PhysicsRaycastResult>& result, const Ray& ray, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -194,6 +217,9 @@ public:
     /// Perform a physics world swept sphere test and return the closest hit.
     void SphereCast
         (PhysicsRaycastResult& result, const Ray& ray, float radius, float maxDistance, unsigned collisionMask = M_MAX_UNSIGNED);
+    /// Perform a batch of raycasts and sphere casts and return the closest hit of each, in the order of the queries. The queries are split to the work queue threads. The optional callback is called for each result from the thread that executed the query. Can not be called during the simulation step.
+    void CastBatch(PODVector<PhysicsRaycastResult>& results, const Vector<PhysicsCastQuery>& queries,
+        const PhysicsCastCallback& callback = nullptr);
     /// Perform a physics world swept convex test using a user-supplied collision shape and return the first hit.
     void ConvexCast(PhysicsRaycastResult& result, CollisionShape* shape, const Vector3& startPos, const Quaternion& startRot,
         const Vector3& endPos, const Quaternion& endRot, unsigned collisionMask = M_MAX_UNSIGNED);
@@ -232,12 +258,18 @@ public:
     /// Return whether split impulse collision mode is enabled.
     bool GetSplitImpulse() const;
 
+    /// Return whether simulation islands are solved in parallel on the work queue threads.
+    bool IsMultithreaded() const { return multithreaded_; }
+
     /// Return simulation steps per second.
     int GetFps() const { return fps_; }
 
     /// Return maximum angular velocity for network replication.
     float GetMaxNetworkAngularVelocity() const { return maxNetworkAngularVelocity_; }
 
+    /// Return whether simulated transforms are applied in worker threads.
+    bool GetThreadedTransformSync() const { return threadedTransformSync_; }
+
     /// Add a rigid body to keep track of. Called by RigidBody.
     void AddRigidBody(RigidBody* body);
     /// Remove a rigid body. Called by RigidBody.
@@ -250,8 +282,10 @@ public:
     void AddConstraint(Constraint* constraint);
     /// Remove a constraint. Called by Constraint.
     void RemoveConstraint(Constraint* constraint);
-    /// Add a delayed world transform assignment. Called by RigidBody.
+    /// Add a delayed world transform assignment for a body parented to another rigid body. Called by RigidBody.
     void AddDelayedWorldTransform(const DelayedWorldTransform& transform);
+    /// Add a world transform assignment for an unparented body, to be applied in bulk after the simulation step. Called by RigidBody.
+    void AddWorldTransform(const DelayedWorldTransform& transform, bool threadSafe);
     /// Add debug geometry to the debug renderer.
     void DrawDebugGeometry(bool depthTest);
     /// Set debug renderer to use. Called both by PhysicsWorld itself and physics components.
@@ -299,6 +333,8 @@ private:
     void PostStep(float timeStep);
     /// Send accumulated collision events.
     void SendCollisionEvents();
+    /// Apply the world transforms of unparented bodies from the last simulation step.
+    void ApplyWorldTransforms();
 
     /// Bullet collision configuration.
     btCollisionConfiguration* collisionConfiguration_{};
@@ -324,6 +360,10 @@ private:
     HashMap<Pair<WeakPtr<RigidBody>, WeakPtr<RigidBody> >, ManifoldPair> previousCollisions_;
     /// Delayed (parented) world transform assignments.
     HashMap<RigidBody*, DelayedWorldTransform> delayedWorldTransforms_;
+    /// World transform assignments of unparented bodies which may be applied in worker threads.
+    PODVector<DelayedWorldTransform> worldTransforms_;
+    /// World transform assignments of unparented bodies which must be applied in the main thread.
+    PODVector<DelayedWorldTransform> mainThreadWorldTransforms_;
     /// Cache for trimesh geometry data by model and LOD level.
     CollisionGeometryDataCache triMeshCache_;
     /// Cache for convex geometry data by model and LOD level.
@@ -354,6 +394,10 @@ private:
     bool applyingTransforms_{};
     /// Simulating flag.
     bool simulating_{};
+    /// Multithreaded island solving flag.
+    bool multithreaded_{};
+    /// Threaded transform sync flag.
+    bool threadedTransformSync_{};
     /// Debug draw depth test mode.
     bool debugDepthTest_{};
     /// Debug renderer.
@@ -172,12 +172,11 @@ void RigidBody::setWorldTransform(const btTransform& worldTrans)
         // If the rigid body is parented to another rigid body, can not set the transform immediately.
         // In that case store it to PhysicsWorld for delayed assignment
         Node* parent = node_->GetParent();
-        if (parent != GetScene() && parent)
+        bool rootLevel = parent == GetScene() || !parent;
+        if (!rootLevel)
             parentRigidBody = parent->GetComponent<RigidBody>();
 
-        if (!parentRigidBody)
-            ApplyWorldTransform(newWorldPosition, newWorldRotation);
-        else
+        if (parentRigidBody)
         {
             DelayedWorldTransform delayed;
             delayed.rigidBody_ = this;
@@ -186,6 +185,24 @@ void RigidBody::setWorldTransform(const btTransform& worldTrans)
             delayed.worldRotation_ = newWorldRotation;
             physicsWorld_->AddDelayedWorldTransform(delayed);
         }
+        // Bullet reports also bodies which did not move, for example sleeping bodies. Skip dirtying their nodes, unless
+        // deeper in the hierarchy where an ancestor rigid body may have moved them
+        else if (!rootLevel || newWorldPosition != lastPosition_ || newWorldRotation != lastRotation_)
+        {
+            // During the simulation step, leave the transform to be applied in bulk after the step. Only bodies directly
+            // under the scene and without SmoothedTransform, which sends events, can be applied in worker threads
+            if (physicsWorld_->IsSimulating())
+            {
+                DelayedWorldTransform delayed;
+                delayed.rigidBody_ = this;
+                delayed.parentRigidBody_ = nullptr;
+                delayed.worldPosition_ = newWorldPosition;
+                delayed.worldRotation_ = newWorldRotation;
+                physicsWorld_->AddWorldTransform(delayed, rootLevel && !smoothedTransform_);
+            }
+            else
+                ApplyWorldTransform(newWorldPosition, newWorldRotation);
+        }
 
         MarkNetworkUpdate();
     }
@@ -712,7 +729,10 @@ void RigidBody::ApplyWorldTransform(const Vector3& newWorldPosition, const Quate
     if (!node_ || !physicsWorld_)
         return;
 
-    physicsWorld_->SetApplyingTransforms(true);
+    // The physics world keeps the flag set itself when applying transforms in bulk
+    bool wasApplying = physicsWorld_->IsApplyingTransforms();
+    if (!wasApplying)
+        physicsWorld_->SetApplyingTransforms(true);
 
     // Apply transform to the SmoothedTransform component instead of node transform if available
     if (smoothedTransform_)
@@ -724,13 +744,13 @@ void RigidBody::ApplyWorldTransform(const Vector3& newWorldPosition, const Quate
     }
     else
     {
-        node_->SetWorldPosition(newWorldPosition);
-        node_->SetWorldRotation(newWorldRotation);
+        node_->SetWorldTransform(newWorldPosition, newWorldRotation);
         lastPosition_ = node_->GetWorldPosition();
         lastRotation_ = node_->GetWorldRotation();
     }
 
-    physicsWorld_->SetApplyingTransforms(false);
+    if (!wasApplying)
+        physicsWorld_->SetApplyingTransforms(false);
 }
 
 void RigidBody::UpdateMass()
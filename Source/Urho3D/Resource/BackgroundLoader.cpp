@@ -82,6 +82,11 @@ void BackgroundLoader::ThreadFunction()
             SharedPtr<File> file = owner_->GetFile(resource->GetName(), item.sendEventOnFailure_);
             if (file)
             {
+#if URHO3D_PROFILING
+                URHO3D_PROFILE_C("BeginLoad", PROFILER_COLOR_RESOURCES);
+                String zoneName = ToString("%s::BeginLoad(\"%s\")", resource->GetTypeName().CString(), resource->GetName().CString());
+                URHO3D_PROFILE_ZONENAME(zoneName.CString(), zoneName.Length());
+#endif
                 resource->SetAsyncLoadState(ASYNC_LOADING);
                 success = resource->BeginLoad(*file);
             }
@@ -264,7 +269,11 @@ void BackgroundLoader::FinishBackgroundLoading(BackgroundLoadItem& item)
     // If BeginLoad() phase was successful, call EndLoad() and get the final success/failure result
     if (success)
     {
-        URHO3D_PROFILE(String("Finish" + resource->GetTypeName()).CString());
+#if URHO3D_PROFILING
+        URHO3D_PROFILE_C("EndLoad", PROFILER_COLOR_RESOURCES);
+        String zoneName = ToString("%s::EndLoad(\"%s\")", resource->GetTypeName().CString(), resource->GetName().CString());
+        URHO3D_PROFILE_ZONENAME(zoneName.CString(), zoneName.Length());
+#endif
         URHO3D_LOGDEBUG("Finishing background loaded resource " + resource->GetName());
         success = resource->EndLoad();
     }
@@ -0,0 +1,663 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
+#include "../Resource/Compress.h"
+
+#include <cstring>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Minimum number of blocks in an image to split its compression to worker threads.
+static const unsigned MIN_PARALLEL_COMPRESS_BLOCKS = 1024;
+/// Maximum number of endpoint refinement iterations.
+static const unsigned MAX_REFINE_ITERATIONS = 8;
+
+/// Function that compresses a range of block rows.
+using CompressBlockRowsFunction = void (*)(unsigned char*, const unsigned char*, int, int, CompressedFormat, CompressionQuality, unsigned,
+    unsigned);
+
+/// Fetch a 4x4 block of RGBA pixels, replicating the edge pixels of blocks that extend past the image.
+static void FetchBlock(unsigned char* dest, const unsigned char* rgba, int width, int height, int x, int y)
+{
+    for (int py = 0; py < 4; ++py)
+    {
+        const unsigned char* row = rgba + 4 * width * Min(y + py, height - 1);
+        for (int px = 0; px < 4; ++px)
+            memcpy(dest + 16 * py + 4 * px, row + 4 * Min(x + px, width - 1), 4);
+    }
+}
+
+/// Compress all block rows of an image, splitting large images to the worker threads.
+static void CompressBlockRows(CompressBlockRowsFunction function, unsigned char* blocks, const unsigned char* rgba, int width, int height,
+    CompressedFormat format, CompressionQuality quality, WorkQueue* queue)
+{
+    auto numRows = (unsigned)(height + 3) / 4;
+    auto numBlocks = numRows * ((width + 3) / 4);
+
+    if (queue && numBlocks >= MIN_PARALLEL_COMPRESS_BLOCKS)
+    {
+        URHO3D_PROFILE("CompressImageParallel");
+        queue->ParallelFor(numRows, [=](unsigned firstRow, unsigned lastRow)
+        {
+            function(blocks, rgba, width, height, format, quality, firstRow, lastRow);
+        });
+    }
+    else
+        function(blocks, rgba, width, height, format, quality, 0, numRows);
+}
+
+/// Pack a color to 5:6:5 bits.
+static unsigned Pack565(const float* color)
+{
+    int red = Clamp((int)(color[0] * (31.0f / 255.0f) + 0.5f), 0, 31);
+    int green = Clamp((int)(color[1] * (63.0f / 255.0f) + 0.5f), 0, 63);
+    int blue = Clamp((int)(color[2] * (31.0f / 255.0f) + 0.5f), 0, 31);
+    return (unsigned)((red << 11) | (green << 5) | blue);
+}
+
+/// Unpack a 5:6:5 color to 8 bits per component the same way as the decoder.
+static void Unpack565(unsigned packed, int* color)
+{
+    int red = (packed >> 11) & 0x1f;
+    int green = (packed >> 5) & 0x3f;
+    int blue = packed & 0x1f;
+    color[0] = (red << 3) | (red >> 2);
+    color[1] = (green << 2) | (green >> 4);
+    color[2] = (blue << 3) | (blue >> 2);
+}
+
+/// Choose the nearest palette color of two endpoints for each pixel, building the palette the same way as the decoder. Transparent pixels get the punch-through index, which requires the 3-color mode. Return the squared error.
+static float FitIndicesDXT(const float (*pixels)[3], const bool* transparent, unsigned c0, unsigned c1, bool isDxt1, unsigned& indices)
+{
+    int palette[4][3];
+    Unpack565(c0, palette[0]);
+    Unpack565(c1, palette[1]);
+
+    bool threeColor = isDxt1 && c0 <= c1;
+    for (int i = 0; i < 3; ++i)
+    {
+        if (threeColor)
+        {
+            palette[2][i] = (palette[0][i] + palette[1][i]) / 2;
+            palette[3][i] = 0;
+        }
+        else
+        {
+            palette[2][i] = (2 * palette[0][i] + palette[1][i]) / 3;
+            palette[3][i] = (palette[0][i] + 2 * palette[1][i]) / 3;
+        }
+    }
+
+    // In the 3-color mode the last entry is transparent black and only used for transparent pixels
+    unsigned numColors = threeColor ? 3 : 4;
+    float error = 0.0f;
+    indices = 0;
+
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        unsigned best = 3;
+        if (!transparent[i])
+        {
+            float bestDistance = M_INFINITY;
+            for (unsigned j = 0; j < numColors; ++j)
+            {
+                float dr = pixels[i][0] - palette[j][0];
+                float dg = pixels[i][1] - palette[j][1];
+                float db = pixels[i][2] - palette[j][2];
+                float distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = j;
+                }
+            }
+            error += bestDistance;
+        }
+
+        indices |= best << (2 * i);
+    }
+
+    return error;
+}
+
+/// Order two packed endpoints for the color mode required by the block.
+static void OrderEndpointsDXT(unsigned& c0, unsigned& c1, bool threeColor)
+{
+    if (threeColor ? c0 > c1 : c0 < c1)
+        Swap(c0, c1);
+}
+
+/// Solve the endpoints that best reproduce the pixels with the chosen indices in the least squares sense. Return false if the system is degenerate.
+static bool RefineEndpointsDXT(const float (*pixels)[3], const bool* transparent, unsigned indices, bool threeColor, float* start,
+    float* end)
+{
+    static const float weights4[4] = {1.0f, 0.0f, 2.0f / 3.0f, 1.0f / 3.0f};
+    static const float weights3[4] = {1.0f, 0.0f, 0.5f, 0.0f};
+    const float* weights = threeColor ? weights3 : weights4;
+
+    float aa = 0.0f, ab = 0.0f, bb = 0.0f;
+    float ax[3] = {}, bx[3] = {};
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        if (transparent[i])
+            continue;
+
+        float a = weights[(indices >> (2 * i)) & 0x3];
+        float b = 1.0f - a;
+        aa += a * a;
+        ab += a * b;
+        bb += b * b;
+        for (int j = 0; j < 3; ++j)
+        {
+            ax[j] += a * pixels[i][j];
+            bx[j] += b * pixels[i][j];
+        }
+    }
+
+    float det = aa * bb - ab * ab;
+    if (Abs(det) < M_EPSILON)
+        return false;
+
+    float invDet = 1.0f / det;
+    for (int j = 0; j < 3; ++j)
+    {
+        start[j] = Clamp((ax[j] * bb - bx[j] * ab) * invDet, 0.0f, 255.0f);
+        end[j] = Clamp((bx[j] * aa - ax[j] * ab) * invDet, 0.0f, 255.0f);
+    }
+
+    return true;
+}
+
+static void CompressColourDXT(unsigned char* dest, const unsigned char* rgba, bool isDxt1, CompressionQuality quality)
+{
+    float pixels[16][3];
+    bool transparent[16];
+    bool anyTransparent = false;
+    unsigned numOpaque = 0;
+    float mean[3] = {};
+    float minColor[3] = {255.0f, 255.0f, 255.0f};
+    float maxColor[3] = {};
+
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        for (int j = 0; j < 3; ++j)
+            pixels[i][j] = rgba[4 * i + j];
+
+        // Only DXT1 has punch-through alpha, DXT3 and DXT5 store alpha separately
+        transparent[i] = isDxt1 && rgba[4 * i + 3] < 128;
+        if (transparent[i])
+        {
+            anyTransparent = true;
+            continue;
+        }
+
+        ++numOpaque;
+        for (int j = 0; j < 3; ++j)
+        {
+            mean[j] += pixels[i][j];
+            minColor[j] = Min(minColor[j], pixels[i][j]);
+            maxColor[j] = Max(maxColor[j], pixels[i][j]);
+        }
+    }
+
+    unsigned c0 = 0;
+    unsigned c1 = 0;
+    unsigned indices = 0xffffffff;
+
+    if (numOpaque)
+    {
+        float start[3];
+        float end[3];
+
+        if (quality == COMPRESSION_FAST)
+        {
+            // Use the bounding box diagonal, inset slightly as the extremes are rarely hit exactly
+            for (int j = 0; j < 3; ++j)
+            {
+                float inset = (maxColor[j] - minColor[j]) / 16.0f;
+                start[j] = minColor[j] + inset;
+                end[j] = maxColor[j] - inset;
+            }
+        }
+        else
+        {
+            for (int j = 0; j < 3; ++j)
+                mean[j] /= (float)numOpaque;
+
+            // Find the principal axis of the colors by power iteration on the covariance matrix
+            float covariance[6] = {};
+            for (unsigned i = 0; i < 16; ++i)
+            {
+                if (transparent[i])
+                    continue;
+                float r = pixels[i][0] - mean[0];
+                float g = pixels[i][1] - mean[1];
+                float b = pixels[i][2] - mean[2];
+                covariance[0] += r * r;
+                covariance[1] += r * g;
+                covariance[2] += r * b;
+                covariance[3] += g * g;
+                covariance[4] += g * b;
+                covariance[5] += b * b;
+            }
+
+            float axis[3] = {maxColor[0] - minColor[0], maxColor[1] - minColor[1], maxColor[2] - minColor[2]};
+            for (unsigned iteration = 0; iteration < 8; ++iteration)
+            {
+                float x = axis[0] * covariance[0] + axis[1] * covariance[1] + axis[2] * covariance[2];
+                float y = axis[0] * covariance[1] + axis[1] * covariance[3] + axis[2] * covariance[4];
+                float z = axis[0] * covariance[2] + axis[1] * covariance[4] + axis[2] * covariance[5];
+                float length = Max(Max(Abs(x), Abs(y)), Abs(z));
+                if (length < M_EPSILON)
+                    break;
+                axis[0] = x / length;
+                axis[1] = y / length;
+                axis[2] = z / length;
+            }
+
+            // Use the extreme colors along the axis as the initial endpoints
+            float minProjection = M_INFINITY;
+            float maxProjection = -M_INFINITY;
+            for (unsigned i = 0; i < 16; ++i)
+            {
+                if (transparent[i])
+                    continue;
+                float projection = pixels[i][0] * axis[0] + pixels[i][1] * axis[1] + pixels[i][2] * axis[2];
+                if (projection < minProjection)
+                {
+                    minProjection = projection;
+                    memcpy(start, pixels[i], sizeof start);
+                }
+                if (projection > maxProjection)
+                {
+                    maxProjection = projection;
+                    memcpy(end, pixels[i], sizeof end);
+                }
+            }
+        }
+
+        bool threeColor = isDxt1 && anyTransparent;
+        c0 = Pack565(end);
+        c1 = Pack565(start);
+        OrderEndpointsDXT(c0, c1, threeColor);
+        float error = FitIndicesDXT(pixels, transparent, c0, c1, isDxt1, indices);
+
+        unsigned iterations = quality == COMPRESSION_FAST ? 0 : (quality == COMPRESSION_NORMAL ? 1 : MAX_REFINE_ITERATIONS);
+        for (unsigned iteration = 0; iteration < iterations && error > 0.0f; ++iteration)
+        {
+            if (!RefineEndpointsDXT(pixels, transparent, indices, isDxt1 && c0 <= c1, start, end))
+                break;
+
+            unsigned newC0 = Pack565(start);
+            unsigned newC1 = Pack565(end);
+            OrderEndpointsDXT(newC0, newC1, threeColor);
+            unsigned newIndices;
+            float newError = FitIndicesDXT(pixels, transparent, newC0, newC1, isDxt1, newIndices);
+            if (newError >= error)
+                break;
+
+            c0 = newC0;
+            c1 = newC1;
+            indices = newIndices;
+            error = newError;
+        }
+    }
+
+    dest[0] = (unsigned char)(c0 & 0xff);
+    dest[1] = (unsigned char)(c0 >> 8);
+    dest[2] = (unsigned char)(c1 & 0xff);
+    dest[3] = (unsigned char)(c1 >> 8);
+    for (int i = 0; i < 4; ++i)
+        dest[4 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+static void CompressAlphaDXT3(unsigned char* dest, const unsigned char* rgba)
+{
+    // quantise down to 4 bits with rounding, two pixels per byte
+    for (int i = 0; i < 8; ++i)
+    {
+        auto lo = (unsigned)(rgba[8 * i + 3] * 15 + 127) / 255;
+        auto hi = (unsigned)(rgba[8 * i + 7] * 15 + 127) / 255;
+        dest[i] = (unsigned char)(lo | (hi << 4));
+    }
+}
+
+/// Choose the nearest codebook alpha for each pixel, building the codebook the same way as the decoder. Return the squared error.
+static int FitAlphaDXT5(const unsigned char* rgba, int alpha0, int alpha1, unsigned long long& indices)
+{
+    int codes[8];
+    codes[0] = alpha0;
+    codes[1] = alpha1;
+    if (alpha0 <= alpha1)
+    {
+        for (int i = 1; i < 5; ++i)
+            codes[1 + i] = ((5 - i) * alpha0 + i * alpha1) / 5;
+        codes[6] = 0;
+        codes[7] = 255;
+    }
+    else
+    {
+        for (int i = 1; i < 7; ++i)
+            codes[1 + i] = ((7 - i) * alpha0 + i * alpha1) / 7;
+    }
+
+    int error = 0;
+    indices = 0;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        int alpha = rgba[4 * i + 3];
+        unsigned best = 0;
+        int bestDistance = M_MAX_INT;
+        for (unsigned j = 0; j < 8; ++j)
+        {
+            int distance = (alpha - codes[j]) * (alpha - codes[j]);
+            if (distance < bestDistance)
+            {
+                bestDistance = distance;
+                best = j;
+            }
+        }
+
+        error += bestDistance;
+        indices |= (unsigned long long)best << (3 * i);
+    }
+
+    return error;
+}
+
+static void CompressAlphaDXT5(unsigned char* dest, const unsigned char* rgba, CompressionQuality quality)
+{
+    int minAlpha = 255;
+    int maxAlpha = 0;
+    // Range of the alphas that are not exactly 0 or 255, which the 6-alpha codebook has separate codes for
+    int minInner = 255;
+    int maxInner = 0;
+    for (unsigned i = 0; i < 16; ++i)
+    {
+        int alpha = rgba[4 * i + 3];
+        minAlpha = Min(minAlpha, alpha);
+        maxAlpha = Max(maxAlpha, alpha);
+        if (alpha != 0 && alpha != 255)
+        {
+            minInner = Min(minInner, alpha);
+            maxInner = Max(maxInner, alpha);
+        }
+    }
+
+    // Use the 8-alpha codebook, which requires alpha0 > alpha1
+    int alpha0 = maxAlpha;
+    int alpha1 = minAlpha;
+    unsigned long long indices;
+    int error = FitAlphaDXT5(rgba, alpha0, alpha1, indices);
+
+    if (quality == COMPRESSION_HIGH && error > 0 && minInner <= maxInner)
+    {
+        unsigned long long innerIndices;
+        int innerError = FitAlphaDXT5(rgba, minInner, maxInner, innerIndices);
+        if (innerError < error)
+        {
+            alpha0 = minInner;
+            alpha1 = maxInner;
+            indices = innerIndices;
+        }
+    }
+
+    dest[0] = (unsigned char)alpha0;
+    dest[1] = (unsigned char)alpha1;
+    for (int i = 0; i < 6; ++i)
+        dest[2 + i] = (unsigned char)(indices >> (8 * i));
+}
+
+static void CompressDXT(unsigned char* dest, const unsigned char* rgba, CompressedFormat format, CompressionQuality quality)
+{
+    // get the block locations
+    unsigned char* colourBlock = dest;
+    if (format == CF_DXT3 || format == CF_DXT5)
+        colourBlock = dest + 8;
+
+    // compress colour
+    CompressColourDXT(colourBlock, rgba, format == CF_DXT1, quality);
+
+    // compress alpha separately if necessary
+    if (format == CF_DXT3)
+        CompressAlphaDXT3(dest, rgba);
+    else if (format == CF_DXT5)
+        CompressAlphaDXT5(dest, rgba, quality);
+}
+
+static void CompressBlockRowsDXT(unsigned char* blocks, const unsigned char* rgba, int width, int height, CompressedFormat format,
+    CompressionQuality quality, unsigned firstRow, unsigned lastRow)
+{
+    int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+    int blocksX = (width + 3) / 4;
+    unsigned char* targetBlock = blocks + firstRow * blocksX * bytesPerBlock;
+
+    for (unsigned row = firstRow; row < lastRow; ++row)
+    {
+        for (int x = 0; x < width; x += 4)
+        {
+            unsigned char sourceRgba[4 * 16];
+            FetchBlock(sourceRgba, rgba, width, height, x, row * 4);
+            CompressDXT(targetBlock, sourceRgba, format, quality);
+            targetBlock += bytesPerBlock;
+        }
+    }
+}
+
+void CompressImageDXT(unsigned char* blocks, const unsigned char* rgba, int width, int height, CompressedFormat format,
+    CompressionQuality quality, WorkQueue* queue)
+{
+    CompressBlockRows(CompressBlockRowsDXT, blocks, rgba, width, height, format, quality, queue);
+}
+
+/// ETC1 intensity modifier tables, in the order of the pixel index values.
+static const int ETC_MODIFIERS[8][4] = {{2,  8,   -2,  -8},
+                                        {5,  17,  -5,  -17},
+                                        {9,  29,  -9,  -29},
+                                        {13, 42,  -13, -42},
+                                        {18, 60,  -18, -60},
+                                        {24, 80,  -24, -80},
+                                        {33, 106, -33, -106},
+                                        {47, 183, -47, -183}};
+
+/// Encoding of an ETC1 subblock.
+struct ETCSubblock
+{
+    /// Modifier table.
+    unsigned table_;
+    /// Pixel index values by pixel number (x * 4 + y).
+    unsigned selectors_[16];
+    /// Squared error.
+    int error_;
+};
+
+/// Find the modifier table and pixel index values that best reproduce the pixels of a subblock from its base color.
+static void FitSubblockETC(const unsigned char* rgba, const int* base, bool flip, unsigned subblock, ETCSubblock& result)
+{
+    result.error_ = M_MAX_INT;
+
+    for (unsigned table = 0; table < 8; ++table)
+    {
+        int error = 0;
+        unsigned selectors[16];
+
+        for (unsigned i = 0; i < 8; ++i)
+        {
+            // Subblocks are 2x4 pixels side by side, or 4x2 pixels on top of each other when flipped
+            unsigned x = flip ? (i & 3) : subblock * 2 + (i >> 2);
+            unsigned y = flip ? subblock * 2 + (i >> 2) : (i & 3);
+            const unsigned char* pixel = rgba + 16 * y + 4 * x;
+
+            int bestDistance = M_MAX_INT;
+            unsigned best = 0;
+            for (unsigned j = 0; j < 4; ++j)
+            {
+                int modifier = ETC_MODIFIERS[table][j];
+                int dr = Clamp(base[0] + modifier, 0, 255) - pixel[0];
+                int dg = Clamp(base[1] + modifier, 0, 255) - pixel[1];
+                int db = Clamp(base[2] + modifier, 0, 255) - pixel[2];
+                int distance = dr * dr + dg * dg + db * db;
+                if (distance < bestDistance)
+                {
+                    bestDistance = distance;
+                    best = j;
+                }
+            }
+
+            error += bestDistance;
+            selectors[x * 4 + y] = best;
+        }
+
+        if (error < result.error_)
+        {
+            result.error_ = error;
+            result.table_ = table;
+            for (unsigned i = 0; i < 8; ++i)
+            {
+                unsigned x = flip ? (i & 3) : subblock * 2 + (i >> 2);
+                unsigned y = flip ? subblock * 2 + (i >> 2) : (i & 3);
+                result.selectors_[x * 4 + y] = selectors[x * 4 + y];
+            }
+        }
+    }
+}
+
+static void CompressETC(unsigned char* dest, const unsigned char* rgba, CompressionQuality quality)
+{
+    int bestError = M_MAX_INT;
+
+    for (unsigned flip = 0; flip < 2; ++flip)
+    {
+        // Average color of the subblocks
+        float average[2][3] = {};
+        for (unsigned y = 0; y < 4; ++y)
+        {
+            for (unsigned x = 0; x < 4; ++x)
+            {
+                unsigned subblock = flip ? y / 2 : x / 2;
+                for (int j = 0; j < 3; ++j)
+                    average[subblock][j] += rgba[16 * y + 4 * x + j] / 8.0f;
+            }
+        }
+
+        // Differential mode stores 5-bit base colors with the second relative to the first, individual mode 4-bit base colors
+        int quantized5[2][3];
+        int quantized4[2][3];
+        bool diffValid = true;
+        for (int j = 0; j < 3; ++j)
+        {
+            for (unsigned k = 0; k < 2; ++k)
+            {
+                quantized5[k][j] = Clamp((int)(average[k][j] * (31.0f / 255.0f) + 0.5f), 0, 31);
+                quantized4[k][j] = Clamp((int)(average[k][j] * (15.0f / 255.0f) + 0.5f), 0, 15);
+            }
+            int delta = quantized5[1][j] - quantized5[0][j];
+            if (delta < -4 || delta > 3)
+                diffValid = false;
+        }
+
+        for (unsigned diff = 0; diff < 2; ++diff)
+        {
+            if (diff ? !diffValid : diffValid && quality != COMPRESSION_HIGH)
+                continue;
+
+            int base[2][3];
+            for (unsigned k = 0; k < 2; ++k)
+            {
+                for (int j = 0; j < 3; ++j)
+                {
+                    base[k][j] = diff ? (quantized5[k][j] << 3) | (quantized5[k][j] >> 2) :
+                        (quantized4[k][j] << 4) | quantized4[k][j];
+                }
+            }
+
+            ETCSubblock subblocks[2];
+            FitSubblockETC(rgba, base[0], flip != 0, 0, subblocks[0]);
+            FitSubblockETC(rgba, base[1], flip != 0, 1, subblocks[1]);
+            int error = subblocks[0].error_ + subblocks[1].error_;
+            if (error >= bestError)
+                continue;
+            bestError = error;
+
+            if (diff)
+            {
+                for (int j = 0; j < 3; ++j)
+                    dest[j] = (unsigned char)((quantized5[0][j] << 3) | ((quantized5[1][j] - quantized5[0][j]) & 0x7));
+            }
+            else
+            {
+                for (int j = 0; j < 3; ++j)
+                    dest[j] = (unsigned char)((quantized4[0][j] << 4) | quantized4[1][j]);
+            }
+            dest[3] = (unsigned char)((subblocks[0].table_ << 5) | (subblocks[1].table_ << 2) | (diff << 1) | flip);
+
+            // The most and least significant bits of the pixel index values are stored in separate 16-bit big-endian words
+            unsigned msb = 0;
+            unsigned lsb = 0;
+            for (unsigned i = 0; i < 16; ++i)
+            {
+                unsigned subblock = flip ? (i & 3) / 2 : i / 8;
+                unsigned selector = subblocks[subblock].selectors_[i];
+                msb |= (selector >> 1) << i;
+                lsb |= (selector & 1) << i;
+            }
+            dest[4] = (unsigned char)(msb >> 8);
+            dest[5] = (unsigned char)(msb & 0xff);
+            dest[6] = (unsigned char)(lsb >> 8);
+            dest[7] = (unsigned char)(lsb & 0xff);
+        }
+    }
+}
+
+static void CompressBlockRowsETC(unsigned char* blocks, const unsigned char* rgba, int width, int height, CompressedFormat /*format*/,
+    CompressionQuality quality, unsigned firstRow, unsigned lastRow)
+{
+    int bytesPerBlock = 8;
+    int blocksX = (width + 3) / 4;
+    unsigned char* targetBlock = blocks + firstRow * blocksX * bytesPerBlock;
+
+    for (unsigned row = firstRow; row < lastRow; ++row)
+    {
+        for (int x = 0; x < width; x += 4)
+        {
+            unsigned char sourceRgba[4 * 16];
+            FetchBlock(sourceRgba, rgba, width, height, x, row * 4);
+            CompressETC(targetBlock, sourceRgba, quality);
+            targetBlock += bytesPerBlock;
+        }
+    }
+}
+
+void CompressImageETC(unsigned char* blocks, const unsigned char* rgba, int width, int height, CompressionQuality quality,
+    WorkQueue* queue)
+{
+    CompressBlockRows(CompressBlockRowsETC, blocks, rgba, width, height, CF_ETC1, quality, queue);
+}
+
+}
@@ -22,13 +22,73 @@
 
 #include "../Precompiled.h"
 
+#include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../Resource/Decompress.h"
 
+#include <cstring>
+
 // DXT decompression based on the Squish library, modified for Urho3D
 
 namespace Urho3D
 {
 
+/// Minimum number of blocks in an image to split its decompression to worker threads.
+static const unsigned MIN_PARALLEL_DECOMPRESS_BLOCKS = 16384;
+
+/// Function that decompresses a range of block rows. Rows of all depth slices are numbered consecutively.
+using DecompressBlockRowsFunction = void (*)(unsigned char*, const unsigned char*, int, int, CompressedFormat, unsigned, unsigned);
+
+/// Return the first destination pixel of a block row.
+static inline unsigned char* GetBlockRowTarget(unsigned char* rgba, int width, int height, unsigned row)
+{
+    unsigned blocksY = (unsigned)(height + 3) / 4;
+    unsigned z = row / blocksY;
+    unsigned y = (row - z * blocksY) * 4;
+    return rgba + 4 * ((size_t)z * width * height + (size_t)y * width);
+}
+
+/// Return the number of pixel rows of a block row that are inside the image.
+static inline int GetBlockRowHeight(int height, unsigned row)
+{
+    unsigned blocksY = (unsigned)(height + 3) / 4;
+    return Min(height - (int)(row % blocksY) * 4, 4);
+}
+
+/// Copy a decompressed 4x4 block to the image, clipping it at the right and bottom edges.
+static inline void StoreBlock(unsigned char* dest, const unsigned char* block, int width, int blockWidth, int blockHeight)
+{
+    if (blockWidth == 4)
+    {
+        for (int y = 0; y < blockHeight; ++y)
+            memcpy(dest + 4 * width * y, block + 16 * y, 16);
+    }
+    else
+    {
+        for (int y = 0; y < blockHeight; ++y)
+            memcpy(dest + 4 * width * y, block + 16 * y, (size_t)blockWidth * 4);
+    }
+}
+
+/// Decompress all block rows of an image, splitting large images to the worker threads.
+static void DecompressBlockRows(DecompressBlockRowsFunction function, unsigned char* rgba, const unsigned char* blocks, int width,
+    int height, int depth, CompressedFormat format, WorkQueue* queue)
+{
+    auto numRows = (unsigned)(((height + 3) / 4) * depth);
+    auto numBlocks = numRows * ((width + 3) / 4);
+
+    if (queue && numBlocks >= MIN_PARALLEL_DECOMPRESS_BLOCKS)
+    {
+        URHO3D_PROFILE("DecompressImageParallel");
+        queue->ParallelFor(numRows, [=](unsigned firstRow, unsigned lastRow)
+        {
+            function(rgba, blocks, width, height, format, firstRow, lastRow);
+        });
+    }
+    else
+        function(rgba, blocks, width, height, format, 0, numRows);
+}
+
 /* -----------------------------------------------------------------------------
 
     Copyright (c) 2006 Simon Brown                          si@sjbrown.co.uk
@@ -106,25 +166,12 @@ static void DecompressColourDXT(unsigned char* rgba, void const* block, bool isD
     codes[8 + 3] = 255;
     codes[12 + 3] = (unsigned char)((isDxt1 && a <= b) ? 0 : 255);
 
-    // unpack the indices
-    unsigned char indices[16];
-    for (int i = 0; i < 4; ++i)
-    {
-        unsigned char* ind = indices + 4 * i;
-        unsigned char packed = bytes[4 + i];
-
-        ind[0] = (unsigned char)(packed & 0x3);
-        ind[1] = (unsigned char)((packed >> 2) & 0x3);
-        ind[2] = (unsigned char)((packed >> 4) & 0x3);
-        ind[3] = (unsigned char)((packed >> 6) & 0x3);
-    }
-
-    // store out the colours
+    // store out the colours as whole words, taking the 2-bit indices from a single 32-bit value
+    unsigned indices = (unsigned)bytes[4] | ((unsigned)bytes[5] << 8) | ((unsigned)bytes[6] << 16) | ((unsigned)bytes[7] << 24);
     for (int i = 0; i < 16; ++i)
     {
-        auto offset = (unsigned char)(4 * indices[i]);
-        for (int j = 0; j < 4; ++j)
-            rgba[4 * i + j] = codes[offset + j];
+        memcpy(rgba + 4 * i, codes + 4 * (indices & 0x3), 4);
+        indices >>= 2;
     }
 }
 
@@ -174,31 +221,15 @@ static void DecompressAlphaDXT5(unsigned char* rgba, void const* block)
             codes[1 + i] = (unsigned char)(((7 - i) * alpha0 + i * alpha1) / 7);
     }
 
-    // decode the indices
-    unsigned char indices[16];
-    unsigned char const* src = bytes + 2;
-    unsigned char* dest = indices;
-    for (int i = 0; i < 2; ++i)
+    // write out the indexed codebook values, taking the 3-bit indices from a single 48-bit value
+    unsigned long long indices = 0;
+    for (int i = 0; i < 6; ++i)
+        indices |= (unsigned long long)bytes[2 + i] << (8 * i);
+    for (int i = 0; i < 16; ++i)
     {
-        // grab 3 bytes
-        int value = 0;
-        for (int j = 0; j < 3; ++j)
-        {
-            int byte = *src++;
-            value |= (byte << 8 * j);
-        }
-
-        // unpack 8 3-bit values from it
-        for (int j = 0; j < 8; ++j)
-        {
-            int index = (value >> 3 * j) & 0x7;
-            *dest++ = (unsigned char)index;
-        }
+        rgba[4 * i + 3] = codes[indices & 0x7];
+        indices >>= 3;
     }
-
-    // write out the indexed codebook values
-    for (int i = 0; i < 16; ++i)
-        rgba[4 * i + 3] = codes[indices[i]];
 }
 
 static void DecompressDXT(unsigned char* rgba, const void* block, CompressedFormat format)
@@ -219,56 +250,34 @@ static void DecompressDXT(unsigned char* rgba, const void* block, CompressedForm
         DecompressAlphaDXT5(rgba, alphaBock);
 }
 
-void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format)
+static void DecompressBlockRowsDXT(unsigned char* rgba, const unsigned char* blocks, int width, int height, CompressedFormat format,
+    unsigned firstRow, unsigned lastRow)
 {
-    // initialise the block input
-    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
     int bytesPerBlock = format == CF_DXT1 ? 8 : 16;
+    int blocksX = (width + 3) / 4;
+    const unsigned char* sourceBlock = blocks + firstRow * blocksX * bytesPerBlock;
 
-    // loop over blocks
-    for (int z = 0; z < depth; ++z)
+    for (unsigned row = firstRow; row < lastRow; ++row)
     {
-        int sz = width * height * 4 * z;
-        for (int y = 0; y < height; y += 4)
-        {
-            for (int x = 0; x < width; x += 4)
-            {
-                // decompress the block
-                unsigned char targetRgba[4 * 16];
-                DecompressDXT(targetRgba, sourceBlock, format);
+        unsigned char* targetRow = GetBlockRowTarget(rgba, width, height, row);
+        int blockHeight = GetBlockRowHeight(height, row);
 
-                // write the decompressed pixels to the correct image locations
-                unsigned char const* sourcePixel = targetRgba;
-                for (int py = 0; py < 4; ++py)
-                {
-                    for (int px = 0; px < 4; ++px)
-                    {
-                        // get the target location
-                        int sx = x + px;
-                        int sy = y + py;
-                        if (sx < width && sy < height)
-                        {
-                            unsigned char* targetPixel = rgba + sz + 4 * (width * sy + sx);
-
-                            // copy the rgba value
-                            for (int i = 0; i < 4; ++i)
-                                *targetPixel++ = *sourcePixel++;
-                        }
-                        else
-                        {
-                            // skip this pixel as its outside the image
-                            sourcePixel += 4;
-                        }
-                    }
-                }
-
-                // advance
-                sourceBlock += bytesPerBlock;
-            }
+        for (int x = 0; x < width; x += 4)
+        {
+            unsigned char targetRgba[4 * 16];
+            DecompressDXT(targetRgba, sourceBlock, format);
+            StoreBlock(targetRow + 4 * x, targetRgba, width, Min(width - x, 4), blockHeight);
+            sourceBlock += bytesPerBlock;
         }
     }
 }
 
+void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format,
+    WorkQueue* queue)
+{
+    DecompressBlockRows(DecompressBlockRowsDXT, rgba, reinterpret_cast<const unsigned char*>(blocks), width, height, depth, format, queue);
+}
+
 // ETC and PVRTC decompression based on the Oolong Engine, modified for Urho3D
 
 /*
@@ -303,34 +312,39 @@ const int mod[8][4] = {{2,  8,   -2,  -8},
                        {33, 106, -33, -106},
                        {47, 183, -47, -183}};
 
+// Read a 32-bit word in little-endian order regardless of the platform, as the bit layout below assumes it
+static unsigned ReadETCWord(const unsigned char* bytes)
+{
+    return (unsigned)bytes[0] | ((unsigned)bytes[1] << 8) | ((unsigned)bytes[2] << 16) | ((unsigned)bytes[3] << 24);
+}
+
 // lsb: hgfedcba ponmlkji msb: hgfedcba ponmlkji due to endianness
-static unsigned long ModifyPixel(int red, int green, int blue, int x, int y, unsigned long modBlock, int modTable)
+static void ModifyPixel(unsigned char* dest, int red, int green, int blue, int x, int y, unsigned modBlock, int modTable)
 {
     int index = x * 4 + y, pixelMod;
-    unsigned long mostSig = modBlock << 1;
+    unsigned mostSig = modBlock << 1;
     if (index < 8)    //hgfedcba
         pixelMod = mod[modTable][((modBlock >> (index + 24)) & 0x1) + ((mostSig >> (index + 8)) & 0x2)];
     else    // ponmlkj
         pixelMod = mod[modTable][((modBlock >> (index + 8)) & 0x1) + ((mostSig >> (index - 8)) & 0x2)];
 
-    red = _CLAMP_(red + pixelMod, 0, 255);
-    green = _CLAMP_(green + pixelMod, 0, 255);
-    blue = _CLAMP_(blue + pixelMod, 0, 255);
-
-    return ((blue << 16) + (green << 8) + red) | 0xff000000;
+    dest[0] = (unsigned char)_CLAMP_(red + pixelMod, 0, 255);
+    dest[1] = (unsigned char)_CLAMP_(green + pixelMod, 0, 255);
+    dest[2] = (unsigned char)_CLAMP_(blue + pixelMod, 0, 255);
+    dest[3] = 255;
 }
 
 static void DecompressETC(unsigned char* pDestData, const void* pSrcData)
 {
-    unsigned long blockTop, blockBot, * input = (unsigned long*)pSrcData, * output;
+    auto const* input = reinterpret_cast<unsigned char const*>(pSrcData);
+    unsigned blockTop, blockBot;
     unsigned char red1, green1, blue1, red2, green2, blue2;
     bool bFlip, bDiff;
     int modtable1, modtable2;
 
-    blockTop = *(input++);
-    blockBot = *(input++);
+    blockTop = ReadETCWord(input);
+    blockBot = ReadETCWord(input + 4);
 
-    output = (unsigned long*)pDestData;
     // check flipbit
     bFlip = (blockTop & ETC_FLIP) != 0;
     bDiff = (blockTop & ETC_DIFF) != 0;
@@ -387,8 +401,8 @@ static void DecompressETC(unsigned char* pDestData, const void* pSrcData)
         {
             for (int k = 0; k < 2; k++)    // horizontal
             {
-                *(output + j * 4 + k) = ModifyPixel(red1, green1, blue1, k, j, blockBot, modtable1);
-                *(output + j * 4 + k + 2) = ModifyPixel(red2, green2, blue2, k + 2, j, blockBot, modtable2);
+                ModifyPixel(pDestData + 4 * (j * 4 + k), red1, green1, blue1, k, j, blockBot, modtable1);
+                ModifyPixel(pDestData + 4 * (j * 4 + k + 2), red2, green2, blue2, k + 2, j, blockBot, modtable2);
             }
         }
     }
@@ -398,59 +412,40 @@ static void DecompressETC(unsigned char* pDestData, const void* pSrcData)
         {
             for (int k = 0; k < 4; k++)
             {
-                *(output + j * 4 + k) = ModifyPixel(red1, green1, blue1, k, j, blockBot, modtable1);
-                *(output + (j + 2) * 4 + k) = ModifyPixel(red2, green2, blue2, k, j + 2, blockBot, modtable2);
+                ModifyPixel(pDestData + 4 * (j * 4 + k), red1, green1, blue1, k, j, blockBot, modtable1);
+                ModifyPixel(pDestData + 4 * ((j + 2) * 4 + k), red2, green2, blue2, k, j + 2, blockBot, modtable2);
             }
         }
     }
 }
 
-void DecompressImageETC(unsigned char* rgba, const void* blocks, int width, int height)
+static void DecompressBlockRowsETC(unsigned char* rgba, const unsigned char* blocks, int width, int height, CompressedFormat /*format*/,
+    unsigned firstRow, unsigned lastRow)
 {
-    // initialise the block input
-    auto const* sourceBlock = reinterpret_cast< unsigned char const* >( blocks );
     int bytesPerBlock = 8;
+    int blocksX = (width + 3) / 4;
+    const unsigned char* sourceBlock = blocks + firstRow * blocksX * bytesPerBlock;
 
-    // loop over blocks
-    for (int y = 0; y < height; y += 4)
+    for (unsigned row = firstRow; row < lastRow; ++row)
     {
+        unsigned char* targetRow = GetBlockRowTarget(rgba, width, height, row);
+        int blockHeight = GetBlockRowHeight(height, row);
+
         for (int x = 0; x < width; x += 4)
         {
-            // decompress the block
             unsigned char targetRgba[4 * 16];
             DecompressETC(targetRgba, sourceBlock);
-
-            // write the decompressed pixels to the correct image locations
-            unsigned char const* sourcePixel = targetRgba;
-            for (int py = 0; py < 4; ++py)
-            {
-                for (int px = 0; px < 4; ++px)
-                {
-                    // get the target location
-                    int sx = x + px;
-                    int sy = y + py;
-                    if (sx < width && sy < height)
-                    {
-                        unsigned char* targetPixel = rgba + 4 * (width * sy + sx);
-
-                        // copy the rgba value
-                        for (int i = 0; i < 4; ++i)
-                            *targetPixel++ = *sourcePixel++;
-                    }
-                    else
-                    {
-                        // skip this pixel as its outside the image
-                        sourcePixel += 4;
-                    }
-                }
-            }
-
-            // advance
+            StoreBlock(targetRow + 4 * x, targetRgba, width, Min(width - x, 4), blockHeight);
             sourceBlock += bytesPerBlock;
         }
     }
 }
 
+void DecompressImageETC(unsigned char* rgba, const void* blocks, int width, int height, WorkQueue* queue)
+{
+    DecompressBlockRows(DecompressBlockRowsETC, rgba, reinterpret_cast<const unsigned char*>(blocks), width, height, 1, CF_ETC1, queue);
+}
+
 #define PT_INDEX    (2) /*The Punch-through index*/
 #define BLK_Y_SIZE  (4) /*always 4 for all 2D block types*/
 #define BLK_X_MAX   (8) /*Max X dimension for blocks*/
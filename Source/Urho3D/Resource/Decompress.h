@@ -27,11 +27,13 @@
 namespace Urho3D
 {
 
-/// Decompress a DXT compressed image to RGBA.
-URHO3D_API void
-    DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format);
-/// Decompress an ETC1 compressed image to RGBA.
-URHO3D_API void DecompressImageETC(unsigned char* rgba, const void* blocks, int width, int height);
+class WorkQueue;
+
+/// Decompress a DXT compressed image to RGBA. When a work queue with worker threads is given and called from the main thread, large images are split to the worker threads by rows of blocks.
+URHO3D_API void DecompressImageDXT(unsigned char* rgba, const void* blocks, int width, int height, int depth, CompressedFormat format,
+    WorkQueue* queue = nullptr);
+/// Decompress an ETC1 compressed image to RGBA. When a work queue with worker threads is given and called from the main thread, large images are split to the worker threads by rows of blocks.
+URHO3D_API void DecompressImageETC(unsigned char* rgba, const void* blocks, int width, int height, WorkQueue* queue = nullptr);
 /// Decompress a PVRTC compressed image to RGBA.
 URHO3D_API void DecompressImagePVRTC(unsigned char* rgba, const void* blocks, int width, int height, CompressedFormat format);
 /// Flip a compressed block vertically.
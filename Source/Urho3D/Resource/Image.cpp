@@ -24,9 +24,11 @@
 
 #include "../Core/Context.h"
 #include "../Core/Profiler.h"
+#include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
+#include "../Resource/Compress.h"
 #include "../Resource/Decompress.h"
 
 #include <SDL/SDL_surface.h>
@@ -214,7 +216,258 @@ struct DDSurfaceDesc2
     unsigned dwTextureStage_;
 };
 
-bool CompressedLevel::Decompress(unsigned char* dest)
+/// Minimum number of output pixels to split image processing to the worker threads.
+static const unsigned MIN_PARALLEL_IMAGE_PIXELS = 128 * 128;
+
+/// Process the output rows of an image, splitting large images to the worker threads. WorkQueue::ParallelFor() runs serially when not called from the main thread, so asynchronous texture loading calculates mip levels serially on the loading thread.
+template <class T> static void ProcessImageRows(Context* context, unsigned numRows, unsigned rowPixels, T function)
+{
+    auto* queue = context->GetSubsystem<WorkQueue>();
+    if (queue && numRows * rowPixels >= MIN_PARALLEL_IMAGE_PIXELS)
+        queue->ParallelFor(numRows, function);
+    else
+        function(0, numRows);
+}
+
+/// Return table for converting 8-bit sRGB values to linear.
+static const float* GetSRGBToLinearTable()
+{
+    static const struct Table
+    {
+        Table()
+        {
+            for (unsigned i = 0; i < 256; ++i)
+                values_[i] = Color::ConvertGammaToLinear((float)i / 255.0f);
+        }
+
+        float values_[256];
+    } table;
+
+    return table.values_;
+}
+
+/// Number of entries in the linear to sRGB conversion table.
+static const unsigned LINEAR_TO_SRGB_TABLE_SIZE = 4096;
+
+/// Return table for converting linear values quantized to the table size to 8-bit sRGB.
+static const unsigned char* GetLinearToSRGBTable()
+{
+    static const struct Table
+    {
+        Table()
+        {
+            for (unsigned i = 0; i < LINEAR_TO_SRGB_TABLE_SIZE; ++i)
+            {
+                float gamma = Color::ConvertLinearToGamma((float)i / (float)(LINEAR_TO_SRGB_TABLE_SIZE - 1));
+                values_[i] = (unsigned char)Clamp((int)(gamma * 255.0f + 0.5f), 0, 255);
+            }
+        }
+
+        unsigned char values_[LINEAR_TO_SRGB_TABLE_SIZE];
+    } table;
+
+    return table.values_;
+}
+
+/// Average samples of one component into a mip level pixel. Color components of sRGB images are averaged in linear space.
+template <unsigned N> static inline unsigned char AverageSamples(const unsigned char* const* samples, unsigned offset, bool linear)
+{
+    if (!linear)
+    {
+        unsigned sum = 0;
+        for (unsigned i = 0; i < N; ++i)
+            sum += samples[i][offset];
+        return (unsigned char)(sum / N);
+    }
+
+    const float* toLinear = GetSRGBToLinearTable();
+    float sum = 0.0f;
+    for (unsigned i = 0; i < N; ++i)
+        sum += toLinear[samples[i][offset]];
+    return GetLinearToSRGBTable()[(unsigned)(sum * ((float)(LINEAR_TO_SRGB_TABLE_SIZE - 1) / N) + 0.5f)];
+}
+
+/// Calculate a 1D mip level by averaging pairs of pixels. C is the number of components.
+template <unsigned C> static void DownsamplePixels1D(const unsigned char* in, unsigned char* out, int widthOut, bool sRGB)
+{
+    const unsigned colorComponents = C < 3 ? 1 : 3;
+
+    if (!sRGB)
+    {
+        for (int x = 0; x < widthOut * (int)C; x += C)
+        {
+            for (unsigned c = 0; c < C; ++c)
+                out[x + c] = (unsigned char)(((unsigned)in[x * 2 + c] + in[x * 2 + C + c]) >> 1);
+        }
+    }
+    else
+    {
+        for (int x = 0; x < widthOut * (int)C; x += C)
+        {
+            const unsigned char* samples[2] = {&in[x * 2], &in[x * 2 + C]};
+            for (unsigned c = 0; c < C; ++c)
+                out[x + c] = AverageSamples<2>(samples, c, c < colorComponents);
+        }
+    }
+}
+
+/// Calculate rows of a 2D mip level by averaging 2x2 pixel blocks. C is the number of components.
+template <unsigned C> static void DownsampleRows2D(const unsigned char* in, unsigned char* out, int widthIn, int widthOut, bool sRGB,
+    unsigned firstRow, unsigned lastRow)
+{
+    const unsigned colorComponents = C < 3 ? 1 : 3;
+
+    for (unsigned y = firstRow; y < lastRow; ++y)
+    {
+        const unsigned char* inUpper = &in[(y * 2) * widthIn * C];
+        const unsigned char* inLower = &in[(y * 2 + 1) * widthIn * C];
+        unsigned char* outRow = &out[y * widthOut * C];
+
+        if (!sRGB)
+        {
+            for (int x = 0; x < widthOut * (int)C; x += C)
+            {
+                for (unsigned c = 0; c < C; ++c)
+                {
+                    outRow[x + c] = (unsigned char)(((unsigned)inUpper[x * 2 + c] + inUpper[x * 2 + C + c] +
+                                                     inLower[x * 2 + c] + inLower[x * 2 + C + c]) >> 2);
+                }
+            }
+        }
+        else
+        {
+            for (int x = 0; x < widthOut * (int)C; x += C)
+            {
+                const unsigned char* samples[4] = {&inUpper[x * 2], &inUpper[x * 2 + C], &inLower[x * 2], &inLower[x * 2 + C]};
+                for (unsigned c = 0; c < C; ++c)
+                    outRow[x + c] = AverageSamples<4>(samples, c, c < colorComponents);
+            }
+        }
+    }
+}
+
+/// Calculate rows of a 3D mip level by averaging 2x2x2 pixel blocks. Rows of all depth slices are numbered consecutively. C is the number of components.
+template <unsigned C> static void DownsampleRows3D(const unsigned char* in, unsigned char* out, int widthIn, int heightIn, int widthOut,
+    int heightOut, bool sRGB, unsigned firstRow, unsigned lastRow)
+{
+    const unsigned colorComponents = C < 3 ? 1 : 3;
+
+    for (unsigned row = firstRow; row < lastRow; ++row)
+    {
+        unsigned z = row / heightOut;
+        unsigned y = row - z * heightOut;
+        const unsigned char* inOuter = &in[(z * 2) * widthIn * heightIn * C];
+        const unsigned char* inInner = &in[(z * 2 + 1) * widthIn * heightIn * C];
+        const unsigned char* inOuterUpper = &inOuter[(y * 2) * widthIn * C];
+        const unsigned char* inOuterLower = &inOuter[(y * 2 + 1) * widthIn * C];
+        const unsigned char* inInnerUpper = &inInner[(y * 2) * widthIn * C];
+        const unsigned char* inInnerLower = &inInner[(y * 2 + 1) * widthIn * C];
+        unsigned char* outRow = &out[(z * heightOut + y) * widthOut * C];
+
+        for (int x = 0; x < widthOut * (int)C; x += C)
+        {
+            const unsigned char* samples[8] = {&inOuterUpper[x * 2], &inOuterUpper[x * 2 + C], &inOuterLower[x * 2],
+                &inOuterLower[x * 2 + C], &inInnerUpper[x * 2], &inInnerUpper[x * 2 + C], &inInnerLower[x * 2],
+                &inInnerLower[x * 2 + C]};
+            for (unsigned c = 0; c < C; ++c)
+                outRow[x + c] = AverageSamples<8>(samples, c, sRGB && c < colorComponents);
+        }
+    }
+}
+
+/// Resample rows of a 2D image. C is the number of components.
+template <unsigned C> static void ResampleRows(const unsigned char* in, unsigned char* out, int widthIn, int heightIn, int widthOut,
+    int heightOut, ResampleFilter filter, unsigned firstRow, unsigned lastRow)
+{
+    for (unsigned y = firstRow; y < lastRow; ++y)
+    {
+        unsigned char* outRow = &out[y * widthOut * C];
+
+        switch (filter)
+        {
+        case RESAMPLE_NEAREST:
+            {
+                const unsigned char* inRow = &in[Min((int)(y * heightIn / heightOut), heightIn - 1) * widthIn * C];
+                for (int x = 0; x < widthOut; ++x)
+                {
+                    const unsigned char* src = &inRow[Min(x * widthIn / widthOut, widthIn - 1) * C];
+                    for (unsigned c = 0; c < C; ++c)
+                        outRow[x * C + c] = src[c];
+                }
+            }
+            break;
+
+        case RESAMPLE_BILINEAR:
+            {
+                // Map the first and last output pixels to the edges of the image like GetPixelBilinear() does
+                float yF = heightOut > 1 ? (float)y / (float)(heightOut - 1) : 0.0f;
+                float srcY = Clamp(yF * heightIn - 0.5f, 0.0f, (float)(heightIn - 1));
+                auto y0 = (int)srcY;
+                int y1 = Min(y0 + 1, heightIn - 1);
+                float fy = srcY - (float)y0;
+                const unsigned char* inUpper = &in[y0 * widthIn * C];
+                const unsigned char* inLower = &in[y1 * widthIn * C];
+
+                for (int x = 0; x < widthOut; ++x)
+                {
+                    float xF = widthOut > 1 ? (float)x / (float)(widthOut - 1) : 0.0f;
+                    float srcX = Clamp(xF * widthIn - 0.5f, 0.0f, (float)(widthIn - 1));
+                    auto x0 = (int)srcX;
+                    int x1 = Min(x0 + 1, widthIn - 1);
+                    float fx = srcX - (float)x0;
+
+                    for (unsigned c = 0; c < C; ++c)
+                    {
+                        float top = Lerp((float)inUpper[x0 * C + c], (float)inUpper[x1 * C + c], fx);
+                        float bottom = Lerp((float)inLower[x0 * C + c], (float)inLower[x1 * C + c], fx);
+                        outRow[x * C + c] = (unsigned char)(Lerp(top, bottom, fy) + 0.5f);
+                    }
+                }
+            }
+            break;
+
+        case RESAMPLE_BOX:
+            {
+                // Average all source pixels covered by the output pixel, or the nearest source pixel when enlarging
+                int y0 = y * heightIn / heightOut;
+                int y1 = Max((int)((y + 1) * heightIn / heightOut), y0 + 1);
+                for (int x = 0; x < widthOut; ++x)
+                {
+                    int x0 = x * widthIn / widthOut;
+                    int x1 = Max((x + 1) * widthIn / widthOut, x0 + 1);
+                    unsigned sums[C] = {};
+                    for (int sy = y0; sy < y1; ++sy)
+                    {
+                        const unsigned char* src = &in[(sy * widthIn + x0) * C];
+                        for (int sx = x0; sx < x1; ++sx, src += C)
+                        {
+                            for (unsigned c = 0; c < C; ++c)
+                                sums[c] += src[c];
+                        }
+                    }
+
+                    auto count = (unsigned)((y1 - y0) * (x1 - x0));
+                    for (unsigned c = 0; c < C; ++c)
+                        outRow[x * C + c] = (unsigned char)((sums[c] + count / 2) / count);
+                }
+            }
+            break;
+        }
+    }
+}
+
+/// Process image rows with a function template instantiated for the number of components.
+#define DISPATCH_COMPONENTS(components, function, ...) \
+    switch (components) \
+    { \
+    case 1: function<1>(__VA_ARGS__); break; \
+    case 2: function<2>(__VA_ARGS__); break; \
+    case 3: function<3>(__VA_ARGS__); break; \
+    case 4: function<4>(__VA_ARGS__); break; \
+    default: assert(false); break; \
+    }
+
+bool CompressedLevel::Decompress(unsigned char* dest, WorkQueue* queue)
 {
     if (!data_)
         return false;
@@ -224,11 +477,11 @@ bool CompressedLevel::Decompress(unsigned char* dest)
     case CF_DXT1:
     case CF_DXT3:
     case CF_DXT5:
-        DecompressImageDXT(dest, data_, width_, height_, depth_, format_);
+        DecompressImageDXT(dest, data_, width_, height_, depth_, format_, queue);
         return true;
 
     case CF_ETC1:
-        DecompressImageETC(dest, data_, width_, height_);
+        DecompressImageETC(dest, data_, width_, height_, queue);
         return true;
 
     case CF_ETC2_RGB:
@@ -377,7 +630,8 @@ bool Image::BeginLoad(Deserializer& source)
         unsigned dataSize = 0;
         if (compressedFormat_ != CF_RGBA)
         {
-            const unsigned blockSize = compressedFormat_ == CF_DXT1 ? 8 : 16; //DXT1/BC1 is 8 bytes, DXT3/BC2 and DXT5/BC3 are 16 bytes
+            //DXT1/BC1 and ETC1 are 8 bytes, DXT3/BC2 and DXT5/BC3 are 16 bytes
+            const unsigned blockSize = (compressedFormat_ == CF_DXT1 || compressedFormat_ == CF_ETC1 || compressedFormat_ == CF_ETC2_RGB) ? 8 : 16;
             // Add 3 to ensure valid block: ie 2x2 fits uses a whole 4x4 block
             unsigned blocksWide = (ddsd.dwWidth_ + 3) / 4;
             unsigned blocksHeight = (ddsd.dwHeight_ + 3) / 4;
@@ -1166,7 +1420,7 @@ bool Image::FlipVertical()
     return true;
 }
 
-bool Image::Resize(int width, int height)
+bool Image::Resize(int width, int height, ResampleFilter filter)
 {
     URHO3D_PROFILE("ResizeImage");
 
@@ -1185,40 +1439,21 @@ bool Image::Resize(int width, int height)
     if (!data_ || width <= 0 || height <= 0)
         return false;
 
-    /// \todo Reducing image size does not sample all needed pixels
     SharedArrayPtr<unsigned char> newData(new unsigned char[width * height * components_]);
-    for (int y = 0; y < height; ++y)
+    const unsigned char* in = data_.Get();
+    unsigned char* out = newData.Get();
+    int widthIn = width_;
+    int heightIn = height_;
+    unsigned components = components_;
+    ProcessImageRows(context_, (unsigned)height, (unsigned)width, [=](unsigned firstRow, unsigned lastRow)
     {
-        for (int x = 0; x < width; ++x)
-        {
-            // Calculate float coordinates between 0 - 1 for resampling
-            float xF = (width_ > 1) ? (float)x / (float)(width - 1) : 0.0f;
-            float yF = (height_ > 1) ? (float)y / (float)(height - 1) : 0.0f;
-            unsigned uintColor = GetPixelBilinear(xF, yF).ToUInt();
-            unsigned char* dest = newData + (y * width + x) * components_;
-            auto* src = (unsigned char*)&uintColor;
-
-            switch (components_)
-            {
-            case 4:
-                dest[3] = src[3];
-                // Fall through
-            case 3:
-                dest[2] = src[2];
-                // Fall through
-            case 2:
-                dest[1] = src[1];
-                // Fall through
-            default:
-                dest[0] = src[0];
-                break;
-            }
-        }
-    }
+        DISPATCH_COMPONENTS(components, ResampleRows, in, out, widthIn, heightIn, width, height, filter, firstRow, lastRow)
+    });
 
     width_ = width;
     height_ = height;
     data_ = newData;
+    nextLevel_.Reset();
     SetMemoryUse(width * height * depth_ * components_);
     return true;
 }
@@ -1349,10 +1584,7 @@ bool Image::SaveDDS(const String& fileName) const
     }
 
     if (IsCompressed())
-    {
-        URHO3D_LOGERROR("Can not save compressed image to DDS");
-        return false;
-    }
+        return SaveCompressedDDS(outFile);
 
     if (components_ != 4)
     {
@@ -1389,6 +1621,138 @@ bool Image::SaveDDS(const String& fileName) const
     return true;
 }
 
+bool Image::SaveCompressedDDS(Serializer& dest) const
+{
+    unsigned fourCC;
+    unsigned dxgiFormat;
+    switch (compressedFormat_)
+    {
+    case CF_DXT1:
+        fourCC = FOURCC_DXT1;
+        dxgiFormat = DDS_DXGI_FORMAT_BC1_UNORM_SRGB;
+        break;
+
+    case CF_DXT3:
+        fourCC = FOURCC_DXT3;
+        dxgiFormat = DDS_DXGI_FORMAT_BC2_UNORM_SRGB;
+        break;
+
+    case CF_DXT5:
+        fourCC = FOURCC_DXT5;
+        dxgiFormat = DDS_DXGI_FORMAT_BC3_UNORM_SRGB;
+        break;
+
+    case CF_ETC1:
+        fourCC = FOURCC_ETC1;
+        dxgiFormat = 0;
+        break;
+
+    default:
+        URHO3D_LOGERROR("Can not save image with this compressed format to DDS");
+        return false;
+    }
+
+    if (depth_ > 1 || nextSibling_)
+    {
+        URHO3D_LOGERROR("Can not save compressed 3D, cube or array image to DDS");
+        return false;
+    }
+
+    // sRGB is only expressible with the DX10 header, which has no ETC1 format
+    bool writeDXGI = sRGB_ && dxgiFormat;
+    CompressedLevel level = GetCompressedLevel(0);
+
+    dest.WriteFileID("DDS ");
+
+    DDSurfaceDesc2 ddsd;        // NOLINT(hicpp-member-init)
+    memset(&ddsd, 0, sizeof(ddsd));
+    ddsd.dwSize_ = sizeof(ddsd);
+    ddsd.dwFlags_ = 0x00000001l /*DDSD_CAPS*/
+        | 0x00000002l /*DDSD_HEIGHT*/ | 0x00000004l /*DDSD_WIDTH*/ | 0x00020000l /*DDSD_MIPMAPCOUNT*/ | 0x00001000l /*DDSD_PIXELFORMAT*/
+        | 0x00080000l /*DDSD_LINEARSIZE*/;
+    ddsd.dwWidth_ = width_;
+    ddsd.dwHeight_ = height_;
+    ddsd.dwLinearSize_ = level.dataSize_;
+    ddsd.dwMipMapCount_ = numCompressedLevels_;
+    ddsd.ddpfPixelFormat_.dwFlags_ = 0x00000004l /*DDPF_FOURCC*/;
+    ddsd.ddpfPixelFormat_.dwSize_ = sizeof(ddsd.ddpfPixelFormat_);
+    ddsd.ddpfPixelFormat_.dwFourCC_ = writeDXGI ? FOURCC_DX10 : fourCC;
+    ddsd.ddsCaps_.dwCaps_ = DDSCAPS_TEXTURE | (numCompressedLevels_ > 1 ? DDSCAPS_COMPLEX | DDSCAPS_MIPMAP : 0);
+
+    dest.Write(&ddsd, sizeof(ddsd));
+    if (writeDXGI)
+    {
+        DDSHeader10 dxgiHeader;     // NOLINT(hicpp-member-init)
+        memset(&dxgiHeader, 0, sizeof(dxgiHeader));
+        dxgiHeader.dxgiFormat = dxgiFormat;
+        dxgiHeader.resourceDimension = DDS_DIMENSION_TEXTURE2D;
+        dxgiHeader.arraySize = 1;
+        dest.Write(&dxgiHeader, sizeof(dxgiHeader));
+    }
+
+    return dest.Write(data_.Get(), GetMemoryUse()) == GetMemoryUse();
+}
+
+bool Image::Compress(CompressedFormat format, CompressionQuality quality)
+{
+    URHO3D_PROFILE("CompressImage");
+
+    if (IsCompressed())
+    {
+        URHO3D_LOGERROR("Image is already compressed");
+        return false;
+    }
+    if (depth_ > 1)
+    {
+        URHO3D_LOGERROR("Compression not supported for 3D images");
+        return false;
+    }
+    if (format != CF_DXT1 && format != CF_DXT3 && format != CF_DXT5 && format != CF_ETC1)
+    {
+        URHO3D_LOGERROR("Unsupported compressed format, only DXT1, DXT3, DXT5 and ETC1 can be encoded");
+        return false;
+    }
+    if (!data_)
+        return false;
+
+    // Generate the full mip chain in RGBA and compress the levels one after another into the same buffer
+    SharedPtr<Image> rgbaImage = ConvertToRGBA();
+    if (!rgbaImage)
+        return false;
+    rgbaImage->sRGB_ = sRGB_;
+
+    Vector<SharedPtr<Image> > levels;
+    levels.Push(rgbaImage);
+    while (levels.Back()->width_ > 1 || levels.Back()->height_ > 1)
+        levels.Push(levels.Back()->GetNextLevel());
+
+    const unsigned blockSize = (format == CF_DXT1 || format == CF_ETC1) ? 8 : 16;
+    unsigned dataSize = 0;
+    for (unsigned i = 0; i < levels.Size(); ++i)
+        dataSize += ((levels[i]->width_ + 3) / 4) * ((levels[i]->height_ + 3) / 4) * blockSize;
+
+    SharedArrayPtr<unsigned char> newData(new unsigned char[dataSize]);
+    auto* queue = GetSubsystem<WorkQueue>();
+    unsigned offset = 0;
+    for (unsigned i = 0; i < levels.Size(); ++i)
+    {
+        const Image* level = levels[i];
+        if (format == CF_ETC1)
+            CompressImageETC(newData.Get() + offset, level->data_.Get(), level->width_, level->height_, quality, queue);
+        else
+            CompressImageDXT(newData.Get() + offset, level->data_.Get(), level->width_, level->height_, format, quality, queue);
+        offset += ((level->width_ + 3) / 4) * ((level->height_ + 3) / 4) * blockSize;
+    }
+
+    data_ = newData;
+    compressedFormat_ = format;
+    numCompressedLevels_ = levels.Size();
+    components_ = (format == CF_DXT1 || format == CF_ETC1) ? 3 : 4;
+    nextLevel_.Reset();
+    SetMemoryUse(dataSize);
+    return true;
+}
+
 bool Image::SaveWEBP(const String& fileName, float compression /* = 0.0f */) const
 {
 #ifdef URHO3D_WEBP
@@ -1634,6 +1998,7 @@ SharedPtr<Image> Image::GetNextLevel() const
         mipImage->SetSize(widthOut, heightOut, depthOut, components_);
     else
         mipImage->SetSize(widthOut, heightOut, components_);
+    mipImage->sRGB_ = sRGB_;
 
     const unsigned char* pixelDataIn = data_.Get();
     unsigned char* pixelDataOut = mipImage->data_.Get();
@@ -1645,256 +2010,31 @@ SharedPtr<Image> Image::GetNextLevel() const
         if (widthOut < heightOut)
             widthOut = heightOut;
 
-        switch (components_)
-        {
-        case 1:
-            for (int x = 0; x < widthOut; ++x)
-                pixelDataOut[x] = (unsigned char)(((unsigned)pixelDataIn[x * 2] + pixelDataIn[x * 2 + 1]) >> 1);
-            break;
-
-        case 2:
-            for (int x = 0; x < widthOut * 2; x += 2)
-            {
-                pixelDataOut[x] = (unsigned char)(((unsigned)pixelDataIn[x * 2] + pixelDataIn[x * 2 + 2]) >> 1);
-                pixelDataOut[x + 1] = (unsigned char)(((unsigned)pixelDataIn[x * 2 + 1] + pixelDataIn[x * 2 + 3]) >> 1);
-            }
-            break;
-
-        case 3:
-            for (int x = 0; x < widthOut * 3; x += 3)
-            {
-                pixelDataOut[x] = (unsigned char)(((unsigned)pixelDataIn[x * 2] + pixelDataIn[x * 2 + 3]) >> 1);
-                pixelDataOut[x + 1] = (unsigned char)(((unsigned)pixelDataIn[x * 2 + 1] + pixelDataIn[x * 2 + 4]) >> 1);
-                pixelDataOut[x + 2] = (unsigned char)(((unsigned)pixelDataIn[x * 2 + 2] + pixelDataIn[x * 2 + 5]) >> 1);
-            }
-            break;
-
-        case 4:
-            for (int x = 0; x < widthOut * 4; x += 4)
-            {
-                pixelDataOut[x] = (unsigned char)(((unsigned)pixelDataIn[x * 2] + pixelDataIn[x * 2 + 4]) >> 1);
-                pixelDataOut[x + 1] = (unsigned char)(((unsigned)pixelDataIn[x * 2 + 1] + pixelDataIn[x * 2 + 5]) >> 1);
-                pixelDataOut[x + 2] = (unsigned char)(((unsigned)pixelDataIn[x * 2 + 2] + pixelDataIn[x * 2 + 6]) >> 1);
-                pixelDataOut[x + 3] = (unsigned char)(((unsigned)pixelDataIn[x * 2 + 3] + pixelDataIn[x * 2 + 7]) >> 1);
-            }
-            break;
-
-        default:
-            assert(false);  // Should never reach here
-            break;
-        }
+        DISPATCH_COMPONENTS(components_, DownsamplePixels1D, pixelDataIn, pixelDataOut, widthOut, sRGB_)
     }
     // 2D case
     else if (depth_ == 1)
     {
-        switch (components_)
+        int widthIn = width_;
+        unsigned components = components_;
+        bool sRGB = sRGB_;
+        ProcessImageRows(context_, (unsigned)heightOut, (unsigned)widthOut, [=](unsigned firstRow, unsigned lastRow)
         {
-        case 1:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_];
-                unsigned char* out = &pixelDataOut[y * widthOut];
-
-                for (int x = 0; x < widthOut; ++x)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 1] +
-                                              inLower[x * 2] + inLower[x * 2 + 1]) >> 2);
-                }
-            }
-            break;
-
-        case 2:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 2];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 2];
-                unsigned char* out = &pixelDataOut[y * widthOut * 2];
-
-                for (int x = 0; x < widthOut * 2; x += 2)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 2] +
-                                              inLower[x * 2] + inLower[x * 2 + 2]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 3] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 3]) >> 2);
-                }
-            }
-            break;
-
-        case 3:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 3];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 3];
-                unsigned char* out = &pixelDataOut[y * widthOut * 3];
-
-                for (int x = 0; x < widthOut * 3; x += 3)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 3] +
-                                              inLower[x * 2] + inLower[x * 2 + 3]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 4] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 5]) >> 2);
-                }
-            }
-            break;
-
-        case 4:
-            for (int y = 0; y < heightOut; ++y)
-            {
-                const unsigned char* inUpper = &pixelDataIn[(y * 2) * width_ * 4];
-                const unsigned char* inLower = &pixelDataIn[(y * 2 + 1) * width_ * 4];
-                unsigned char* out = &pixelDataOut[y * widthOut * 4];
-
-                for (int x = 0; x < widthOut * 4; x += 4)
-                {
-                    out[x] = (unsigned char)(((unsigned)inUpper[x * 2] + inUpper[x * 2 + 4] +
-                                              inLower[x * 2] + inLower[x * 2 + 4]) >> 2);
-                    out[x + 1] = (unsigned char)(((unsigned)inUpper[x * 2 + 1] + inUpper[x * 2 + 5] +
-                                                  inLower[x * 2 + 1] + inLower[x * 2 + 5]) >> 2);
-                    out[x + 2] = (unsigned char)(((unsigned)inUpper[x * 2 + 2] + inUpper[x * 2 + 6] +
-                                                  inLower[x * 2 + 2] + inLower[x * 2 + 6]) >> 2);
-                    out[x + 3] = (unsigned char)(((unsigned)inUpper[x * 2 + 3] + inUpper[x * 2 + 7] +
-                                                  inLower[x * 2 + 3] + inLower[x * 2 + 7]) >> 2);
-                }
-            }
-            break;
-
-        default:
-            assert(false);  // Should never reach here
-            break;
-        }
+            DISPATCH_COMPONENTS(components, DownsampleRows2D, pixelDataIn, pixelDataOut, widthIn, widthOut, sRGB, firstRow, lastRow)
+        });
     }
     // 3D case
     else
     {
-        switch (components_)
+        int widthIn = width_;
+        int heightIn = height_;
+        unsigned components = components_;
+        bool sRGB = sRGB_;
+        ProcessImageRows(context_, (unsigned)(heightOut * depthOut), (unsigned)widthOut, [=](unsigned firstRow, unsigned lastRow)
         {
-        case 1:
-            for (int z = 0; z < depthOut; ++z)
-            {
-                const unsigned char* inOuter = &pixelDataIn[(z * 2) * width_ * height_];
-                const unsigned char* inInner = &pixelDataIn[(z * 2 + 1) * width_ * height_];
-
-                for (int y = 0; y < heightOut; ++y)
-                {
-                    const unsigned char* inOuterUpper = &inOuter[(y * 2) * width_];
-                    const unsigned char* inOuterLower = &inOuter[(y * 2 + 1) * width_];
-                    const unsigned char* inInnerUpper = &inInner[(y * 2) * width_];
-                    const unsigned char* inInnerLower = &inInner[(y * 2 + 1) * width_];
-                    unsigned char* out = &pixelDataOut[z * widthOut * heightOut + y * widthOut];
-
-                    for (int x = 0; x < widthOut; ++x)
-                    {
-                        out[x] = (unsigned char)(((unsigned)inOuterUpper[x * 2] + inOuterUpper[x * 2 + 1] +
-                                                  inOuterLower[x * 2] + inOuterLower[x * 2 + 1] +
-                                                  inInnerUpper[x * 2] + inInnerUpper[x * 2 + 1] +
-                                                  inInnerLower[x * 2] + inInnerLower[x * 2 + 1]) >> 3);
-                    }
-                }
-            }
-            break;
-
-        case 2:
-            for (int z = 0; z < depthOut; ++z)
-            {
-                const unsigned char* inOuter = &pixelDataIn[(z * 2) * width_ * height_ * 2];
-                const unsigned char* inInner = &pixelDataIn[(z * 2 + 1) * width_ * height_ * 2];
-
-                for (int y = 0; y < heightOut; ++y)
-                {
-                    const unsigned char* inOuterUpper = &inOuter[(y * 2) * width_ * 2];
-                    const unsigned char* inOuterLower = &inOuter[(y * 2 + 1) * width_ * 2];
-                    const unsigned char* inInnerUpper = &inInner[(y * 2) * width_ * 2];
-                    const unsigned char* inInnerLower = &inInner[(y * 2 + 1) * width_ * 2];
-                    unsigned char* out = &pixelDataOut[z * widthOut * heightOut * 2 + y * widthOut * 2];
-
-                    for (int x = 0; x < widthOut * 2; x += 2)
-                    {
-                        out[x] = (unsigned char)(((unsigned)inOuterUpper[x * 2] + inOuterUpper[x * 2 + 2] +
-                                                  inOuterLower[x * 2] + inOuterLower[x * 2 + 2] +
-                                                  inInnerUpper[x * 2] + inInnerUpper[x * 2 + 2] +
-                                                  inInnerLower[x * 2] + inInnerLower[x * 2 + 2]) >> 3);
-                        out[x + 1] = (unsigned char)(((unsigned)inOuterUpper[x * 2 + 1] + inOuterUpper[x * 2 + 3] +
-                                                      inOuterLower[x * 2 + 1] + inOuterLower[x * 2 + 3] +
-                                                      inInnerUpper[x * 2 + 1] + inInnerUpper[x * 2 + 3] +
-                                                      inInnerLower[x * 2 + 1] + inInnerLower[x * 2 + 3]) >> 3);
-                    }
-                }
-            }
-            break;
-
-        case 3:
-            for (int z = 0; z < depthOut; ++z)
-            {
-                const unsigned char* inOuter = &pixelDataIn[(z * 2) * width_ * height_ * 3];
-                const unsigned char* inInner = &pixelDataIn[(z * 2 + 1) * width_ * height_ * 3];
-
-                for (int y = 0; y < heightOut; ++y)
-                {
-                    const unsigned char* inOuterUpper = &inOuter[(y * 2) * width_ * 3];
-                    const unsigned char* inOuterLower = &inOuter[(y * 2 + 1) * width_ * 3];
-                    const unsigned char* inInnerUpper = &inInner[(y * 2) * width_ * 3];
-                    const unsigned char* inInnerLower = &inInner[(y * 2 + 1) * width_ * 3];
-                    unsigned char* out = &pixelDataOut[z * widthOut * heightOut * 3 + y * widthOut * 3];
-
-                    for (int x = 0; x < widthOut * 3; x += 3)
-                    {
-                        out[x] = (unsigned char)(((unsigned)inOuterUpper[x * 2] + inOuterUpper[x * 2 + 3] +
-                                                  inOuterLower[x * 2] + inOuterLower[x * 2 + 3] +
-                                                  inInnerUpper[x * 2] + inInnerUpper[x * 2 + 3] +
-                                                  inInnerLower[x * 2] + inInnerLower[x * 2 + 3]) >> 3);
-                        out[x + 1] = (unsigned char)(((unsigned)inOuterUpper[x * 2 + 1] + inOuterUpper[x * 2 + 4] +
-                                                      inOuterLower[x * 2 + 1] + inOuterLower[x * 2 + 4] +
-                                                      inInnerUpper[x * 2 + 1] + inInnerUpper[x * 2 + 4] +
-                                                      inInnerLower[x * 2 + 1] + inInnerLower[x * 2 + 4]) >> 3);
-                        out[x + 2] = (unsigned char)(((unsigned)inOuterUpper[x * 2 + 2] + inOuterUpper[x * 2 + 5] +
-                                                      inOuterLower[x * 2 + 2] + inOuterLower[x * 2 + 5] +
-                                                      inInnerUpper[x * 2 + 2] + inInnerUpper[x * 2 + 5] +
-                                                      inInnerLower[x * 2 + 2] + inInnerLower[x * 2 + 5]) >> 3);
-                    }
-                }
-            }
-            break;
-
-        case 4:
-            for (int z = 0; z < depthOut; ++z)
-            {
-                const unsigned char* inOuter = &pixelDataIn[(z * 2) * width_ * height_ * 4];
-                const unsigned char* inInner = &pixelDataIn[(z * 2 + 1) * width_ * height_ * 4];
-
-                for (int y = 0; y < heightOut; ++y)
-                {
-                    const unsigned char* inOuterUpper = &inOuter[(y * 2) * width_ * 4];
-                    const unsigned char* inOuterLower = &inOuter[(y * 2 + 1) * width_ * 4];
-                    const unsigned char* inInnerUpper = &inInner[(y * 2) * width_ * 4];
-                    const unsigned char* inInnerLower = &inInner[(y * 2 + 1) * width_ * 4];
-                    unsigned char* out = &pixelDataOut[z * widthOut * heightOut * 4 + y * widthOut * 4];
-
-                    for (int x = 0; x < widthOut * 4; x += 4)
-                    {
-                        out[x] = (unsigned char)(((unsigned)inOuterUpper[x * 2] + inOuterUpper[x * 2 + 4] +
-                                                  inOuterLower[x * 2] + inOuterLower[x * 2 + 4] +
-                                                  inInnerUpper[x * 2] + inInnerUpper[x * 2 + 4] +
-                                                  inInnerLower[x * 2] + inInnerLower[x * 2 + 4]) >> 3);
-                        out[x + 1] = (unsigned char)(((unsigned)inOuterUpper[x * 2 + 1] + inOuterUpper[x * 2 + 5] +
-                                                      inOuterLower[x * 2 + 1] + inOuterLower[x * 2 + 5] +
-                                                      inInnerUpper[x * 2 + 1] + inInnerUpper[x * 2 + 5] +
-                                                      inInnerLower[x * 2 + 1] + inInnerLower[x * 2 + 5]) >> 3);
-                        out[x + 2] = (unsigned char)(((unsigned)inOuterUpper[x * 2 + 2] + inOuterUpper[x * 2 + 6] +
-                                                      inOuterLower[x * 2 + 2] + inOuterLower[x * 2 + 6] +
-                                                      inInnerUpper[x * 2 + 2] + inInnerUpper[x * 2 + 6] +
-                                                      inInnerLower[x * 2 + 2] + inInnerLower[x * 2 + 6]) >> 3);
-                    }
-                }
-            }
-            break;
-
-        default:
-            assert(false);  // Should never reach here
-            break;
-        }
+            DISPATCH_COMPONENTS(components, DownsampleRows3D, pixelDataIn, pixelDataOut, widthIn, heightIn, widthOut, heightOut, sRGB,
+                firstRow, lastRow)
+        });
     }
 
     return mipImage;
@@ -1967,6 +2107,48 @@ SharedPtr<Image> Image::ConvertToRGBA() const
         break;
     }
 
+    ret->sRGB_ = sRGB_;
+    return ret;
+}
+
+SharedPtr<Image> Image::GetDecompressedImage() const
+{
+    if (!IsCompressed())
+    {
+        URHO3D_LOGERROR("Image is not compressed");
+        return SharedPtr<Image>();
+    }
+    if (depth_ > 1 || nextSibling_)
+    {
+        URHO3D_LOGERROR("Decompression of 3D, cube or array images is not supported");
+        return SharedPtr<Image>();
+    }
+
+    URHO3D_PROFILE("DecompressImage");
+
+    auto* queue = GetSubsystem<WorkQueue>();
+    SharedPtr<Image> ret;
+    Image* previous = nullptr;
+
+    for (unsigned i = 0; i < numCompressedLevels_; ++i)
+    {
+        CompressedLevel level = GetCompressedLevel(i);
+        SharedPtr<Image> levelImage(context_->CreateObject<Image>());
+        levelImage->SetSize(level.width_, level.height_, 4);
+        levelImage->sRGB_ = sRGB_;
+        if (!level.Decompress(levelImage->GetData(), queue))
+        {
+            URHO3D_LOGERROR("Failed to decompress image");
+            return SharedPtr<Image>();
+        }
+
+        if (previous)
+            previous->nextLevel_ = levelImage;
+        else
+            ret = levelImage;
+        previous = levelImage;
+    }
+
     return ret;
 }
 
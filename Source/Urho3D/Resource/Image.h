@@ -30,6 +30,8 @@ struct SDL_Surface;
 namespace Urho3D
 {
 
+class WorkQueue;
+
 static const int COLOR_LUT_SIZE = 16;
 
 /// Supported compressed image formats.
@@ -49,11 +51,30 @@ enum CompressedFormat
     CF_PVRTC_RGBA_4BPP,
 };
 
+/// Image resampling filter.
+enum ResampleFilter
+{
+    RESAMPLE_NEAREST = 0,
+    RESAMPLE_BILINEAR,
+    RESAMPLE_BOX
+};
+
+/// Block compression quality.
+enum CompressionQuality
+{
+    /// Endpoints from the color bounding box.
+    COMPRESSION_FAST = 0,
+    /// Endpoints along the principal axis of the colors, refined once.
+    COMPRESSION_NORMAL,
+    /// Endpoints refined until the error no longer improves. ETC1 also tries both base color modes and DXT5 both alpha modes.
+    COMPRESSION_HIGH
+};
+
 /// Compressed image mip level.
 struct URHO3D_API CompressedLevel
 {
-    /// Decompress to RGBA. The destination buffer required is width * height * 4 bytes. Return true if successful.
-    bool Decompress(unsigned char* dest);
+    /// Decompress to RGBA. The destination buffer required is width * height * 4 bytes. Large DXT and ETC1 levels are decompressed in parallel when a work queue is given. Return true if successful.
+    bool Decompress(unsigned char* dest, WorkQueue* queue = nullptr);
 
     /// Compressed image data.
     unsigned char* data_{};
@@ -115,8 +136,10 @@ public:
     bool FlipHorizontal();
     /// Flip image vertically. Return true if successful.
     bool FlipVertical();
-    /// Resize image by bilinear resampling. Return true if successful.
-    bool Resize(int width, int height);
+    /// Resize image by resampling with the specified filter. Return true if successful.
+    bool Resize(int width, int height, ResampleFilter filter = RESAMPLE_BILINEAR);
+    /// Compress to DXT1, DXT3, DXT5 or ETC1 with a full mip chain. Large levels are split to the worker threads when called from the main thread. 3D images are not supported. Return true if successful.
+    bool Compress(CompressedFormat format, CompressionQuality quality = COMPRESSION_NORMAL);
     /// Clear the image with a color.
     void Clear(const Color& color);
     /// Clear the image with an integer color. R component is in the 8 lowest bits.
@@ -129,7 +152,7 @@ public:
     bool SaveTGA(const String& fileName) const;
     /// Save in JPG format with specified quality. Return true if successful.
     bool SaveJPG(const String& fileName, int quality) const;
-    /// Save in DDS format. Only uncompressed RGBA images are supported. Return true if successful.
+    /// Save in DDS format. Uncompressed RGBA and DXT1, DXT3, DXT5 or ETC1 compressed 2D images are supported. Return true if successful.
     bool SaveDDS(const String& fileName) const;
     /// Save in WebP format with minimum (fastest) or specified compression. Return true if successful. Fails always if WebP support is not compiled in.
     bool SaveWEBP(const String& fileName, float compression = 0.0f) const;
@@ -137,7 +160,9 @@ public:
     bool IsCubemap() const { return cubemap_; }
     /// Whether this texture has been detected as a volume, only relevant for DDS.
     bool IsArray() const { return array_; }
-    /// Whether this texture is in sRGB, only relevant for DDS.
+    /// Set whether the color data is in sRGB. Mip levels of sRGB images are averaged in linear space.
+    void SetSRGB(bool enable) { sRGB_ = enable; }
+    /// Whether the color data is in sRGB. Detected from DDS files or set with SetSRGB().
     bool IsSRGB() const { return sRGB_; }
 
     /// Return a 2D pixel color.
@@ -185,11 +210,13 @@ public:
     SharedPtr<Image> ConvertToRGBA() const;
     /// Return a compressed mip level.
     CompressedLevel GetCompressedLevel(unsigned index) const;
+    /// Return a compressed image decompressed to RGBA. The compressed mip levels are kept as the precalculated mip levels of the result. 3D, cube and array images are not supported. Return null if failed.
+    SharedPtr<Image> GetDecompressedImage() const;
     /// Return subimage from the image by the defined rect or null if failed. 3D images are not supported. You must free the subimage yourself.
     Image* GetSubimage(const IntRect& rect) const;
     /// Return an SDL surface from the image, or null if failed. Only RGB images are supported. Specify rect to only return partial image. You must free the surface yourself.
     SDL_Surface* GetSDLSurface(const IntRect& rect = IntRect::ZERO) const;
-    /// Precalculate the mip levels. Used by asynchronous texture loading.
+    /// Precalculate the mip levels. Used by asynchronous texture loading. Large levels are split to the worker threads only when called from the main thread, so during asynchronous loading they are calculated serially on the loading thread, which keeps the main thread free. Synchronously loaded textures calculate their levels on upload from the main thread and use the worker threads.
     void PrecalculateLevels();
     /// Whether this texture has an alpha channel
     bool HasAlphaChannel() const;
@@ -207,6 +234,8 @@ private:
     static unsigned char* GetImageData(Deserializer& source, int& width, int& height, unsigned& components);
     /// Free an image file's pixel data.
     static void FreeImageData(unsigned char* pixelData);
+    /// Write compressed image data in DDS format. Return true if successful.
+    bool SaveCompressedDDS(Serializer& dest) const;
 
     /// Width.
     int width_{};
@@ -29,6 +29,7 @@
 #include "../IO/Log.h"
 #include "../IO/MemoryBuffer.h"
 #include "../Resource/JSONFile.h"
+#include "../Resource/JSONView.h"
 #include "../Resource/ResourceCache.h"
 
 #include <rapidjson/document.h>
@@ -42,6 +43,15 @@ using namespace rapidjson;
 namespace Urho3D
 {
 
+/// Document parsed in place, along with the buffer its strings refer to.
+struct JSONFile::ParsedDocument
+{
+    /// Buffer parsed in place.
+    SharedArrayPtr<char> buffer_;
+    /// Parsed document.
+    rapidjson::Document document_;
+};
+
 JSONFile::JSONFile(Context* context) :
     Resource(context)
 {
@@ -54,63 +64,6 @@ void JSONFile::RegisterObject(Context* context)
     context->RegisterFactory<JSONFile>();
 }
 
-// Convert rapidjson value to JSON value.
-static void ToJSONValue(JSONValue& jsonValue, const rapidjson::Value& rapidjsonValue)
-{
-    switch (rapidjsonValue.GetType())
-    {
-    case kNullType:
-        // Reset to null type
-        jsonValue.SetType(JSON_NULL);
-        break;
-
-    case kFalseType:
-        jsonValue = false;
-        break;
-
-    case kTrueType:
-        jsonValue = true;
-        break;
-
-    case kNumberType:
-        if (rapidjsonValue.IsInt())
-            jsonValue = rapidjsonValue.GetInt();
-        else if (rapidjsonValue.IsUint())
-            jsonValue = rapidjsonValue.GetUint();
-        else
-            jsonValue = rapidjsonValue.GetDouble();
-        break;
-
-    case kStringType:
-        jsonValue = rapidjsonValue.GetString();
-        break;
-
-    case kArrayType:
-        {
-            jsonValue.Resize(rapidjsonValue.Size());
-            for (unsigned i = 0; i < rapidjsonValue.Size(); ++i)
-            {
-                ToJSONValue(jsonValue[i], rapidjsonValue[i]);
-            }
-        }
-        break;
-
-    case kObjectType:
-        {
-            jsonValue.SetType(JSON_OBJECT);
-            for (rapidjson::Value::ConstMemberIterator i = rapidjsonValue.MemberBegin(); i != rapidjsonValue.MemberEnd(); ++i)
-            {
-                JSONValue& value = jsonValue[String(i->name.GetString())];
-                ToJSONValue(value, i->value);
-            }
-        }
-        break;
-
-    default:
-        break;
-    }
-}
-
 bool JSONFile::BeginLoad(Deserializer& source)
 {
     unsigned dataSize = source.GetSize();
@@ -125,16 +78,22 @@ bool JSONFile::BeginLoad(Deserializer& source)
         return false;
     buffer[dataSize] = '\0';
 
-    rapidjson::Document document;
-    if (document.Parse<kParseCommentsFlag | kParseTrailingCommasFlag>(buffer).HasParseError())
+    // Parse in place so that rapidjson refers to the strings in the buffer instead of copying them. The document is
+    // kept for views and only converted into JSON values when the root value is requested
+    UniquePtr<ParsedDocument> document(new ParsedDocument());
+    if (document->document_.ParseInsitu<kParseCommentsFlag | kParseTrailingCommasFlag>(buffer.Get()).HasParseError())
     {
         URHO3D_LOGERROR("Could not parse JSON data from " + source.GetName());
         return false;
     }
 
-    ToJSONValue(root_, document);
-
-    SetMemoryUse(dataSize);
+    MutexLock lock(mutex_);
+    document->buffer_ = buffer;
+    document_ = std::move(document);
+    root_.SetType(JSON_NULL);
+    rootConverted_ = false;
+    dataSize_ = dataSize;
+    UpdateMemoryUse();
 
     return true;
 }
@@ -218,7 +177,7 @@ bool JSONFile::Save(Serializer& dest) const
 bool JSONFile::Save(Serializer& dest, const String& indendation) const
 {
     rapidjson::Document document;
-    ToRapidjsonValue(document, root_, document.GetAllocator());
+    ToRapidjsonValue(document, GetRoot(), document.GetAllocator());
 
     StringBuffer buffer;
     PrettyWriter<StringBuffer> writer(buffer);
@@ -248,14 +207,70 @@ bool JSONFile::ParseJSON(const String& json, JSONValue& value, bool reportError)
 
         return false;
     }
-    ToJSONValue(value, document);
+    JSONView(&document).CopyTo(value);
     return true;
 }
 
+JSONValue& JSONFile::GetRoot()
+{
+    MutexLock lock(mutex_);
+    ConvertRoot();
+    // The root value may be modified through the returned reference, so views of the parsed document would go stale
+    if (document_)
+    {
+        document_.Reset();
+        UpdateMemoryUse();
+    }
+    return root_;
+}
+
+const JSONValue& JSONFile::GetRoot() const
+{
+    MutexLock lock(mutex_);
+    ConvertRoot();
+    return root_;
+}
+
+JSONView JSONFile::GetRootView() const
+{
+    MutexLock lock(mutex_);
+    if (!document_)
+    {
+        // The root value has been accessed for modification, so build a document from it again
+        document_ = new ParsedDocument();
+        ToRapidjsonValue(document_->document_, root_, document_->document_.GetAllocator());
+        UpdateMemoryUse();
+    }
+
+    return JSONView(&document_->document_);
+}
+
+void JSONFile::ConvertRoot() const
+{
+    if (rootConverted_)
+        return;
+
+    URHO3D_PROFILE("ConvertJSONRoot");
+
+    JSONView(&document_->document_).CopyTo(root_);
+    rootConverted_ = true;
+    UpdateMemoryUse();
+}
+
+void JSONFile::UpdateMemoryUse() const
+{
+    // The converted root value is estimated by the size of the data it was loaded from. Views refer to the parsed buffer
+    // and the allocator of the retained document
+    unsigned memoryUse = rootConverted_ ? dataSize_ : 0;
+    if (document_)
+        memoryUse += (document_->buffer_ ? dataSize_ + 1 : 0) + (unsigned)document_->document_.GetAllocator().Capacity();
+    const_cast<JSONFile*>(this)->SetMemoryUse(memoryUse);
+}
+
 String JSONFile::ToString(const String& indendation) const
 {
     rapidjson::Document document;
-    ToRapidjsonValue(document, root_, document.GetAllocator());
+    ToRapidjsonValue(document, GetRoot(), document.GetAllocator());
 
     StringBuffer buffer;
     PrettyWriter<StringBuffer> writer(buffer);
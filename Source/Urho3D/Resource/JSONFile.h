@@ -22,8 +22,10 @@
 
 #pragma once
 
+#include "../Core/Mutex.h"
 #include "../Resource/Resource.h"
 #include "../Resource/JSONValue.h"
+#include "../Resource/JSONView.h"
 
 namespace Urho3D
 {
@@ -53,16 +55,33 @@ public:
     /// Save to a string.
     String ToString(const String& indendation = "\t") const;
 
-    /// Return root value.
-    JSONValue& GetRoot() { return root_; }
-    /// Return root value.
-    const JSONValue& GetRoot() const { return root_; }
+    /// Return root value. Converts the parsed document on first access and releases it, as the root value may then be modified.
+    JSONValue& GetRoot();
+    /// Return root value. Converts the parsed document on first access. Safe to call from several threads.
+    const JSONValue& GetRoot() const;
+    /// Return read-only view of the root value. Refers to the buffer parsed in place without converting it into JSON values. Valid until the file is loaded again or the root value is accessed for modification. Safe to call from several threads.
+    JSONView GetRootView() const;
 
     /// Return true if parsing json string into JSONValue succeeds.
     static bool ParseJSON(const String& json, JSONValue& value, bool reportError = true);
 private:
-    /// JSON root value.
-    JSONValue root_;
+    struct ParsedDocument;
+
+    /// Convert the parsed document into the root value if not done yet. Must be called with the mutex locked.
+    void ConvertRoot() const;
+    /// Update the memory use from the root value and the retained document. Must be called with the mutex locked.
+    void UpdateMemoryUse() const;
+
+    /// Parsed document and the buffer it refers to.
+    mutable UniquePtr<ParsedDocument> document_;
+    /// JSON root value, converted from the parsed document on demand.
+    mutable JSONValue root_;
+    /// Whether the root value is up to date with the parsed document.
+    mutable bool rootConverted_{true};
+    /// Size of the loaded JSON data.
+    unsigned dataSize_{};
+    /// Mutex for the conversions done on demand from const accessors.
+    mutable Mutex mutex_;
 };
 
 }
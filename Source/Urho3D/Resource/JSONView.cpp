@@ -0,0 +1,368 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/StringUtils.h"
+#include "../IO/Log.h"
+#include "../Resource/JSONView.h"
+
+#include <rapidjson/document.h>
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+static inline const rapidjson::Value* ToRapidjson(const void* value)
+{
+    return static_cast<const rapidjson::Value*>(value);
+}
+
+JSONValueType JSONView::GetValueType() const
+{
+    if (!value_)
+        return JSON_NULL;
+
+    switch (ToRapidjson(value_)->GetType())
+    {
+    case rapidjson::kFalseType:
+    case rapidjson::kTrueType:
+        return JSON_BOOL;
+
+    case rapidjson::kNumberType:
+        return JSON_NUMBER;
+
+    case rapidjson::kStringType:
+        return JSON_STRING;
+
+    case rapidjson::kArrayType:
+        return JSON_ARRAY;
+
+    case rapidjson::kObjectType:
+        return JSON_OBJECT;
+
+    default:
+        return JSON_NULL;
+    }
+}
+
+JSONNumberType JSONView::GetNumberType() const
+{
+    if (!IsNumber())
+        return JSONNT_NAN;
+
+    const rapidjson::Value* value = ToRapidjson(value_);
+    if (value->IsInt())
+        return JSONNT_INT;
+    else if (value->IsUint())
+        return JSONNT_UINT;
+    else
+        return JSONNT_FLOAT_DOUBLE;
+}
+
+bool JSONView::GetBool() const
+{
+    return IsBool() ? ToRapidjson(value_)->GetBool() : false;
+}
+
+int JSONView::GetInt() const
+{
+    return IsNumber() ? (int)ToRapidjson(value_)->GetDouble() : 0;
+}
+
+unsigned JSONView::GetUInt() const
+{
+    return IsNumber() ? (unsigned)ToRapidjson(value_)->GetDouble() : 0;
+}
+
+float JSONView::GetFloat() const
+{
+    return IsNumber() ? (float)ToRapidjson(value_)->GetDouble() : 0.0f;
+}
+
+double JSONView::GetDouble() const
+{
+    return IsNumber() ? ToRapidjson(value_)->GetDouble() : 0.0;
+}
+
+const char* JSONView::GetCString() const
+{
+    return IsString() ? ToRapidjson(value_)->GetString() : "";
+}
+
+unsigned JSONView::GetStringLength() const
+{
+    return IsString() ? ToRapidjson(value_)->GetStringLength() : 0;
+}
+
+StringHash JSONView::GetStringHash() const
+{
+    if (!IsString())
+        return StringHash();
+
+    const rapidjson::Value* value = ToRapidjson(value_);
+    return StringHash(StringHash::Calculate((void*)value->GetString(), value->GetStringLength()));
+}
+
+String JSONView::GetString() const
+{
+    return IsString() ? String(ToRapidjson(value_)->GetString(), ToRapidjson(value_)->GetStringLength()) : String::EMPTY;
+}
+
+unsigned JSONView::Size() const
+{
+    switch (GetValueType())
+    {
+    case JSON_ARRAY:
+        return ToRapidjson(value_)->Size();
+
+    case JSON_OBJECT:
+        return ToRapidjson(value_)->MemberCount();
+
+    default:
+        return 0;
+    }
+}
+
+JSONView JSONView::operator [](unsigned index) const
+{
+    if (!IsArray() || index >= ToRapidjson(value_)->Size())
+        return JSONView();
+
+    return JSONView(&(*ToRapidjson(value_))[index]);
+}
+
+JSONView JSONView::Get(const char* key) const
+{
+    if (!IsObject())
+        return JSONView();
+
+    const rapidjson::Value* value = ToRapidjson(value_);
+    rapidjson::Value::ConstMemberIterator i = value->FindMember(key);
+    return i != value->MemberEnd() ? JSONView(&i->value) : JSONView();
+}
+
+const char* JSONView::GetMemberName(unsigned index) const
+{
+    if (!IsObject() || index >= ToRapidjson(value_)->MemberCount())
+        return "";
+
+    return (ToRapidjson(value_)->MemberBegin() + index)->name.GetString();
+}
+
+unsigned JSONView::GetMemberNameLength(unsigned index) const
+{
+    if (!IsObject() || index >= ToRapidjson(value_)->MemberCount())
+        return 0;
+
+    return (ToRapidjson(value_)->MemberBegin() + index)->name.GetStringLength();
+}
+
+JSONView JSONView::GetMemberValue(unsigned index) const
+{
+    if (!IsObject() || index >= ToRapidjson(value_)->MemberCount())
+        return JSONView();
+
+    return JSONView(&(ToRapidjson(value_)->MemberBegin() + index)->value);
+}
+
+Variant JSONView::GetVariant() const
+{
+    VariantType type = Variant::GetTypeFromName(Get("type").GetCString());
+    return Get("value").GetVariantValue(type);
+}
+
+Variant JSONView::GetVariantValue(VariantType type) const
+{
+    Variant variant;
+    switch (type)
+    {
+    case VAR_BOOL:
+        variant = GetBool();
+        break;
+
+    case VAR_INT:
+        variant = GetInt();
+        break;
+
+    case VAR_FLOAT:
+        variant = GetFloat();
+        break;
+
+    case VAR_DOUBLE:
+        variant = GetDouble();
+        break;
+
+    case VAR_STRING:
+        variant = GetString();
+        break;
+
+    case VAR_VARIANTVECTOR:
+        variant = GetVariantVector();
+        break;
+
+    case VAR_VARIANTMAP:
+        variant = GetVariantMap();
+        break;
+
+    case VAR_RESOURCEREF:
+        {
+            ResourceRef ref;
+            StringVector values = String::Split(GetCString(), ';');
+            if (values.Size() == 2)
+            {
+                ref.type_ = values[0];
+                ref.name_ = values[1];
+            }
+            variant = ref;
+        }
+        break;
+
+    case VAR_RESOURCEREFLIST:
+        {
+            ResourceRefList refList;
+            StringVector values = String::Split(GetCString(), ';', true);
+            if (values.Size() >= 1)
+            {
+                refList.type_ = values[0];
+                refList.names_.Resize(values.Size() - 1);
+                for (unsigned i = 1; i < values.Size(); ++i)
+                    refList.names_[i - 1] = values[i];
+            }
+            variant = refList;
+        }
+        break;
+
+    case VAR_STRINGVECTOR:
+        {
+            StringVector vector;
+            for (unsigned i = 0; i < Size(); ++i)
+                vector.Push((*this)[i].GetString());
+            variant = vector;
+        }
+        break;
+
+    default:
+        variant.FromString(type, GetCString());
+    }
+
+    return variant;
+}
+
+VariantMap JSONView::GetVariantMap() const
+{
+    VariantMap variantMap;
+    if (!IsObject())
+    {
+        URHO3D_LOGERROR("JSONView is not a object");
+        return variantMap;
+    }
+
+    for (unsigned i = 0; i < Size(); ++i)
+    {
+        /// \todo Ideally this should allow any strings, but for now the convention is that the keys need to be hexadecimal StringHashes
+        StringHash key(ToUInt(GetMemberName(i), 16));
+        variantMap[key] = GetMemberValue(i).GetVariant();
+    }
+
+    return variantMap;
+}
+
+VariantVector JSONView::GetVariantVector() const
+{
+    VariantVector variantVector;
+    if (!IsArray())
+    {
+        URHO3D_LOGERROR("JSONView is not a array");
+        return variantVector;
+    }
+
+    variantVector.Reserve(Size());
+    for (unsigned i = 0; i < Size(); ++i)
+        variantVector.Push((*this)[i].GetVariant());
+
+    return variantVector;
+}
+
+void JSONView::CopyTo(JSONValue& dest) const
+{
+    if (!value_)
+    {
+        dest.SetType(JSON_NULL);
+        return;
+    }
+
+    const rapidjson::Value& value = *ToRapidjson(value_);
+    switch (value.GetType())
+    {
+    case rapidjson::kNullType:
+        // Reset to null type
+        dest.SetType(JSON_NULL);
+        break;
+
+    case rapidjson::kFalseType:
+        dest = false;
+        break;
+
+    case rapidjson::kTrueType:
+        dest = true;
+        break;
+
+    case rapidjson::kNumberType:
+        if (value.IsInt())
+            dest = value.GetInt();
+        else if (value.IsUint())
+            dest = value.GetUint();
+        else
+            dest = value.GetDouble();
+        break;
+
+    case rapidjson::kStringType:
+        dest = String(value.GetString(), value.GetStringLength());
+        break;
+
+    case rapidjson::kArrayType:
+        {
+            dest.Resize(value.Size());
+            for (unsigned i = 0; i < value.Size(); ++i)
+                JSONView(&value[i]).CopyTo(dest[i]);
+        }
+        break;
+
+    case rapidjson::kObjectType:
+        {
+            dest.SetType(JSON_OBJECT);
+            for (rapidjson::Value::ConstMemberIterator i = value.MemberBegin(); i != value.MemberEnd(); ++i)
+            {
+                JSONValue& member = dest[String(i->name.GetString(), i->name.GetStringLength())];
+                JSONView(&i->value).CopyTo(member);
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+}
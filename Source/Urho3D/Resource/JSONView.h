@@ -0,0 +1,113 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Resource/JSONValue.h"
+
+namespace Urho3D
+{
+
+/// Read-only view of a JSON value parsed in place. Strings point into the parsed buffer and are returned without copying. A view is valid only as long as the document it was returned from.
+class URHO3D_API JSONView
+{
+public:
+    /// Construct null view.
+    JSONView() noexcept :
+        value_(nullptr)
+    {
+    }
+
+    /// Construct from a rapidjson value, internal function.
+    explicit JSONView(const void* value) noexcept :
+        value_(value)
+    {
+    }
+
+    /// Return value type. Return null type if the view does not refer to a value.
+    JSONValueType GetValueType() const;
+    /// Return number type.
+    JSONNumberType GetNumberType() const;
+
+    /// Check is null or does not refer to a value.
+    bool IsNull() const { return GetValueType() == JSON_NULL; }
+    /// Check is boolean.
+    bool IsBool() const { return GetValueType() == JSON_BOOL; }
+    /// Check is number.
+    bool IsNumber() const { return GetValueType() == JSON_NUMBER; }
+    /// Check is string.
+    bool IsString() const { return GetValueType() == JSON_STRING; }
+    /// Check is array.
+    bool IsArray() const { return GetValueType() == JSON_ARRAY; }
+    /// Check is object.
+    bool IsObject() const { return GetValueType() == JSON_OBJECT; }
+
+    /// Return boolean value.
+    bool GetBool() const;
+    /// Return integer value.
+    int GetInt() const;
+    /// Return unsigned integer value.
+    unsigned GetUInt() const;
+    /// Return float value.
+    float GetFloat() const;
+    /// Return double value.
+    double GetDouble() const;
+    /// Return string value without copying, or empty string if not a string.
+    const char* GetCString() const;
+    /// Return length of string value.
+    unsigned GetStringLength() const;
+    /// Return hash of string value without registering it for reverse lookup.
+    StringHash GetStringHash() const;
+    /// Return a copy of string value.
+    String GetString() const;
+
+    /// Return size of array or number of members in object.
+    unsigned Size() const;
+    /// Return array element at index, or null view if out of range.
+    JSONView operator [](unsigned index) const;
+    /// Return object member value with key, or null view if not found.
+    JSONView Get(const char* key) const;
+    /// Return name of object member at index without copying.
+    const char* GetMemberName(unsigned index) const;
+    /// Return length of the name of object member at index.
+    unsigned GetMemberNameLength(unsigned index) const;
+    /// Return value of object member at index.
+    JSONView GetMemberValue(unsigned index) const;
+
+    /// Return a variant.
+    Variant GetVariant() const;
+    /// Return a variant with type. Parses string encoded values directly from the parsed buffer.
+    Variant GetVariantValue(VariantType type) const;
+    /// Return a variant map.
+    VariantMap GetVariantMap() const;
+    /// Return a variant vector.
+    VariantVector GetVariantVector() const;
+
+    /// Copy into a JSON value.
+    void CopyTo(JSONValue& dest) const;
+
+private:
+    /// Viewed rapidjson value.
+    const void* value_;
+};
+
+}
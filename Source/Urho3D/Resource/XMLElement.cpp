@@ -753,7 +753,7 @@ Vector<String> XMLElement::GetAttributeNames() const
 
 bool XMLElement::GetBool(const String& name) const
 {
-    return ToBool(GetAttribute(name));
+    return ToBool(GetAttributeCString(name.CString()));
 }
 
 BoundingBox XMLElement::GetBoundingBox() const
@@ -786,67 +786,67 @@ bool XMLElement::GetBuffer(const String& name, void* dest, unsigned size) const
 
 Color XMLElement::GetColor(const String& name) const
 {
-    return ToColor(GetAttribute(name));
+    return ToColor(GetAttributeCString(name.CString()));
 }
 
 float XMLElement::GetFloat(const String& name) const
 {
-    return ToFloat(GetAttribute(name));
+    return ToFloat(GetAttributeCString(name.CString()));
 }
 
 double XMLElement::GetDouble(const String& name) const
 {
-    return ToDouble(GetAttribute(name));
+    return ToDouble(GetAttributeCString(name.CString()));
 }
 
 unsigned XMLElement::GetUInt(const String& name) const
 {
-    return ToUInt(GetAttribute(name));
+    return ToUInt(GetAttributeCString(name.CString()));
 }
 
 int XMLElement::GetInt(const String& name) const
 {
-    return ToInt(GetAttribute(name));
+    return ToInt(GetAttributeCString(name.CString()));
 }
 
 unsigned long long XMLElement::GetUInt64(const String& name) const
 {
-    return ToUInt64(GetAttribute(name));
+    return ToUInt64(GetAttributeCString(name.CString()));
 }
 
 long long XMLElement::GetInt64(const String& name) const
 {
-    return ToInt64(GetAttribute(name));
+    return ToInt64(GetAttributeCString(name.CString()));
 }
 
 IntRect XMLElement::GetIntRect(const String& name) const
 {
-    return ToIntRect(GetAttribute(name));
+    return ToIntRect(GetAttributeCString(name.CString()));
 }
 
 IntVector2 XMLElement::GetIntVector2(const String& name) const
 {
-    return ToIntVector2(GetAttribute(name));
+    return ToIntVector2(GetAttributeCString(name.CString()));
 }
 
 IntVector3 XMLElement::GetIntVector3(const String& name) const
 {
-    return ToIntVector3(GetAttribute(name));
+    return ToIntVector3(GetAttributeCString(name.CString()));
 }
 
 Quaternion XMLElement::GetQuaternion(const String& name) const
 {
-    return ToQuaternion(GetAttribute(name));
+    return ToQuaternion(GetAttributeCString(name.CString()));
 }
 
 Rect XMLElement::GetRect(const String& name) const
 {
-    return ToRect(GetAttribute(name));
+    return ToRect(GetAttributeCString(name.CString()));
 }
 
 Variant XMLElement::GetVariant() const
 {
-    VariantType type = Variant::GetTypeFromName(GetAttribute("type"));
+    VariantType type = Variant::GetTypeFromName(GetAttributeCString("type"));
     return GetVariantValue(type);
 }
 
@@ -874,11 +874,13 @@ ResourceRef XMLElement::GetResourceRef() const
 {
     ResourceRef ret;
 
-    Vector<String> values = GetAttribute("value").Split(';');
-    if (values.Size() == 2)
+    // Split "type;name" in place, without allocating temporary strings
+    const char* value = GetAttributeCString("value");
+    const char* separator = value ? strchr(value, ';') : nullptr;
+    if (separator && separator != value && separator[1] && !strchr(separator + 1, ';'))
     {
-        ret.type_ = values[0];
-        ret.name_ = values[1];
+        ret.type_ = StringHash(String(value, (unsigned)(separator - value)));
+        ret.name_ = separator + 1;
     }
 
     return ret;
@@ -888,13 +890,17 @@ ResourceRefList XMLElement::GetResourceRefList() const
 {
     ResourceRefList ret;
 
-    Vector<String> values = GetAttribute("value").Split(';', true);
-    if (values.Size() >= 1)
+    const char* value = GetAttributeCString("value");
+    if (value && *value)
     {
-        ret.type_ = values[0];
-        ret.names_.Resize(values.Size() - 1);
-        for (unsigned i = 1; i < values.Size(); ++i)
-            ret.names_[i - 1] = values[i];
+        const char* separator = strchr(value, ';');
+        ret.type_ = StringHash(separator ? String(value, (unsigned)(separator - value)) : String(value));
+        while (separator)
+        {
+            const char* start = separator + 1;
+            separator = strchr(start, ';');
+            ret.names_.Push(separator ? String(start, (unsigned)(separator - start)) : String(start));
+        }
     }
 
     return ret;
@@ -937,7 +943,7 @@ VariantMap XMLElement::GetVariantMap() const
     {
         // If this is a manually edited map, user can not be expected to calculate hashes manually. Also accept "name" attribute
         if (variantElem.HasAttribute("name"))
-            ret[StringHash(variantElem.GetAttribute("name"))] = variantElem.GetVariant();
+            ret[StringHash(variantElem.GetAttributeCString("name"))] = variantElem.GetVariant();
         else if (variantElem.HasAttribute("hash"))
             ret[StringHash(variantElem.GetUInt("hash"))] = variantElem.GetVariant();
 
@@ -949,42 +955,42 @@ VariantMap XMLElement::GetVariantMap() const
 
 Vector2 XMLElement::GetVector2(const String& name) const
 {
-    return ToVector2(GetAttribute(name));
+    return ToVector2(GetAttributeCString(name.CString()));
 }
 
 Vector3 XMLElement::GetVector3(const String& name) const
 {
-    return ToVector3(GetAttribute(name));
+    return ToVector3(GetAttributeCString(name.CString()));
 }
 
 Vector4 XMLElement::GetVector4(const String& name) const
 {
-    return ToVector4(GetAttribute(name));
+    return ToVector4(GetAttributeCString(name.CString()));
 }
 
 Vector4 XMLElement::GetVector(const String& name) const
 {
-    return ToVector4(GetAttribute(name), true);
+    return ToVector4(GetAttributeCString(name.CString()), true);
 }
 
 Variant XMLElement::GetVectorVariant(const String& name) const
 {
-    return ToVectorVariant(GetAttribute(name));
+    return ToVectorVariant(GetAttributeCString(name.CString()));
 }
 
 Matrix3 XMLElement::GetMatrix3(const String& name) const
 {
-    return ToMatrix3(GetAttribute(name));
+    return ToMatrix3(GetAttributeCString(name.CString()));
 }
 
 Matrix3x4 XMLElement::GetMatrix3x4(const String& name) const
 {
-    return ToMatrix3x4(GetAttribute(name));
+    return ToMatrix3x4(GetAttributeCString(name.CString()));
 }
 
 Matrix4 XMLElement::GetMatrix4(const String& name) const
 {
-    return ToMatrix4(GetAttribute(name));
+    return ToMatrix4(GetAttributeCString(name.CString()));
 }
 
 XMLFile* XMLElement::GetFile() const
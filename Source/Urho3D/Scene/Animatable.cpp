@@ -26,6 +26,7 @@
 #include "../IO/Log.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/JSONValue.h"
+#include "../Resource/JSONView.h"
 #include "../Resource/XMLElement.h"
 #include "../Scene/Animatable.h"
 #include "../Scene/ObjectAnimation.h"
@@ -125,10 +126,35 @@ bool Animatable::LoadJSON(const JSONValue& source)
     if (!Serializable::LoadJSON(source))
         return false;
 
+    return LoadAnimationsJSON(source);
+}
+
+bool Animatable::LoadJSON(const JSONView& source)
+{
+    if (!CanLoadJSONView())
+        return LoadJSONValueCopy(source);
+
+    if (!Serializable::LoadJSON(source))
+        return false;
+
+    // Animations are rare and loaded from JSON values, so convert only them
+    JSONValue animations(JSON_OBJECT);
+    JSONView objectAnimationValue = source.Get("objectanimation");
+    if (!objectAnimationValue.IsNull())
+        objectAnimationValue.CopyTo(animations["objectanimation"]);
+    JSONView attributeAnimationValue = source.Get("attributeanimation");
+    if (!attributeAnimationValue.IsNull())
+        attributeAnimationValue.CopyTo(animations["attributeanimation"]);
+
+    return LoadAnimationsJSON(animations);
+}
+
+bool Animatable::LoadAnimationsJSON(const JSONValue& source)
+{
     SetObjectAnimation(nullptr);
     attributeAnimationInfos_.Clear();
 
-    JSONValue value = source.Get("objectanimation");
+    const JSONValue& value = source.Get("objectanimation");
     if (!value.IsNull())
     {
         SharedPtr<ObjectAnimation> objectAnimation(context_->CreateObject<ObjectAnimation>());
@@ -138,7 +164,7 @@ bool Animatable::LoadJSON(const JSONValue& source)
         SetObjectAnimation(objectAnimation);
     }
 
-    JSONValue attributeAnimationValue = source.Get("attributeanimation");
+    const JSONValue& attributeAnimationValue = source.Get("attributeanimation");
 
     if (attributeAnimationValue.IsNull())
         return true;
@@ -152,8 +178,8 @@ bool Animatable::LoadJSON(const JSONValue& source)
     const JSONObject& attributeAnimationObject = attributeAnimationValue.GetObject();
     for (JSONObject::ConstIterator it = attributeAnimationObject.Begin(); it != attributeAnimationObject.End(); it++)
     {
-        String name = it->first_;
-        JSONValue value = it->second_;
+        const String& name = it->first_;
+        const JSONValue& value = it->second_;
         SharedPtr<ValueAnimation> attributeAnimation(context_->CreateObject<ValueAnimation>());
         if (!attributeAnimation->LoadJSON(it->second_))
             return false;
@@ -78,6 +78,8 @@ public:
     bool SaveXML(XMLElement& dest) const override;
     /// Load from JSON data. Return true if successful.
     bool LoadJSON(const JSONValue& source) override;
+    /// Load from a read-only view of JSON data. Return true if successful.
+    bool LoadJSON(const JSONView& source) override;
     /// Save as JSON data. Return true if successful.
     bool SaveJSON(JSONValue& dest) const override;
 
@@ -138,6 +140,8 @@ protected:
     void UpdateAttributeAnimations(float timeStep);
     /// Is animated network attribute.
     bool IsAnimatedNetworkAttribute(const AttributeInfo& attrInfo) const;
+    /// Load object and attribute animations from JSON data after the attributes. Return true if successful.
+    bool LoadAnimationsJSON(const JSONValue& source);
     /// Return attribute animation info.
     AttributeAnimationInfo* GetAttributeAnimationInfo(const String& name) const;
     /// Handle attribute animation added.
@@ -165,6 +165,12 @@ void Component::AddReplicationState(ComponentReplicationState* state)
     networkState_->replicationStates_.Push(state);
 }
 
+void Component::RemoveReplicationState(ComponentReplicationState* state)
+{
+    if (networkState_)
+        networkState_->replicationStates_.Remove(state);
+}
+
 void Component::PrepareNetworkUpdate()
 {
     if (!networkState_)
@@ -177,6 +183,9 @@ void Component::PrepareNetworkUpdate()
     unsigned numAttributes = attributes->Size();
 
     // Check for attribute changes
+    DirtyBits changedAttributes;
+    Scene* scene = GetScene();
+    unsigned frame = scene ? scene->GetNetworkFrame() : 0;
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         const AttributeInfo& attr = attributes->At(i);
@@ -189,6 +198,9 @@ void Component::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            changedAttributes.Set(i);
+            networkState_->changedFrames_[i] = frame;
+            networkState_->lastChangedFrame_ = frame;
 
             // Mark the attribute dirty in all replication states that are tracking this component
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
@@ -208,6 +220,8 @@ void Component::PrepareNetworkUpdate()
         }
     }
 
+    EncodeNetworkState(changedAttributes);
+
     networkUpdate_ = false;
 }
 
@@ -103,6 +103,8 @@ public:
 
     /// Add a replication state that is tracking this component.
     void AddReplicationState(ComponentReplicationState* state);
+    /// Remove a replication state that is tracking this component.
+    void RemoveReplicationState(ComponentReplicationState* state);
     /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
     void PrepareNetworkUpdate();
     /// Clean up all references to a network connection that is about to be removed.
@@ -28,6 +28,7 @@
 #include "../IO/MemoryBuffer.h"
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
+#include "../Resource/JSONView.h"
 #include "../Scene/Component.h"
 #include "../Scene/ObjectAnimation.h"
 #include "../Scene/ReplicationState.h"
@@ -191,6 +192,28 @@ bool Node::LoadJSON(const JSONValue& source)
     return success;
 }
 
+bool Node::LoadJSON(const JSONView& source)
+{
+    if (!CanLoadJSONView())
+        return LoadJSONValueCopy(source);
+
+    SceneResolver resolver;
+
+    // Read own ID. Will not be applied, only stored for resolving possible references
+    unsigned nodeID = source.Get("id").GetUInt();
+    resolver.AddNode(nodeID, this);
+
+    // Read attributes, components and child nodes
+    bool success = LoadJSON(source, resolver);
+    if (success)
+    {
+        resolver.Resolve();
+        ApplyAttributes();
+    }
+
+    return success;
+}
+
 bool Node::SaveXML(XMLElement& dest) const
 {
     // Write node ID
@@ -298,6 +321,12 @@ void Node::AddReplicationState(NodeReplicationState* state)
     networkState_->replicationStates_.Push(state);
 }
 
+void Node::RemoveReplicationState(NodeReplicationState* state)
+{
+    if (networkState_)
+        networkState_->replicationStates_.Remove(state);
+}
+
 bool Node::SaveXML(Serializer& dest, const String& indentation) const
 {
     SharedPtr<XMLFile> xml(context_->CreateObject<XMLFile>());
@@ -536,8 +565,11 @@ void Node::SetWorldScale(const Vector3& scale)
 
 void Node::SetWorldTransform(const Vector3& position, const Quaternion& rotation)
 {
-    SetWorldPosition(position);
-    SetWorldRotation(rotation);
+    // Set both at once to dirty the node hierarchy only once
+    if (parent_ == scene_ || !parent_)
+        SetTransform(position, rotation);
+    else
+        SetTransform(parent_->GetWorldTransform().Inverse() * position, parent_->GetWorldRotation().Inverse() * rotation);
 }
 
 void Node::SetWorldTransform(const Vector3& position, const Quaternion& rotation, float scale)
@@ -842,6 +874,17 @@ void Node::AddChild(Node* node, unsigned index)
     for (Vector<SharedPtr<Component> >::Iterator i = node->components_.Begin(); i != node->components_.End(); ++i)
         (*i)->MarkNetworkUpdate();
 
+    // When reparented within the scene, mark the hierarchy dirty also for connections that are not tracking it yet, as it
+    // may have moved into their area of interest
+    if (oldParent && scene_ && node->IsReplicated() && oldParent->GetScene() == scene_)
+    {
+        scene_->MarkReplicationDirty(node);
+        PODVector<Node*> children;
+        node->GetChildren(children, true);
+        for (PODVector<Node*>::ConstIterator i = children.Begin(); i != children.End(); ++i)
+            scene_->MarkReplicationDirty(*i);
+    }
+
     // Send change event
     if (scene_)
     {
@@ -1675,6 +1718,53 @@ bool Node::LoadJSON(const JSONValue& source, SceneResolver& resolver, bool loadC
     return true;
 }
 
+bool Node::LoadJSON(const JSONView& source, SceneResolver& resolver, bool loadChildren, bool rewriteIDs, CreateMode mode)
+{
+    // Remove all children and components first in case this is not a fresh load
+    RemoveAllChildren();
+    RemoveAllComponents();
+
+    if (!Animatable::LoadJSON(source))
+        return false;
+
+    JSONView componentsArray = source.Get("components");
+    unsigned numComponents = componentsArray.IsArray() ? componentsArray.Size() : 0;
+    for (unsigned i = 0; i < numComponents; i++)
+    {
+        JSONView compVal = componentsArray[i];
+        JSONView typeVal = compVal.Get("type");
+        String typeName(typeVal.GetCString(), typeVal.GetStringLength());
+        unsigned compID = compVal.Get("id").GetUInt();
+        Component* newComponent = SafeCreateComponent(typeName, StringHash(typeName),
+            (mode == REPLICATED && Scene::IsReplicatedID(compID)) ? REPLICATED : LOCAL, rewriteIDs ? 0 : compID);
+        if (newComponent)
+        {
+            resolver.AddComponent(compID, newComponent);
+            if (!newComponent->LoadJSON(compVal))
+                return false;
+        }
+    }
+
+    if (!loadChildren)
+        return true;
+
+    JSONView childrenArray = source.Get("children");
+    unsigned numChildren = childrenArray.IsArray() ? childrenArray.Size() : 0;
+    for (unsigned i = 0; i < numChildren; i++)
+    {
+        JSONView childVal = childrenArray[i];
+
+        unsigned nodeID = childVal.Get("id").GetUInt();
+        Node* newNode = CreateChild(rewriteIDs ? 0 : nodeID, (mode == REPLICATED && Scene::IsReplicatedID(nodeID)) ? REPLICATED :
+            LOCAL);
+        resolver.AddNode(nodeID, newNode);
+        if (!newNode->LoadJSON(childVal, resolver, loadChildren, rewriteIDs, mode))
+            return false;
+    }
+
+    return true;
+}
+
 void Node::PrepareNetworkUpdate()
 {
     // Update dependency nodes list first
@@ -1706,6 +1796,8 @@ void Node::PrepareNetworkUpdate()
     unsigned numAttributes = attributes->Size();
 
     // Check for attribute changes
+    DirtyBits changedAttributes;
+    unsigned frame = scene_ ? scene_->GetNetworkFrame() : 0;
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         const AttributeInfo& attr = attributes->At(i);
@@ -1718,6 +1810,9 @@ void Node::PrepareNetworkUpdate()
         if (networkState_->currentValues_[i] != networkState_->previousValues_[i])
         {
             networkState_->previousValues_[i] = networkState_->currentValues_[i];
+            changedAttributes.Set(i);
+            networkState_->changedFrames_[i] = frame;
+            networkState_->lastChangedFrame_ = frame;
 
             // Mark the attribute dirty in all replication states that are tracking this node
             for (PODVector<ReplicationState*>::Iterator j = networkState_->replicationStates_.Begin();
@@ -1736,6 +1831,8 @@ void Node::PrepareNetworkUpdate()
         }
     }
 
+    EncodeNetworkState(changedAttributes);
+
     // Finally check for user var changes
     for (VariantMap::ConstIterator i = vars_.Begin(); i != vars_.End(); ++i)
     {
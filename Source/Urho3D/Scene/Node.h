@@ -90,6 +90,8 @@ public:
     bool LoadXML(const XMLElement& source) override;
     /// Load from JSON data. Return true if successful.
     bool LoadJSON(const JSONValue& source) override;
+    /// Load from a read-only view of JSON data. Return true if successful.
+    bool LoadJSON(const JSONView& source) override;
     /// Save as binary data. Return true if successful.
     bool Save(Serializer& dest) const override;
     /// Save as XML data. Return true if successful.
@@ -106,6 +108,8 @@ public:
     void MarkNetworkUpdate() override;
     /// Add a replication state that is tracking this node.
     virtual void AddReplicationState(NodeReplicationState* state);
+    /// Remove a replication state that is tracking this node.
+    void RemoveReplicationState(NodeReplicationState* state);
 
     /// Save to an XML file. Return true if successful.
     bool SaveXML(Serializer& dest, const String& indentation = "\t") const;
@@ -596,9 +600,12 @@ public:
     /// Load components from XML data and optionally load child nodes.
     bool LoadXML(const XMLElement& source, SceneResolver& resolver, bool loadChildren = true, bool rewriteIDs = false,
         CreateMode mode = REPLICATED);
-    /// Load components from XML data and optionally load child nodes.
+    /// Load components from JSON data and optionally load child nodes.
     bool LoadJSON(const JSONValue& source, SceneResolver& resolver, bool loadChildren = true, bool rewriteIDs = false,
         CreateMode mode = REPLICATED);
+    /// Load components from a read-only view of JSON data and optionally load child nodes.
+    bool LoadJSON(const JSONView& source, SceneResolver& resolver, bool loadChildren = true, bool rewriteIDs = false,
+        CreateMode mode = REPLICATED);
     /// Return the depended on nodes to order network updates.
     const PODVector<Node*>& GetDependencyNodes() const { return impl_->dependencyNodes_; }
 
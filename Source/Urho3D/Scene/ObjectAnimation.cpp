@@ -132,7 +132,7 @@ bool ObjectAnimation::LoadJSON(const JSONValue& source)
 {
     attributeAnimationInfos_.Clear();
 
-    JSONValue attributeAnimationsValue = source.Get("attributeanimations");
+    const JSONValue& attributeAnimationsValue = source.Get("attributeanimations");
     if (attributeAnimationsValue.IsNull())
         return true;
     if (!attributeAnimationsValue.IsObject())
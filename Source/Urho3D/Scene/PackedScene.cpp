@@ -0,0 +1,667 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../IO/VectorBuffer.h"
+#include "../Scene/Component.h"
+#include "../Scene/PackedScene.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneResolver.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+namespace
+{
+
+/// Attribute layout of a type as stored in a packed scene, mapped to the registered attributes when loading.
+struct PackedLayout
+{
+    /// Type.
+    StringHash type_;
+    /// Type name.
+    String typeName_;
+    /// Stored attribute types.
+    PODVector<VariantType> types_;
+    /// Registered attributes matching the stored ones, null when the attribute no longer exists.
+    PODVector<const AttributeInfo*> targets_;
+};
+
+/// Node hierarchy record of a packed scene.
+struct PackedNode
+{
+    /// Stored ID.
+    unsigned id_;
+    /// Index of the parent node.
+    unsigned parentIndex_;
+    /// Index of the first component in the component records.
+    unsigned firstComponent_;
+    /// Number of components.
+    unsigned numComponents_;
+};
+
+/// Component record of a packed scene.
+struct PackedComponent
+{
+    /// Index of the type layout.
+    unsigned typeIndex_;
+    /// Stored ID.
+    unsigned id_;
+};
+
+/// Minimum stored size of a type layout: type hash, empty name and attribute count.
+const unsigned MIN_LAYOUT_SIZE = 6;
+/// Minimum stored size of an attribute in a type layout: empty name and type.
+const unsigned MIN_LAYOUT_ATTRIBUTE_SIZE = 2;
+/// Minimum stored size of a node record: ID and component count.
+const unsigned MIN_NODE_RECORD_SIZE = 5;
+/// Minimum stored size of a component record: type index and ID.
+const unsigned MIN_COMPONENT_RECORD_SIZE = 5;
+
+/// Return whether the remaining data can hold the layouts and records given by the header counts. Checked before
+/// allocating for them, so that corrupt counts fail instead of causing huge allocations.
+bool CheckHeaderCounts(const MemoryBuffer& source, unsigned numNodes, unsigned numComponents, unsigned numTypes)
+{
+    const unsigned long long minSize = (numTypes + 2ULL) * MIN_LAYOUT_SIZE + (unsigned long long)numNodes * MIN_NODE_RECORD_SIZE +
+        (unsigned long long)numComponents * MIN_COMPONENT_RECORD_SIZE;
+    return minSize <= source.GetSize() - source.GetPosition();
+}
+
+/// Return whether an attribute is stored in scene files.
+bool IsSavedAttribute(const AttributeInfo& attr)
+{
+    return (attr.mode_ & AM_FILE) && (attr.mode_ & AM_FILEREADONLY) != AM_FILEREADONLY;
+}
+
+/// Write the layout of a type.
+void WriteLayout(Serializer& dest, StringHash type, const String& typeName, const Vector<AttributeInfo>* attributes)
+{
+    dest.WriteStringHash(type);
+    dest.WriteString(typeName);
+
+    unsigned numAttributes = 0;
+    if (attributes)
+    {
+        for (const AttributeInfo& attr : *attributes)
+        {
+            if (IsSavedAttribute(attr))
+                ++numAttributes;
+        }
+    }
+
+    dest.WriteVLE(numAttributes);
+    if (!numAttributes)
+        return;
+
+    for (const AttributeInfo& attr : *attributes)
+    {
+        if (!IsSavedAttribute(attr))
+            continue;
+        dest.WriteString(attr.name_);
+        dest.WriteUByte((unsigned char)attr.type_);
+    }
+}
+
+/// Write the attributes of an object into a block.
+void WriteAttributes(VectorBuffer& dest, const Serializable* object)
+{
+    const Vector<AttributeInfo>* attributes = object->GetAttributes();
+    if (!attributes)
+        return;
+
+    Variant value;
+    for (const AttributeInfo& attr : *attributes)
+    {
+        if (!IsSavedAttribute(attr))
+            continue;
+        object->OnGetAttribute(attr, value);
+        dest.WriteVariantData(value);
+    }
+}
+
+/// Write a block with its size so that the reader can skip it.
+void WriteBlock(Serializer& dest, const VectorBuffer& block)
+{
+    dest.WriteUInt(block.GetSize());
+    dest.Write(block.GetData(), block.GetSize());
+}
+
+/// Read the layout of a type and map it to the registered attributes, if a context is given. Return false if the attribute
+/// count does not fit in the remaining data.
+bool ReadLayout(MemoryBuffer& source, Context* context, PackedLayout& layout)
+{
+    layout.type_ = source.ReadStringHash();
+    layout.typeName_ = source.ReadString();
+
+    const unsigned numAttributes = source.ReadVLE();
+    if (numAttributes > (source.GetSize() - source.GetPosition()) / MIN_LAYOUT_ATTRIBUTE_SIZE)
+        return false;
+
+    layout.types_.Resize(numAttributes);
+    layout.targets_.Resize(numAttributes);
+
+    const Vector<AttributeInfo>* attributes = context ? context->GetAttributes(layout.type_) : nullptr;
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const String name = source.ReadString();
+        layout.types_[i] = (VariantType)source.ReadUByte();
+        layout.targets_[i] = nullptr;
+
+        if (!attributes)
+            continue;
+
+        // Attributes are usually in the same order as when saved, so check the same index first
+        if (i < attributes->Size() && attributes->At(i).name_ == name && attributes->At(i).type_ == layout.types_[i])
+        {
+            if (IsSavedAttribute(attributes->At(i)))
+                layout.targets_[i] = &attributes->At(i);
+        }
+        else
+        {
+            for (const AttributeInfo& attr : *attributes)
+            {
+                if (attr.name_ == name && attr.type_ == layout.types_[i] && IsSavedAttribute(attr))
+                {
+                    layout.targets_[i] = &attr;
+                    break;
+                }
+            }
+        }
+    }
+
+    return true;
+}
+
+/// Read attributes of an object using a layout. A null object skips the values.
+void ReadAttributes(MemoryBuffer& source, const PackedLayout& layout, Serializable* object, Variant& value)
+{
+    for (unsigned i = 0; i < layout.types_.Size(); ++i)
+    {
+        PackedSceneReader::ReadValue(source, layout.types_[i], value);
+        if (object && layout.targets_[i])
+            object->OnSetAttribute(*layout.targets_[i], value);
+    }
+}
+
+template <class T> void ReadFixedValue(MemoryBuffer& source, Variant& dest)
+{
+    T value;
+    source.Read(&value, sizeof value);
+    dest = value;
+}
+
+}
+
+bool PackedSceneWriter::Write(Serializer& dest, const Node* root)
+{
+    URHO3D_PROFILE("WritePackedScene");
+
+    if (!root)
+        return false;
+
+    Context* context = root->GetContext();
+
+    // Flatten the hierarchy in preorder, so that parents are always created before their children and child order
+    // is preserved
+    PODVector<const Node*> nodes;
+    PODVector<unsigned> parentIndices;
+    PODVector<Pair<const Node*, unsigned> > stack;
+    stack.Push(MakePair(root, M_MAX_UNSIGNED));
+    while (!stack.Empty())
+    {
+        const Pair<const Node*, unsigned> item = stack.Back();
+        stack.Pop();
+
+        const unsigned index = nodes.Size();
+        nodes.Push(item.first_);
+        parentIndices.Push(item.second_);
+
+        const Vector<SharedPtr<Node> >& children = item.first_->GetChildren();
+        for (unsigned i = children.Size() - 1; i < children.Size(); --i)
+        {
+            if (!children[i]->IsTemporary())
+                stack.Push(MakePair(static_cast<const Node*>(children[i].Get()), index));
+        }
+    }
+
+    // Group components by type
+    HashMap<StringHash, unsigned> typeIndices;
+    Vector<PODVector<const Component*> > typeComponents;
+    unsigned numComponents = 0;
+    for (const Node* node : nodes)
+    {
+        for (const SharedPtr<Component>& component : node->GetComponents())
+        {
+            if (component->IsTemporary())
+                continue;
+            if (!context->GetObjectFactories().Contains(component->GetType()))
+            {
+                URHO3D_LOGWARNING("Skipping unregistered component type " + component->GetTypeName() + " in packed scene");
+                continue;
+            }
+
+            auto i = typeIndices.Find(component->GetType());
+            if (i == typeIndices.End())
+            {
+                i = typeIndices.Insert(MakePair(component->GetType(), typeComponents.Size()));
+                typeComponents.Resize(typeComponents.Size() + 1);
+            }
+            typeComponents[i->second_].Push(component.Get());
+            ++numComponents;
+        }
+    }
+
+    // Header
+    if (!dest.WriteFileID(PACKED_SCENE_FILE_ID))
+        return false;
+    dest.WriteUInt(PACKED_SCENE_VERSION);
+    dest.WriteUInt(nodes.Size());
+    dest.WriteUInt(numComponents);
+    dest.WriteUInt(typeComponents.Size());
+
+    // Layouts
+    WriteLayout(dest, root->GetType(), root->GetTypeName(), root->GetAttributes());
+    WriteLayout(dest, Node::GetTypeStatic(), Node::GetTypeNameStatic(), context->GetAttributes(Node::GetTypeStatic()));
+    for (const PODVector<const Component*>& components : typeComponents)
+    {
+        const Component* component = components.Front();
+        WriteLayout(dest, component->GetType(), component->GetTypeName(), component->GetAttributes());
+    }
+
+    // Hierarchy
+    for (unsigned i = 0; i < nodes.Size(); ++i)
+    {
+        const Node* node = nodes[i];
+        dest.WriteUInt(node->GetID());
+        if (i)
+            dest.WriteVLE(parentIndices[i]);
+
+        const Vector<SharedPtr<Component> >& components = node->GetComponents();
+        unsigned numNodeComponents = 0;
+        for (const SharedPtr<Component>& component : components)
+        {
+            if (!component->IsTemporary() && typeIndices.Contains(component->GetType()))
+                ++numNodeComponents;
+        }
+
+        dest.WriteVLE(numNodeComponents);
+        for (const SharedPtr<Component>& component : components)
+        {
+            auto j = typeIndices.Find(component->GetType());
+            if (component->IsTemporary() || j == typeIndices.End())
+                continue;
+            dest.WriteVLE(j->second_);
+            dest.WriteUInt(component->GetID());
+        }
+    }
+
+    // Attribute blocks: root, other nodes, then one block per component type. Components within a block are in
+    // hierarchy order, which is also the order they are created in when loading
+    VectorBuffer block;
+    WriteAttributes(block, root);
+    WriteBlock(dest, block);
+
+    block.Clear();
+    for (unsigned i = 1; i < nodes.Size(); ++i)
+        WriteAttributes(block, nodes[i]);
+    WriteBlock(dest, block);
+
+    for (const PODVector<const Component*>& components : typeComponents)
+    {
+        block.Clear();
+        for (const Component* component : components)
+            WriteAttributes(block, component);
+        WriteBlock(dest, block);
+    }
+
+    return true;
+}
+
+bool PackedSceneReader::IsPacked(const unsigned char* data, unsigned size)
+{
+    return data && size >= 4 && !memcmp(data, PACKED_SCENE_FILE_ID, 4);
+}
+
+bool PackedSceneReader::Read(const unsigned char* data, unsigned size, Node* root, SceneResolver& resolver, bool rewriteIDs, CreateMode mode)
+{
+    URHO3D_PROFILE("ReadPackedScene");
+
+    if (!root || !IsPacked(data, size))
+    {
+        URHO3D_LOGERROR("Not a packed scene");
+        return false;
+    }
+
+    Context* context = root->GetContext();
+    MemoryBuffer source(data, size);
+    source.Seek(4);
+
+    const unsigned version = source.ReadUInt();
+    if (version > PACKED_SCENE_VERSION)
+    {
+        URHO3D_LOGERROR("Unsupported packed scene version " + String(version));
+        return false;
+    }
+
+    const unsigned numNodes = source.ReadUInt();
+    const unsigned numComponents = source.ReadUInt();
+    const unsigned numTypes = source.ReadUInt();
+    if (!numNodes)
+    {
+        URHO3D_LOGERROR("Packed scene has no root node");
+        return false;
+    }
+    if (!CheckHeaderCounts(source, numNodes, numComponents, numTypes))
+    {
+        URHO3D_LOGERROR("Packed scene truncated or corrupt");
+        return false;
+    }
+
+    // Layouts
+    PackedLayout rootLayout;
+    PackedLayout nodeLayout;
+    Vector<PackedLayout> componentLayouts(numTypes);
+    bool layoutsValid = ReadLayout(source, context, rootLayout) && ReadLayout(source, context, nodeLayout);
+    for (unsigned i = 0; i < componentLayouts.Size() && layoutsValid; ++i)
+        layoutsValid = ReadLayout(source, context, componentLayouts[i]);
+    if (!layoutsValid)
+    {
+        URHO3D_LOGERROR("Corrupt packed scene type layout");
+        return false;
+    }
+
+    // Hierarchy
+    PODVector<PackedNode> nodeRecords(numNodes);
+    PODVector<PackedComponent> componentRecords;
+    componentRecords.Reserve(numComponents);
+    unsigned numReplicatedNodes = 0;
+    unsigned numReplicatedComponents = 0;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        PackedNode& record = nodeRecords[i];
+        record.id_ = source.ReadUInt();
+        record.parentIndex_ = i ? source.ReadVLE() : M_MAX_UNSIGNED;
+        record.firstComponent_ = componentRecords.Size();
+        record.numComponents_ = source.ReadVLE();
+        if ((i && record.parentIndex_ >= i) || record.numComponents_ > numComponents - componentRecords.Size())
+        {
+            URHO3D_LOGERROR("Corrupt packed scene hierarchy");
+            return false;
+        }
+        if (Scene::IsReplicatedID(record.id_))
+            ++numReplicatedNodes;
+
+        for (unsigned j = 0; j < record.numComponents_; ++j)
+        {
+            PackedComponent component;
+            component.typeIndex_ = source.ReadVLE();
+            component.id_ = source.ReadUInt();
+            if (component.typeIndex_ >= numTypes)
+            {
+                URHO3D_LOGERROR("Corrupt packed scene component type");
+                return false;
+            }
+            if (Scene::IsReplicatedID(component.id_))
+                ++numReplicatedComponents;
+            componentRecords.Push(component);
+        }
+    }
+
+    // Create all objects up front. Reserve ID maps in the scene first to avoid rehashing while adding
+    root->RemoveAllChildren();
+    root->RemoveAllComponents();
+
+    Scene* scene = root->GetScene();
+    if (scene && !rewriteIDs)
+    {
+        scene->ReserveIDs(numReplicatedNodes, numNodes - numReplicatedNodes, numReplicatedComponents,
+            componentRecords.Size() - numReplicatedComponents);
+    }
+
+    for (const PackedLayout& layout : componentLayouts)
+    {
+        if (!context->GetObjectFactories().Contains(layout.type_))
+            URHO3D_LOGWARNING("Skipping unknown component type " + layout.typeName_ + " in packed scene");
+    }
+
+    PODVector<Node*> nodes(numNodes);
+    Vector<PODVector<Component*> > typeComponents(numTypes);
+    nodes[0] = root;
+    resolver.AddNode(nodeRecords[0].id_, root);
+
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        const PackedNode& record = nodeRecords[i];
+        if (i)
+        {
+            const CreateMode nodeMode = (mode == REPLICATED && Scene::IsReplicatedID(record.id_)) ? REPLICATED : LOCAL;
+            nodes[i] = nodes[record.parentIndex_]->CreateChild(rewriteIDs ? 0 : record.id_, nodeMode);
+            resolver.AddNode(record.id_, nodes[i]);
+        }
+
+        Node* node = nodes[i];
+        for (unsigned j = record.firstComponent_; j < record.firstComponent_ + record.numComponents_; ++j)
+        {
+            const PackedComponent& componentRecord = componentRecords[j];
+            const PackedLayout& layout = componentLayouts[componentRecord.typeIndex_];
+
+            Component* component = nullptr;
+            if (context->GetObjectFactories().Contains(layout.type_))
+            {
+                const CreateMode componentMode = (mode == REPLICATED && Scene::IsReplicatedID(componentRecord.id_)) ?
+                    REPLICATED : LOCAL;
+                component = node->CreateComponent(layout.type_, componentMode, rewriteIDs ? 0 : componentRecord.id_);
+                if (component)
+                    resolver.AddComponent(componentRecord.id_, component);
+            }
+            typeComponents[componentRecord.typeIndex_].Push(component);
+        }
+    }
+
+    // Attribute blocks
+    Variant value;
+
+    unsigned blockSize = source.ReadUInt();
+    unsigned blockEnd = source.GetPosition() + blockSize;
+    ReadAttributes(source, rootLayout, rootLayout.type_ == root->GetType() ? root : nullptr, value);
+    source.Seek(blockEnd);
+
+    blockSize = source.ReadUInt();
+    blockEnd = source.GetPosition() + blockSize;
+    for (unsigned i = 1; i < numNodes; ++i)
+        ReadAttributes(source, nodeLayout, nodes[i], value);
+    source.Seek(blockEnd);
+
+    for (unsigned i = 0; i < numTypes; ++i)
+    {
+        blockSize = source.ReadUInt();
+        blockEnd = source.GetPosition() + blockSize;
+
+        // Whole blocks of unknown types are skipped without decoding
+        if (context->GetObjectFactories().Contains(componentLayouts[i].type_))
+        {
+            for (Component* component : typeComponents[i])
+                ReadAttributes(source, componentLayouts[i], component, value);
+        }
+
+        source.Seek(blockEnd);
+    }
+
+    if (source.GetPosition() != size)
+    {
+        URHO3D_LOGERROR("Packed scene truncated or corrupt");
+        return false;
+    }
+
+    return true;
+}
+
+bool PackedSceneReader::ReadResourceRefs(const unsigned char* data, unsigned size, Vector<ResourceRef>& dest)
+{
+    if (!IsPacked(data, size))
+        return false;
+
+    MemoryBuffer source(data, size);
+    source.Seek(4);
+    if (source.ReadUInt() > PACKED_SCENE_VERSION)
+        return false;
+
+    const unsigned numNodes = source.ReadUInt();
+    const unsigned numComponents = source.ReadUInt();
+    const unsigned numTypes = source.ReadUInt();
+    if (!CheckHeaderCounts(source, numNodes, numComponents, numTypes))
+        return false;
+
+    // Layouts of root, nodes and component types
+    Vector<PackedLayout> layouts(numTypes + 2);
+    for (PackedLayout& layout : layouts)
+    {
+        if (!ReadLayout(source, nullptr, layout))
+            return false;
+    }
+
+    // Count objects per layout from the hierarchy
+    PODVector<unsigned> numObjects(numTypes + 2);
+    numObjects[0] = 1;
+    numObjects[1] = numNodes ? numNodes - 1 : 0;
+    for (unsigned i = 2; i < numObjects.Size(); ++i)
+        numObjects[i] = 0;
+    for (unsigned i = 0; i < numNodes; ++i)
+    {
+        source.ReadUInt();
+        if (i)
+            source.ReadVLE();
+        const unsigned numNodeComponents = source.ReadVLE();
+        for (unsigned j = 0; j < numNodeComponents; ++j)
+        {
+            const unsigned typeIndex = source.ReadVLE();
+            source.ReadUInt();
+            if (typeIndex < numTypes)
+                ++numObjects[typeIndex + 2];
+        }
+    }
+
+    // Scan the attribute blocks, skipping blocks without resource references whole
+    Variant value;
+    for (unsigned i = 0; i < layouts.Size(); ++i)
+    {
+        const unsigned blockSize = source.ReadUInt();
+        const unsigned blockEnd = source.GetPosition() + blockSize;
+
+        const PODVector<VariantType>& types = layouts[i].types_;
+        if (types.Contains(VAR_RESOURCEREF) || types.Contains(VAR_RESOURCEREFLIST))
+        {
+            for (unsigned j = 0; j < numObjects[i]; ++j)
+            {
+                for (VariantType type : types)
+                {
+                    ReadValue(source, type, value);
+                    if (type == VAR_RESOURCEREF && !value.GetResourceRef().name_.Empty())
+                        dest.Push(value.GetResourceRef());
+                    else if (type == VAR_RESOURCEREFLIST)
+                    {
+                        const ResourceRefList& refList = value.GetResourceRefList();
+                        for (const String& name : refList.names_)
+                        {
+                            if (!name.Empty())
+                                dest.Push(ResourceRef(refList.type_, name));
+                        }
+                    }
+                }
+            }
+        }
+
+        source.Seek(blockEnd);
+    }
+
+    return source.GetPosition() == size;
+}
+
+void PackedSceneReader::ReadValue(MemoryBuffer& source, VariantType type, Variant& dest)
+{
+    switch (type)
+    {
+    case VAR_BOOL:
+        dest = source.ReadUByte() != 0;
+        break;
+    case VAR_INT:
+        ReadFixedValue<int>(source, dest);
+        break;
+    case VAR_FLOAT:
+        ReadFixedValue<float>(source, dest);
+        break;
+    case VAR_INT64:
+        ReadFixedValue<long long>(source, dest);
+        break;
+    case VAR_DOUBLE:
+        ReadFixedValue<double>(source, dest);
+        break;
+    case VAR_VECTOR2:
+        ReadFixedValue<Vector2>(source, dest);
+        break;
+    case VAR_INTVECTOR2:
+        ReadFixedValue<IntVector2>(source, dest);
+        break;
+    case VAR_VECTOR3:
+        ReadFixedValue<Vector3>(source, dest);
+        break;
+    case VAR_INTVECTOR3:
+        ReadFixedValue<IntVector3>(source, dest);
+        break;
+    case VAR_VECTOR4:
+        ReadFixedValue<Vector4>(source, dest);
+        break;
+    case VAR_QUATERNION:
+        ReadFixedValue<Quaternion>(source, dest);
+        break;
+    case VAR_COLOR:
+        ReadFixedValue<Color>(source, dest);
+        break;
+    case VAR_RECT:
+        ReadFixedValue<Rect>(source, dest);
+        break;
+    case VAR_INTRECT:
+        ReadFixedValue<IntRect>(source, dest);
+        break;
+    case VAR_MATRIX3:
+        ReadFixedValue<Matrix3>(source, dest);
+        break;
+    case VAR_MATRIX3X4:
+        ReadFixedValue<Matrix3x4>(source, dest);
+        break;
+    case VAR_MATRIX4:
+        ReadFixedValue<Matrix4>(source, dest);
+        break;
+    default:
+        dest = source.ReadVariant(type);
+        break;
+    }
+}
+
+}
@@ -0,0 +1,67 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Attribute.h"
+#include "../Scene/Node.h"
+
+namespace Urho3D
+{
+
+class MemoryBuffer;
+class SceneResolver;
+class Serializer;
+
+/// File identifier of packed scene files.
+static const char* PACKED_SCENE_FILE_ID = "USCP";
+/// Version of the packed scene format written by PackedSceneWriter.
+static const unsigned PACKED_SCENE_VERSION = 1;
+
+/// Packed scene format. Stores the node hierarchy first, then the attributes of the root, of all other nodes and of
+/// each component type in contiguous blocks. Attribute names and types are stored once per type, so that files stay
+/// loadable when attributes are added or removed, while loading maps them to the registered attributes only once per
+/// type instead of once per object.
+class URHO3D_API PackedSceneWriter
+{
+public:
+    /// Write a node with its components and children. Temporary objects are skipped. Return true if successful.
+    static bool Write(Serializer& dest, const Node* root);
+};
+
+/// Reader of the packed scene format.
+class URHO3D_API PackedSceneReader
+{
+public:
+    /// Load into a node from packed data, which must start with the file identifier. Removes existing children and components first. The root attributes are only applied when loading into a node of the same type as was saved. Return true if successful.
+    static bool Read(const unsigned char* data, unsigned size, Node* root, SceneResolver& resolver, bool rewriteIDs = false, CreateMode mode = REPLICATED);
+    /// Return whether data starts with the packed scene file identifier.
+    static bool IsPacked(const unsigned char* data, unsigned size);
+
+    /// Collect the resource references of all attributes without creating any objects. Return true if successful.
+    static bool ReadResourceRefs(const unsigned char* data, unsigned size, Vector<ResourceRef>& dest);
+
+    /// Read an attribute value. Fixed size values are copied directly from the buffer, reusing the destination's storage.
+    static void ReadValue(MemoryBuffer& source, VariantType type, Variant& dest);
+};
+
+}
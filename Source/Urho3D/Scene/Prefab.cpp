@@ -0,0 +1,407 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../IO/Deserializer.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/MemoryBuffer.h"
+#include "../Resource/JSONFile.h"
+#include "../Resource/XMLFile.h"
+#include "../Scene/Component.h"
+#include "../Scene/PackedScene.h"
+#include "../Scene/Prefab.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneResolver.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+Prefab::Prefab(Context* context) :
+    Resource(context)
+{
+}
+
+Prefab::~Prefab() = default;
+
+void Prefab::RegisterObject(Context* context)
+{
+    context->RegisterFactory<Prefab>();
+}
+
+bool Prefab::BeginLoad(Deserializer& source)
+{
+    nodes_.Clear();
+    components_.Clear();
+    attributes_.Clear();
+    idAttributes_.Clear();
+
+    // The hierarchy can only be created in the main thread, so just read the data here
+    String extension = GetExtension(source.GetName());
+    if (extension == ".xml")
+    {
+        loadXMLFile_ = context_->CreateObject<XMLFile>();
+        return loadXMLFile_->Load(source);
+    }
+    else if (extension == ".json")
+    {
+        loadJSONFile_ = context_->CreateObject<JSONFile>();
+        return loadJSONFile_->Load(source);
+    }
+    else
+    {
+        loadData_.Resize(source.GetSize());
+        return source.Read(loadData_.Buffer(), loadData_.Size()) == loadData_.Size();
+    }
+}
+
+bool Prefab::EndLoad()
+{
+    // Instantiate into a private scene to convert the attributes exactly like a regular instantiation does, then record
+    // the result
+    SharedPtr<Scene> scene(new Scene(context_));
+    Node* root = nullptr;
+
+    if (loadXMLFile_)
+        root = scene->InstantiateXML(loadXMLFile_->GetRoot(), Vector3::ZERO, Quaternion::IDENTITY);
+    else if (loadJSONFile_)
+        root = scene->InstantiateJSON(loadJSONFile_->GetRootView(), Vector3::ZERO, Quaternion::IDENTITY);
+    else if (PackedSceneReader::IsPacked(loadData_.Buffer(), loadData_.Size()))
+    {
+        SceneResolver resolver;
+        root = scene->CreateChild(0, REPLICATED);
+        if (PackedSceneReader::Read(loadData_.Buffer(), loadData_.Size(), root, resolver, true))
+        {
+            resolver.Resolve();
+            root->ApplyAttributes();
+        }
+        else
+            root = nullptr;
+    }
+    else if (!loadData_.Empty())
+    {
+        MemoryBuffer buffer(loadData_);
+        root = scene->Instantiate(buffer, Vector3::ZERO, Quaternion::IDENTITY);
+    }
+
+    loadXMLFile_.Reset();
+    loadJSONFile_.Reset();
+    loadData_.Clear();
+
+    if (!root)
+    {
+        URHO3D_LOGERROR("Could not load prefab " + GetName());
+        return false;
+    }
+
+    SetNode(root);
+    return true;
+}
+
+void Prefab::SetNode(const Node* root)
+{
+    URHO3D_PROFILE("CompilePrefab");
+
+    nodes_.Clear();
+    components_.Clear();
+    attributes_.Clear();
+    idAttributes_.Clear();
+    numReplicatedNodes_ = 0;
+    numReplicatedComponents_ = 0;
+
+    if (!root)
+    {
+        SetMemoryUse(0);
+        return;
+    }
+
+    // Flatten the hierarchy in preorder, and index nodes and components by ID for resolving ID attributes
+    PODVector<const Node*> srcNodes;
+    PODVector<const Component*> srcComponents;
+    HashMap<unsigned, unsigned> nodeIndices;
+    HashMap<unsigned, unsigned> componentIndices;
+    PODVector<Pair<const Node*, unsigned> > stack;
+    stack.Push(MakePair(root, M_MAX_UNSIGNED));
+    while (!stack.Empty())
+    {
+        const Pair<const Node*, unsigned> item = stack.Back();
+        stack.Pop();
+
+        const Node* node = item.first_;
+        const unsigned index = nodes_.Size();
+        PrefabNode dest;
+        dest.id_ = node->GetID();
+        dest.parentIndex_ = item.second_;
+        dest.firstAttribute_ = 0;
+        dest.numAttributes_ = 0;
+        dest.firstComponent_ = components_.Size();
+        dest.numComponents_ = 0;
+        if (Scene::IsReplicatedID(dest.id_))
+            ++numReplicatedNodes_;
+
+        for (const SharedPtr<Component>& component : node->GetComponents())
+        {
+            if (component->IsTemporary())
+                continue;
+
+            PrefabComponent destComponent;
+            destComponent.type_ = component->GetType();
+            destComponent.id_ = component->GetID();
+            destComponent.firstAttribute_ = 0;
+            destComponent.numAttributes_ = 0;
+            if (Scene::IsReplicatedID(destComponent.id_))
+                ++numReplicatedComponents_;
+
+            componentIndices[destComponent.id_] = components_.Size();
+            components_.Push(destComponent);
+            srcComponents.Push(component.Get());
+            ++dest.numComponents_;
+        }
+
+        nodeIndices[dest.id_] = index;
+        nodes_.Push(dest);
+        srcNodes.Push(node);
+
+        const Vector<SharedPtr<Node> >& children = node->GetChildren();
+        for (unsigned i = children.Size() - 1; i < children.Size(); --i)
+        {
+            if (!children[i]->IsTemporary())
+                stack.Push(MakePair(static_cast<const Node*>(children[i].Get()), index));
+        }
+    }
+
+    // Record attributes that differ from a newly created object. Setters can change other attributes, for example setting
+    // a model resets the materials, so the recorded attributes are also applied to the new object in the same order as
+    // instantiation does, before comparing the following ones
+    SharedPtr<Scene> defaultScene(new Scene(context_));
+    for (unsigned i = 0; i < nodes_.Size(); ++i)
+    {
+        PrefabNode& dest = nodes_[i];
+        Node* defaultNode = defaultScene->CreateChild(0, LOCAL);
+        dest.firstAttribute_ = attributes_.Size();
+        dest.numAttributes_ = AddAttributes(srcNodes[i], defaultNode, nodeIndices, componentIndices, M_MAX_UNSIGNED);
+
+        for (unsigned j = dest.firstComponent_; j < dest.firstComponent_ + dest.numComponents_; ++j)
+        {
+            Component* defaultComponent = defaultNode->CreateComponent(components_[j].type_, LOCAL);
+            components_[j].firstAttribute_ = attributes_.Size();
+            components_[j].numAttributes_ = AddAttributes(srcComponents[j], defaultComponent, nodeIndices, componentIndices, j);
+        }
+
+        defaultNode->Remove();
+    }
+
+    unsigned memoryUse = sizeof(Prefab) + nodes_.Size() * sizeof(PrefabNode) + components_.Size() * sizeof(PrefabComponent) +
+        attributes_.Size() * sizeof(PrefabAttribute);
+    SetMemoryUse(memoryUse);
+}
+
+Node* Prefab::Instantiate(Node* parent, const Vector3& position, const Quaternion& rotation, CreateMode mode) const
+{
+    URHO3D_PROFILE("InstantiatePrefab");
+
+    if (!parent || nodes_.Empty())
+        return nullptr;
+
+    ReserveIDs(parent, mode, 1);
+
+    PODVector<Node*> nodes;
+    PODVector<Component*> components;
+    Node* node = CreateNodes(parent, mode, nodes, components);
+    node->SetTransform(position, rotation);
+    node->ApplyAttributes();
+    return node;
+}
+
+void Prefab::Instantiate(Node* parent, const PODVector<Vector3>& positions, const PODVector<Quaternion>& rotations,
+    PODVector<Node*>& dest, CreateMode mode) const
+{
+    URHO3D_PROFILE("InstantiatePrefabs");
+
+    dest.Clear();
+    if (!parent || nodes_.Empty())
+        return;
+
+    ReserveIDs(parent, mode, positions.Size());
+    dest.Reserve(positions.Size());
+
+    // The node and component arrays are reused between copies
+    PODVector<Node*> nodes;
+    PODVector<Component*> components;
+    for (unsigned i = 0; i < positions.Size(); ++i)
+    {
+        Node* node = CreateNodes(parent, mode, nodes, components);
+        node->SetTransform(positions[i], i < rotations.Size() ? rotations[i] : Quaternion::IDENTITY);
+        node->ApplyAttributes();
+        dest.Push(node);
+    }
+}
+
+Node* Prefab::CreateNodes(Node* parent, CreateMode mode, PODVector<Node*>& nodes, PODVector<Component*>& components) const
+{
+    nodes.Resize(nodes_.Size());
+    components.Resize(components_.Size());
+
+    const Vector<AttributeInfo>* nodeAttributes = context_->GetAttributes(Node::GetTypeStatic());
+
+    for (unsigned i = 0; i < nodes_.Size(); ++i)
+    {
+        const PrefabNode& src = nodes_[i];
+        Node* parentNode = i ? nodes[src.parentIndex_] : parent;
+        Node* node = parentNode->CreateChild(0, (mode == REPLICATED && Scene::IsReplicatedID(src.id_)) ? REPLICATED : LOCAL);
+        nodes[i] = node;
+
+        for (unsigned j = src.firstAttribute_; j < src.firstAttribute_ + src.numAttributes_; ++j)
+            node->OnSetAttribute(nodeAttributes->At(attributes_[j].index_), attributes_[j].value_);
+
+        for (unsigned j = src.firstComponent_; j < src.firstComponent_ + src.numComponents_; ++j)
+        {
+            const PrefabComponent& srcComponent = components_[j];
+            Component* component = node->CreateComponent(srcComponent.type_, (mode == REPLICATED &&
+                Scene::IsReplicatedID(srcComponent.id_)) ? REPLICATED : LOCAL);
+            components[j] = component;
+            if (!component)
+                continue;
+
+            const Vector<AttributeInfo>* attributes = component->GetAttributes();
+            for (unsigned k = srcComponent.firstAttribute_; k < srcComponent.firstAttribute_ + srcComponent.numAttributes_; ++k)
+            {
+                const PrefabAttribute& attr = attributes_[k];
+                if (attr.references_.Empty())
+                    component->OnSetAttribute(attributes->At(attr.index_), attr.value_);
+            }
+        }
+    }
+
+    // Set ID attributes now that all nodes and components of the copy exist. References outside the prefab are
+    // kept as is, except in ID vectors where they are set to 0, same as when instantiating from a file
+    for (const Pair<unsigned, unsigned>& idAttribute : idAttributes_)
+    {
+        Component* component = components[idAttribute.first_];
+        if (!component)
+            continue;
+
+        const PrefabAttribute& attr = attributes_[idAttribute.second_];
+        const AttributeInfo& info = component->GetAttributes()->At(attr.index_);
+        if (info.mode_ & AM_NODEIDVECTOR)
+        {
+            VariantVector ids = attr.value_.GetVariantVector();
+            for (unsigned i = 0; i < attr.references_.Size(); ++i)
+            {
+                const unsigned reference = attr.references_[i];
+                ids[i + 1] = reference < nodes.Size() ? nodes[reference]->GetID() : 0;
+            }
+            component->OnSetAttribute(info, ids);
+        }
+        else
+        {
+            const unsigned reference = attr.references_.Front();
+            if (reference == M_MAX_UNSIGNED)
+                component->OnSetAttribute(info, attr.value_);
+            else if (info.mode_ & AM_NODEID)
+                component->OnSetAttribute(info, nodes[reference]->GetID());
+            else if (components[reference])
+                component->OnSetAttribute(info, components[reference]->GetID());
+        }
+    }
+
+    return nodes.Front();
+}
+
+unsigned Prefab::AddAttributes(const Serializable* object, Serializable* defaults, const HashMap<unsigned, unsigned>& nodeIndices,
+    const HashMap<unsigned, unsigned>& componentIndices, unsigned componentIndex)
+{
+    const Vector<AttributeInfo>* attributes = object->GetAttributes();
+    if (!attributes)
+        return 0;
+
+    unsigned numAttributes = 0;
+    Variant defaultValue;
+    for (unsigned i = 0; i < attributes->Size(); ++i)
+    {
+        const AttributeInfo& info = attributes->At(i);
+        if (!(info.mode_ & AM_FILE) || (info.mode_ & AM_FILEREADONLY) == AM_FILEREADONLY)
+            continue;
+
+        PrefabAttribute attr;
+        attr.index_ = i;
+        object->OnGetAttribute(info, attr.value_);
+
+        // ID attributes of components are resolved to indices within the prefab
+        if (componentIndex != M_MAX_UNSIGNED && (info.mode_ & (AM_NODEID | AM_COMPONENTID | AM_NODEIDVECTOR)))
+        {
+            if (info.mode_ & AM_NODEIDVECTOR)
+            {
+                const VariantVector& ids = attr.value_.GetVariantVector();
+                for (unsigned j = 1; j < ids.Size(); ++j)
+                {
+                    auto k = nodeIndices.Find(ids[j].GetUInt());
+                    attr.references_.Push(k != nodeIndices.End() ? k->second_ : M_MAX_UNSIGNED);
+                }
+            }
+            else if (unsigned id = attr.value_.GetUInt())
+            {
+                const HashMap<unsigned, unsigned>& indices = (info.mode_ & AM_NODEID) ? nodeIndices : componentIndices;
+                auto k = indices.Find(id);
+                attr.references_.Push(k != indices.End() ? k->second_ : M_MAX_UNSIGNED);
+            }
+
+            if (!attr.references_.Empty())
+                idAttributes_.Push(MakePair(componentIndex, attributes_.Size()));
+        }
+
+        if (attr.references_.Empty() && defaults)
+        {
+            defaults->OnGetAttribute(info, defaultValue);
+            if (attr.value_ == defaultValue)
+                continue;
+            defaults->OnSetAttribute(info, attr.value_);
+        }
+
+        attributes_.Push(attr);
+        ++numAttributes;
+    }
+
+    return numAttributes;
+}
+
+void Prefab::ReserveIDs(Node* parent, CreateMode mode, unsigned count) const
+{
+    Scene* scene = parent->GetScene();
+    if (!scene)
+        return;
+
+    if (mode == REPLICATED)
+    {
+        scene->ReserveIDs(numReplicatedNodes_ * count, (nodes_.Size() - numReplicatedNodes_) * count,
+            numReplicatedComponents_ * count, (components_.Size() - numReplicatedComponents_) * count);
+    }
+    else
+        scene->ReserveIDs(0, nodes_.Size() * count, 0, components_.Size() * count);
+}
+
+}
@@ -0,0 +1,135 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Resource/Resource.h"
+#include "../Scene/Node.h"
+
+namespace Urho3D
+{
+
+class JSONFile;
+class XMLFile;
+
+/// Attribute value of a prefab node or component, converted when the prefab is loaded.
+struct PrefabAttribute
+{
+    /// Index into the registered attributes of the object type.
+    unsigned index_;
+    /// Value.
+    Variant value_;
+    /// Indices of the nodes or components referred to by an ID attribute, M_MAX_UNSIGNED for references outside the prefab.
+    PODVector<unsigned> references_;
+};
+
+/// Node of a prefab.
+struct PrefabNode
+{
+    /// Original ID.
+    unsigned id_;
+    /// Index of the parent node, M_MAX_UNSIGNED for the root.
+    unsigned parentIndex_;
+    /// Index of the first attribute.
+    unsigned firstAttribute_;
+    /// Number of attributes.
+    unsigned numAttributes_;
+    /// Index of the first component.
+    unsigned firstComponent_;
+    /// Number of components.
+    unsigned numComponents_;
+};
+
+/// Component of a prefab.
+struct PrefabComponent
+{
+    /// Type.
+    StringHash type_;
+    /// Original ID.
+    unsigned id_;
+    /// Index of the first attribute.
+    unsigned firstAttribute_;
+    /// Number of attributes.
+    unsigned numAttributes_;
+};
+
+/// Node hierarchy resource for fast repeated instantiation. Loads from the same XML, JSON, binary or packed data as Scene::Instantiate() and keeps the nodes and components in flat arrays, with only the attribute values that differ from a newly created object.
+class URHO3D_API Prefab : public Resource
+{
+    URHO3D_OBJECT(Prefab, Resource);
+
+public:
+    /// Construct.
+    explicit Prefab(Context* context);
+    /// Destruct.
+    ~Prefab() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Finish resource loading. Always called from the main thread. Return true if successful.
+    bool EndLoad() override;
+
+    /// Record a node hierarchy. Temporary nodes and components are skipped.
+    void SetNode(const Node* root);
+    /// Create a copy of the prefab as a child of a node. Return the root node of the copy, or null if the prefab is empty.
+    Node* Instantiate(Node* parent, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED) const;
+    /// Create several copies of the prefab as children of a node. Rotations may be left empty to use identity rotation. The root nodes of the copies are returned in dest.
+    void Instantiate(Node* parent, const PODVector<Vector3>& positions, const PODVector<Quaternion>& rotations, PODVector<Node*>& dest,
+        CreateMode mode = REPLICATED) const;
+
+    /// Return number of nodes.
+    unsigned GetNumNodes() const { return nodes_.Size(); }
+    /// Return number of components.
+    unsigned GetNumComponents() const { return components_.Size(); }
+
+private:
+    /// Create the nodes and components of one copy and set their attributes. Return the root node.
+    Node* CreateNodes(Node* parent, CreateMode mode, PODVector<Node*>& nodes, PODVector<Component*>& components) const;
+    /// Record the attributes of an object that differ from a newly created object of the same type, and apply them to the new object so that side effects of their setters are accounted for. Return number of attributes recorded.
+    unsigned AddAttributes(const Serializable* object, Serializable* defaults, const HashMap<unsigned, unsigned>& nodeIndices,
+        const HashMap<unsigned, unsigned>& componentIndices, unsigned componentIndex);
+    /// Reserve scene IDs for copies of the prefab.
+    void ReserveIDs(Node* parent, CreateMode mode, unsigned count) const;
+
+    /// Nodes in hierarchy order, parents before children.
+    PODVector<PrefabNode> nodes_;
+    /// Components in hierarchy order.
+    PODVector<PrefabComponent> components_;
+    /// Attribute values of nodes and components.
+    Vector<PrefabAttribute> attributes_;
+    /// Component and attribute indices of component ID attributes, which are set after all nodes and components have been created.
+    PODVector<Pair<unsigned, unsigned> > idAttributes_;
+    /// Number of nodes with replicated IDs.
+    unsigned numReplicatedNodes_{};
+    /// Number of components with replicated IDs.
+    unsigned numReplicatedComponents_{};
+    /// XML file used while loading.
+    SharedPtr<XMLFile> loadXMLFile_;
+    /// JSON file used while loading.
+    SharedPtr<JSONFile> loadJSONFile_;
+    /// Binary data used while loading.
+    PODVector<unsigned char> loadData_;
+};
+
+}
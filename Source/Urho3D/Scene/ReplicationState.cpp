@@ -0,0 +1,166 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Scene/ReplicationState.h"
+
+#ifdef _MSC_VER
+#include <intrin.h>
+#endif
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+/// Allocation granularity of ID bitsets in ID's. Fills the summary words.
+static const unsigned ID_BITSET_GRANULARITY = 32 * 32;
+
+/// Return the index of the lowest set bit of a nonzero value.
+static inline unsigned LowestSetBit(unsigned value)
+{
+#if defined(_MSC_VER)
+    unsigned long index;
+    _BitScanForward(&index, value);
+    return (unsigned)index;
+#else
+    return (unsigned)__builtin_ctz(value);
+#endif
+}
+
+void IDBitSet::Reserve(unsigned size)
+{
+    if (size <= capacity_)
+        return;
+
+    // Grow at least by doubling to avoid repeated reallocation as ID's are allocated
+    unsigned newCapacity = Max(size, capacity_ * 2);
+    newCapacity = (newCapacity + ID_BITSET_GRANULARITY - 1) / ID_BITSET_GRANULARITY * ID_BITSET_GRANULARITY;
+
+    unsigned numWords = capacity_ >> 5u;
+    unsigned newNumWords = newCapacity >> 5u;
+    SharedArrayPtr<std::atomic<unsigned> > newWords(new std::atomic<unsigned>[newNumWords]);
+    SharedArrayPtr<std::atomic<unsigned> > newSummary(new std::atomic<unsigned>[newNumWords >> 5u]);
+
+    for (unsigned i = 0; i < newNumWords; ++i)
+        newWords[i].store(i < numWords ? words_[i].load(std::memory_order_relaxed) : 0, std::memory_order_relaxed);
+    for (unsigned i = 0; i < (newNumWords >> 5u); ++i)
+        newSummary[i].store(i < (numWords >> 5u) ? summary_[i].load(std::memory_order_relaxed) : 0, std::memory_order_relaxed);
+
+    words_ = newWords;
+    summary_ = newSummary;
+    capacity_ = newCapacity;
+}
+
+void IDBitSet::Insert(const IDBitSet& set)
+{
+    Reserve(set.capacity_);
+
+    unsigned numSummaryWords = set.capacity_ >> 10u;
+    for (unsigned i = 0; i < numSummaryWords; ++i)
+    {
+        unsigned summaryBits = set.summary_[i].load(std::memory_order_relaxed);
+        if (!summaryBits)
+            continue;
+
+        summary_[i].fetch_or(summaryBits, std::memory_order_relaxed);
+        while (summaryBits)
+        {
+            unsigned word = (i << 5u) + LowestSetBit(summaryBits);
+            words_[word].fetch_or(set.words_[word].load(std::memory_order_relaxed), std::memory_order_relaxed);
+            summaryBits &= summaryBits - 1;
+        }
+    }
+}
+
+bool IDBitSet::Erase(unsigned id)
+{
+    if (id >= capacity_)
+        return false;
+
+    unsigned word = id >> 5u;
+    unsigned bit = 1u << (id & 31u);
+    unsigned bits = words_[word].load(std::memory_order_relaxed);
+    if (!(bits & bit))
+        return false;
+
+    bits &= ~bit;
+    words_[word].store(bits, std::memory_order_relaxed);
+    if (!bits)
+        summary_[word >> 5u].fetch_and(~(1u << (word & 31u)), std::memory_order_relaxed);
+    return true;
+}
+
+void IDBitSet::Clear()
+{
+    unsigned numSummaryWords = capacity_ >> 10u;
+    for (unsigned i = 0; i < numSummaryWords; ++i)
+    {
+        unsigned summaryBits = summary_[i].load(std::memory_order_relaxed);
+        if (!summaryBits)
+            continue;
+
+        while (summaryBits)
+        {
+            words_[(i << 5u) + LowestSetBit(summaryBits)].store(0, std::memory_order_relaxed);
+            summaryBits &= summaryBits - 1;
+        }
+        summary_[i].store(0, std::memory_order_relaxed);
+    }
+}
+
+unsigned IDBitSet::FindNext(unsigned id) const
+{
+    if (id >= capacity_)
+        return M_MAX_UNSIGNED;
+
+    // Check the rest of the word containing the ID first
+    unsigned word = id >> 5u;
+    unsigned bits = words_[word].load(std::memory_order_relaxed) & (~0u << (id & 31u));
+    if (bits)
+        return (word << 5u) + LowestSetBit(bits);
+
+    // Then find the next nonzero word from the summary
+    unsigned numWords = capacity_ >> 5u;
+    ++word;
+    while (word < numWords)
+    {
+        unsigned summaryIndex = word >> 5u;
+        unsigned summaryBits = summary_[summaryIndex].load(std::memory_order_relaxed) & (~0u << (word & 31u));
+        if (!summaryBits)
+        {
+            word = (summaryIndex + 1) << 5u;
+            continue;
+        }
+
+        word = (summaryIndex << 5u) + LowestSetBit(summaryBits);
+        bits = words_[word].load(std::memory_order_relaxed);
+        if (bits)
+            return (word << 5u) + LowestSetBit(bits);
+        ++word;
+    }
+
+    return M_MAX_UNSIGNED;
+}
+
+}
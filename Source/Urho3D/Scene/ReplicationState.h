@@ -25,9 +25,12 @@
 #include "../Core/Attribute.h"
 #include "../Container/HashMap.h"
 #include "../Container/HashSet.h"
+#include "../Container/ArrayPtr.h"
 #include "../Container/Ptr.h"
+#include "../IO/VectorBuffer.h"
 #include "../Math/StringHash.h"
 
+#include <atomic>
 #include <cstring>
 
 namespace Urho3D
@@ -117,6 +120,66 @@ struct URHO3D_API DirtyBits
     unsigned char count_{};
 };
 
+/// Set of node or component ID's for network replication. Stored as a bitset indexed by the ID, with a second level of
+/// bits marking the nonzero words, so that insertion is O(1) and iteration skips over empty ranges. Insertion is lock-free
+/// and may be done from several threads at once, as long as the set has room for the ID beforehand.
+class URHO3D_API IDBitSet
+{
+public:
+    /// Construct empty.
+    IDBitSet() = default;
+    /// Prevent copy construction.
+    IDBitSet(const IDBitSet& set) = delete;
+    /// Prevent assignment.
+    IDBitSet& operator =(const IDBitSet& rhs) = delete;
+
+    /// Make room for ID's below a limit. Not thread-safe.
+    void Reserve(unsigned size);
+    /// Insert all ID's of another set. Not thread-safe.
+    void Insert(const IDBitSet& set);
+    /// Erase an ID. Return true if it was in the set. Not thread-safe.
+    bool Erase(unsigned id);
+    /// Remove all ID's. Only the nonzero words are cleared. Not thread-safe.
+    void Clear();
+
+    /// Insert an ID. Return true if it was not in the set yet. Thread-safe if the set has room for the ID, otherwise grows the set.
+    bool Insert(unsigned id)
+    {
+        if (id >= capacity_)
+            Reserve(id + 1);
+
+        unsigned word = id >> 5u;
+        unsigned bit = 1u << (id & 31u);
+        if ((words_[word].load(std::memory_order_relaxed) & bit) ||
+            (words_[word].fetch_or(bit, std::memory_order_relaxed) & bit))
+            return false;
+
+        summary_[word >> 5u].fetch_or(1u << (word & 31u), std::memory_order_relaxed);
+        return true;
+    }
+
+    /// Return whether contains an ID.
+    bool Contains(unsigned id) const
+    {
+        return id < capacity_ && (words_[id >> 5u].load(std::memory_order_relaxed) & (1u << (id & 31u))) != 0;
+    }
+
+    /// Return the smallest ID equal to or greater than the given one, or M_MAX_UNSIGNED if none.
+    unsigned FindNext(unsigned id) const;
+    /// Return whether the set is empty.
+    bool Empty() const { return FindNext(0) == M_MAX_UNSIGNED; }
+    /// Return the number of ID's the set has room for.
+    unsigned GetCapacity() const { return capacity_; }
+
+private:
+    /// Bits of the ID's.
+    SharedArrayPtr<std::atomic<unsigned> > words_;
+    /// Bits of the nonzero words.
+    SharedArrayPtr<std::atomic<unsigned> > summary_;
+    /// Number of ID's the set has room for.
+    unsigned capacity_{};
+};
+
 /// Per-object attribute state for network replication, allocated on demand.
 struct URHO3D_API NetworkState
 {
@@ -126,6 +189,14 @@ struct URHO3D_API NetworkState
     Vector<Variant> currentValues_;
     /// Previous network attribute values.
     Vector<Variant> previousValues_;
+    /// Current network attribute values encoded once per network update, shared by all connections.
+    VectorBuffer encodedValues_;
+    /// Offsets of the attribute values in the encoded data, with one element more than there are attributes. Empty if not encoded yet.
+    PODVector<unsigned> encodedOffsets_;
+    /// Scene network frame at which each attribute last changed. Used by snapshot replication.
+    PODVector<unsigned> changedFrames_;
+    /// Scene network frame at which any attribute last changed.
+    unsigned lastChangedFrame_{};
     /// Replication states that are tracking this object.
     PODVector<ReplicationState*> replicationStates_;
     /// Previous user variables.
@@ -150,6 +221,8 @@ struct URHO3D_API ComponentReplicationState : public ReplicationState
     WeakPtr<Component> component_;
     /// Dirty attribute bits.
     DirtyBits dirtyAttributes_;
+    /// Scene network frame at which the component was sent to the user.
+    unsigned createdFrame_{};
 };
 
 /// Per-user node network replication state.
@@ -165,6 +238,10 @@ struct URHO3D_API NodeReplicationState : public ReplicationState
     HashSet<StringHash> dirtyVars_;
     /// Components by ID.
     HashMap<unsigned, ComponentReplicationState> componentStates_;
+    /// Scene network frame at which the node was sent to the user.
+    unsigned createdFrame_{};
+    /// Scene network frame of the latest snapshot containing the node that the user acknowledged.
+    unsigned ackedSnapshotFrame_{};
     /// Interest management priority accumulator.
     float priorityAcc_{};
     /// Whether exists in the SceneState's dirty set.
@@ -177,7 +254,7 @@ struct URHO3D_API SceneReplicationState : public ReplicationState
     /// Nodes by ID.
     HashMap<unsigned, NodeReplicationState> nodeStates_;
     /// Dirty node IDs.
-    HashSet<unsigned> dirtyNodes_;
+    IDBitSet dirtyNodes_;
 
     void Clear()
     {
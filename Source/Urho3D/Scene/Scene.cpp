@@ -28,19 +28,24 @@
 #include "../Core/WorkQueue.h"
 #include "../IO/File.h"
 #include "../IO/Log.h"
+#include "../IO/MemoryMappedFile.h"
 #include "../IO/PackageFile.h"
 #include "../Resource/ResourceCache.h"
 #include "../Resource/ResourceEvents.h"
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
+#include "../Resource/JSONView.h"
 #include "../Scene/CameraViewport.h"
 #include "../Scene/Component.h"
 #include "../Scene/ObjectAnimation.h"
+#include "../Scene/PackedScene.h"
+#include "../Scene/Prefab.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/Scene.h"
 #include "../Scene/SceneEvents.h"
 #include "../Scene/SceneManager.h"
 #include "../Scene/SceneMetadata.h"
+#include "../Scene/SceneStreamer.h"
 #include "../Scene/SmoothedTransform.h"
 #include "../Scene/SplinePath.h"
 #include "../Scene/UnknownComponent.h"
@@ -65,6 +70,7 @@ Scene::Scene(Context* context) :
     localNodeID_(FIRST_LOCAL_ID),
     localComponentID_(FIRST_LOCAL_ID),
     checksum_(0),
+    networkFrame_(0),
     asyncLoadingMs_(5),
     timeScale_(1.0f),
     elapsedTime_(0),
@@ -121,7 +127,13 @@ bool Scene::Load(Deserializer& source)
     StopAsyncLoading();
 
     // Check ID
-    if (source.ReadFileID() != "USCN")
+    String fileID = source.ReadFileID();
+    if (fileID == PACKED_SCENE_FILE_ID)
+    {
+        source.Seek(source.GetPosition() - fileID.Length());
+        return LoadPacked(source);
+    }
+    if (fileID != "USCN")
     {
         URHO3D_LOGERROR(source.GetName() + " is not a valid scene file");
         return false;
@@ -199,6 +211,25 @@ bool Scene::LoadJSON(const JSONValue& source)
         return false;
 }
 
+bool Scene::LoadJSON(const JSONView& source)
+{
+    if (!CanLoadJSONView())
+        return LoadJSONValueCopy(source);
+
+    URHO3D_PROFILE("LoadSceneJSON");
+
+    StopAsyncLoading();
+
+    // Load the whole scene, then perform post-load if successfully loaded
+    if (Node::LoadJSON(source))
+    {
+        FinishLoading(nullptr);
+        return true;
+    }
+    else
+        return false;
+}
+
 void Scene::MarkNetworkUpdate()
 {
     if (!networkUpdate_)
@@ -217,6 +248,79 @@ void Scene::AddReplicationState(NodeReplicationState* state)
         state->sceneState_->dirtyNodes_.Insert(i->first_);
 }
 
+bool Scene::LoadPacked(Deserializer& source)
+{
+    URHO3D_PROFILE("LoadScenePacked");
+
+    StopAsyncLoading();
+
+    // Map files directly, other sources are read into memory whole
+    SharedPtr<MemoryMappedFile> mappedFile;
+    PODVector<unsigned char> buffer;
+    const unsigned char* data = nullptr;
+    unsigned size = 0;
+
+    auto* file = dynamic_cast<File*>(&source);
+    if (file && !source.GetPosition())
+    {
+        mappedFile = new MemoryMappedFile();
+        if (!mappedFile->Open(file))
+            return false;
+        data = mappedFile->GetData();
+        size = mappedFile->GetSize();
+    }
+    else
+    {
+        buffer.Resize(source.GetSize() - source.GetPosition());
+        if (source.Read(buffer.Buffer(), buffer.Size()) != buffer.Size())
+        {
+            URHO3D_LOGERROR("Could not read scene from " + source.GetName());
+            return false;
+        }
+        data = buffer.Buffer();
+        size = buffer.Size();
+    }
+
+    if (!PackedSceneReader::IsPacked(data, size))
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid packed scene file");
+        return false;
+    }
+
+    URHO3D_LOGINFO("Loading scene from " + source.GetName());
+
+    Clear();
+
+    SceneResolver resolver;
+    if (!PackedSceneReader::Read(data, size, this, resolver))
+        return false;
+
+    resolver.Resolve();
+    ApplyAttributes();
+    FinishLoading(&source);
+    return true;
+}
+
+bool Scene::SavePacked(Serializer& dest) const
+{
+    URHO3D_PROFILE("SaveScenePacked");
+
+    auto* ptr = dynamic_cast<Deserializer*>(&dest);
+    if (ptr)
+        URHO3D_LOGINFO("Saving scene to " + ptr->GetName());
+
+    if (PackedSceneWriter::Write(dest, this))
+    {
+        FinishSaving(&dest);
+        return true;
+    }
+    else
+    {
+        URHO3D_LOGERROR("Could not save scene, writing to stream failed");
+        return false;
+    }
+}
+
 bool Scene::LoadXML(Deserializer& source)
 {
     URHO3D_PROFILE("LoadSceneXML");
@@ -254,7 +358,8 @@ bool Scene::LoadJSON(Deserializer& source)
 
     Clear();
 
-    if (Node::LoadJSON(json->GetRoot()))
+    // Load from the document parsed in place instead of converting it into JSON values first
+    if (Node::LoadJSON(json->GetRootView()))
     {
         FinishLoading(&source);
         return true;
@@ -480,7 +585,7 @@ bool Scene::LoadAsyncJSON(File* file, LoadMode mode)
 
     if (mode > LOAD_RESOURCES_ONLY)
     {
-        JSONValue rootVal = json->GetRoot();
+        const JSONValue& rootVal = json->GetRoot();
 
         // Preload resources if appropriate
         if (mode != LOAD_SCENE)
@@ -499,7 +604,7 @@ bool Scene::LoadAsyncJSON(File* file, LoadMode mode)
             return false;
 
         // Then prepare for loading all root level child nodes in the async update
-        JSONArray childrenArray = rootVal.Get("children").GetArray();
+        const JSONArray& childrenArray = rootVal.Get("children").GetArray();
         asyncProgress_.jsonIndex_ = 0;
 
         // Count the amount of child nodes
@@ -597,6 +702,29 @@ Node* Scene::InstantiateJSON(const JSONValue& source, const Vector3& position, c
     }
 }
 
+Node* Scene::InstantiateJSON(const JSONView& source, const Vector3& position, const Quaternion& rotation, CreateMode mode)
+{
+    URHO3D_PROFILE("InstantiateJSON");
+
+    SceneResolver resolver;
+    unsigned nodeID = source.Get("id").GetUInt();
+    // Rewrite IDs when instantiating
+    Node* node = CreateChild(0, mode);
+    resolver.AddNode(nodeID, node);
+    if (node->LoadJSON(source, resolver, true, true, mode))
+    {
+        resolver.Resolve();
+        node->SetTransform(position, rotation);
+        node->ApplyAttributes();
+        return node;
+    }
+    else
+    {
+        node->Remove();
+        return nullptr;
+    }
+}
+
 Node* Scene::InstantiateXML(Deserializer& source, const Vector3& position, const Quaternion& rotation, CreateMode mode)
 {
     SharedPtr<XMLFile> xml(context_->CreateObject<XMLFile>());
@@ -612,7 +740,12 @@ Node* Scene::InstantiateJSON(Deserializer& source, const Vector3& position, cons
     if (!json->Load(source))
         return nullptr;
 
-    return InstantiateJSON(json->GetRoot(), position, rotation, mode);
+    return InstantiateJSON(json->GetRootView(), position, rotation, mode);
+}
+
+Node* Scene::Instantiate(Prefab* prefab, const Vector3& position, const Quaternion& rotation, CreateMode mode)
+{
+    return prefab ? prefab->Instantiate(this, position, rotation, mode) : nullptr;
 }
 
 void Scene::Clear(bool clearReplicated, bool clearLocal)
@@ -906,6 +1039,22 @@ unsigned Scene::GetFreeComponentID(CreateMode mode)
     }
 }
 
+/// Rehash an ID map once to fit a final element count, instead of repeatedly while growing.
+template <class T> static void ReserveBuckets(HashMap<unsigned, T*>& map, unsigned count)
+{
+    const unsigned numBuckets = NextPowerOfTwo(count / HashBase::MAX_LOAD_FACTOR);
+    if (numBuckets > map.NumBuckets())
+        map.Rehash(numBuckets);
+}
+
+void Scene::ReserveIDs(unsigned numReplicatedNodes, unsigned numLocalNodes, unsigned numReplicatedComponents, unsigned numLocalComponents)
+{
+    ReserveBuckets(replicatedNodes_, replicatedNodes_.Size() + numReplicatedNodes);
+    ReserveBuckets(localNodes_, localNodes_.Size() + numLocalNodes);
+    ReserveBuckets(replicatedComponents_, replicatedComponents_.Size() + numReplicatedComponents);
+    ReserveBuckets(localComponents_, localComponents_.Size() + numLocalComponents);
+}
+
 void Scene::NodeAdded(Node* node)
 {
     if (!node || node->GetScene() == this)
@@ -938,6 +1087,8 @@ void Scene::NodeAdded(Node* node)
 
         replicatedNodes_[id] = node;
 
+        // Make room for marking the node for network update from worker threads
+        networkUpdateNodes_.Reserve(id + 1);
         MarkNetworkUpdate(node);
         MarkReplicationDirty(node);
     }
@@ -1036,6 +1187,9 @@ void Scene::ComponentAdded(Component* component)
         }
 
         replicatedComponents_[id] = component;
+
+        // Make room for marking the component for network update from worker threads
+        networkUpdateComponents_.Reserve(id + 1);
     }
     else
     {
@@ -1093,22 +1247,29 @@ String Scene::GetVarNamesAttr() const
 
 void Scene::PrepareNetworkUpdate()
 {
-    for (HashSet<unsigned>::Iterator i = networkUpdateNodes_.Begin(); i != networkUpdateNodes_.End(); ++i)
+    ++networkFrame_;
+
+    for (unsigned id = networkUpdateNodes_.FindNext(0); id != M_MAX_UNSIGNED; id = networkUpdateNodes_.FindNext(id + 1))
     {
-        Node* node = GetNode(*i);
+        Node* node = GetNode(id);
         if (node)
             node->PrepareNetworkUpdate();
     }
 
-    for (HashSet<unsigned>::Iterator i = networkUpdateComponents_.Begin(); i != networkUpdateComponents_.End(); ++i)
+    for (unsigned id = networkUpdateComponents_.FindNext(0); id != M_MAX_UNSIGNED; id = networkUpdateComponents_.FindNext(id + 1))
     {
-        Component* component = GetComponent(*i);
+        Component* component = GetComponent(id);
         if (component)
             component->PrepareNetworkUpdate();
     }
 
     networkUpdateNodes_.Clear();
     networkUpdateComponents_.Clear();
+
+    // Connections read world positions of the replicated nodes from worker threads. Reading a dirty world transform would
+    // update it in place, so update the dirty transforms here on the main thread
+    for (HashMap<unsigned, Node*>::ConstIterator i = replicatedNodes_.Begin(); i != replicatedNodes_.End(); ++i)
+        i->second_->GetWorldTransform();
 }
 
 void Scene::CleanupConnection(Connection* connection)
@@ -1124,30 +1285,15 @@ void Scene::CleanupConnection(Connection* connection)
 
 void Scene::MarkNetworkUpdate(Node* node)
 {
+    // The set has room for all replicated nodes in the scene, so this is lock-free also during threaded update
     if (node)
-    {
-        if (!threadedUpdate_)
-            networkUpdateNodes_.Insert(node->GetID());
-        else
-        {
-            MutexLock lock(sceneMutex_);
-            networkUpdateNodes_.Insert(node->GetID());
-        }
-    }
+        networkUpdateNodes_.Insert(node->GetID());
 }
 
 void Scene::MarkNetworkUpdate(Component* component)
 {
     if (component)
-    {
-        if (!threadedUpdate_)
-            networkUpdateComponents_.Insert(component->GetID());
-        else
-        {
-            MutexLock lock(sceneMutex_);
-            networkUpdateComponents_.Insert(component->GetID());
-        }
-    }
+        networkUpdateComponents_.Insert(component->GetID());
 }
 
 void Scene::MarkReplicationDirty(Node* node)
@@ -1454,7 +1600,7 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
     auto* cache = GetSubsystem<ResourceCache>();
 
     // Node or Scene attributes do not include any resources; therefore skip to the components
-    JSONArray componentArray = value.Get("components").GetArray();
+    const JSONArray& componentArray = value.Get("components").GetArray();
 
     for (unsigned i = 0; i < componentArray.Size(); i++)
     {
@@ -1464,7 +1610,7 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
         const Vector<AttributeInfo>* attributes = context_->GetAttributes(StringHash(typeName));
         if (attributes)
         {
-            JSONArray attributesArray = compValue.Get("attributes").GetArray();
+            const JSONArray& attributesArray = compValue.Get("attributes").GetArray();
 
             unsigned startIndex = 0;
 
@@ -1521,7 +1667,7 @@ void Scene::PreloadResourcesJSON(const JSONValue& value)
 
     }
 
-    JSONArray childrenArray = value.Get("children").GetArray();
+    const JSONArray& childrenArray = value.Get("children").GetArray();
     for (unsigned i = 0; i < childrenArray.Size(); i++)
     {
         const JSONValue& childVal = childrenArray.At(i);
@@ -1534,6 +1680,8 @@ void RegisterSceneLibrary(Context* context)
 {
     ValueAnimation::RegisterObject(context);
     ObjectAnimation::RegisterObject(context);
+    Prefab::RegisterObject(context);
+    SceneCellFile::RegisterObject(context);
     Node::RegisterObject(context);
     Scene::RegisterObject(context);
     SmoothedTransform::RegisterObject(context);
@@ -1541,6 +1689,7 @@ void RegisterSceneLibrary(Context* context)
     SplinePath::RegisterObject(context);
     SceneManager::RegisterObject(context);
     SceneMetadata::RegisterObject(context);
+    SceneStreamer::RegisterObject(context);
     CameraViewport::RegisterObject(context);
 }
 
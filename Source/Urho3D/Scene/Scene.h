@@ -27,6 +27,7 @@
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONFile.h"
 #include "../Scene/Node.h"
+#include "../Scene/ReplicationState.h"
 #include "../Scene/SceneResolver.h"
 
 namespace Urho3D
@@ -34,6 +35,7 @@ namespace Urho3D
 
 class File;
 class PackageFile;
+class Prefab;
 
 static const unsigned FIRST_REPLICATED_ID = 0x1;
 static const unsigned LAST_REPLICATED_ID = 0xffffff;
@@ -106,6 +108,8 @@ public:
     bool LoadXML(const XMLElement& source) override;
     /// Load from JSON data. Removes all existing child nodes and components first. Return true if successful.
     bool LoadJSON(const JSONValue& source) override;
+    /// Load from a read-only view of JSON data. Removes all existing child nodes and components first. Return true if successful.
+    bool LoadJSON(const JSONView& source) override;
     /// Mark for attribute check on the next network update.
     void MarkNetworkUpdate() override;
     /// Add a replication state that is tracking this scene.
@@ -119,6 +123,10 @@ public:
     bool SaveXML(Serializer& dest, const String& indentation = "\t") const;
     /// Save to a JSON file. Return true if successful.
     bool SaveJSON(Serializer& dest, const String& indentation = "\t") const;
+    /// Load from a packed binary file. Files are memory mapped when possible. Return true if successful.
+    bool LoadPacked(Deserializer& source);
+    /// Save to a packed binary file, which loads faster than the regular binary format. Return true if successful.
+    bool SavePacked(Serializer& dest) const;
     /// Load from a binary file asynchronously. Return true if started successfully. The LOAD_RESOURCES_ONLY mode can also be used to preload resources from object prefab files.
     bool LoadAsync(File* file, LoadMode mode = LOAD_SCENE_AND_RESOURCES);
     /// Load from an XML file asynchronously. Return true if started successfully. The LOAD_RESOURCES_ONLY mode can also be used to preload resources from object prefab files.
@@ -137,8 +145,13 @@ public:
     /// Instantiate scene content from JSON data. Return root node if successful.
     Node* InstantiateJSON
         (const JSONValue& source, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
+    /// Instantiate scene content from a read-only view of JSON data. Return root node if successful.
+    Node* InstantiateJSON
+        (const JSONView& source, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
     /// Instantiate scene content from JSON data. Return root node if successful.
     Node* InstantiateJSON(Deserializer& source, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
+    /// Instantiate a prefab resource. Faster than instantiating from a file when done repeatedly. Return root node if successful.
+    Node* Instantiate(Prefab* prefab, const Vector3& position, const Quaternion& rotation, CreateMode mode = REPLICATED);
 
     /// Clear scene completely of either replicated, local or all nodes and components.
     void Clear(bool clearReplicated = true, bool clearLocal = true);
@@ -205,6 +218,9 @@ public:
     /// Return maximum milliseconds per frame to spend on async loading.
     int GetAsyncLoadingMs() const { return asyncLoadingMs_; }
 
+    /// Return number of network updates prepared. Used as the frame number of network attribute changes.
+    unsigned GetNetworkFrame() const { return networkFrame_; }
+
     /// Return required package files.
     const Vector<SharedPtr<PackageFile> >& GetRequiredPackageFiles() const { return requiredPackageFiles_; }
 
@@ -227,6 +243,8 @@ public:
     unsigned GetFreeNodeID(CreateMode mode);
     /// Get free component ID, either non-local or local.
     unsigned GetFreeComponentID(CreateMode mode);
+    /// Reserve space in the ID maps for a number of nodes and components about to be added.
+    void ReserveIDs(unsigned numReplicatedNodes, unsigned numLocalNodes, unsigned numReplicatedComponents, unsigned numLocalComponents);
     /// Return whether the specified id is a replicated id.
     static bool IsReplicatedID(unsigned id) { return id < FIRST_LOCAL_ID; }
 
@@ -247,7 +265,7 @@ public:
     void SetVarNamesAttr(const String& value);
     /// Return node user variable reverse mappings.
     String GetVarNamesAttr() const;
-    /// Prepare network update by comparing attributes and marking replication states dirty as necessary.
+    /// Prepare network update by comparing attributes and marking replication states dirty as necessary. Also updates the world transforms of the replicated nodes, so that connections can read them concurrently.
     void PrepareNetworkUpdate();
     /// Clean up all references to a network connection that is about to be removed.
     void CleanupConnection(Connection* connection);
@@ -299,9 +317,9 @@ private:
     /// Registered node user variable reverse mappings.
     HashMap<StringHash, String> varNames_;
     /// Nodes to check for attribute changes on the next network update.
-    HashSet<unsigned> networkUpdateNodes_;
+    IDBitSet networkUpdateNodes_;
     /// Components to check for attribute changes on the next network update.
-    HashSet<unsigned> networkUpdateComponents_;
+    IDBitSet networkUpdateComponents_;
     /// Delayed dirty notification queue for components.
     PODVector<Component*> delayedDirtyComponents_;
     /// Mutex for the delayed dirty notification queue.
@@ -318,6 +336,8 @@ private:
     unsigned localComponentID_;
     /// Scene source file checksum.
     mutable unsigned checksum_;
+    /// Number of network updates prepared.
+    unsigned networkFrame_;
     /// Maximum milliseconds per frame to spend on async scene loading.
     int asyncLoadingMs_;
     /// Scene update time scale.
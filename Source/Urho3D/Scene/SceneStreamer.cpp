@@ -0,0 +1,574 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#include "../Precompiled.h"
+
+#include "../Core/Context.h"
+#include "../Core/Profiler.h"
+#include "../Core/Timer.h"
+#include "../IO/Deserializer.h"
+#include "../IO/File.h"
+#include "../IO/FileSystem.h"
+#include "../IO/Log.h"
+#include "../IO/VectorBuffer.h"
+#include "../Resource/ResourceCache.h"
+#include "../Resource/ResourceEvents.h"
+#include "../Scene/PackedScene.h"
+#include "../Scene/Scene.h"
+#include "../Scene/SceneEvents.h"
+#include "../Scene/SceneResolver.h"
+#include "../Scene/SceneStreamer.h"
+
+#include "../DebugNew.h"
+
+namespace Urho3D
+{
+
+extern const char* SUBSYSTEM_CATEGORY;
+
+/// Number of values per cell in the cells attribute.
+static const unsigned CELL_ATTR_VALUES = 6;
+/// Delay in milliseconds before retrying to load a cell that failed to load.
+static const unsigned CELL_RETRY_DELAY_MS = 5000;
+/// Maximum size of the ID ranges of a cell to check by looking up each ID. Larger ranges are checked against the scene content instead.
+static const unsigned long long MAX_CELL_ID_LOOKUPS = 4096;
+
+/// Return whether any ID in the node or component ID range of a cell is in use in the scene.
+static bool IsCellIDRangeInUse(Scene* scene, const SceneCell& cell)
+{
+    const unsigned long long numNodeIDs = cell.firstNodeID_ ? (unsigned long long)cell.lastNodeID_ - cell.firstNodeID_ + 1 : 0;
+    const unsigned long long numComponentIDs = cell.firstComponentID_ ?
+        (unsigned long long)cell.lastComponentID_ - cell.firstComponentID_ + 1 : 0;
+
+    if (numNodeIDs + numComponentIDs <= MAX_CELL_ID_LOOKUPS)
+    {
+        for (unsigned long long i = 0; i < numNodeIDs; ++i)
+        {
+            if (scene->GetNode((unsigned)(cell.firstNodeID_ + i)))
+                return true;
+        }
+        for (unsigned long long i = 0; i < numComponentIDs; ++i)
+        {
+            if (scene->GetComponent((unsigned)(cell.firstComponentID_ + i)))
+                return true;
+        }
+        return false;
+    }
+
+    PODVector<Node*> nodes;
+    scene->GetChildren(nodes, true);
+    nodes.Push(scene);
+    for (Node* node : nodes)
+    {
+        if (numNodeIDs && node->GetID() >= cell.firstNodeID_ && node->GetID() <= cell.lastNodeID_)
+            return true;
+        for (const SharedPtr<Component>& component : node->GetComponents())
+        {
+            if (numComponentIDs && component->GetID() >= cell.firstComponentID_ && component->GetID() <= cell.lastComponentID_)
+                return true;
+        }
+    }
+    return false;
+}
+
+SceneCellFile::SceneCellFile(Context* context) :
+    Resource(context)
+{
+}
+
+SceneCellFile::~SceneCellFile() = default;
+
+void SceneCellFile::RegisterObject(Context* context)
+{
+    context->RegisterFactory<SceneCellFile>();
+}
+
+bool SceneCellFile::BeginLoad(Deserializer& source)
+{
+    resources_.Clear();
+    resourceRefs_.Clear();
+
+    data_.Resize(source.GetSize());
+    if (source.Read(data_.Buffer(), data_.Size()) != data_.Size() ||
+        !PackedSceneReader::ReadResourceRefs(data_.Buffer(), data_.Size(), resourceRefs_))
+    {
+        URHO3D_LOGERROR(source.GetName() + " is not a valid packed scene file");
+        data_.Clear();
+        return false;
+    }
+
+    // Request the resources used by the cell, so that they are ready when the cell file is
+    if (GetAsyncLoadState() == ASYNC_LOADING)
+    {
+        auto* cache = GetSubsystem<ResourceCache>();
+        for (const ResourceRef& ref : resourceRefs_)
+            cache->BackgroundLoadResource(ref.type_, ref.name_, true, this);
+    }
+
+    SetMemoryUse(data_.Size());
+    return true;
+}
+
+bool SceneCellFile::EndLoad()
+{
+    auto* cache = GetSubsystem<ResourceCache>();
+    for (const ResourceRef& ref : resourceRefs_)
+    {
+        SharedPtr<Resource> resource(cache->GetResource(ref.type_, ref.name_));
+        if (resource)
+            resources_.Push(resource);
+    }
+
+    resourceRefs_.Clear();
+    return true;
+}
+
+SceneStreamer::SceneStreamer(Context* context) :
+    Component(context)
+{
+}
+
+SceneStreamer::~SceneStreamer() = default;
+
+void SceneStreamer::RegisterObject(Context* context)
+{
+    context->RegisterFactory<SceneStreamer>(SUBSYSTEM_CATEGORY);
+
+    URHO3D_ACCESSOR_ATTRIBUTE("Is Enabled", IsEnabled, SetEnabled, bool, true, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Cell Size", GetCellSize, SetCellSize, float, 100.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Load Distance", GetLoadDistance, SetLoadDistance, float, 200.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Unload Distance", GetUnloadDistance, SetUnloadDistance, float, 250.0f, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Frame Budget Ms", GetFrameBudgetMs, SetFrameBudgetMs, int, 2, AM_DEFAULT);
+    URHO3D_ACCESSOR_ATTRIBUTE("Cells", GetCellsAttr, SetCellsAttr, VariantVector, Variant::emptyVariantVector, AM_FILE | AM_NOEDIT);
+}
+
+void SceneStreamer::SetCellSize(float size)
+{
+    cellSize_ = Max(size, M_EPSILON);
+}
+
+void SceneStreamer::SetLoadDistance(float distance)
+{
+    loadDistance_ = Max(distance, 0.0f);
+}
+
+void SceneStreamer::SetUnloadDistance(float distance)
+{
+    unloadDistance_ = Max(distance, 0.0f);
+}
+
+void SceneStreamer::SetFrameBudgetMs(int ms)
+{
+    frameBudgetMs_ = Max(ms, 0);
+}
+
+void SceneStreamer::SetFocusNode(Node* node)
+{
+    focusNode_ = node;
+}
+
+void SceneStreamer::AddCell(const IntVector2& coords, const SceneCell& cell)
+{
+    auto i = cells_.Find(coords);
+    if (i != cells_.End())
+        DetachCell(i->second_);
+
+    SceneCell& dest = cells_[coords];
+    dest = cell;
+    dest.state_ = CELL_UNLOADED;
+    dest.loadFailed_ = false;
+    dest.node_.Reset();
+}
+
+void SceneStreamer::RemoveAllCells()
+{
+    for (auto i = cells_.Begin(); i != cells_.End(); ++i)
+        DetachCell(i->second_);
+    cells_.Clear();
+}
+
+bool SceneStreamer::SplitScene(const String& directory, const String& resourcePath)
+{
+    Scene* scene = GetScene();
+    if (!scene)
+    {
+        URHO3D_LOGERROR("Scene streamer is not in a scene, can not split");
+        return false;
+    }
+
+    auto* fileSystem = GetSubsystem<FileSystem>();
+    const String path = AddTrailingSlash(directory);
+    if (!fileSystem->CreateDir(path))
+    {
+        URHO3D_LOGERROR("Could not create directory " + path);
+        return false;
+    }
+
+    RemoveAllCells();
+
+    // Group root level nodes by cell
+    HashMap<IntVector2, PODVector<Node*> > cellNodes;
+    for (const SharedPtr<Node>& node : scene->GetChildren())
+    {
+        if (!node->IsTemporary() && node != GetNode())
+            cellNodes[GetCellCoords(node->GetWorldPosition())].Push(node.Get());
+    }
+
+    // Copy the content of each cell with new IDs, so that every cell gets its own contiguous range of IDs and loading a
+    // cell does not clash with its neighbours. The copies take local IDs, as streamed content is not replicated. One
+    // resolver for all cells keeps the references between cells valid
+    Vector<Pair<IntVector2, SharedPtr<Node> > > sourceRoots;
+    Vector<SharedPtr<Node> > cellRoots;
+    SceneResolver resolver;
+    bool success = true;
+
+    for (auto i = cellNodes.Begin(); i != cellNodes.End() && success; ++i)
+    {
+        SharedPtr<Node> sourceRoot(scene->CreateChild("Cell " + i->first_.ToString(), LOCAL));
+        for (Node* node : i->second_)
+            node->SetParent(sourceRoot);
+        sourceRoots.Push(MakePair(i->first_, sourceRoot));
+
+        VectorBuffer buffer;
+        SharedPtr<Node> cellRoot(scene->CreateChild(sourceRoot->GetName(), LOCAL));
+        cellRoots.Push(cellRoot);
+        success = PackedSceneWriter::Write(buffer, sourceRoot) &&
+            PackedSceneReader::Read(buffer.GetData(), buffer.GetSize(), cellRoot, resolver, true, LOCAL);
+    }
+
+    if (success)
+    {
+        resolver.Resolve();
+        for (Node* cellRoot : cellRoots)
+            cellRoot->ApplyAttributes();
+    }
+
+    for (unsigned i = 0; i < cellRoots.Size() && success; ++i)
+    {
+        const IntVector2& coords = sourceRoots[i].first_;
+        Node* cellRoot = cellRoots[i];
+        const String fileName = "Cell_" + String(coords.x_) + "_" + String(coords.y_) + ".bin";
+
+        SceneCell cell;
+        cell.fileName_ = resourcePath + fileName;
+        cell.firstNodeID_ = cell.firstComponentID_ = M_MAX_UNSIGNED;
+        PODVector<Node*> nodes;
+        cellRoot->GetChildren(nodes, true);
+        for (Node* node : nodes)
+        {
+            cell.firstNodeID_ = Min(cell.firstNodeID_, node->GetID());
+            cell.lastNodeID_ = Max(cell.lastNodeID_, node->GetID());
+            for (const SharedPtr<Component>& component : node->GetComponents())
+            {
+                cell.firstComponentID_ = Min(cell.firstComponentID_, component->GetID());
+                cell.lastComponentID_ = Max(cell.lastComponentID_, component->GetID());
+            }
+        }
+        if (cell.firstNodeID_ > cell.lastNodeID_)
+            cell.firstNodeID_ = cell.lastNodeID_ = 0;
+        if (cell.firstComponentID_ > cell.lastComponentID_)
+            cell.firstComponentID_ = cell.lastComponentID_ = 0;
+
+        File file(context_);
+        if (!file.Open(path + fileName, FILE_WRITE) || !PackedSceneWriter::Write(file, cellRoot))
+        {
+            URHO3D_LOGERROR("Could not write scene cell " + path + fileName);
+            success = false;
+        }
+        else
+            cells_[coords] = cell;
+    }
+
+    for (Node* cellRoot : cellRoots)
+        cellRoot->Remove();
+
+    // Remove the original content, or move it back on failure, so that a failed split does not lose it
+    for (const Pair<IntVector2, SharedPtr<Node> >& sourceRoot : sourceRoots)
+    {
+        if (!success)
+        {
+            for (Node* node : cellNodes[sourceRoot.first_])
+                node->SetParent(scene);
+        }
+        sourceRoot.second_->Remove();
+    }
+
+    if (!success)
+    {
+        cells_.Clear();
+        URHO3D_LOGERROR("Could not split scene into cells");
+    }
+
+    return success;
+}
+
+IntVector2 SceneStreamer::GetCellCoords(const Vector3& position) const
+{
+    return IntVector2(FloorToInt(position.x_ / cellSize_), FloorToInt(position.z_ / cellSize_));
+}
+
+const SceneCell* SceneStreamer::GetCell(const IntVector2& coords) const
+{
+    auto i = cells_.Find(coords);
+    return i != cells_.End() ? &i->second_ : nullptr;
+}
+
+unsigned SceneStreamer::GetNumAttachedCells() const
+{
+    unsigned num = 0;
+    for (auto i = cells_.Begin(); i != cells_.End(); ++i)
+    {
+        if (i->second_.state_ == CELL_ATTACHED)
+            ++num;
+    }
+    return num;
+}
+
+void SceneStreamer::SetCellsAttr(const VariantVector& value)
+{
+    RemoveAllCells();
+
+    for (unsigned i = 0; i + CELL_ATTR_VALUES <= value.Size(); i += CELL_ATTR_VALUES)
+    {
+        SceneCell cell;
+        cell.fileName_ = value[i + 1].GetString();
+        cell.firstNodeID_ = value[i + 2].GetUInt();
+        cell.lastNodeID_ = value[i + 3].GetUInt();
+        cell.firstComponentID_ = value[i + 4].GetUInt();
+        cell.lastComponentID_ = value[i + 5].GetUInt();
+        cells_[value[i].GetIntVector2()] = cell;
+    }
+}
+
+VariantVector SceneStreamer::GetCellsAttr() const
+{
+    VariantVector ret;
+    ret.Reserve(cells_.Size() * CELL_ATTR_VALUES);
+
+    for (auto i = cells_.Begin(); i != cells_.End(); ++i)
+    {
+        const SceneCell& cell = i->second_;
+        ret.Push(i->first_);
+        ret.Push(cell.fileName_);
+        ret.Push(cell.firstNodeID_);
+        ret.Push(cell.lastNodeID_);
+        ret.Push(cell.firstComponentID_);
+        ret.Push(cell.lastComponentID_);
+    }
+
+    return ret;
+}
+
+void SceneStreamer::OnSceneSet(Scene* scene)
+{
+    if (scene)
+    {
+        SubscribeToEvent(scene, E_SCENEPOSTUPDATE, URHO3D_HANDLER(SceneStreamer, HandleScenePostUpdate));
+        SubscribeToEvent(E_RESOURCEBACKGROUNDLOADED, URHO3D_HANDLER(SceneStreamer, HandleResourceBackgroundLoaded));
+    }
+    else
+    {
+        UnsubscribeFromEvent(E_SCENEPOSTUPDATE);
+        UnsubscribeFromEvent(E_RESOURCEBACKGROUNDLOADED);
+        for (auto i = cells_.Begin(); i != cells_.End(); ++i)
+        {
+            i->second_.state_ = CELL_UNLOADED;
+            i->second_.node_.Reset();
+        }
+    }
+}
+
+void SceneStreamer::HandleScenePostUpdate(StringHash eventType, VariantMap& eventData)
+{
+    if (IsEnabledEffective())
+        UpdateCells();
+}
+
+void SceneStreamer::HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData)
+{
+    using namespace ResourceBackgroundLoaded;
+
+    auto* resource = static_cast<Resource*>(eventData[P_RESOURCE].GetPtr());
+    if (eventData[P_SUCCESS].GetBool() || !resource || resource->GetType() != SceneCellFile::GetTypeStatic())
+        return;
+
+    // A failed load leaves no resource to attach, so return the cell to the unloaded state and try again later
+    auto* cache = GetSubsystem<ResourceCache>();
+    const String& name = eventData[P_RESOURCENAME].GetString();
+    for (auto i = cells_.Begin(); i != cells_.End(); ++i)
+    {
+        SceneCell& cell = i->second_;
+        if ((cell.state_ == CELL_LOADING || cell.state_ == CELL_CANCELLING) && cache->SanitateResourceName(cell.fileName_) == name)
+        {
+            URHO3D_LOGERROR("Could not load scene cell " + name + ", retrying in " + String(CELL_RETRY_DELAY_MS) + " ms");
+            cache->ReleaseResource<SceneCellFile>(cell.fileName_);
+            SetLoadFailed(cell);
+        }
+    }
+}
+
+void SceneStreamer::UpdateCells()
+{
+    if (!focusNode_ || cells_.Empty())
+        return;
+
+    URHO3D_PROFILE("UpdateSceneStreaming");
+
+    auto* cache = GetSubsystem<ResourceCache>();
+    const Vector3 focusPosition = focusNode_->GetWorldPosition();
+
+    // Attach and detach until the budget runs out, but always process at least one cell to make progress
+    HiresTimer timer;
+    const long long budget = frameBudgetMs_ * 1000LL;
+    bool processed = false;
+
+    for (auto i = cells_.Begin(); i != cells_.End(); ++i)
+    {
+        SceneCell& cell = i->second_;
+        const float distance = GetDistance(i->first_, focusPosition);
+        const bool withinBudget = !processed || timer.GetUSec(false) < budget;
+
+        switch (cell.state_)
+        {
+        case CELL_UNLOADED:
+            if (distance <= loadDistance_ && (!cell.loadFailed_ || cell.retryTimer_.GetMSec(false) >= CELL_RETRY_DELAY_MS) &&
+                cache->BackgroundLoadResource<SceneCellFile>(cell.fileName_))
+            {
+                cell.state_ = CELL_LOADING;
+                cell.loadFailed_ = false;
+            }
+            break;
+
+        case CELL_LOADING:
+            if (distance > unloadDistance_)
+            {
+                // Releasing a resource still being loaded has no effect, so wait for the load to finish
+                if (cache->GetExistingResource<SceneCellFile>(cell.fileName_))
+                {
+                    cache->ReleaseResource<SceneCellFile>(cell.fileName_);
+                    cell.state_ = CELL_UNLOADED;
+                }
+                else
+                    cell.state_ = CELL_CANCELLING;
+            }
+            else if (withinBudget && cache->GetExistingResource<SceneCellFile>(cell.fileName_))
+            {
+                if (!AttachCell(cell))
+                    SetLoadFailed(cell);
+                processed = true;
+            }
+            break;
+
+        case CELL_CANCELLING:
+            if (distance <= loadDistance_)
+                cell.state_ = CELL_LOADING;
+            else if (cache->GetExistingResource<SceneCellFile>(cell.fileName_))
+            {
+                cache->ReleaseResource<SceneCellFile>(cell.fileName_);
+                cell.state_ = CELL_UNLOADED;
+            }
+            break;
+
+        case CELL_ATTACHED:
+            if (!cell.node_)
+                cell.state_ = CELL_UNLOADED;
+            else if (distance > unloadDistance_ && withinBudget)
+            {
+                DetachCell(cell);
+                processed = true;
+            }
+            break;
+        }
+    }
+}
+
+bool SceneStreamer::AttachCell(SceneCell& cell)
+{
+    URHO3D_PROFILE("AttachSceneCell");
+
+    Scene* scene = GetScene();
+    auto* cache = GetSubsystem<ResourceCache>();
+    SharedPtr<SceneCellFile> file(cache->GetExistingResource<SceneCellFile>(cell.fileName_));
+    if (!scene || !file)
+        return false;
+
+    // Keep the IDs the cell was saved with, unless any ID in its ranges has been taken in the meanwhile
+    const bool rewriteIDs = IsCellIDRangeInUse(scene, cell);
+    if (rewriteIDs)
+        URHO3D_LOGWARNING("IDs of scene cell " + cell.fileName_ + " are in use, assigning new IDs");
+
+    const PODVector<unsigned char>& data = file->GetData();
+    // The cell root is temporary, so that saving the scene does not include the streamed content
+    Node* node = scene->CreateChild(String::EMPTY, LOCAL, 0, true);
+    SceneResolver resolver;
+    if (!PackedSceneReader::Read(data.Buffer(), data.Size(), node, resolver, rewriteIDs))
+    {
+        URHO3D_LOGERROR("Could not attach scene cell " + cell.fileName_);
+        node->Remove();
+        cache->ReleaseResource<SceneCellFile>(cell.fileName_);
+        return false;
+    }
+
+    // With the saved IDs kept, references to content outside the cell stay valid as they are
+    if (rewriteIDs)
+        resolver.Resolve();
+    node->ApplyAttributes();
+
+    cell.node_ = node;
+    cell.state_ = CELL_ATTACHED;
+
+    // The content has been created, so the file data is no longer needed. The resources used by it are now held by the
+    // components
+    file.Reset();
+    cache->ReleaseResource<SceneCellFile>(cell.fileName_);
+    return true;
+}
+
+void SceneStreamer::DetachCell(SceneCell& cell)
+{
+    if (cell.node_)
+    {
+        URHO3D_PROFILE("DetachSceneCell");
+        cell.node_->Remove();
+    }
+
+    cell.node_.Reset();
+    cell.state_ = CELL_UNLOADED;
+}
+
+void SceneStreamer::SetLoadFailed(SceneCell& cell)
+{
+    cell.state_ = CELL_UNLOADED;
+    cell.loadFailed_ = true;
+    cell.retryTimer_.Reset();
+}
+
+float SceneStreamer::GetDistance(const IntVector2& coords, const Vector3& position) const
+{
+    const float minX = coords.x_ * cellSize_;
+    const float minZ = coords.y_ * cellSize_;
+    const float dx = Max(Max(minX - position.x_, position.x_ - (minX + cellSize_)), 0.0f);
+    const float dz = Max(Max(minZ - position.z_, position.z_ - (minZ + cellSize_)), 0.0f);
+    return sqrtf(dx * dx + dz * dz);
+}
+
+}
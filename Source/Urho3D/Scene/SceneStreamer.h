@@ -0,0 +1,183 @@
+//
+// Copyright (c) 2008-2019 the Urho3D project.
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in
+// all copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN
+// THE SOFTWARE.
+//
+
+#pragma once
+
+#include "../Core/Timer.h"
+#include "../Math/Vector2.h"
+#include "../Resource/Resource.h"
+#include "../Scene/Component.h"
+
+namespace Urho3D
+{
+
+/// Packed scene file of a streaming cell. Reads the data and requests the resources it refers to in the background, so that attaching the cell does not load anything.
+class URHO3D_API SceneCellFile : public Resource
+{
+    URHO3D_OBJECT(SceneCellFile, Resource);
+
+public:
+    /// Construct.
+    explicit SceneCellFile(Context* context);
+    /// Destruct.
+    ~SceneCellFile() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Load resource from stream. May be called from a worker thread. Return true if successful.
+    bool BeginLoad(Deserializer& source) override;
+    /// Finish resource loading. Always called from the main thread. Return true if successful.
+    bool EndLoad() override;
+
+    /// Return packed scene data.
+    const PODVector<unsigned char>& GetData() const { return data_; }
+
+private:
+    /// Packed scene data.
+    PODVector<unsigned char> data_;
+    /// Resources referred to by the cell, held while the cell file exists.
+    Vector<SharedPtr<Resource> > resources_;
+    /// Resource references found while loading.
+    Vector<ResourceRef> resourceRefs_;
+};
+
+/// Streaming cell state.
+enum SceneCellState
+{
+    CELL_UNLOADED = 0,
+    CELL_LOADING,
+    CELL_CANCELLING,
+    CELL_ATTACHED
+};
+
+/// Streaming cell of a scene.
+struct SceneCell
+{
+    /// Resource name of the cell file.
+    String fileName_;
+    /// First node ID of the cell content.
+    unsigned firstNodeID_{};
+    /// Last node ID of the cell content.
+    unsigned lastNodeID_{};
+    /// First component ID of the cell content.
+    unsigned firstComponentID_{};
+    /// Last component ID of the cell content.
+    unsigned lastComponentID_{};
+    /// State.
+    SceneCellState state_{CELL_UNLOADED};
+    /// Root node of the cell content while attached.
+    WeakPtr<Node> node_;
+    /// Whether the last load or attach failed. Loading is retried after a delay.
+    bool loadFailed_{};
+    /// Time since the last failed load.
+    Timer retryTimer_;
+};
+
+/// Scene component that streams content in and out in square cells on the XZ plane, based on distance from a focus node such as the camera. Cell files are loaded with the background loader, and attaching and detaching cells is limited to a time budget per frame.
+class URHO3D_API SceneStreamer : public Component
+{
+    URHO3D_OBJECT(SceneStreamer, Component);
+
+public:
+    /// Construct.
+    explicit SceneStreamer(Context* context);
+    /// Destruct.
+    ~SceneStreamer() override;
+    /// Register object factory.
+    static void RegisterObject(Context* context);
+
+    /// Set cell size in world units.
+    void SetCellSize(float size);
+    /// Set distance from the focus at which cells are loaded.
+    void SetLoadDistance(float distance);
+    /// Set distance from the focus at which cells are unloaded. Should be larger than the load distance to avoid reloading cells at the border.
+    void SetUnloadDistance(float distance);
+    /// Set time budget in milliseconds per frame for attaching and detaching cells. At least one cell is processed per frame.
+    void SetFrameBudgetMs(int ms);
+    /// Set node whose position decides which cells are loaded.
+    void SetFocusNode(Node* node);
+    /// Add a cell. Replaces an existing cell at the same coordinates.
+    void AddCell(const IntVector2& coords, const SceneCell& cell);
+    /// Remove all cells. Attached cell content is removed from the scene.
+    void RemoveAllCells();
+    /// Move the scene's root level nodes to cells by their position, save each cell as a packed scene file into a directory and remove the nodes from the scene. The content of each cell is saved with its own contiguous range of local IDs. Resource names of the cells are formed from the resource path and the file names. Return true if successful.
+    bool SplitScene(const String& directory, const String& resourcePath);
+
+    /// Return cell size.
+    float GetCellSize() const { return cellSize_; }
+    /// Return load distance.
+    float GetLoadDistance() const { return loadDistance_; }
+    /// Return unload distance.
+    float GetUnloadDistance() const { return unloadDistance_; }
+    /// Return time budget per frame.
+    int GetFrameBudgetMs() const { return frameBudgetMs_; }
+    /// Return focus node.
+    Node* GetFocusNode() const { return focusNode_; }
+    /// Return cell coordinates of a world position.
+    IntVector2 GetCellCoords(const Vector3& position) const;
+    /// Return cell by coordinates, or null if none.
+    const SceneCell* GetCell(const IntVector2& coords) const;
+    /// Return all cells.
+    const HashMap<IntVector2, SceneCell>& GetCells() const { return cells_; }
+    /// Return number of attached cells.
+    unsigned GetNumAttachedCells() const;
+
+    /// Set cells attribute.
+    void SetCellsAttr(const VariantVector& value);
+    /// Return cells attribute.
+    VariantVector GetCellsAttr() const;
+
+protected:
+    /// Handle scene being assigned.
+    void OnSceneSet(Scene* scene) override;
+
+private:
+    /// Handle scene post-update event.
+    void HandleScenePostUpdate(StringHash eventType, VariantMap& eventData);
+    /// Handle a background loaded resource, to detect cell files that failed to load.
+    void HandleResourceBackgroundLoaded(StringHash eventType, VariantMap& eventData);
+    /// Update cell states from the focus position and attach or detach cells within the time budget.
+    void UpdateCells();
+    /// Create the content of a loaded cell. Return true if successful.
+    bool AttachCell(SceneCell& cell);
+    /// Remove the content of a cell.
+    void DetachCell(SceneCell& cell);
+    /// Return a cell to the unloaded state after a failed load or attach, delaying the next attempt.
+    void SetLoadFailed(SceneCell& cell);
+    /// Return distance on the XZ plane from a position to a cell.
+    float GetDistance(const IntVector2& coords, const Vector3& position) const;
+
+    /// Cells by coordinates.
+    HashMap<IntVector2, SceneCell> cells_;
+    /// Focus node.
+    WeakPtr<Node> focusNode_;
+    /// Cell size.
+    float cellSize_{100.0f};
+    /// Load distance.
+    float loadDistance_{200.0f};
+    /// Unload distance.
+    float unloadDistance_{250.0f};
+    /// Time budget per frame in milliseconds.
+    int frameBudgetMs_{2};
+};
+
+}
@@ -23,6 +23,7 @@
 #include "../Precompiled.h"
 
 #include "../Core/Context.h"
+#include "../IO/BitStream.h"
 #include "../IO/Deserializer.h"
 #include "../IO/FileSystem.h"
 #include "../IO/Log.h"
@@ -31,6 +32,7 @@
 #include "../Resource/XMLFile.h"
 #include "../Resource/JSONFile.h"
 #include "../Resource/JSONValue.h"
+#include "../Resource/JSONView.h"
 #include "../Resource/ResourceCache.h"
 #include "../Scene/ReplicationState.h"
 #include "../Scene/SceneEvents.h"
@@ -41,6 +43,175 @@
 namespace Urho3D
 {
 
+/// Largest magnitude of the three smallest components of a normalized quaternion.
+static const float QUATERNION_COMPONENT_MAX = 0.707106781f;
+
+static unsigned GetNumQuantizedComponents(const AttributeInfo& attr)
+{
+    if (!attr.quantizeBits_)
+        return 0;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        return 1;
+    case VAR_VECTOR2:
+        return 2;
+    case VAR_VECTOR3:
+        return 3;
+    case VAR_QUATERNION:
+        // Index of the largest component, followed by the three others
+        return 4;
+    default:
+        return 0;
+    }
+}
+
+static unsigned QuantizeFloat(float value, float minValue, float maxValue, unsigned bits)
+{
+    auto maxSteps = (double)((1ULL << bits) - 1);
+    double range = (double)maxValue - minValue;
+    double t = range > 0.0 ? ((double)Clamp(value, minValue, maxValue) - minValue) / range : 0.0;
+    return (unsigned)(t * maxSteps + 0.5);
+}
+
+static float DequantizeFloat(unsigned value, float minValue, float maxValue, unsigned bits)
+{
+    auto maxSteps = (double)((1ULL << bits) - 1);
+    return (float)(minValue + ((double)maxValue - minValue) * (value / maxSteps));
+}
+
+static void QuantizeValue(const AttributeInfo& attr, const Variant& value, unsigned* dest)
+{
+    float minValue = attr.quantizeMin_;
+    float maxValue = attr.quantizeMax_;
+    unsigned bits = attr.quantizeBits_;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        dest[0] = QuantizeFloat(value.GetFloat(), minValue, maxValue, bits);
+        break;
+
+    case VAR_VECTOR2:
+        {
+            const Vector2& vec = value.GetVector2();
+            dest[0] = QuantizeFloat(vec.x_, minValue, maxValue, bits);
+            dest[1] = QuantizeFloat(vec.y_, minValue, maxValue, bits);
+        }
+        break;
+
+    case VAR_VECTOR3:
+        {
+            const Vector3& vec = value.GetVector3();
+            dest[0] = QuantizeFloat(vec.x_, minValue, maxValue, bits);
+            dest[1] = QuantizeFloat(vec.y_, minValue, maxValue, bits);
+            dest[2] = QuantizeFloat(vec.z_, minValue, maxValue, bits);
+        }
+        break;
+
+    case VAR_QUATERNION:
+        {
+            // Send the three smallest components, as the largest can be reconstructed from them. Flip the sign so that the
+            // largest is positive, as q and -q represent the same rotation
+            Quaternion quat = value.GetQuaternion().Normalized();
+            const float* data = quat.Data();
+            unsigned largest = 0;
+            for (unsigned i = 1; i < 4; ++i)
+            {
+                if (Abs(data[i]) > Abs(data[largest]))
+                    largest = i;
+            }
+
+            float sign = data[largest] < 0.0f ? -1.0f : 1.0f;
+            dest[0] = largest;
+            for (unsigned i = 0, j = 1; i < 4; ++i)
+            {
+                if (i != largest)
+                    dest[j++] = QuantizeFloat(data[i] * sign, -QUATERNION_COMPONENT_MAX, QUATERNION_COMPONENT_MAX, bits);
+            }
+        }
+        break;
+
+    default:
+        break;
+    }
+}
+
+static Variant DequantizeValue(const AttributeInfo& attr, const unsigned* src)
+{
+    float minValue = attr.quantizeMin_;
+    float maxValue = attr.quantizeMax_;
+    unsigned bits = attr.quantizeBits_;
+
+    switch (attr.type_)
+    {
+    case VAR_FLOAT:
+        return DequantizeFloat(src[0], minValue, maxValue, bits);
+
+    case VAR_VECTOR2:
+        return Vector2(DequantizeFloat(src[0], minValue, maxValue, bits), DequantizeFloat(src[1], minValue, maxValue, bits));
+
+    case VAR_VECTOR3:
+        return Vector3(DequantizeFloat(src[0], minValue, maxValue, bits), DequantizeFloat(src[1], minValue, maxValue, bits),
+            DequantizeFloat(src[2], minValue, maxValue, bits));
+
+    case VAR_QUATERNION:
+        {
+            float data[4];
+            unsigned largest = src[0] & 3u;
+            float sumSquares = 0.0f;
+            for (unsigned i = 0, j = 1; i < 4; ++i)
+            {
+                if (i != largest)
+                {
+                    data[i] = DequantizeFloat(src[j++], -QUATERNION_COMPONENT_MAX, QUATERNION_COMPONENT_MAX, bits);
+                    sumSquares += data[i] * data[i];
+                }
+            }
+            data[largest] = sqrtf(Max(1.0f - sumSquares, 0.0f));
+            return Quaternion(data[0], data[1], data[2], data[3]).Normalized();
+        }
+
+    default:
+        return Variant::EMPTY;
+    }
+}
+
+static void EncodeNetworkValue(Serializer& dest, const AttributeInfo& attr, const Variant& value)
+{
+    // Quantized values are stored unpacked, so that they keep their size and can be bit-packed when writing an update
+    unsigned numComponents = GetNumQuantizedComponents(attr);
+    if (numComponents)
+    {
+        unsigned components[4];
+        QuantizeValue(attr, value, components);
+        dest.Write(components, numComponents * sizeof(unsigned));
+    }
+    else
+        dest.WriteVariantData(value);
+}
+
+static void WriteQuantizedComponents(BitWriter& dest, const AttributeInfo& attr, const unsigned* components)
+{
+    unsigned numComponents = GetNumQuantizedComponents(attr);
+    unsigned i = 0;
+    if (attr.type_ == VAR_QUATERNION)
+        dest.Write(components[i++], 2);
+    for (; i < numComponents; ++i)
+        dest.Write(components[i], attr.quantizeBits_);
+}
+
+static void ReadQuantizedComponents(BitReader& source, const AttributeInfo& attr, unsigned* components)
+{
+    unsigned numComponents = GetNumQuantizedComponents(attr);
+    unsigned i = 0;
+    if (attr.type_ == VAR_QUATERNION)
+        components[i++] = source.Read(2);
+    for (; i < numComponents; ++i)
+        components[i] = source.Read(attr.quantizeBits_);
+}
+
 static unsigned RemapAttributeIndex(const Vector<AttributeInfo>* attributes, const AttributeInfo& netAttr, unsigned netAttrIndex)
 {
     if (!attributes)
@@ -66,6 +237,54 @@ Serializable::Serializable(Context* context) :
 
 Serializable::~Serializable() = default;
 
+/// Return index of the file attribute with the given name, or M_MAX_UNSIGNED if not found. Tries the predicted index
+/// first, as attributes are usually saved in order, then the interned name hashes.
+static unsigned FindFileAttribute(const Vector<AttributeInfo>& attributes, const HashMap<StringHash, unsigned>* indices,
+    const char* name, unsigned length, unsigned predicted)
+{
+    auto matches = [&](unsigned index)
+    {
+        const AttributeInfo& attr = attributes[index];
+        return (attr.mode_ & AM_FILE) && attr.name_.Length() == length && !memcmp(attr.name_.CString(), name, length);
+    };
+
+    if (predicted < attributes.Size() && matches(predicted))
+        return predicted;
+
+    if (indices)
+    {
+        HashMap<StringHash, unsigned>::ConstIterator i = indices->Find(StringHash(StringHash::Calculate((void*)name, length)));
+        if (i != indices->End() && i->second_ < attributes.Size() && matches(i->second_))
+            return i->second_;
+    }
+
+    // Unknown names, hash collisions and attributes not registered to the context fall back to a linear search
+    for (unsigned i = 0; i < attributes.Size(); ++i)
+    {
+        if (matches(i))
+            return i;
+    }
+
+    return M_MAX_UNSIGNED;
+}
+
+/// Return enum attribute value from name, or empty variant if not found.
+static Variant GetEnumValue(const AttributeInfo& attr, const char* value)
+{
+    int enumValue = 0;
+    const char** enumPtr = attr.enumNames_;
+    while (*enumPtr)
+    {
+        if (!String::Compare(value, *enumPtr, false))
+            return enumValue;
+        ++enumPtr;
+        ++enumValue;
+    }
+
+    URHO3D_LOGWARNING("Unknown enum value " + String(value) + " in attribute " + attr.name_);
+    return Variant::EMPTY;
+}
+
 void Serializable::OnSetAttribute(const AttributeInfo& attr, const Variant& src)
 {
     // TODO: may be could use an observer pattern here
@@ -294,6 +513,12 @@ const Vector<AttributeInfo>* Serializable::GetNetworkAttributes() const
     return networkState_ ? networkState_->attributes_ : context_->GetNetworkAttributes(GetType());
 }
 
+const HashMap<StringHash, unsigned>* Serializable::GetFileAttributeIndices(const Vector<AttributeInfo>* attributes) const
+{
+    // The interned name hashes index the attributes registered to the context, which subclasses may replace
+    return attributes == context_->GetAttributes(GetType()) ? context_->GetAttributeIndices(GetType()) : nullptr;
+}
+
 bool Serializable::Load(Deserializer& source)
 {
     const Vector<AttributeInfo>* attributes = GetAttributes();
@@ -357,62 +582,32 @@ bool Serializable::LoadXML(const XMLElement& source)
     if (!attributes)
         return true;
 
+    const HashMap<StringHash, unsigned>* indices = GetFileAttributeIndices(attributes);
     XMLElement attrElem = source.GetChild("attribute");
     unsigned startIndex = 0;
 
     while (attrElem)
     {
-        String name = attrElem.GetAttribute("name");
-        unsigned i = startIndex;
-        unsigned attempts = attributes->Size();
-
-        while (attempts)
+        const char* name = attrElem.GetAttributeCString("name");
+        unsigned i = FindFileAttribute(*attributes, indices, name, String::CStringLength(name), startIndex);
+        if (i < attributes->Size())
         {
             const AttributeInfo& attr = attributes->At(i);
-            if ((attr.mode_ & AM_FILE) && !attr.name_.Compare(name, true))
-            {
-                Variant varValue;
+            Variant varValue;
 
-                // If enums specified, do enum lookup and int assignment. Otherwise assign the variant directly
-                if (attr.enumNames_ && attr.type_ == VAR_INT)
-                {
-                    String value = attrElem.GetAttribute("value");
-                    bool enumFound = false;
-                    int enumValue = 0;
-                    const char** enumPtr = attr.enumNames_;
-                    while (*enumPtr)
-                    {
-                        if (!value.Compare(*enumPtr, false))
-                        {
-                            enumFound = true;
-                            break;
-                        }
-                        ++enumPtr;
-                        ++enumValue;
-                    }
-                    if (enumFound)
-                        varValue = enumValue;
-                    else
-                        URHO3D_LOGWARNING("Unknown enum value " + value + " in attribute " + attr.name_);
-                }
-                else
-                    varValue = attrElem.GetVariantValue(attr.type_);
+            // If enums specified, do enum lookup and int assignment. Otherwise assign the variant directly
+            if (attr.enumNames_ && attr.type_ == VAR_INT)
+                varValue = GetEnumValue(attr, attrElem.GetAttributeCString("value"));
+            else
+                varValue = attrElem.GetVariantValue(attr.type_);
 
-                if (!varValue.IsEmpty())
-                    OnSetAttribute(attr, varValue);
+            if (!varValue.IsEmpty())
+                OnSetAttribute(attr, varValue);
 
-                startIndex = (i + 1) % attributes->Size();
-                break;
-            }
-            else
-            {
-                i = (i + 1) % attributes->Size();
-                --attempts;
-            }
+            startIndex = (i + 1) % attributes->Size();
         }
-
-        if (!attempts)
-            URHO3D_LOGWARNING("Unknown attribute " + name + " in XML data");
+        else
+            URHO3D_LOGWARNING("Unknown attribute " + String(name) + " in XML data");
 
         attrElem = attrElem.GetNext("attribute");
     }
@@ -433,7 +628,7 @@ bool Serializable::LoadJSON(const JSONValue& source)
         return true;
 
     // Get attributes value
-    JSONValue attributesValue = source.Get("attributes");
+    const JSONValue& attributesValue = source.Get("attributes");
     if (attributesValue.IsNull())
         return true;
     // Warn if the attributes value isn't an object
@@ -444,65 +639,89 @@ bool Serializable::LoadJSON(const JSONValue& source)
     }
 
     const JSONObject& attributesObject = attributesValue.GetObject();
-
+    const HashMap<StringHash, unsigned>* indices = GetFileAttributeIndices(attributes);
     unsigned startIndex = 0;
 
-    for (JSONObject::ConstIterator it = attributesObject.Begin(); it != attributesObject.End();)
+    for (JSONObject::ConstIterator it = attributesObject.Begin(); it != attributesObject.End(); ++it)
     {
-        String name = it->first_;
+        const String& name = it->first_;
         const JSONValue& value = it->second_;
-        unsigned i = startIndex;
-        unsigned attempts = attributes->Size();
-
-        while (attempts)
+        unsigned i = FindFileAttribute(*attributes, indices, name.CString(), name.Length(), startIndex);
+        if (i < attributes->Size())
         {
             const AttributeInfo& attr = attributes->At(i);
-            if ((attr.mode_ & AM_FILE) && !attr.name_.Compare(name, true))
-            {
-                Variant varValue;
+            Variant varValue;
 
-                // If enums specified, do enum lookup ad int assignment. Otherwise assign variant directly
-                if (attr.enumNames_ && attr.type_ == VAR_INT)
-                {
-                    const String& valueStr = value.GetString();
-                    bool enumFound = false;
-                    int enumValue = 0;
-                    const char** enumPtr = attr.enumNames_;
-                    while (*enumPtr)
-                    {
-                        if (!valueStr.Compare(*enumPtr, false))
-                        {
-                            enumFound = true;
-                            break;
-                        }
-                        ++enumPtr;
-                        ++enumValue;
-                    }
-                    if (enumFound)
-                        varValue = enumValue;
-                    else
-                        URHO3D_LOGWARNING("Unknown enum value " + valueStr + " in attribute " + attr.name_);
-                }
-                else
-                    varValue = value.GetVariantValue(attr.type_);
+            // If enums specified, do enum lookup ad int assignment. Otherwise assign variant directly
+            if (attr.enumNames_ && attr.type_ == VAR_INT)
+                varValue = GetEnumValue(attr, value.GetString().CString());
+            else
+                varValue = value.GetVariantValue(attr.type_);
 
-                if (!varValue.IsEmpty())
-                    OnSetAttribute(attr, varValue);
+            if (!varValue.IsEmpty())
+                OnSetAttribute(attr, varValue);
 
-                startIndex = (i + 1) % attributes->Size();
-                break;
-            }
-            else
-            {
-                i = (i + 1) % attributes->Size();
-                --attempts;
-            }
+            startIndex = (i + 1) % attributes->Size();
         }
-
-        if (!attempts)
+        else
             URHO3D_LOGWARNING("Unknown attribute " + name + " in JSON data");
+    }
+
+    return true;
+}
+
+bool Serializable::LoadJSON(const JSONView& source)
+{
+    if (!CanLoadJSONView())
+        return LoadJSONValueCopy(source);
 
-        it++;
+    if (source.IsNull())
+    {
+        URHO3D_LOGERROR("Could not load " + GetTypeName() + ", null JSON source element");
+        return false;
+    }
+
+    const Vector<AttributeInfo>* attributes = GetAttributes();
+    if (!attributes)
+        return true;
+
+    // Get attributes value
+    JSONView attributesValue = source.Get("attributes");
+    if (attributesValue.IsNull())
+        return true;
+    // Warn if the attributes value isn't an object
+    if (!attributesValue.IsObject())
+    {
+        URHO3D_LOGWARNING("'attributes' object is present in " + GetTypeName() + " but is not a JSON object; skipping load");
+        return true;
+    }
+
+    const HashMap<StringHash, unsigned>* indices = GetFileAttributeIndices(attributes);
+    unsigned startIndex = 0;
+
+    for (unsigned j = 0; j < attributesValue.Size(); ++j)
+    {
+        const char* name = attributesValue.GetMemberName(j);
+        JSONView value = attributesValue.GetMemberValue(j);
+        unsigned i = FindFileAttribute(*attributes, indices, name, attributesValue.GetMemberNameLength(j), startIndex);
+        if (i < attributes->Size())
+        {
+            const AttributeInfo& attr = attributes->At(i);
+            Variant varValue;
+
+            // If enums specified, do enum lookup and int assignment. Otherwise parse the variant directly from the view
+            if (attr.enumNames_ && attr.type_ == VAR_INT)
+                varValue = GetEnumValue(attr, value.GetCString());
+            else
+                varValue = value.GetVariantValue(attr.type_);
+
+            if (!varValue.IsEmpty())
+                OnSetAttribute(attr, varValue);
+
+            startIndex = (i + 1) % attributes->Size();
+        }
+        else
+            URHO3D_LOGWARNING("Unknown attribute " + String(name) + " in JSON data");
     }
 
     return true;
@@ -550,6 +769,18 @@ bool Serializable::SaveXML(XMLElement& dest) const
     return true;
 }
 
+bool Serializable::CanLoadJSONView() const
+{
+    return context_->CanLoadJSONView(GetType());
+}
+
+bool Serializable::LoadJSONValueCopy(const JSONView& source)
+{
+    JSONValue value;
+    source.CopyTo(value);
+    return LoadJSON(value);
+}
+
 bool Serializable::SaveJSON(JSONValue& dest) const
 {
     const Vector<AttributeInfo>* attributes = GetAttributes();
@@ -770,11 +1001,102 @@ void Serializable::AllocateNetworkState()
     {
         networkState_->currentValues_.Resize(numAttributes);
         networkState_->previousValues_.Resize(numAttributes);
+        networkState_->changedFrames_.Resize(numAttributes);
 
         // Copy the default attribute values to the previous state as a starting point
         for (unsigned i = 0; i < numAttributes; ++i)
+        {
             networkState_->previousValues_[i] = networkAttributes->At(i).defaultValue_;
+            networkState_->changedFrames_[i] = 0;
+        }
+    }
+}
+
+void Serializable::EncodeNetworkState(const DirtyBits& changedAttributes)
+{
+    if (!networkState_ || !networkState_->attributes_)
+        return;
+
+    const Vector<AttributeInfo>& attributes = *networkState_->attributes_;
+    const Vector<Variant>& values = networkState_->currentValues_;
+    VectorBuffer& encoded = networkState_->encodedValues_;
+    PODVector<unsigned>& offsets = networkState_->encodedOffsets_;
+    unsigned numAttributes = values.Size();
+
+    if (offsets.Size() == numAttributes + 1)
+    {
+        if (!changedAttributes.Count())
+            return;
+
+        // Overwrite the changed values in place, unless the size of any of them changes
+        bool sizeChanged = false;
+        for (unsigned i = 0; i < numAttributes && !sizeChanged; ++i)
+        {
+            if (changedAttributes.IsSet(i))
+            {
+                encoded.Seek(offsets[i]);
+                EncodeNetworkValue(encoded, attributes[i], values[i]);
+                sizeChanged = encoded.GetPosition() != offsets[i + 1];
+            }
+        }
+
+        if (!sizeChanged)
+            return;
+    }
+
+    encoded.Clear();
+    offsets.Resize(numAttributes + 1);
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        offsets[i] = encoded.GetPosition();
+        EncodeNetworkValue(encoded, attributes[i], values[i]);
+    }
+    offsets[numAttributes] = encoded.GetPosition();
+}
+
+void Serializable::WriteNetworkValues(Serializer& dest, const DirtyBits& attributeBits) const
+{
+    const Vector<AttributeInfo>& attributes = *networkState_->attributes_;
+    const Vector<Variant>& values = networkState_->currentValues_;
+    const unsigned char* encodedData = networkState_->encodedValues_.GetData();
+    const PODVector<unsigned>& offsets = networkState_->encodedOffsets_;
+    unsigned numAttributes = attributes.Size();
+    bool encoded = offsets.Size() == numAttributes + 1;
+    bool hasQuantized = false;
+
+    // Write full precision values first, copying from the encoded data if available
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        if (!attributeBits.IsSet(i))
+            continue;
+
+        if (GetNumQuantizedComponents(attributes[i]))
+            hasQuantized = true;
+        else if (encoded)
+            dest.Write(encodedData + offsets[i], offsets[i + 1] - offsets[i]);
+        else
+            dest.WriteVariantData(values[i]);
+    }
+
+    if (!hasQuantized)
+        return;
+
+    // Then bit-pack the quantized values
+    BitWriter bits(dest);
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        unsigned numComponents = GetNumQuantizedComponents(attributes[i]);
+        if (!numComponents || !attributeBits.IsSet(i))
+            continue;
+
+        unsigned components[4];
+        if (encoded)
+            memcpy(components, encodedData + offsets[i], numComponents * sizeof(unsigned));
+        else
+            QuantizeValue(attributes[i], values[i], components);
+        WriteQuantizedComponents(bits, attributes[i], components);
     }
+    bits.Flush();
 }
 
 void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeStamp)
@@ -803,12 +1125,7 @@ void Serializable::WriteInitialDeltaUpdate(Serializer& dest, unsigned char timeS
     // First write the change bitfield, then attribute data for non-default attributes
     dest.WriteUByte(timeStamp);
     dest.Write(attributeBits.data_, (numAttributes + 7) >> 3u);
-
-    for (unsigned i = 0; i < numAttributes; ++i)
-    {
-        if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
-    }
+    WriteNetworkValues(dest, attributeBits);
 }
 
 void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attributeBits, unsigned char timeStamp)
@@ -829,12 +1146,7 @@ void Serializable::WriteDeltaUpdate(Serializer& dest, const DirtyBits& attribute
     // Note: the attribute bits should not contain LATESTDATA attributes
     dest.WriteUByte(timeStamp);
     dest.Write(attributeBits.data_, (numAttributes + 7) >> 3u);
-
-    for (unsigned i = 0; i < numAttributes; ++i)
-    {
-        if (attributeBits.IsSet(i))
-            dest.WriteVariantData(networkState_->currentValues_[i]);
-    }
+    WriteNetworkValues(dest, attributeBits);
 }
 
 void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeStamp)
@@ -850,14 +1162,16 @@ void Serializable::WriteLatestDataUpdate(Serializer& dest, unsigned char timeSta
         return;
 
     unsigned numAttributes = attributes->Size();
-
-    dest.WriteUByte(timeStamp);
+    DirtyBits attributeBits;
 
     for (unsigned i = 0; i < numAttributes; ++i)
     {
         if (attributes->At(i).mode_ & AM_LATESTDATA)
-            dest.WriteVariantData(networkState_->currentValues_[i]);
+            attributeBits.Set(i);
     }
+
+    dest.WriteUByte(timeStamp);
+    WriteNetworkValues(dest, attributeBits);
 }
 
 bool Serializable::ReadDeltaUpdate(Deserializer& source)
@@ -868,38 +1182,11 @@ bool Serializable::ReadDeltaUpdate(Deserializer& source)
 
     unsigned numAttributes = attributes->Size();
     DirtyBits attributeBits;
-    bool changed = false;
 
-    unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
     unsigned char timeStamp = source.ReadUByte();
     source.Read(attributeBits.data_, (numAttributes + 7) >> 3u);
 
-    for (unsigned i = 0; i < numAttributes && !source.IsEof(); ++i)
-    {
-        if (attributeBits.IsSet(i))
-        {
-            const AttributeInfo& attr = attributes->At(i);
-            if (!(interceptMask & (1ULL << i)))
-            {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
-                changed = true;
-            }
-            else
-            {
-                using namespace InterceptNetworkUpdate;
-
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_SERIALIZABLE] = this;
-                eventData[P_TIMESTAMP] = (unsigned)timeStamp;
-                eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
-                eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
-                SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
-            }
-        }
-    }
-
-    return changed;
+    return ReadNetworkValues(source, attributeBits, timeStamp);
 }
 
 bool Serializable::ReadLatestDataUpdate(Deserializer& source)
@@ -909,39 +1196,80 @@ bool Serializable::ReadLatestDataUpdate(Deserializer& source)
         return false;
 
     unsigned numAttributes = attributes->Size();
-    bool changed = false;
+    DirtyBits attributeBits;
+
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        if (attributes->At(i).mode_ & AM_LATESTDATA)
+            attributeBits.Set(i);
+    }
 
-    unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
     unsigned char timeStamp = source.ReadUByte();
 
+    return ReadNetworkValues(source, attributeBits, timeStamp);
+}
+
+bool Serializable::ReadNetworkValues(Deserializer& source, const DirtyBits& attributeBits, unsigned char timeStamp)
+{
+    const Vector<AttributeInfo>& attributes = *GetNetworkAttributes();
+    unsigned numAttributes = attributes.Size();
+    bool changed = false;
+    bool hasQuantized = false;
+
     for (unsigned i = 0; i < numAttributes && !source.IsEof(); ++i)
     {
-        const AttributeInfo& attr = attributes->At(i);
-        if (attr.mode_ & AM_LATESTDATA)
-        {
-            if (!(interceptMask & (1ULL << i)))
-            {
-                OnSetAttribute(attr, source.ReadVariant(attr.type_));
-                changed = true;
-            }
-            else
-            {
-                using namespace InterceptNetworkUpdate;
-
-                VariantMap& eventData = GetEventDataMap();
-                eventData[P_SERIALIZABLE] = this;
-                eventData[P_TIMESTAMP] = (unsigned)timeStamp;
-                eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, i);
-                eventData[P_NAME] = attr.name_;
-                eventData[P_VALUE] = source.ReadVariant(attr.type_);
-                SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
-            }
-        }
+        if (!attributeBits.IsSet(i))
+            continue;
+
+        const AttributeInfo& attr = attributes[i];
+        if (GetNumQuantizedComponents(attr))
+            hasQuantized = true;
+        else if (SetNetworkValue(attr, i, source.ReadVariant(attr.type_), timeStamp))
+            changed = true;
+    }
+
+    if (!hasQuantized)
+        return changed;
+
+    BitReader bits(source);
+    for (unsigned i = 0; i < numAttributes; ++i)
+    {
+        const AttributeInfo& attr = attributes[i];
+        if (!attributeBits.IsSet(i) || !GetNumQuantizedComponents(attr))
+            continue;
+
+        unsigned components[4];
+        ReadQuantizedComponents(bits, attr, components);
+        if (SetNetworkValue(attr, i, DequantizeValue(attr, components), timeStamp))
+            changed = true;
     }
 
     return changed;
 }
 
+bool Serializable::SetNetworkValue(const AttributeInfo& attr, unsigned index, const Variant& value, unsigned char timeStamp)
+{
+    unsigned long long interceptMask = networkState_ ? networkState_->interceptMask_ : 0;
+    if (!(interceptMask & (1ULL << index)))
+    {
+        OnSetAttribute(attr, value);
+        return true;
+    }
+    else
+    {
+        using namespace InterceptNetworkUpdate;
+
+        VariantMap& eventData = GetEventDataMap();
+        eventData[P_SERIALIZABLE] = this;
+        eventData[P_TIMESTAMP] = (unsigned)timeStamp;
+        eventData[P_INDEX] = RemapAttributeIndex(GetAttributes(), attr, index);
+        eventData[P_NAME] = attr.name_;
+        eventData[P_VALUE] = value;
+        SendEvent(E_INTERCEPTNETWORKUPDATE, eventData);
+        return false;
+    }
+}
+
 Variant Serializable::GetAttribute(unsigned index) const
 {
     Variant ret;
@@ -35,6 +35,7 @@ class Deserializer;
 class Serializer;
 class XMLElement;
 class JSONValue;
+class JSONView;
 
 struct DirtyBits;
 struct NetworkState;
@@ -69,6 +70,8 @@ public:
     virtual bool SaveXML(XMLElement& dest) const;
     /// Load from JSON data. Return true if successful.
     virtual bool LoadJSON(const JSONValue& source);
+    /// Load from a read-only view of JSON data parsed in place, without converting it into JSON values. Return true if successful. Types that override only LoadJSON(const JSONValue&) get the view converted and passed to it.
+    virtual bool LoadJSON(const JSONView& source);
     /// Save as JSON data. Return true if successful.
     virtual bool SaveJSON(JSONValue& dest) const;
     /// Load from binary resource.
@@ -139,10 +142,25 @@ public:
     NetworkState* GetNetworkState() const { return networkState_.Get(); }
 
 protected:
+    /// Return whether this object may load from a JSON view directly. False when its type overrides LoadJSON(const JSONValue&) but not the view overload, or was not registered with the template factory. Overrides of the view overload should check this first.
+    bool CanLoadJSONView() const;
+    /// Load from a JSON view by converting it to a JSON value and calling LoadJSON(const JSONValue&).
+    bool LoadJSONValueCopy(const JSONView& source);
+    /// Encode the current network attribute values for writing the network updates of all connections. Changed attributes are encoded in place when their size stays the same. Called by PrepareNetworkUpdate().
+    void EncodeNetworkState(const DirtyBits& changedAttributes);
+
     /// Network attribute state.
     UniquePtr<NetworkState> networkState_;
 
 private:
+    /// Write network attribute values according to attribute bits, from the encoded data if available. Quantized values are bit-packed after the others.
+    void WriteNetworkValues(Serializer& dest, const DirtyBits& attributeBits) const;
+    /// Read and apply network attribute values according to attribute bits. Return true if attributes were changed.
+    bool ReadNetworkValues(Deserializer& source, const DirtyBits& attributeBits, unsigned char timeStamp);
+    /// Apply a received network attribute value, or send it as an event if intercepted. Return true if applied.
+    bool SetNetworkValue(const AttributeInfo& attr, unsigned index, const Variant& value, unsigned char timeStamp);
+    /// Return interned name hashes for the attributes if they are the ones registered to the context, or null otherwise.
+    const HashMap<StringHash, unsigned>* GetFileAttributeIndices(const Vector<AttributeInfo>* attributes) const;
     /// Set instance-level default value. Allocate the internal data structure as necessary.
     void SetInstanceDefault(const String& name, const Variant& defaultValue);
     /// Get instance-level default value.
@@ -28,6 +28,7 @@
 #include "../IO/Serializer.h"
 #include "../Resource/XMLElement.h"
 #include "../Resource/JSONValue.h"
+#include "../Resource/JSONView.h"
 #include "../Scene/UnknownComponent.h"
 
 #include "../DebugNew.h"
@@ -92,6 +93,12 @@ bool UnknownComponent::LoadXML(const XMLElement& source)
 }
 
 
+bool UnknownComponent::LoadJSON(const JSONView& source)
+{
+    // Unknown components are rare, so convert their data and load it as JSON values
+    return LoadJSONValueCopy(source);
+}
+
 bool UnknownComponent::LoadJSON(const JSONValue& source)
 {
     useXML_ = true;
@@ -99,7 +106,7 @@ bool UnknownComponent::LoadJSON(const JSONValue& source)
     xmlAttributeInfos_.Clear();
     binaryAttributes_.Clear();
 
-    JSONArray attributesArray = source.Get("attributes").GetArray();
+    const JSONArray& attributesArray = source.Get("attributes").GetArray();
     for (unsigned i = 0; i < attributesArray.Size(); i++)
     {
         const JSONValue& attrVal = attributesArray.At(i);
@@ -59,6 +59,8 @@ public:
     bool LoadXML(const XMLElement& source) override;
     /// Load from JSON data. Return true if successful.
     bool LoadJSON(const JSONValue& source) override;
+    /// Load from a read-only view of JSON data. Return true if successful.
+    bool LoadJSON(const JSONView& source) override;
     /// Save as binary data. Return true if successful.
     bool Save(Serializer& dest) const override;
     /// Save as XML data. Return true if successful.
@@ -161,7 +161,7 @@ bool ValueAnimation::LoadJSON(const JSONValue& source)
         splineTension_ = source.Get("splinetension").GetFloat();
 
     // Load keyframes
-    JSONArray keyFramesArray = source.Get("keyframes").GetArray();
+    const JSONArray& keyFramesArray = source.Get("keyframes").GetArray();
     for (unsigned i = 0; i < keyFramesArray.Size(); i++)
     {
         const JSONValue& val = keyFramesArray[i];
@@ -171,7 +171,7 @@ bool ValueAnimation::LoadJSON(const JSONValue& source)
     }
 
     // Load event frames
-    JSONArray eventFramesArray = source.Get("eventframes").GetArray();
+    const JSONArray& eventFramesArray = source.Get("eventframes").GetArray();
     for (unsigned i = 0; i < eventFramesArray.Size(); i++)
     {
         const JSONValue& eventFrameVal = eventFramesArray[i];
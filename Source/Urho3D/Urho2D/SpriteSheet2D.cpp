@@ -280,7 +280,7 @@ bool SpriteSheet2D::BeginLoadFromJSONFile(Deserializer& source)
 
     SetMemoryUse(source.GetSize());
 
-    JSONValue rootElem = loadJSONFile_->GetRoot();
+    const JSONValue& rootElem = loadJSONFile_->GetRoot();
     if (rootElem.IsNull())
     {
         URHO3D_LOGERROR("Invalid sprite sheet");
@@ -308,8 +308,8 @@ bool SpriteSheet2D::EndLoadFromJSONFile()
         return false;
     }
 
-    JSONValue rootVal = loadJSONFile_->GetRoot();
-    JSONArray subTextureArray = rootVal.Get("subtextures").GetArray();
+    const JSONValue& rootVal = loadJSONFile_->GetRoot();
+    const JSONArray& subTextureArray = rootVal.Get("subtextures").GetArray();
 
     for (unsigned i = 0; i < subTextureArray.Size(); i++)
     {
@@ -324,8 +324,8 @@ bool SpriteSheet2D::EndLoadFromJSONFile()
 
         Vector2 hotSpot(0.5f, 0.5f);
         IntVector2 offset(0, 0);
-        JSONValue frameWidthVal = subTextureVal.Get("frameWidth");
-        JSONValue frameHeightVal = subTextureVal.Get("frameHeight");
+        const JSONValue& frameWidthVal = subTextureVal.Get("frameWidth");
+        const JSONValue& frameHeightVal = subTextureVal.Get("frameHeight");
 
         if (!frameWidthVal.IsNull() && !frameHeightVal.IsNull())
         {
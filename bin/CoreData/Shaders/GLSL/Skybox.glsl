@@ -2,6 +2,8 @@
 #include "Samplers.glsl"
 #include "Transform.glsl"
 
+uniform vec4 cPositionDequantize;
+
 varying vec3 vTexCoord;
 
 void VS()
@@ -10,7 +12,7 @@ void VS()
     vec3 worldPos = GetWorldPos(modelMatrix);
     gl_Position = GetClipPos(worldPos);
     gl_Position.z = gl_Position.w;
-    vTexCoord = iPos.xyz;
+    vTexCoord = iPos.xyz * cPositionDequantize.w + cPositionDequantize.xyz;
 }
 
 void PS()
@@ -2,6 +2,21 @@
 #include "Samplers.hlsl"
 #include "Transform.hlsl"
 
+#ifndef D3D11
+
+// D3D9 uniforms
+uniform float4 cPositionDequantize;
+
+#else
+
+// D3D11 constant buffer
+cbuffer CustomVS : register(b6)
+{
+    float4 cPositionDequantize;
+}
+
+#endif
+
 void VS(float4 iPos : POSITION,
     #ifdef INSTANCED
         float4x3 iModelInstance : TEXCOORD4,
@@ -14,7 +29,7 @@ void VS(float4 iPos : POSITION,
     oPos = GetClipPos(worldPos);
 
     oPos.z = oPos.w;
-    oTexCoord = iPos.xyz;
+    oTexCoord = iPos.xyz * cPositionDequantize.w + cPositionDequantize.xyz;
 }
 
 void PS(float3 iTexCoord : TEXCOORD0,
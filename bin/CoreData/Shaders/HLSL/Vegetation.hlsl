@@ -12,6 +12,7 @@ uniform float cWindHeightFactor;
 uniform float cWindHeightPivot;
 uniform float cWindPeriod;
 uniform float2 cWindWorldSpacing;
+uniform float4 cPositionDequantize;
 
 #else
 
@@ -22,6 +23,7 @@ cbuffer CustomVS : register(b6)
     float cWindHeightPivot;
     float cWindPeriod;
     float2 cWindWorldSpacing;
+    float4 cPositionDequantize;
 }
 
 #endif
@@ -96,7 +98,7 @@ void VS(float4 iPos : POSITION,
     float4x3 modelMatrix = iModelMatrix;
     float3 worldPos = GetWorldPos(modelMatrix);
     
-    float windStrength = max(iPos.y - cWindHeightPivot, 0.0) * cWindHeightFactor;
+    float windStrength = max(iPos.y * cPositionDequantize.w + cPositionDequantize.y - cWindHeightPivot, 0.0) * cWindHeightFactor;
     float windPeriod = cElapsedTime * cWindPeriod + dot(worldPos.xz, cWindWorldSpacing);
     worldPos.x += windStrength * sin(windPeriod);
     worldPos.z -= windStrength * cos(windPeriod);